@@ -0,0 +1,70 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+// ---------------------------
+// Arduino API for the native build
+// ---------------------------
+// The subset of the Arduino-ESP32 core the firmware uses, implemented on
+// POSIX so the portable sources compile and run as a Linux process. Like the
+// ESP32 core, this header also brings in FreeRTOS and esp_timer.
+// Host-only controls (data directory, virtual time, heap and flash counters)
+// are in host_platform.h.
+
+#include <ctype.h>
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include "HardwareSerial.h"
+#include "Print.h"
+#include "WString.h"
+#include "esp_err.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "freertos/timers.h"
+
+using std::abs;
+using std::max;
+using std::min;
+
+typedef uint8_t byte;
+typedef bool boolean;
+typedef uint16_t word;
+
+#define PROGMEM
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+
+long random(long howbig);
+long random(long howsmall, long howbig);
+void randomSeed(unsigned long seed);
+long map(long x, long inMin, long inMax, long outMin, long outMax);
+
+/// ESP.restart() and the few chip queries the firmware makes.
+class EspClass {
+ public:
+  /// Ends the process: there is nothing to reboot into.
+  [[noreturn]] void restart();
+  uint32_t getFreeHeap();
+  uint32_t getHeapSize();
+  const char* getSdkVersion() { return "host"; }
+};
+
+extern EspClass ESP;
+
+#endif // HOST_ARDUINO_H
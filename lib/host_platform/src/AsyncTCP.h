@@ -0,0 +1,7 @@
+#ifndef HOST_ASYNC_TCP_H
+#define HOST_ASYNC_TCP_H
+
+// The web server isn't part of the native build (see ESPAsyncWebServer.h).
+class AsyncClient;
+
+#endif // HOST_ASYNC_TCP_H
@@ -0,0 +1,27 @@
+#ifndef HOST_ESP_ASYNC_WEB_SERVER_H
+#define HOST_ESP_ASYNC_WEB_SERVER_H
+
+#include "AsyncTCP.h"
+#include <stdint.h>
+
+// ---------------------------
+// ESPAsyncWebServer declarations
+// ---------------------------
+// Only what wifi_manager_esp32.h names, so the game modes that take a
+// WiFiManagerESP32 compile. The native build has no web server: the host
+// WiFiManagerESP32 (src/host/wifi_manager_host.cpp) keeps the state the modes
+// read and write and never registers handlers.
+
+class AsyncWebServerRequest;
+
+class AsyncWebServer {
+ public:
+  explicit AsyncWebServer(uint16_t port) : port(port) {}
+  void begin() {}
+  void end() {}
+
+ private:
+  uint16_t port;
+};
+
+#endif // HOST_ESP_ASYNC_WEB_SERVER_H
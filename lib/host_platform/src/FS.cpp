@@ -0,0 +1,299 @@
+#include "FS.h"
+#include "LittleFS.h"
+#include "host_platform.h"
+
+#include <atomic>
+#include <dirent.h>
+#include <fcntl.h>
+#include <ftw.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// ---------------------------
+// Flash Counters
+// ---------------------------
+
+static std::atomic<uint64_t> statOpens{0};
+static std::atomic<uint64_t> statWriteCalls{0};
+static std::atomic<uint64_t> statBytesWritten{0};
+static std::atomic<uint64_t> statReadCalls{0};
+static std::atomic<uint64_t> statBytesRead{0};
+static std::atomic<uint64_t> statRemoves{0};
+static std::atomic<uint64_t> statRenames{0};
+
+HostFsStats HostFs::stats() {
+  return {statOpens.load(), statWriteCalls.load(), statBytesWritten.load(), statReadCalls.load(), statBytesRead.load(), statRemoves.load(), statRenames.load()};
+}
+
+void HostFs::resetStats() {
+  statOpens = 0;
+  statWriteCalls = 0;
+  statBytesWritten = 0;
+  statReadCalls = 0;
+  statBytesRead = 0;
+  statRemoves = 0;
+  statRenames = 0;
+}
+
+namespace fs {
+
+// ---------------------------
+// File
+// ---------------------------
+
+class FileImpl {
+ public:
+  int fd = -1;
+  DIR* dir = nullptr;
+  String path;     // As the firmware named it ("/games/001.bin")
+  String hostPath; // Where it is on the host
+  String baseName;
+
+  ~FileImpl() {
+    if (fd >= 0)
+      ::close(fd);
+    if (dir)
+      closedir(dir);
+  }
+};
+
+static const char* lastComponent(const String& path) {
+  int slash = path.lastIndexOf('/');
+  return path.c_str() + (slash < 0 ? 0 : slash + 1);
+}
+
+size_t File::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t File::write(const uint8_t* buf, size_t size) {
+  if (!impl || impl->fd < 0)
+    return 0;
+  ssize_t n = ::write(impl->fd, buf, size);
+  statWriteCalls++;
+  if (n <= 0)
+    return 0;
+  statBytesWritten += (uint64_t)n;
+  return (size_t)n;
+}
+
+size_t File::read(uint8_t* buf, size_t size) {
+  if (!impl || impl->fd < 0)
+    return 0;
+  ssize_t n = ::read(impl->fd, buf, size);
+  statReadCalls++;
+  if (n <= 0)
+    return 0;
+  statBytesRead += (uint64_t)n;
+  return (size_t)n;
+}
+
+int File::read() {
+  uint8_t c;
+  return read(&c, 1) == 1 ? c : -1;
+}
+
+int File::peek() {
+  if (!impl || impl->fd < 0)
+    return -1;
+  off_t pos = lseek(impl->fd, 0, SEEK_CUR);
+  int c = read();
+  lseek(impl->fd, pos, SEEK_SET);
+  return c;
+}
+
+int File::available() {
+  if (!impl || impl->fd < 0)
+    return 0;
+  return (int)(size() - position());
+}
+
+bool File::seek(uint32_t pos, SeekMode mode) {
+  if (!impl || impl->fd < 0)
+    return false;
+  int whence = mode == SeekCur ? SEEK_CUR : mode == SeekEnd ? SEEK_END : SEEK_SET;
+  return lseek(impl->fd, (off_t)pos, whence) >= 0;
+}
+
+size_t File::position() const {
+  if (!impl || impl->fd < 0)
+    return 0;
+  off_t pos = lseek(impl->fd, 0, SEEK_CUR);
+  return pos < 0 ? 0 : (size_t)pos;
+}
+
+size_t File::size() const {
+  if (!impl || impl->fd < 0)
+    return 0;
+  struct stat st;
+  return fstat(impl->fd, &st) == 0 ? (size_t)st.st_size : 0;
+}
+
+void File::close() {
+  impl.reset();
+}
+
+File::operator bool() const {
+  return impl && (impl->fd >= 0 || impl->dir);
+}
+
+const char* File::path() const {
+  return impl ? impl->path.c_str() : nullptr;
+}
+
+const char* File::name() const {
+  return impl ? impl->baseName.c_str() : nullptr;
+}
+
+bool File::isDirectory() const {
+  return impl && impl->dir;
+}
+
+File File::openNextFile(const char* mode) {
+  if (!impl || !impl->dir)
+    return File();
+  while (struct dirent* entry = readdir(impl->dir)) {
+    if (!strcmp(entry->d_name, ".") || !strcmp(entry->d_name, ".."))
+      continue;
+    String child = impl->path;
+    if (!child.endsWith("/"))
+      child += "/";
+    child += entry->d_name;
+    FileImplPtr next = std::make_shared<FileImpl>();
+    next->path = child;
+    next->hostPath = impl->hostPath + "/" + entry->d_name;
+    next->baseName = entry->d_name;
+    struct stat st;
+    if (stat(next->hostPath.c_str(), &st) == 0 && S_ISDIR(st.st_mode))
+      next->dir = opendir(next->hostPath.c_str());
+    else
+      next->fd = ::open(next->hostPath.c_str(), strchr(mode, 'w') || strchr(mode, '+') ? O_RDWR : O_RDONLY);
+    statOpens++;
+    return File(next);
+  }
+  return File();
+}
+
+void File::rewindDirectory() {
+  if (impl && impl->dir)
+    rewinddir(impl->dir);
+}
+
+// ---------------------------
+// FS
+// ---------------------------
+
+String FS::hostPath(const char* path) const {
+  String out = root();
+  if (path && path[0] != '/')
+    out += "/";
+  out += path ? path : "";
+  while (out.length() > 1 && out.endsWith("/"))
+    out.remove(out.length() - 1);
+  return out;
+}
+
+File FS::open(const char* path, const char* mode, bool create) {
+  FileImplPtr impl = std::make_shared<FileImpl>();
+  impl->path = path;
+  impl->hostPath = hostPath(path);
+  impl->baseName = lastComponent(impl->path);
+  statOpens++;
+
+  struct stat st;
+  bool exists = stat(impl->hostPath.c_str(), &st) == 0;
+  if (exists && S_ISDIR(st.st_mode)) {
+    impl->dir = opendir(impl->hostPath.c_str());
+    return impl->dir ? File(impl) : File();
+  }
+
+  int flags;
+  if (!strcmp(mode, "r"))
+    flags = O_RDONLY;
+  else if (!strcmp(mode, "r+"))
+    flags = O_RDWR;
+  else if (!strcmp(mode, "w"))
+    flags = O_WRONLY | O_CREAT | O_TRUNC;
+  else if (!strcmp(mode, "w+"))
+    flags = O_RDWR | O_CREAT | O_TRUNC;
+  else if (!strcmp(mode, "a"))
+    flags = O_WRONLY | O_CREAT | O_APPEND;
+  else if (!strcmp(mode, "a+"))
+    flags = O_RDWR | O_CREAT | O_APPEND;
+  else
+    return File();
+  if (create && (flags & O_CREAT)) {
+    int slash = impl->hostPath.lastIndexOf('/');
+    if (slash > 0)
+      HostPlatform::makeDirs(impl->hostPath.substring(0, slash).c_str());
+  }
+  impl->fd = ::open(impl->hostPath.c_str(), flags, 0644);
+  return impl->fd >= 0 ? File(impl) : File();
+}
+
+bool FS::exists(const char* path) {
+  struct stat st;
+  return stat(hostPath(path).c_str(), &st) == 0;
+}
+
+bool FS::remove(const char* path) {
+  statRemoves++;
+  return ::unlink(hostPath(path).c_str()) == 0;
+}
+
+bool FS::rename(const char* pathFrom, const char* pathTo) {
+  statRenames++;
+  return ::rename(hostPath(pathFrom).c_str(), hostPath(pathTo).c_str()) == 0;
+}
+
+bool FS::mkdir(const char* path) {
+  return ::mkdir(hostPath(path).c_str(), 0755) == 0;
+}
+
+bool FS::rmdir(const char* path) {
+  return ::rmdir(hostPath(path).c_str()) == 0;
+}
+
+// ---------------------------
+// LittleFS
+// ---------------------------
+
+String LittleFSFS::root() const {
+  return String(HostPlatform::dataDir()) + "/littlefs";
+}
+
+bool LittleFSFS::begin(bool formatOnFail, const char* basePath, uint8_t maxOpenFiles, const char* partitionLabel) {
+  (void)formatOnFail;
+  (void)basePath;
+  (void)maxOpenFiles;
+  (void)partitionLabel;
+  return HostPlatform::makeDirs(root().c_str());
+}
+
+bool LittleFSFS::format() {
+  HostPlatform::removeTree(root().c_str());
+  HostPlatform::makeDirs(root().c_str());
+  return true;
+}
+
+static thread_local size_t usedBlockBytes;
+
+static int addBlocks(const char*, const struct stat* st, int type, struct FTW*) {
+  if (type == FTW_F)
+    usedBlockBytes += (((size_t)st->st_size + LittleFSFS::BLOCK_BYTES - 1) / LittleFSFS::BLOCK_BYTES) * LittleFSFS::BLOCK_BYTES;
+  else if (type == FTW_D)
+    usedBlockBytes += LittleFSFS::BLOCK_BYTES; // A directory takes a metadata block
+  return 0;
+}
+
+size_t LittleFSFS::usedBytes() {
+  usedBlockBytes = 0;
+  nftw(root().c_str(), addBlocks, 16, FTW_PHYS);
+  return usedBlockBytes;
+}
+
+} // namespace fs
+
+fs::LittleFSFS LittleFS;
@@ -0,0 +1,92 @@
+#ifndef HOST_FS_H
+#define HOST_FS_H
+
+#include "Print.h"
+#include "WString.h"
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+
+// ---------------------------
+// fs::FS / fs::File
+// ---------------------------
+// The Arduino-ESP32 file API over a host directory. Files are unbuffered
+// descriptors, so each write() reaches the disk as a LittleFS write would
+// reach flash, and HostFs counts them.
+
+namespace fs {
+
+enum SeekMode {
+  SeekSet = 0,
+  SeekCur = 1,
+  SeekEnd = 2
+};
+
+class FileImpl;
+typedef std::shared_ptr<FileImpl> FileImplPtr;
+
+class File : public Stream {
+ public:
+  File(FileImplPtr impl = FileImplPtr()) : impl(impl) {}
+
+  using Print::write;
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t* buf, size_t size) override;
+  int available() override;
+  int read() override;
+  int peek() override;
+  void flush() override {}
+  size_t read(uint8_t* buf, size_t size);
+  size_t readBytes(char* buffer, size_t length) { return read((uint8_t*)buffer, length); }
+
+  bool seek(uint32_t pos, SeekMode mode);
+  bool seek(uint32_t pos) { return seek(pos, SeekSet); }
+  size_t position() const;
+  size_t size() const;
+  void close();
+  operator bool() const;
+  const char* path() const;
+  /// The last path component, as on ESP32 core 2.x and later.
+  const char* name() const;
+  bool isDirectory() const;
+  File openNextFile(const char* mode = "r");
+  void rewindDirectory();
+
+ protected:
+  bool waitForData() override { return false; } // At the end of a file nothing more will come
+
+ private:
+  FileImplPtr impl;
+};
+
+class FS {
+ public:
+  File open(const char* path, const char* mode = "r", bool create = false);
+  File open(const String& path, const char* mode = "r", bool create = false) { return open(path.c_str(), mode, create); }
+  bool exists(const char* path);
+  bool exists(const String& path) { return exists(path.c_str()); }
+  bool remove(const char* path);
+  bool remove(const String& path) { return remove(path.c_str()); }
+  bool rename(const char* pathFrom, const char* pathTo);
+  bool rename(const String& pathFrom, const String& pathTo) { return rename(pathFrom.c_str(), pathTo.c_str()); }
+  bool mkdir(const char* path);
+  bool mkdir(const String& path) { return mkdir(path.c_str()); }
+  bool rmdir(const char* path);
+  bool rmdir(const String& path) { return rmdir(path.c_str()); }
+
+ protected:
+  /// The host directory this file system lives in.
+  virtual String root() const = 0;
+  String hostPath(const char* path) const;
+};
+
+} // namespace fs
+
+using fs::File;
+using fs::FS;
+using fs::SeekCur;
+using fs::SeekEnd;
+using fs::SeekMode;
+using fs::SeekSet;
+
+#endif // HOST_FS_H
@@ -0,0 +1,26 @@
+#ifndef HOST_HARDWARE_SERIAL_H
+#define HOST_HARDWARE_SERIAL_H
+
+#include "Print.h"
+
+/// Serial on stdout and stdin.
+class HardwareSerial : public Stream {
+ public:
+  using Print::write;
+  void begin(unsigned long baud) { (void)baud; }
+  void end() {}
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t* buffer, size_t size) override;
+  void flush() override;
+  int available() override;
+  int read() override;
+  int peek() override;
+  operator bool() const { return true; }
+
+ private:
+  int peeked = -1;
+};
+
+extern HardwareSerial Serial;
+
+#endif // HOST_HARDWARE_SERIAL_H
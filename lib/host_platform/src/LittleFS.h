@@ -0,0 +1,30 @@
+#ifndef HOST_LITTLEFS_H
+#define HOST_LITTLEFS_H
+
+#include "FS.h"
+
+namespace fs {
+
+/// LittleFS in `<HostPlatform::dataDir()>/littlefs`, sized like the esp32dev
+/// default partition table's data partition.
+class LittleFSFS : public FS {
+ public:
+  static constexpr size_t PARTITION_BYTES = 0x160000;
+  static constexpr size_t BLOCK_BYTES = 4096;
+
+  bool begin(bool formatOnFail = false, const char* basePath = "/littlefs", uint8_t maxOpenFiles = 10, const char* partitionLabel = "spiffs");
+  void end() {}
+  bool format();
+  size_t totalBytes() { return PARTITION_BYTES; }
+  /// Whole blocks taken by the files, as LittleFS counts them.
+  size_t usedBytes();
+
+ protected:
+  String root() const override;
+};
+
+} // namespace fs
+
+extern fs::LittleFSFS LittleFS;
+
+#endif // HOST_LITTLEFS_H
@@ -0,0 +1,125 @@
+#include "Preferences.h"
+#include "host_platform.h"
+#include "nvs_flash.h"
+
+#include <dirent.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static String nvsRoot() {
+  return String(HostPlatform::dataDir()) + "/nvs";
+}
+
+esp_err_t nvs_flash_init(void) {
+  return HostPlatform::makeDirs(nvsRoot().c_str()) ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t nvs_flash_erase(void) {
+  HostPlatform::removeTree(nvsRoot().c_str());
+  return ESP_OK;
+}
+
+bool Preferences::begin(const char* name, bool readOnly, const char* partitionLabel) {
+  (void)partitionLabel;
+  if (!name || strlen(name) > 15)
+    return false; // NVS namespace names are at most 15 characters
+  if (nvs_flash_init() != ESP_OK)
+    return false;
+  dir = nvsRoot() + "/" + name;
+  this->readOnly = readOnly;
+  if (!readOnly)
+    mkdir(dir.c_str(), 0755);
+  return true;
+}
+
+void Preferences::end() {
+  dir = "";
+}
+
+String Preferences::keyPath(const char* key) const {
+  return dir + "/" + key;
+}
+
+bool Preferences::clear() {
+  if (dir.length() == 0 || readOnly)
+    return false;
+  DIR* d = opendir(dir.c_str());
+  if (!d)
+    return true;
+  while (struct dirent* entry = readdir(d))
+    if (entry->d_type == DT_REG)
+      unlink((dir + "/" + entry->d_name).c_str());
+  closedir(d);
+  return true;
+}
+
+bool Preferences::remove(const char* key) {
+  if (dir.length() == 0 || readOnly)
+    return false;
+  return unlink(keyPath(key).c_str()) == 0;
+}
+
+bool Preferences::isKey(const char* key) {
+  struct stat st;
+  return dir.length() && stat(keyPath(key).c_str(), &st) == 0;
+}
+
+size_t Preferences::putBytes(const char* key, const void* value, size_t len) {
+  if (dir.length() == 0 || readOnly || !key || strlen(key) > 15)
+    return 0;
+  // Write a temp file and rename it in, so a reader never sees half a value
+  String path = keyPath(key);
+  String temp = path + ".tmp";
+  FILE* f = fopen(temp.c_str(), "wb");
+  if (!f)
+    return 0;
+  bool ok = fwrite(value, 1, len, f) == len;
+  ok = fclose(f) == 0 && ok;
+  if (!ok || rename(temp.c_str(), path.c_str()) != 0) {
+    unlink(temp.c_str());
+    return 0;
+  }
+  return len;
+}
+
+size_t Preferences::putString(const char* key, const char* value) {
+  return putBytes(key, value, strlen(value)) == strlen(value) ? strlen(value) : 0;
+}
+
+size_t Preferences::getBytesLength(const char* key) {
+  struct stat st;
+  if (dir.length() == 0 || stat(keyPath(key).c_str(), &st) != 0)
+    return 0;
+  return (size_t)st.st_size;
+}
+
+size_t Preferences::getBytes(const char* key, void* buf, size_t maxLen) {
+  size_t len = getBytesLength(key);
+  if (len == 0 || len > maxLen)
+    return 0;
+  FILE* f = fopen(keyPath(key).c_str(), "rb");
+  if (!f)
+    return 0;
+  size_t n = fread(buf, 1, len, f);
+  fclose(f);
+  return n == len ? len : 0;
+}
+
+String Preferences::getString(const char* key, const String& defaultValue) {
+  size_t len = getBytesLength(key);
+  if (!isKey(key))
+    return defaultValue;
+  String out;
+  out.reserve((unsigned int)len);
+  FILE* f = fopen(keyPath(key).c_str(), "rb");
+  if (!f)
+    return defaultValue;
+  char chunk[64];
+  size_t n;
+  while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0)
+    out.concat(chunk, (unsigned int)n);
+  fclose(f);
+  return out;
+}
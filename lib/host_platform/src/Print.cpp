@@ -0,0 +1,81 @@
+#include "Print.h"
+#include "host_platform.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+  size_t n = 0;
+  while (size--) {
+    if (write(*buffer++) == 0)
+      break;
+    n++;
+  }
+  return n;
+}
+
+size_t Print::write(const char* str) {
+  return str ? write((const uint8_t*)str, strlen(str)) : 0;
+}
+
+size_t Print::printf(const char* format, ...) {
+  char small[128];
+  va_list args;
+  va_start(args, format);
+  int len = vsnprintf(small, sizeof(small), format, args);
+  va_end(args);
+  if (len < 0)
+    return 0;
+  if ((size_t)len < sizeof(small))
+    return write((const uint8_t*)small, (size_t)len);
+  char* buffer = new char[len + 1];
+  va_start(args, format);
+  vsnprintf(buffer, (size_t)len + 1, format, args);
+  va_end(args);
+  size_t n = write((const uint8_t*)buffer, (size_t)len);
+  delete[] buffer;
+  return n;
+}
+
+int Stream::timedRead() {
+  // Wall-clock wait: under virtual time, delay() would skip the timeout without waiting for data
+  uint64_t start = HostClock::realMicros();
+  do {
+    int c = read();
+    if (c >= 0)
+      return c;
+    if (!waitForData())
+      return -1;
+  } while (HostClock::realMicros() - start < (uint64_t)timeout * 1000);
+  return -1;
+}
+
+bool Stream::waitForData() {
+  HostClock::realSleepMicros(1000);
+  return true;
+}
+
+size_t Stream::readBytes(char* buffer, size_t length) {
+  size_t count = 0;
+  while (count < length) {
+    int c = timedRead();
+    if (c < 0)
+      break;
+    buffer[count++] = (char)c;
+  }
+  return count;
+}
+
+String Stream::readString() {
+  String out;
+  for (int c = timedRead(); c >= 0; c = timedRead())
+    out += (char)c;
+  return out;
+}
+
+String Stream::readStringUntil(char terminator) {
+  String out;
+  for (int c = timedRead(); c >= 0 && c != terminator; c = timedRead())
+    out += (char)c;
+  return out;
+}
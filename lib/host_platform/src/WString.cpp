@@ -0,0 +1,296 @@
+#include "WString.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static std::string formatUnsigned(unsigned long long value, unsigned char base) {
+  if (base < 2 || base > 36)
+    base = 10;
+  char buf[66];
+  int pos = sizeof(buf) - 1;
+  buf[pos] = '\0';
+  do {
+    int digit = (int)(value % base);
+    buf[--pos] = (char)(digit < 10 ? '0' + digit : 'a' + digit - 10);
+    value /= base;
+  } while (value > 0);
+  return std::string(buf + pos);
+}
+
+static std::string formatSigned(long long value, unsigned char base) {
+  // Like the ESP32 core: only base 10 shows a sign, other bases print the two's complement
+  if (base == 10 && value < 0)
+    return "-" + formatUnsigned((unsigned long long)(-(value + 1)) + 1, base);
+  return formatUnsigned((unsigned long long)value, base);
+}
+
+static std::string formatFloat(double value, unsigned int decimalPlaces) {
+  char buf[64];
+  snprintf(buf, sizeof(buf), "%.*f", (int)decimalPlaces, value);
+  return std::string(buf);
+}
+
+String::String(const char* cstr) {
+  if (cstr)
+    buffer = cstr;
+}
+
+String::String(const char* cstr, unsigned int length) {
+  if (cstr)
+    buffer.assign(cstr, strnlen(cstr, length));
+}
+
+String::String(char c) : buffer(1, c) {}
+String::String(unsigned char value, unsigned char base) : buffer(formatUnsigned(value, base)) {}
+String::String(int value, unsigned char base) : buffer(base == 10 ? formatSigned(value, base) : formatUnsigned((unsigned int)value, base)) {}
+String::String(unsigned int value, unsigned char base) : buffer(formatUnsigned(value, base)) {}
+String::String(long value, unsigned char base) : buffer(base == 10 ? formatSigned(value, base) : formatUnsigned((unsigned long)value, base)) {}
+String::String(unsigned long value, unsigned char base) : buffer(formatUnsigned(value, base)) {}
+String::String(long long value, unsigned char base) : buffer(formatSigned(value, base)) {}
+String::String(unsigned long long value, unsigned char base) : buffer(formatUnsigned(value, base)) {}
+String::String(float value, unsigned int decimalPlaces) : buffer(formatFloat(value, decimalPlaces)) {}
+String::String(double value, unsigned int decimalPlaces) : buffer(formatFloat(value, decimalPlaces)) {}
+
+String& String::operator=(const char* cstr) {
+  if (cstr)
+    buffer = cstr;
+  else
+    buffer.clear();
+  return *this;
+}
+
+bool String::reserve(unsigned int size) {
+  buffer.reserve(size);
+  return true;
+}
+
+bool String::concat(const String& str) {
+  buffer += str.buffer;
+  return true;
+}
+
+bool String::concat(const char* cstr) {
+  if (!cstr)
+    return false;
+  buffer += cstr;
+  return true;
+}
+
+bool String::concat(const char* cstr, unsigned int length) {
+  if (!cstr)
+    return false;
+  buffer.append(cstr, strnlen(cstr, length));
+  return true;
+}
+
+bool String::concat(char c) {
+  buffer += c;
+  return true;
+}
+
+bool String::concat(unsigned char num) { return concat(String(num)); }
+bool String::concat(int num) { return concat(String(num)); }
+bool String::concat(unsigned int num) { return concat(String(num)); }
+bool String::concat(long num) { return concat(String(num)); }
+bool String::concat(unsigned long num) { return concat(String(num)); }
+bool String::concat(long long num) { return concat(String(num)); }
+bool String::concat(unsigned long long num) { return concat(String(num)); }
+bool String::concat(float num) { return concat(String(num)); }
+bool String::concat(double num) { return concat(String(num)); }
+
+int String::compareTo(const String& s) const {
+  return strcmp(buffer.c_str(), s.buffer.c_str());
+}
+
+bool String::equals(const char* cstr) const {
+  return cstr ? buffer == cstr : buffer.empty();
+}
+
+bool String::equalsIgnoreCase(const String& s) const {
+  if (buffer.size() != s.buffer.size())
+    return false;
+  for (size_t i = 0; i < buffer.size(); i++)
+    if (tolower((unsigned char)buffer[i]) != tolower((unsigned char)s.buffer[i]))
+      return false;
+  return true;
+}
+
+bool String::startsWith(const String& prefix, unsigned int offset) const {
+  if (offset > buffer.size() || prefix.buffer.size() > buffer.size() - offset)
+    return false;
+  return buffer.compare(offset, prefix.buffer.size(), prefix.buffer) == 0;
+}
+
+bool String::endsWith(const String& suffix) const {
+  if (suffix.buffer.size() > buffer.size())
+    return false;
+  return buffer.compare(buffer.size() - suffix.buffer.size(), suffix.buffer.size(), suffix.buffer) == 0;
+}
+
+char String::charAt(unsigned int index) const {
+  return index < buffer.size() ? buffer[index] : '\0';
+}
+
+void String::setCharAt(unsigned int index, char c) {
+  if (index < buffer.size())
+    buffer[index] = c;
+}
+
+char& String::operator[](unsigned int index) {
+  static char dummy;
+  if (index >= buffer.size()) {
+    dummy = '\0';
+    return dummy;
+  }
+  return buffer[index];
+}
+
+void String::getBytes(unsigned char* buf, unsigned int bufsize, unsigned int index) const {
+  if (!bufsize || !buf)
+    return;
+  if (index >= buffer.size()) {
+    buf[0] = '\0';
+    return;
+  }
+  unsigned int n = bufsize - 1;
+  if (n > buffer.size() - index)
+    n = (unsigned int)(buffer.size() - index);
+  memcpy(buf, buffer.data() + index, n);
+  buf[n] = '\0';
+}
+
+int String::indexOf(char ch, unsigned int fromIndex) const {
+  size_t pos = buffer.find(ch, fromIndex);
+  return pos == std::string::npos ? -1 : (int)pos;
+}
+
+int String::indexOf(const String& str, unsigned int fromIndex) const {
+  size_t pos = buffer.find(str.buffer, fromIndex);
+  return pos == std::string::npos ? -1 : (int)pos;
+}
+
+int String::lastIndexOf(char ch) const {
+  size_t pos = buffer.rfind(ch);
+  return pos == std::string::npos ? -1 : (int)pos;
+}
+
+int String::lastIndexOf(char ch, unsigned int fromIndex) const {
+  size_t pos = buffer.rfind(ch, fromIndex);
+  return pos == std::string::npos ? -1 : (int)pos;
+}
+
+int String::lastIndexOf(const String& str) const {
+  size_t pos = buffer.rfind(str.buffer);
+  return pos == std::string::npos ? -1 : (int)pos;
+}
+
+int String::lastIndexOf(const String& str, unsigned int fromIndex) const {
+  size_t pos = buffer.rfind(str.buffer, fromIndex);
+  return pos == std::string::npos ? -1 : (int)pos;
+}
+
+String String::substring(unsigned int beginIndex, unsigned int endIndex) const {
+  if (beginIndex > endIndex) {
+    unsigned int temp = endIndex;
+    endIndex = beginIndex;
+    beginIndex = temp;
+  }
+  String out;
+  if (beginIndex >= buffer.size())
+    return out;
+  if (endIndex > buffer.size())
+    endIndex = (unsigned int)buffer.size();
+  out.buffer = buffer.substr(beginIndex, endIndex - beginIndex);
+  return out;
+}
+
+void String::replace(char find, char replace) {
+  for (char& c : buffer)
+    if (c == find)
+      c = replace;
+}
+
+void String::replace(const String& find, const String& replace) {
+  if (find.buffer.empty())
+    return;
+  size_t pos = 0;
+  while ((pos = buffer.find(find.buffer, pos)) != std::string::npos) {
+    buffer.replace(pos, find.buffer.size(), replace.buffer);
+    pos += replace.buffer.size();
+  }
+}
+
+void String::remove(unsigned int index) {
+  if (index < buffer.size())
+    buffer.erase(index);
+}
+
+void String::remove(unsigned int index, unsigned int count) {
+  if (index < buffer.size())
+    buffer.erase(index, count);
+}
+
+void String::toLowerCase() {
+  for (char& c : buffer)
+    c = (char)tolower((unsigned char)c);
+}
+
+void String::toUpperCase() {
+  for (char& c : buffer)
+    c = (char)toupper((unsigned char)c);
+}
+
+void String::trim() {
+  size_t first = 0;
+  while (first < buffer.size() && isspace((unsigned char)buffer[first]))
+    first++;
+  size_t last = buffer.size();
+  while (last > first && isspace((unsigned char)buffer[last - 1]))
+    last--;
+  buffer = buffer.substr(first, last - first);
+}
+
+long String::toInt() const {
+  return atol(buffer.c_str());
+}
+
+float String::toFloat() const {
+  return (float)atof(buffer.c_str());
+}
+
+double String::toDouble() const {
+  return atof(buffer.c_str());
+}
+
+String operator+(const String& lhs, const String& rhs) {
+  String out(lhs);
+  out.concat(rhs);
+  return out;
+}
+
+String operator+(const String& lhs, const char* rhs) {
+  String out(lhs);
+  out.concat(rhs);
+  return out;
+}
+
+String operator+(const char* lhs, const String& rhs) {
+  String out(lhs);
+  out.concat(rhs);
+  return out;
+}
+
+String operator+(const String& lhs, char rhs) {
+  String out(lhs);
+  out.concat(rhs);
+  return out;
+}
+
+String operator+(const String& lhs, unsigned char rhs) { return lhs + String(rhs); }
+String operator+(const String& lhs, int rhs) { return lhs + String(rhs); }
+String operator+(const String& lhs, unsigned int rhs) { return lhs + String(rhs); }
+String operator+(const String& lhs, long rhs) { return lhs + String(rhs); }
+String operator+(const String& lhs, unsigned long rhs) { return lhs + String(rhs); }
+String operator+(const String& lhs, float rhs) { return lhs + String(rhs); }
+String operator+(const String& lhs, double rhs) { return lhs + String(rhs); }
@@ -0,0 +1,214 @@
+#include "WiFi.h"
+#include "host_platform.h"
+
+#include <arpa/inet.h>
+#include <atomic>
+#include <errno.h>
+#include <fcntl.h>
+#include <map>
+#include <mutex>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <string>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// ---------------------------
+// HostNet
+// ---------------------------
+
+static std::mutex redirectMutex;
+static std::map<std::string, std::pair<std::string, uint16_t>> redirects;
+static std::atomic<bool> stationUp{true};
+
+static std::string redirectKey(const char* host, uint16_t port) {
+  return std::string(host) + ":" + std::to_string(port);
+}
+
+void HostNet::redirect(const char* host, uint16_t port, const char* toHost, uint16_t toPort) {
+  std::lock_guard<std::mutex> lock(redirectMutex);
+  redirects[redirectKey(host, port)] = {toHost, toPort};
+}
+
+void HostNet::clearRedirects() {
+  std::lock_guard<std::mutex> lock(redirectMutex);
+  redirects.clear();
+}
+
+void HostNet::setStationConnected(bool connected) {
+  stationUp.store(connected);
+}
+
+bool HostNet::stationConnected() {
+  return stationUp.load();
+}
+
+// ---------------------------
+// WiFi
+// ---------------------------
+
+WiFiClass WiFi;
+
+wl_status_t WiFiClass::status() {
+  return stationUp.load() ? WL_CONNECTED : WL_DISCONNECTED;
+}
+
+String IPAddress::toString() const {
+  char buf[16];
+  snprintf(buf, sizeof(buf), "%u.%u.%u.%u", (*this)[0], (*this)[1], (*this)[2], (*this)[3]);
+  return String(buf);
+}
+
+// ---------------------------
+// WiFiClient
+// ---------------------------
+
+static constexpr int32_t DEFAULT_CONNECT_TIMEOUT_MS = 3000;
+
+int WiFiClient::connect(const char* host, uint16_t port) {
+  return connect(host, port, DEFAULT_CONNECT_TIMEOUT_MS);
+}
+
+int WiFiClient::connect(const char* host, uint16_t port, int32_t timeoutMs) {
+  stop();
+  if (!stationUp.load())
+    return 0;
+  std::string targetHost = host;
+  uint16_t targetPort = port;
+  {
+    std::lock_guard<std::mutex> lock(redirectMutex);
+    auto it = redirects.find(redirectKey(host, port));
+    if (it != redirects.end()) {
+      targetHost = it->second.first;
+      targetPort = it->second.second;
+    }
+  }
+
+  struct addrinfo hints = {};
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+  struct addrinfo* result = nullptr;
+  if (getaddrinfo(targetHost.c_str(), std::to_string(targetPort).c_str(), &hints, &result) != 0 || !result)
+    return 0;
+
+  int sock = socket(result->ai_family, result->ai_socktype | SOCK_CLOEXEC, result->ai_protocol);
+  if (sock < 0) {
+    freeaddrinfo(result);
+    return 0;
+  }
+  // Non-blocking connect so the timeout applies, then back to blocking for I/O
+  fcntl(sock, F_SETFL, fcntl(sock, F_GETFL) | O_NONBLOCK);
+  int rc = ::connect(sock, result->ai_addr, result->ai_addrlen);
+  freeaddrinfo(result);
+  if (rc != 0 && errno == EINPROGRESS) {
+    struct pollfd pfd = {sock, POLLOUT, 0};
+    int soError = 0;
+    socklen_t len = sizeof(soError);
+    if (poll(&pfd, 1, timeoutMs) == 1 && getsockopt(sock, SOL_SOCKET, SO_ERROR, &soError, &len) == 0 && soError == 0)
+      rc = 0;
+  }
+  if (rc != 0) {
+    ::close(sock);
+    return 0;
+  }
+  fcntl(sock, F_SETFL, fcntl(sock, F_GETFL) & ~O_NONBLOCK);
+  fd = sock;
+  peerClosed = false;
+  return 1;
+}
+
+bool WiFiClient::pollReadable(int timeoutMs) {
+  if (fd < 0)
+    return false;
+  struct pollfd pfd = {fd, POLLIN, 0};
+  return poll(&pfd, 1, timeoutMs) == 1;
+}
+
+uint8_t WiFiClient::connected() {
+  if (fd < 0)
+    return 0;
+  if (peerClosed)
+    return available() > 0; // Like the ESP32 client: still "connected" while unread data remains
+  if (pollReadable(0)) {
+    char c;
+    ssize_t n = recv(fd, &c, 1, MSG_PEEK | MSG_DONTWAIT);
+    if (n == 0)
+      peerClosed = true;
+    else if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)
+      peerClosed = true;
+  }
+  return peerClosed ? available() > 0 : 1;
+}
+
+void WiFiClient::stop() {
+  if (fd >= 0)
+    ::close(fd);
+  fd = -1;
+  peerClosed = false;
+}
+
+int WiFiClient::setNoDelay(bool noDelay) {
+  int flag = noDelay ? 1 : 0;
+  return fd >= 0 && setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag)) == 0;
+}
+
+size_t WiFiClient::write(const uint8_t* buf, size_t size) {
+  if (fd < 0)
+    return 0;
+  size_t sent = 0;
+  while (sent < size) {
+    ssize_t n = send(fd, buf + sent, size - sent, MSG_NOSIGNAL);
+    if (n <= 0)
+      break;
+    sent += (size_t)n;
+  }
+  return sent;
+}
+
+int WiFiClient::available() {
+  if (fd < 0)
+    return 0;
+  int pending = 0;
+  if (ioctl(fd, FIONREAD, &pending) != 0)
+    pending = 0;
+  if (pending == 0 && HostClock::isVirtual() && !peerClosed && pollReadable(1) && ioctl(fd, FIONREAD, &pending) != 0)
+    pending = 0;
+  return pending;
+}
+
+int WiFiClient::read(uint8_t* buf, size_t size) {
+  if (fd < 0)
+    return -1;
+  ssize_t n = recv(fd, buf, size, MSG_DONTWAIT);
+  if (n == 0)
+    peerClosed = true;
+  return n > 0 ? (int)n : -1;
+}
+
+int WiFiClient::read() {
+  uint8_t c;
+  return read(&c, 1) == 1 ? c : -1;
+}
+
+int WiFiClient::peek() {
+  if (fd < 0)
+    return -1;
+  uint8_t c;
+  return recv(fd, &c, 1, MSG_PEEK | MSG_DONTWAIT) == 1 ? c : -1;
+}
+
+bool WiFiClient::waitForData() {
+  if (fd < 0 || peerClosed)
+    return false;
+  if (pollReadable(1)) {
+    char c;
+    if (recv(fd, &c, 1, MSG_PEEK | MSG_DONTWAIT) == 0) {
+      peerClosed = true;
+      return false;
+    }
+  }
+  return true;
+}
@@ -0,0 +1,90 @@
+#ifndef HOST_WIFI_H
+#define HOST_WIFI_H
+
+#include "Arduino.h"
+
+// ---------------------------
+// WiFi for the native build
+// ---------------------------
+// The host is always on its network, so there is no radio to drive: WiFi
+// reports HostNet::stationConnected() and WiFiClient is a plain TCP socket.
+// The firmware's connection logic is exercised through a WiFiLink (see
+// src/host/hal_posix.h), not through this class.
+
+typedef enum {
+  WL_IDLE_STATUS = 0,
+  WL_NO_SSID_AVAIL = 1,
+  WL_CONNECTED = 3,
+  WL_CONNECT_FAILED = 4,
+  WL_CONNECTION_LOST = 5,
+  WL_DISCONNECTED = 6
+} wl_status_t;
+
+typedef enum {
+  ARDUINO_EVENT_WIFI_STA_START = 2,
+  ARDUINO_EVENT_WIFI_STA_CONNECTED = 4,
+  ARDUINO_EVENT_WIFI_STA_DISCONNECTED = 5,
+  ARDUINO_EVENT_WIFI_STA_GOT_IP = 7,
+  ARDUINO_EVENT_WIFI_STA_LOST_IP = 8,
+} arduino_event_id_t;
+
+typedef arduino_event_id_t WiFiEvent_t;
+
+class IPAddress {
+ public:
+  IPAddress(uint32_t address = 0) : address(address) {}
+  IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : address((uint32_t)a | ((uint32_t)b << 8) | ((uint32_t)c << 16) | ((uint32_t)d << 24)) {}
+  operator uint32_t() const { return address; }
+  uint8_t operator[](int index) const { return (uint8_t)(address >> (8 * index)); }
+  String toString() const;
+
+ private:
+  uint32_t address; // Network byte order, as on the ESP32
+};
+
+class WiFiClient : public Stream {
+ public:
+  WiFiClient() = default;
+  ~WiFiClient() override { stop(); }
+  WiFiClient(const WiFiClient&) = delete;
+  WiFiClient& operator=(const WiFiClient&) = delete;
+
+  /// Connect over TCP, following any HostNet::redirect() for host:port.
+  int connect(const char* host, uint16_t port);
+  int connect(const char* host, uint16_t port, int32_t timeoutMs);
+  uint8_t connected();
+  void stop();
+  int setNoDelay(bool noDelay);
+  operator bool() { return connected(); }
+
+  using Print::write;
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t* buf, size_t size) override;
+  /// Bytes readable without blocking. Under virtual time an empty socket is
+  /// given a millisecond of real time first, so polling loops that delay()
+  /// between checks don't time out before the peer can answer.
+  int available() override;
+  int read() override;
+  int read(uint8_t* buf, size_t size);
+  int peek() override;
+
+ protected:
+  bool waitForData() override;
+
+ private:
+  int fd = -1;
+  bool peerClosed = false;
+  bool pollReadable(int timeoutMs);
+};
+
+class WiFiClass {
+ public:
+  wl_status_t status();
+  bool isConnected() { return status() == WL_CONNECTED; }
+  IPAddress localIP() { return IPAddress(127, 0, 0, 1); }
+  int8_t RSSI() { return -50; }
+};
+
+extern WiFiClass WiFi;
+
+#endif // HOST_WIFI_H
@@ -0,0 +1,15 @@
+#ifndef HOST_WIFI_CLIENT_SECURE_H
+#define HOST_WIFI_CLIENT_SECURE_H
+
+#include "WiFi.h"
+
+/// No TLS on the host: the secure client is the plain one, meant to be pointed
+/// at a local stub server with HostNet::redirect().
+class WiFiClientSecure : public WiFiClient {
+ public:
+  void setInsecure() {}
+  void setCACert(const char* rootCA) { (void)rootCA; }
+  void setHandshakeTimeout(unsigned long seconds) { (void)seconds; }
+};
+
+#endif // HOST_WIFI_CLIENT_SECURE_H
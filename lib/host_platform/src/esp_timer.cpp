@@ -0,0 +1,115 @@
+#include "esp_timer.h"
+#include "host_platform.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct esp_timer {
+  esp_timer_cb_t callback;
+  void* arg;
+  uint64_t deadlineUs; // HostClock::realMicros()
+  uint64_t periodUs;   // 0 = one-shot
+  bool armed;
+};
+
+// Never destroyed: the dispatcher thread is still waiting on them when the
+// process exits, and destroying a condition variable with a waiter blocks
+static std::mutex& timerMutex = *new std::mutex;
+static std::condition_variable& timerChanged = *new std::condition_variable;
+static std::vector<esp_timer*>& timers = *new std::vector<esp_timer*>;
+static bool dispatcherStarted = false;
+
+static void dispatcherMain() {
+  std::unique_lock<std::mutex> lock(timerMutex);
+  for (;;) {
+    esp_timer* next = nullptr;
+    for (esp_timer* t : timers)
+      if (t->armed && (!next || t->deadlineUs < next->deadlineUs))
+        next = t;
+    if (!next) {
+      timerChanged.wait(lock);
+      continue;
+    }
+    uint64_t now = HostClock::realMicros();
+    if (now < next->deadlineUs) {
+      timerChanged.wait_for(lock, std::chrono::microseconds(next->deadlineUs - now));
+      continue; // Re-pick: the timer may have been stopped or another armed
+    }
+    if (next->periodUs)
+      next->deadlineUs += next->periodUs;
+    else
+      next->armed = false;
+    esp_timer_cb_t callback = next->callback;
+    void* arg = next->arg;
+    lock.unlock();
+    callback(arg);
+    lock.lock();
+  }
+}
+
+int64_t esp_timer_get_time(void) {
+  return HostClock::now();
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* outHandle) {
+  if (!args || !args->callback || !outHandle)
+    return ESP_ERR_INVALID_ARG;
+  esp_timer* t = new esp_timer{args->callback, args->arg, 0, 0, false};
+  std::lock_guard<std::mutex> lock(timerMutex);
+  if (!dispatcherStarted) {
+    std::thread(dispatcherMain).detach();
+    dispatcherStarted = true;
+  }
+  timers.push_back(t);
+  *outHandle = t;
+  return ESP_OK;
+}
+
+static esp_err_t arm(esp_timer_handle_t timer, uint64_t delayUs, uint64_t periodUs) {
+  if (!timer)
+    return ESP_ERR_INVALID_ARG;
+  std::lock_guard<std::mutex> lock(timerMutex);
+  if (timer->armed)
+    return ESP_ERR_INVALID_STATE;
+  timer->deadlineUs = HostClock::realMicros() + delayUs;
+  timer->periodUs = periodUs;
+  timer->armed = true;
+  timerChanged.notify_all();
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeoutUs) {
+  return arm(timer, timeoutUs, 0);
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t periodUs) {
+  return arm(timer, periodUs, periodUs);
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+  if (!timer)
+    return ESP_ERR_INVALID_ARG;
+  std::lock_guard<std::mutex> lock(timerMutex);
+  if (!timer->armed)
+    return ESP_ERR_INVALID_STATE;
+  timer->armed = false;
+  timerChanged.notify_all();
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer) {
+  if (!timer)
+    return ESP_ERR_INVALID_ARG;
+  std::lock_guard<std::mutex> lock(timerMutex);
+  if (timer->armed)
+    return ESP_ERR_INVALID_STATE;
+  for (size_t i = 0; i < timers.size(); i++)
+    if (timers[i] == timer) {
+      timers.erase(timers.begin() + i);
+      break;
+    }
+  delete timer;
+  return ESP_OK;
+}
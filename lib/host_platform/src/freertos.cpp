@@ -0,0 +1,304 @@
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "freertos/timers.h"
+#include "host_platform.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <new>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+// Waits in ticks become a deadline on the steady clock. Blocking is always
+// real: under virtual time another thread has to do the giving.
+template <typename Predicate>
+static bool waitFor(std::condition_variable& cv, std::unique_lock<std::mutex>& lock, TickType_t ticks, Predicate ready) {
+  if (ticks == portMAX_DELAY) {
+    cv.wait(lock, ready);
+    return true;
+  }
+  return cv.wait_for(lock, std::chrono::milliseconds(ticks), ready);
+}
+
+// ---------------------------
+// Tasks
+// ---------------------------
+
+// Task records come from malloc so the bookkeeping stays out of HostHeap's
+// counts, and are never freed: a handle may outlive its thread.
+struct HostTask {
+  std::mutex mutex;
+  std::condition_variable notified;
+  uint32_t notifyCount = 0;
+  TaskFunction_t function = nullptr;
+  void* param = nullptr;
+  std::string name;
+  BaseType_t core = 1;
+  int64_t startUs = 0;
+  std::string dataDir; // The creator's own flash directory, empty for the shared one
+};
+
+static HostTask* newTask(const char* name, BaseType_t core) {
+  HostTask* task = new (malloc(sizeof(HostTask))) HostTask();
+  task->name = name ? name : "";
+  task->core = core;
+  return task;
+}
+
+static thread_local HostTask* currentTask = nullptr;
+
+static HostTask* selfTask() {
+  if (!currentTask)
+    currentTask = newTask("loopTask", 1); // A thread not started by xTaskCreate: setup()/loop() or a test
+  return currentTask;
+}
+
+static void* taskMain(void* arg) {
+  HostTask* task = (HostTask*)arg;
+  currentTask = task;
+  HostClock::startThreadAt(task->startUs);
+  if (!task->dataDir.empty())
+    HostPlatform::setThreadDataDir(task->dataDir.c_str());
+  task->function(task->param);
+  return nullptr; // Returning from a task is an error on FreeRTOS; here the thread just ends
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char* name, uint32_t stackDepth, void* param, UBaseType_t priority, TaskHandle_t* outHandle, BaseType_t coreId) {
+  (void)stackDepth;
+  (void)priority;
+  HostTask* task = newTask(name, coreId == tskNO_AFFINITY ? 0 : coreId);
+  task->function = function;
+  task->param = param;
+  task->startUs = HostClock::now();
+  if (const char* dir = HostPlatform::threadDataDir())
+    task->dataDir = dir; // A simulated board's tasks see its flash
+  if (outHandle)
+    *outHandle = task; // Before the thread starts, as FreeRTOS does, so the task can be notified at once
+  pthread_t thread;
+  if (pthread_create(&thread, nullptr, taskMain, task) != 0) {
+    if (outHandle)
+      *outHandle = nullptr;
+    return pdFAIL;
+  }
+  pthread_detach(thread);
+  return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t function, const char* name, uint32_t stackDepth, void* param, UBaseType_t priority, TaskHandle_t* outHandle) {
+  return xTaskCreatePinnedToCore(function, name, stackDepth, param, priority, outHandle, tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t task) {
+  if (task && task != currentTask)
+    abort(); // Deleting another task has no pthread equivalent; the firmware never does it
+  pthread_exit(nullptr);
+}
+
+void vTaskDelay(TickType_t ticks) {
+  HostClock::sleepMicros((uint64_t)ticks * 1000);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+  return selfTask();
+}
+
+const char* pcTaskGetName(TaskHandle_t task) {
+  return (task ? task : selfTask())->name.c_str();
+}
+
+TickType_t xTaskGetTickCount(void) {
+  return (TickType_t)(HostClock::now() / 1000);
+}
+
+BaseType_t xPortGetCoreID(void) {
+  return selfTask()->core;
+}
+
+int HostPlatform::taskCore() {
+  return currentTask ? (int)currentTask->core : 1; // No selfTask(): it allocates
+}
+
+void xTaskNotifyGive(TaskHandle_t task) {
+  std::lock_guard<std::mutex> lock(task->mutex);
+  task->notifyCount++;
+  task->notified.notify_one();
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticksToWait) {
+  HostTask* task = selfTask();
+  std::unique_lock<std::mutex> lock(task->mutex);
+  if (!waitFor(task->notified, lock, ticksToWait, [task] { return task->notifyCount > 0; }))
+    return 0;
+  uint32_t count = task->notifyCount;
+  task->notifyCount = clearCountOnExit ? 0 : count - 1;
+  return count;
+}
+
+// ---------------------------
+// Queues
+// ---------------------------
+
+struct HostQueue {
+  std::mutex mutex;
+  std::condition_variable changed;
+  std::deque<std::vector<uint8_t>> items;
+  UBaseType_t length;
+  UBaseType_t itemSize;
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+  HostQueue* queue = new (std::nothrow) HostQueue();
+  if (!queue)
+    return nullptr;
+  queue->length = length;
+  queue->itemSize = itemSize;
+  return queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticksToWait) {
+  std::unique_lock<std::mutex> lock(queue->mutex);
+  if (!waitFor(queue->changed, lock, ticksToWait, [queue] { return queue->items.size() < queue->length; }))
+    return errQUEUE_FULL;
+  const uint8_t* bytes = (const uint8_t*)item;
+  queue->items.emplace_back(bytes, bytes + queue->itemSize);
+  queue->changed.notify_all();
+  return pdPASS;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* buffer, TickType_t ticksToWait) {
+  std::unique_lock<std::mutex> lock(queue->mutex);
+  if (!waitFor(queue->changed, lock, ticksToWait, [queue] { return !queue->items.empty(); }))
+    return pdFALSE;
+  memcpy(buffer, queue->items.front().data(), queue->itemSize);
+  queue->items.pop_front();
+  queue->changed.notify_all();
+  return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+  std::lock_guard<std::mutex> lock(queue->mutex);
+  return (UBaseType_t)queue->items.size();
+}
+
+void vQueueDelete(QueueHandle_t queue) {
+  delete queue;
+}
+
+// ---------------------------
+// Semaphores
+// ---------------------------
+
+struct HostSemaphore {
+  std::mutex mutex;
+  std::condition_variable given;
+  UBaseType_t count;
+  UBaseType_t maxCount;
+};
+
+static SemaphoreHandle_t newSemaphore(UBaseType_t maxCount, UBaseType_t initialCount) {
+  HostSemaphore* semaphore = new (std::nothrow) HostSemaphore();
+  if (!semaphore)
+    return nullptr;
+  semaphore->count = initialCount;
+  semaphore->maxCount = maxCount;
+  return semaphore;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void) {
+  return newSemaphore(1, 1);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void) {
+  return newSemaphore(1, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t maxCount, UBaseType_t initialCount) {
+  return newSemaphore(maxCount, initialCount);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticksToWait) {
+  std::unique_lock<std::mutex> lock(semaphore->mutex);
+  if (!waitFor(semaphore->given, lock, ticksToWait, [semaphore] { return semaphore->count > 0; }))
+    return pdFALSE;
+  semaphore->count--;
+  return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+  std::lock_guard<std::mutex> lock(semaphore->mutex);
+  if (semaphore->count >= semaphore->maxCount)
+    return pdFALSE;
+  semaphore->count++;
+  semaphore->given.notify_one();
+  return pdTRUE;
+}
+
+UBaseType_t uxSemaphoreGetCount(SemaphoreHandle_t semaphore) {
+  std::lock_guard<std::mutex> lock(semaphore->mutex);
+  return semaphore->count;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore) {
+  delete semaphore;
+}
+
+// ---------------------------
+// Software Timers
+// ---------------------------
+
+struct HostTimer {
+  esp_timer_handle_t timer;
+  TimerCallbackFunction_t callback;
+  void* id;
+  uint64_t periodUs;
+  bool autoReload;
+};
+
+static void timerFired(void* arg) {
+  HostTimer* timer = (HostTimer*)arg;
+  timer->callback(timer);
+}
+
+TimerHandle_t xTimerCreate(const char* name, TickType_t period, UBaseType_t autoReload, void* timerId, TimerCallbackFunction_t callback) {
+  HostTimer* timer = new (std::nothrow) HostTimer{nullptr, callback, timerId, (uint64_t)period * 1000, autoReload != 0};
+  if (!timer)
+    return nullptr;
+  esp_timer_create_args_t args = {timerFired, timer, ESP_TIMER_TASK, name, false};
+  if (esp_timer_create(&args, &timer->timer) != ESP_OK) {
+    delete timer;
+    return nullptr;
+  }
+  return timer;
+}
+
+BaseType_t xTimerStart(TimerHandle_t timer, TickType_t ticksToWait) {
+  (void)ticksToWait;
+  esp_timer_stop(timer->timer); // Starting a running timer restarts it
+  esp_err_t err = timer->autoReload ? esp_timer_start_periodic(timer->timer, timer->periodUs) : esp_timer_start_once(timer->timer, timer->periodUs);
+  return err == ESP_OK ? pdPASS : pdFAIL;
+}
+
+BaseType_t xTimerStop(TimerHandle_t timer, TickType_t ticksToWait) {
+  (void)ticksToWait;
+  esp_timer_stop(timer->timer);
+  return pdPASS;
+}
+
+BaseType_t xTimerDelete(TimerHandle_t timer, TickType_t ticksToWait) {
+  (void)ticksToWait;
+  esp_timer_stop(timer->timer);
+  esp_timer_delete(timer->timer);
+  delete timer;
+  return pdPASS;
+}
+
+void* pvTimerGetTimerID(TimerHandle_t timer) {
+  return timer->id;
+}
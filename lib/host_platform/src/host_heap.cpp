@@ -0,0 +1,136 @@
+#include "esp_heap_caps.h"
+#include "host_platform.h"
+
+#include <atomic>
+#include <cstddef>
+#include <malloc.h>
+#include <new>
+#include <stdlib.h>
+
+// Every C++ allocation goes through these replacements of the global operator
+// new and delete, so the counts cover String, the containers and `new`.
+
+static std::atomic<int32_t> liveBlockCount{0};
+static std::atomic<int64_t> liveByteCount{0};
+static std::atomic<int64_t> peakByteCount{0};
+static std::atomic<uint64_t> allocationCount{0};
+static thread_local uint64_t threadAllocationCount = 0;
+
+static void* countedAlloc(size_t size, size_t alignment) {
+  if (size == 0)
+    size = 1;
+  void* p = nullptr;
+  if (alignment > alignof(std::max_align_t)) {
+    if (posix_memalign(&p, alignment, size) != 0)
+      p = nullptr;
+  } else {
+    p = malloc(size);
+  }
+  if (!p)
+    return nullptr;
+  int64_t bytes = (int64_t)malloc_usable_size(p);
+  liveBlockCount.fetch_add(1, std::memory_order_relaxed);
+  int64_t live = liveByteCount.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+  int64_t peak = peakByteCount.load(std::memory_order_relaxed);
+  while (live > peak && !peakByteCount.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+  }
+  allocationCount.fetch_add(1, std::memory_order_relaxed);
+  threadAllocationCount++;
+  return p;
+}
+
+static void countedFree(void* p) {
+  if (!p)
+    return;
+  liveBlockCount.fetch_sub(1, std::memory_order_relaxed);
+  liveByteCount.fetch_sub((int64_t)malloc_usable_size(p), std::memory_order_relaxed);
+  free(p);
+}
+
+void* operator new(size_t size) {
+  void* p = countedAlloc(size, 0);
+  if (!p)
+    throw std::bad_alloc();
+  return p;
+}
+
+void* operator new[](size_t size) {
+  return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+  return countedAlloc(size, 0);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+  return countedAlloc(size, 0);
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+  void* p = countedAlloc(size, (size_t)alignment);
+  if (!p)
+    throw std::bad_alloc();
+  return p;
+}
+
+void* operator new[](size_t size, std::align_val_t alignment) {
+  return operator new(size, alignment);
+}
+
+void operator delete(void* p) noexcept { countedFree(p); }
+void operator delete[](void* p) noexcept { countedFree(p); }
+void operator delete(void* p, size_t) noexcept { countedFree(p); }
+void operator delete[](void* p, size_t) noexcept { countedFree(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { countedFree(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { countedFree(p); }
+void operator delete(void* p, std::align_val_t) noexcept { countedFree(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { countedFree(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { countedFree(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { countedFree(p); }
+
+int32_t HostHeap::liveBlocks() {
+  return liveBlockCount.load();
+}
+
+int64_t HostHeap::liveBytes() {
+  return liveByteCount.load();
+}
+
+int64_t HostHeap::peakBytes() {
+  return peakByteCount.load();
+}
+
+uint64_t HostHeap::allocations() {
+  return allocationCount.load();
+}
+
+uint64_t HostHeap::threadAllocations() {
+  return threadAllocationCount;
+}
+
+static size_t freeBytes(int64_t used) {
+  return used >= (int64_t)HostHeap::HOST_HEAP_BYTES ? 0 : (size_t)(HostHeap::HOST_HEAP_BYTES - used);
+}
+
+size_t heap_caps_get_free_size(uint32_t) {
+  return freeBytes(liveByteCount.load());
+}
+
+size_t heap_caps_get_minimum_free_size(uint32_t) {
+  return freeBytes(peakByteCount.load());
+}
+
+size_t heap_caps_get_largest_free_block(uint32_t caps) {
+  return heap_caps_get_free_size(caps);
+}
+
+void heap_caps_get_info(multi_heap_info_t* info, uint32_t caps) {
+  int64_t used = liveByteCount.load();
+  info->total_free_bytes = freeBytes(used);
+  info->total_allocated_bytes = used > 0 ? (size_t)used : 0;
+  info->largest_free_block = info->total_free_bytes;
+  info->minimum_free_bytes = heap_caps_get_minimum_free_size(caps);
+  info->allocated_blocks = (size_t)liveBlockCount.load();
+  info->free_blocks = 0;
+  info->total_blocks = info->allocated_blocks;
+}
@@ -0,0 +1,255 @@
+#include "Arduino.h"
+#include "host_platform.h"
+
+#include <atomic>
+#include <chrono>
+#include <ftw.h>
+#include <mutex>
+#include <random>
+#include <sched.h>
+#include <string>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <thread>
+#include <time.h>
+#include <unistd.h>
+
+// ---------------------------
+// HostPlatform
+// ---------------------------
+
+static std::string sharedDataDir;
+static std::once_flag dataDirInit;
+static thread_local std::string threadDir;
+static std::atomic<bool> serialOn{true};
+
+void HostPlatform::setDataDir(const char* dir) {
+  std::call_once(dataDirInit, [] {});
+  sharedDataDir = dir;
+}
+
+const char* HostPlatform::dataDir() {
+  if (!threadDir.empty())
+    return threadDir.c_str();
+  std::call_once(dataDirInit, [] {
+    const char* env = getenv("LIBRECHESS_HOST_DIR");
+    sharedDataDir = env && *env ? env : ".pio/host";
+  });
+  return sharedDataDir.c_str();
+}
+
+void HostPlatform::setThreadDataDir(const char* dir) {
+  threadDir = dir ? dir : "";
+}
+
+const char* HostPlatform::threadDataDir() {
+  return threadDir.empty() ? nullptr : threadDir.c_str();
+}
+
+bool HostPlatform::makeDirs(const char* dir) {
+  std::string path = dir;
+  for (size_t slash = path.find('/', 1); slash != std::string::npos; slash = path.find('/', slash + 1))
+    mkdir(path.substr(0, slash).c_str(), 0755);
+  mkdir(path.c_str(), 0755);
+  struct stat st;
+  return stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+static int removeEntry(const char* path, const struct stat*, int, struct FTW*) {
+  remove(path);
+  return 0;
+}
+
+void HostPlatform::removeTree(const char* dir) {
+  nftw(dir, removeEntry, 16, FTW_DEPTH | FTW_PHYS);
+}
+
+void HostPlatform::setSerialEnabled(bool enabled) {
+  serialOn.store(enabled);
+}
+
+bool HostPlatform::serialEnabled() {
+  return serialOn.load();
+}
+
+// ---------------------------
+// HostClock
+// ---------------------------
+
+static std::chrono::steady_clock::time_point processStart() {
+  static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  return start;
+}
+
+static std::atomic<bool> virtualTime{false};
+static thread_local int64_t virtualOffsetUs = 0; // Virtual now = offset + thread CPU time
+
+void HostClock::setVirtual(bool enabled) {
+  virtualTime.store(enabled);
+}
+
+bool HostClock::isVirtual() {
+  return virtualTime.load();
+}
+
+uint64_t HostClock::realMicros() {
+  return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - processStart()).count();
+}
+
+void HostClock::realSleepMicros(uint64_t us) {
+  std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+uint64_t HostClock::threadCpuMicros() {
+  struct timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000;
+}
+
+int64_t HostClock::now() {
+  if (virtualTime.load(std::memory_order_relaxed))
+    return virtualOffsetUs + (int64_t)threadCpuMicros();
+  return (int64_t)realMicros();
+}
+
+void HostClock::sleepMicros(uint64_t us) {
+  if (virtualTime.load(std::memory_order_relaxed)) {
+    virtualOffsetUs += (int64_t)us;
+    sched_yield(); // Let the thread being waited on run, as a real delay would
+    return;
+  }
+  realSleepMicros(us);
+}
+
+void HostClock::startThreadAt(int64_t nowUs) {
+  virtualOffsetUs = nowUs - (int64_t)threadCpuMicros();
+}
+
+// ---------------------------
+// Arduino Core Functions
+// ---------------------------
+
+unsigned long millis() {
+  return (unsigned long)(HostClock::now() / 1000);
+}
+
+unsigned long micros() {
+  return (unsigned long)HostClock::now();
+}
+
+void delay(uint32_t ms) {
+  HostClock::sleepMicros((uint64_t)ms * 1000);
+}
+
+void delayMicroseconds(uint32_t us) {
+  HostClock::sleepMicros(us);
+}
+
+void yield() {
+  sched_yield();
+}
+
+static std::atomic<uint32_t> seedSequence{0};
+static thread_local std::mt19937 randomEngine(std::random_device{}() ^ seedSequence.fetch_add(1));
+
+long random(long howbig) {
+  if (howbig <= 0)
+    return 0;
+  return (long)(randomEngine() % (unsigned long)howbig);
+}
+
+long random(long howsmall, long howbig) {
+  if (howsmall >= howbig)
+    return howsmall;
+  return random(howbig - howsmall) + howsmall;
+}
+
+void randomSeed(unsigned long seed) {
+  randomEngine.seed((std::mt19937::result_type)seed);
+}
+
+long map(long x, long inMin, long inMax, long outMin, long outMax) {
+  if (inMax == inMin)
+    return outMin;
+  return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+size_t strlcpy(char* dst, const char* src, size_t size) {
+  size_t len = strlen(src);
+  if (size) {
+    size_t n = len < size - 1 ? len : size - 1;
+    memcpy(dst, src, n);
+    dst[n] = '\0';
+  }
+  return len;
+}
+
+size_t strlcat(char* dst, const char* src, size_t size) {
+  size_t used = strnlen(dst, size);
+  if (used == size)
+    return size + strlen(src);
+  return used + strlcpy(dst + used, src, size - used);
+}
+
+EspClass ESP;
+
+void EspClass::restart() {
+  fflush(stdout);
+  printf("ESP.restart(): exiting the host process\n");
+  exit(0);
+}
+
+uint32_t EspClass::getFreeHeap() {
+  return (uint32_t)heap_caps_get_free_size(MALLOC_CAP_8BIT);
+}
+
+uint32_t EspClass::getHeapSize() {
+  return HostHeap::HOST_HEAP_BYTES;
+}
+
+// ---------------------------
+// Serial
+// ---------------------------
+
+HardwareSerial Serial;
+
+size_t HardwareSerial::write(uint8_t c) {
+  if (serialOn.load(std::memory_order_relaxed))
+    fputc(c, stdout);
+  return 1;
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+  if (serialOn.load(std::memory_order_relaxed))
+    fwrite(buffer, 1, size, stdout);
+  return size;
+}
+
+void HardwareSerial::flush() {
+  fflush(stdout);
+}
+
+int HardwareSerial::available() {
+  int pending = 0;
+  if (ioctl(STDIN_FILENO, FIONREAD, &pending) != 0)
+    pending = 0;
+  return pending + (peeked >= 0 ? 1 : 0);
+}
+
+int HardwareSerial::read() {
+  if (peeked >= 0) {
+    int c = peeked;
+    peeked = -1;
+    return c;
+  }
+  if (available() == 0)
+    return -1; // Never block the loop, as on the board
+  unsigned char c;
+  return ::read(STDIN_FILENO, &c, 1) == 1 ? c : -1;
+}
+
+int HardwareSerial::peek() {
+  if (peeked < 0)
+    peeked = read();
+  return peeked;
+}
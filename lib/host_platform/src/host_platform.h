@@ -0,0 +1,107 @@
+#ifndef HOST_PLATFORM_H
+#define HOST_PLATFORM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ---------------------------
+// Host Platform Controls
+// ---------------------------
+// Knobs and counters of the native build that have no ESP32 equivalent.
+// Harnesses and tests include this next to the firmware headers; firmware
+// sources never do.
+
+/// Where the emulated flash lives: `<dir>/littlefs` backs LittleFS and
+/// `<dir>/nvs` backs Preferences. Defaults to $LIBRECHESS_HOST_DIR, else ".pio/host".
+class HostPlatform {
+ public:
+  static void setDataDir(const char* dir);
+  static const char* dataDir();
+  /// Give the calling thread its own data directory (nullptr to go back to the
+  /// shared one), so several simulated boards can run side by side. Tasks the
+  /// thread starts afterwards inherit it.
+  static void setThreadDataDir(const char* dir);
+  /// The calling thread's own data directory, or nullptr if it uses the shared one.
+  static const char* threadDataDir();
+  /// Create a directory and any missing parents. True if it exists afterwards.
+  static bool makeDirs(const char* dir);
+  /// Recursively delete a directory. For tests and harnesses that start from a blank flash.
+  static void removeTree(const char* dir);
+  /// Serial output goes to stdout unless turned off (harnesses printing their own report).
+  static void setSerialEnabled(bool enabled);
+  static bool serialEnabled();
+  /// Core the calling thread's task was pinned to (1 for threads not started by
+  /// xTaskCreate). Async-signal-safe, for the SIGPROF sampler.
+  static int taskCore();
+};
+
+/// millis(), micros(), esp_timer_get_time(), delay() and vTaskDelay() read and
+/// advance this clock.
+///
+/// Real time (default): the monotonic clock; delays sleep.
+/// Virtual time: each thread's clock is the CPU time it has used plus the
+/// delays it has asked for, which return at once. Polling loops and timeouts
+/// behave as on the board but a game with a human's pauses runs at CPU speed,
+/// and durations measured with micros() are the thread's own CPU time. A task
+/// starts from its creator's clock. Blocking on a queue, semaphore or
+/// notification still waits in real time.
+class HostClock {
+ public:
+  static void setVirtual(bool enabled);
+  static bool isVirtual();
+  /// Microseconds since the process started, on the calling thread's clock.
+  static int64_t now();
+  static void sleepMicros(uint64_t us);
+  /// Wall-clock time and sleep, whatever the mode (for waiting on I/O).
+  static uint64_t realMicros();
+  static void realSleepMicros(uint64_t us);
+  /// CPU time used by the calling thread, in microseconds.
+  static uint64_t threadCpuMicros();
+  /// Set the calling thread's clock (a new task inherits its creator's).
+  static void startThreadAt(int64_t nowUs);
+};
+
+/// Counts of live and total C++ heap allocations (operator new/delete), which
+/// is how String, the containers and `new` allocate. ArduinoJson's pools use
+/// malloc and aren't counted. heap_caps_* reports against HOST_HEAP_BYTES.
+class HostHeap {
+ public:
+  static constexpr uint32_t HOST_HEAP_BYTES = 320 * 1024; // About what the ESP32 has free after boot
+  static int32_t liveBlocks();
+  static int64_t liveBytes();
+  static int64_t peakBytes();
+  /// Allocations made since the process started, by every thread / by the calling thread.
+  static uint64_t allocations();
+  static uint64_t threadAllocations();
+};
+
+/// What the firmware did to the emulated flash, to compare wear between builds.
+struct HostFsStats {
+  uint64_t opens;
+  uint64_t writeCalls;
+  uint64_t bytesWritten;
+  uint64_t readCalls;
+  uint64_t bytesRead;
+  uint64_t removes;
+  uint64_t renames;
+};
+
+class HostFs {
+ public:
+  static HostFsStats stats();
+  static void resetStats();
+};
+
+/// Network plumbing for WiFiClient / WiFiClientSecure, which are plain TCP
+/// sockets here (no TLS). A redirect sends connections for a public host to a
+/// local stub server instead.
+class HostNet {
+ public:
+  static void redirect(const char* host, uint16_t port, const char* toHost, uint16_t toPort);
+  static void clearRedirects();
+  /// What WiFi.status() reports (connected by default, since the host has a network).
+  static void setStationConnected(bool connected);
+  static bool stationConnected();
+};
+
+#endif // HOST_PLATFORM_H
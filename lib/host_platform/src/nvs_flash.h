@@ -0,0 +1,17 @@
+#ifndef HOST_NVS_FLASH_H
+#define HOST_NVS_FLASH_H
+
+#include "esp_err.h"
+
+// NVS is a directory of files on the host (see Preferences.h); there is no partition to set up.
+#ifdef __cplusplus
+extern "C" {
+#endif
+esp_err_t nvs_flash_init(void);
+/// Delete every saved namespace.
+esp_err_t nvs_flash_erase(void);
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HOST_NVS_FLASH_H
@@ -0,0 +1,9 @@
+#ifndef HOST_XTENSA_CORE_MACROS_H
+#define HOST_XTENSA_CORE_MACROS_H
+
+#include "esp_timer.h"
+
+// The cycle counter of a 240 MHz core, derived from the host clock
+#define XTHAL_GET_CCOUNT() ((uint32_t)(esp_timer_get_time() * 240))
+
+#endif // HOST_XTENSA_CORE_MACROS_H
@@ -1,28 +1,16 @@
 #include "board_driver.h"
 #include "chess_utils.h"
 #include "led_colors.h"
+#include "move_trace.h"
 #include <Arduino.h>
-#include <Preferences.h>
+#include <esp_timer.h>
 #include <math.h>
 
-// 74HC595 shift register pin mapping: bits are sent MSB first, so bit 7 shifts to QH, bit 0 stays at QA
-// col 0 -> QA (pin 15), col 1 -> QB (pin 1), ..., col 7 -> QH (pin 7)
-static int shiftRegPin(int col) {
-  const int pins[] = {15, 1, 2, 3, 4, 5, 6, 7}; // QA=15, QB=1, QC=2, QD=3, QE=4, QF=5, QG=6, QH=7
-  return (col >= 0 && col < 8) ? pins[col] : -1;
-}
-static char shiftRegOutput(int col) {
-  return (col >= 0 && col < 8) ? (char)('A' + col) : '?'; // col 0 -> 'A' (QA), col 7 -> 'H' (QH)
-}
-
-// Static members for animation queue system
-QueueHandle_t BoardDriver::animationQueue = nullptr;
-TaskHandle_t BoardDriver::animationTaskHandle = nullptr;
-SemaphoreHandle_t BoardDriver::ledMutex = nullptr;
-SemaphoreHandle_t BoardDriver::animationDoneSemaphore = nullptr;
-BoardDriver* BoardDriver::instance = nullptr;
+static_assert(NUM_ROWS == HAL_SENSOR_ROWS && NUM_COLS == HAL_SENSOR_COLS, "Sensor matrix size mismatch");
 
-static constexpr int rowPins[NUM_ROWS] = {ROW_PIN_0, ROW_PIN_1, ROW_PIN_2, ROW_PIN_3, ROW_PIN_4, ROW_PIN_5, ROW_PIN_6, ROW_PIN_7};
+// NVS namespaces
+static constexpr const char* CAL_NS = "boardCal";
+static constexpr const char* LED_NS = "ledSettings";
 // ---------------------------
 // LED Strip Col/Row to Pixel index mapping (default)
 // ---------------------------
@@ -37,7 +25,7 @@ static constexpr int DefaultRowColToLEDindexMap[NUM_ROWS][NUM_COLS] = {
     {63, 62, 61, 60, 59, 58, 57, 56},
 };
 
-BoardDriver::BoardDriver() : strip(LED_COUNT, LED_PIN), lastEnabledCol(-2), brightness(BRIGHTNESS), dimMultiplier(70), swapAxes(0), calibrationLoaded(false) {
+BoardDriver::BoardDriver(LedOutput* leds, SensorMatrix* sensors, SettingsStore* settings) : leds(leds), sensors(sensors), settings(settings), animationQueue(nullptr), animationTaskHandle(nullptr), ledMutex(nullptr), animationDoneSemaphore(nullptr), lastChangeMicros(0), brightness(BRIGHTNESS), dimMultiplier(70), swapAxes(0), calibrationLoaded(false) {
   for (int i = 0; i < NUM_ROWS; i++)
     toLogicalRow[i] = i;
   for (int i = 0; i < NUM_COLS; i++)
@@ -50,19 +38,12 @@ BoardDriver::BoardDriver() : strip(LED_COUNT, LED_PIN), lastEnabledCol(-2), brig
 }
 
 void BoardDriver::begin() {
-  // Initialize NeoPixel strip
-  strip.Begin();
+  // Initialize LED strip
+  leds->begin();
   showLEDs();        // turn off all LEDs
   loadLedSettings(); // Load LED settings from NVS (brightness, dim multiplier)
-  strip.SetBrightness(brightness);
-  // Shift register pins as outputs
-  pinMode(SR_SER_DATA_PIN, OUTPUT);
-  pinMode(SR_CLK_PIN, OUTPUT);
-  pinMode(SR_LATCH_PIN, OUTPUT);
-  disableAllCols();
-  // Row pins as inputs
-  for (int c = 0; c < NUM_ROWS; c++)
-    pinMode(rowPins[c], INPUT);
+  leds->setBrightness(brightness);
+  sensors->begin();
   // Initialize sensor arrays
   for (int row = 0; row < NUM_ROWS; row++)
     for (int col = 0; col < NUM_COLS; col++) {
@@ -73,11 +54,10 @@ void BoardDriver::begin() {
     }
 
   // Initialize animation queue system
-  instance = this;
   ledMutex = xSemaphoreCreateMutex();
   animationDoneSemaphore = xSemaphoreCreateBinary();
   animationQueue = xQueueCreate(8, sizeof(AnimationJob));
-  xTaskCreatePinnedToCore(animationWorkerTask, "AnimWorker", 4096, nullptr, 1, &animationTaskHandle, 1);
+  xTaskCreatePinnedToCore(animationWorkerTask, "AnimWorker", 4096, this, 1, &animationTaskHandle, 1);
 
   // Load calibration or run first-time calibration
   if (!loadCalibration()) {
@@ -90,15 +70,16 @@ void BoardDriver::begin() {
 
 // Animation worker task - processes jobs from queue
 void BoardDriver::animationWorkerTask(void* param) {
+  BoardDriver* driver = static_cast<BoardDriver*>(param);
   AnimationJob job;
   while (true) {
-    if (xQueueReceive(animationQueue, &job, portMAX_DELAY) == pdTRUE) {
-      xSemaphoreTake(ledMutex, portMAX_DELAY);
-      instance->executeAnimation(job);
-      xSemaphoreGive(ledMutex);
+    if (xQueueReceive(driver->animationQueue, &job, portMAX_DELAY) == pdTRUE) {
+      xSemaphoreTake(driver->ledMutex, portMAX_DELAY);
+      driver->executeAnimation(job);
+      xSemaphoreGive(driver->ledMutex);
       // Signal completion for cancellable/sync animations (after mutex release)
       if (job.type == AnimationType::THINKING || job.type == AnimationType::WAITING || job.type == AnimationType::SYNC)
-        xSemaphoreGive(animationDoneSemaphore);
+        xSemaphoreGive(driver->animationDoneSemaphore);
     }
   }
 }
@@ -132,99 +113,88 @@ void BoardDriver::executeAnimation(const AnimationJob& job) {
 }
 
 bool BoardDriver::loadCalibration() {
-  if (!ChessUtils::ensureNvsInitialized()) {
+  if (!settings->isAvailable()) {
     Serial.println("NVS init failed - calibration not loaded");
     return false;
   }
-  Preferences prefs;
-  prefs.begin("boardCal", false);
-  uint8_t ver = prefs.getUChar("ver", 0);
-  if (ver != 1) {
-    prefs.end();
+  if (settings->getUChar(CAL_NS, "ver", 0) != 1)
     return false;
-  }
 
   // Verify pin configuration matches
-  size_t rowPinsLen = prefs.getBytesLength("rowPins");
-  if (rowPinsLen != NUM_ROWS) {
-    prefs.end();
-    return false;
-  }
+  SensorWiring wiring = sensors->getWiring();
   uint8_t savedRowPins[NUM_ROWS];
-  prefs.getBytes("rowPins", savedRowPins, sizeof(savedRowPins));
-  for (int i = 0; i < NUM_ROWS; i++)
-    if (savedRowPins[i] != (uint8_t)rowPins[i]) {
-      prefs.end();
-      return false;
-    }
-  uint8_t savedSRPins[3];
-  prefs.getBytes("srPins", savedSRPins, sizeof(savedSRPins));
-  if (savedSRPins[0] != (uint8_t)SR_CLK_PIN || savedSRPins[1] != (uint8_t)SR_LATCH_PIN || savedSRPins[2] != (uint8_t)SR_SER_DATA_PIN) {
-    prefs.end();
+  uint8_t savedSRPins[HAL_WIRING_COLUMN_PINS];
+  if (!settings->getBytes(CAL_NS, "rowPins", savedRowPins, sizeof(savedRowPins)) || memcmp(savedRowPins, wiring.rowPins, sizeof(savedRowPins)) != 0)
     return false;
-  }
-
-  size_t rowLen = prefs.getBytesLength("row");
-  size_t colLen = prefs.getBytesLength("col");
-  size_t ledLen = prefs.getBytesLength("led");
-  if (rowLen != NUM_ROWS || colLen != NUM_COLS || ledLen != LED_COUNT) {
-    prefs.end();
+  if (!settings->getBytes(CAL_NS, "srPins", savedSRPins, sizeof(savedSRPins)) || memcmp(savedSRPins, wiring.columnPins, sizeof(savedSRPins)) != 0)
     return false;
-  }
-  swapAxes = prefs.getUChar("swap", 0);
-  prefs.getBytes("row", toLogicalRow, NUM_ROWS);
-  prefs.getBytes("col", toLogicalCol, NUM_COLS);
+
+  // Read everything before touching the live mapping, so a partial record leaves it intact
+  uint8_t savedRow[NUM_ROWS];
+  uint8_t savedCol[NUM_COLS];
   uint8_t ledFlat[LED_COUNT];
-  prefs.getBytes("led", ledFlat, LED_COUNT);
+  if (!settings->getBytes(CAL_NS, "row", savedRow, NUM_ROWS) || !settings->getBytes(CAL_NS, "col", savedCol, NUM_COLS) || !settings->getBytes(CAL_NS, "led", ledFlat, LED_COUNT))
+    return false;
+  memcpy(toLogicalRow, savedRow, NUM_ROWS);
+  memcpy(toLogicalCol, savedCol, NUM_COLS);
+  swapAxes = settings->getUChar(CAL_NS, "swap", 0);
   int idx = 0;
   for (int row = 0; row < NUM_ROWS; row++)
     for (int col = 0; col < NUM_COLS; col++)
       ledIndexMap[row][col] = ledFlat[idx++];
-  prefs.end();
   calibrationLoaded = true;
   Serial.println("Board calibration loaded from NVS");
   return true;
 }
 
 void BoardDriver::saveCalibration() {
-  if (!ChessUtils::ensureNvsInitialized()) {
+  if (!settings->isAvailable()) {
     Serial.println("NVS init failed - calibration not saved");
     return;
   }
-  Preferences prefs;
-  prefs.begin("boardCal", false);
-  prefs.putUChar("ver", 1);
-  uint8_t rowPinsU8[NUM_ROWS];
-  for (int i = 0; i < NUM_ROWS; i++)
-    rowPinsU8[i] = (uint8_t)rowPins[i];
-  prefs.putBytes("rowPins", rowPinsU8, sizeof(rowPinsU8));
-  uint8_t srPins[3] = {(uint8_t)SR_CLK_PIN, (uint8_t)SR_LATCH_PIN, (uint8_t)SR_SER_DATA_PIN};
-  prefs.putBytes("srPins", srPins, sizeof(srPins));
-  prefs.putUChar("swap", swapAxes);
-  prefs.putBytes("row", toLogicalRow, NUM_ROWS);
-  prefs.putBytes("col", toLogicalCol, NUM_COLS);
+  SensorWiring wiring = sensors->getWiring();
+  settings->putUChar(CAL_NS, "ver", 1);
+  settings->putBytes(CAL_NS, "rowPins", wiring.rowPins, sizeof(wiring.rowPins));
+  settings->putBytes(CAL_NS, "srPins", wiring.columnPins, sizeof(wiring.columnPins));
+  settings->putUChar(CAL_NS, "swap", swapAxes);
+  settings->putBytes(CAL_NS, "row", toLogicalRow, NUM_ROWS);
+  settings->putBytes(CAL_NS, "col", toLogicalCol, NUM_COLS);
   uint8_t ledFlat[LED_COUNT];
   int idx = 0;
   for (int row = 0; row < NUM_ROWS; row++)
     for (int col = 0; col < NUM_COLS; col++)
       ledFlat[idx++] = ledIndexMap[row][col];
-  prefs.putBytes("led", ledFlat, LED_COUNT);
-  prefs.end();
+  settings->putBytes(CAL_NS, "led", ledFlat, LED_COUNT);
   calibrationLoaded = true;
   Serial.println("Board calibration saved to NVS");
 }
 
+void BoardDriver::useIdentityCalibration() {
+  swapAxes = 0;
+  for (int i = 0; i < NUM_ROWS; i++) toLogicalRow[i] = i;
+  for (int i = 0; i < NUM_COLS; i++) toLogicalCol[i] = i;
+  for (int row = 0; row < NUM_ROWS; row++)
+    for (int col = 0; col < NUM_COLS; col++)
+      ledIndexMap[row][col] = row * NUM_COLS + col;
+  calibrationLoaded = true;
+}
+
+void BoardDriver::saveIdentityCalibration() {
+  useIdentityCalibration();
+  saveCalibration();
+}
+
 void BoardDriver::readRawSensors(bool rawState[NUM_ROWS][NUM_COLS]) {
   for (int row = 0; row < NUM_ROWS; row++)
     for (int col = 0; col < NUM_COLS; col++)
       rawState[row][col] = false;
 
   for (int col = 0; col < NUM_COLS; col++) {
-    enableCol(col);
+    sensors->selectColumn(col);
     for (int row = 0; row < NUM_ROWS; row++)
-      rawState[row][col] = (digitalRead(rowPins[row]) == LOW);
+      rawState[row][col] = sensors->readRow(row);
   }
-  disableAllCols();
+  sensors->releaseColumns();
 }
 
 bool BoardDriver::waitForBoardEmpty(unsigned long stableMs) {
@@ -254,7 +224,7 @@ bool BoardDriver::waitForBoardEmpty(unsigned long stableMs) {
         for (int row = 0; row < NUM_ROWS; row++)
           for (int col = 0; col < NUM_COLS; col++)
             if (rawState[row][col])
-              Serial.printf("  GPIO %d + 74HC595 Q%c (pin %d)\n", rowPins[row], shiftRegOutput(col), shiftRegPin(col));
+              Serial.printf("  %s\n", describeRaw(row, col).c_str());
       }
     }
     delay(SENSOR_READ_DELAY_MS);
@@ -284,7 +254,7 @@ bool BoardDriver::waitForSingleRawPress(int& rawRow, int& rawCol, unsigned long
       if (foundRow == lastRow && foundCol == lastCol) {
         if (stableStart == 0) {
           stableStart = millis();
-          Serial.printf("  Detect start: GPIO %d + 74HC595 Q%c (pin %d)\n", rowPins[foundRow], shiftRegOutput(foundCol), shiftRegPin(foundCol));
+          Serial.printf("  Detect start: %s\n", describeRaw(foundRow, foundCol).c_str());
         }
         if (millis() - stableStart >= stableMs) {
           rawRow = foundRow;
@@ -295,7 +265,7 @@ bool BoardDriver::waitForSingleRawPress(int& rawRow, int& rawCol, unsigned long
         // Position changed - warn about unstable detection
         if (lastRow >= 0 && lastCol >= 0) {
           Serial.println("Sensor reading unstable - detected square changed. Hold piece steady on one square.");
-          Serial.printf("  Previous: GPIO %d + 74HC595 Q%c (pin %d), Current: GPIO %d + 74HC595 Q%c (pin %d)\n", rowPins[lastRow], shiftRegOutput(lastCol), shiftRegPin(lastCol), rowPins[foundRow], shiftRegOutput(foundCol), shiftRegPin(foundCol));
+          Serial.printf("  Previous: %s, Current: %s\n", describeRaw(lastRow, lastCol).c_str(), describeRaw(foundRow, foundCol).c_str());
         }
         lastRow = foundRow;
         lastCol = foundCol;
@@ -313,7 +283,7 @@ bool BoardDriver::waitForSingleRawPress(int& rawRow, int& rawCol, unsigned long
           for (int row = 0; row < NUM_ROWS; row++)
             for (int col = 0; col < NUM_COLS; col++)
               if (rawState[row][col])
-                Serial.printf("  GPIO %d + 74HC595 Q%c (pin %d)\n", rowPins[row], shiftRegOutput(col), shiftRegPin(col));
+                Serial.printf("  %s\n", describeRaw(row, col).c_str());
         }
       }
       stableStart = 0;
@@ -324,7 +294,7 @@ bool BoardDriver::waitForSingleRawPress(int& rawRow, int& rawCol, unsigned long
 
 void BoardDriver::showCalibrationError() {
   for (int i = 0; i < LED_COUNT; i++)
-    strip.SetPixelColor(i, RgbColor(LedColors::Red.r, LedColors::Red.g, LedColors::Red.b));
+    leds->setPixel(i, LedColors::Red);
   showLEDs();
   delay(500);
   waitForBoardEmpty();
@@ -371,16 +341,16 @@ bool BoardDriver::calibrateAxis(Axis axis, uint8_t* axisPinsOrder, size_t NUM_PI
     int row = 0;
     int col = 0;
     waitForSingleRawPress(row, col);
-    Serial.printf("  Detected: row=%d (GPIO %d), col=%d (74HC595 Q%c, pin %d)\n", row, rowPins[row], col, shiftRegOutput(col), shiftRegPin(col));
+    Serial.printf("  Detected: row=%d (%s), col=%d (%s)\n", row, sensors->describeRow(row).c_str(), col, sensors->describeColumn(col).c_str());
 
     // Verify pin consistency for column calibration
     if (axis == ColsAxis && expectedRawPin != -1) {
       int actualPin = useRow ? row : col;
       if (actualPin != expectedRawPin) {
         if (useRow)
-          Serial.printf("[ERROR] Expected piece on rank 1 = row %d (GPIO %d) but detected on row %d (GPIO %d) which is not rank 1. Place piece on %s.\n", expectedRawPin, rowPins[expectedRawPin], actualPin, rowPins[actualPin], square);
+          Serial.printf("[ERROR] Expected piece on rank 1 = row %d (%s) but detected on row %d (%s) which is not rank 1. Place piece on %s.\n", expectedRawPin, sensors->describeRow(expectedRawPin).c_str(), actualPin, sensors->describeRow(actualPin).c_str(), square);
         else
-          Serial.printf("[ERROR] Expected piece on rank 1 = col %d (74HC595 Q%c, pin %d) but detected on col %d (74HC595 Q%c, pin %d) which is not rank 1. Place piece on %s.\n", expectedRawPin, shiftRegOutput(expectedRawPin), shiftRegPin(expectedRawPin), actualPin, shiftRegOutput(actualPin), shiftRegPin(actualPin), square);
+          Serial.printf("[ERROR] Expected piece on rank 1 = col %d (%s) but detected on col %d (%s) which is not rank 1. Place piece on %s.\n", expectedRawPin, sensors->describeColumn(expectedRawPin).c_str(), actualPin, sensors->describeColumn(actualPin).c_str(), square);
         showCalibrationError();
         i--;
         continue;
@@ -408,8 +378,8 @@ bool BoardDriver::calibrateAxis(Axis axis, uint8_t* axisPinsOrder, size_t NUM_PI
         Serial.printf("%s calibration using rows %s\n", axisToChessRankFile(axis).c_str(), axis != detectedAxis ? "(axis swap)" : "(no axis swap)");
       } else {
         Serial.printf("\n============== AMBIGUOUS %s CALIBRATION ==============\n", axisToChessRankFile(axis).c_str());
-        Serial.printf("First press:  row=%d (GPIO %d), col=%d (74HC595 Q%c, pin %d)\n", firstRow, rowPins[firstRow], firstCol, shiftRegOutput(firstCol), shiftRegPin(firstCol));
-        Serial.printf("Second press: row=%d (GPIO %d), col=%d (74HC595 Q%c, pin %d)\n", row, rowPins[row], col, shiftRegOutput(col), shiftRegPin(col));
+        Serial.printf("First press:  row=%d (%s), col=%d (%s)\n", firstRow, sensors->describeRow(firstRow).c_str(), firstCol, sensors->describeColumn(firstCol).c_str());
+        Serial.printf("Second press: row=%d (%s), col=%d (%s)\n", row, sensors->describeRow(row).c_str(), col, sensors->describeColumn(col).c_str());
         Serial.printf("PROBLEM: %s\n", (row == firstRow && col == firstCol) ? "Both presses detected by the SAME sensor" : "Both row AND column changed between presses");
         Serial.println("==========================================================\n");
         showCalibrationError();
@@ -436,9 +406,9 @@ bool BoardDriver::calibrateAxis(Axis axis, uint8_t* axisPinsOrder, size_t NUM_PI
       else
         snprintf(assignedRankFile, sizeof(assignedRankFile), "file %c", 'a' + assignedIndex);
       if (detectedAxis == RowsAxis)
-        Serial.printf("[ERROR] Row %d (GPIO %d) already has %s assigned. Retry %s.\n", pin, rowPins[pin], assignedRankFile, square);
+        Serial.printf("[ERROR] Row %d (%s) already has %s assigned. Retry %s.\n", pin, sensors->describeRow(pin).c_str(), assignedRankFile, square);
       else
-        Serial.printf("[ERROR] Col %d (74HC595 Q%c, pin %d) already has %s assigned. Retry %s.\n", pin, shiftRegOutput(pin), shiftRegPin(pin), assignedRankFile, square);
+        Serial.printf("[ERROR] Col %d (%s) already has %s assigned. Retry %s.\n", pin, sensors->describeColumn(pin).c_str(), assignedRankFile, square);
       showCalibrationError();
       i--;
       continue;
@@ -457,7 +427,7 @@ bool BoardDriver::calibrateAxis(Axis axis, uint8_t* axisPinsOrder, size_t NUM_PI
 bool BoardDriver::runCalibration() {
   // Calibration animation - light up each pixel sequentially
   for (int i = 0; i < LED_COUNT; i++) {
-    strip.SetPixelColor(i, RgbColor(LedColors::White.r, LedColors::White.g, LedColors::White.b));
+    leds->setPixel(i, LedColors::White);
     showLEDs();
     delay(50);
   }
@@ -477,14 +447,7 @@ bool BoardDriver::runCalibration() {
         Serial.println("[SKIP] Calibration skipped - using default mapping");
         Serial.println("[SKIP] Sensors/LEDs will NOT work correctly!");
         Serial.println("[SKIP] You will be asked to calibrate again on next reboot");
-        // Set up identity mapping (no calibration)
-        swapAxes = 0;
-        for (int i = 0; i < NUM_ROWS; i++) toLogicalRow[i] = i;
-        for (int i = 0; i < NUM_COLS; i++) toLogicalCol[i] = i;
-        for (int row = 0; row < NUM_ROWS; row++)
-          for (int col = 0; col < NUM_COLS; col++)
-            ledIndexMap[row][col] = row * NUM_COLS + col;
-        calibrationLoaded = true;
+        useIdentityCalibration();
         return true;
       } else {
         Serial.println("Unknown command \"" + input + "\" Type \"skip\" to skip calibration or wait 5 seconds for calibration to begin");
@@ -517,13 +480,13 @@ bool BoardDriver::runCalibration() {
 
   auto displayCalibrationLEDs = [&](int currentPixel) {
     for (int i = 0; i < LED_COUNT; i++)
-      strip.SetPixelColor(i, RgbColor(0));
+      leds->setPixel(i, LedColors::Off);
     for (int r = 0; r < NUM_ROWS; r++)
       for (int c = 0; c < NUM_COLS; c++)
         if (logicalUsed[r][c])
-          strip.SetPixelColor(ledIndexMap[r][c], RgbColor(LedColors::Green.r, LedColors::Green.g, LedColors::Green.b));
+          leds->setPixel(ledIndexMap[r][c], LedColors::Green);
     if (currentPixel < LED_COUNT)
-      strip.SetPixelColor(currentPixel, RgbColor(LedColors::White.r, LedColors::White.g, LedColors::White.b));
+      leds->setPixel(currentPixel, LedColors::White);
     showLEDs();
   };
 
@@ -557,59 +520,14 @@ bool BoardDriver::runCalibration() {
   return false;
 }
 
-void BoardDriver::loadShiftRegister(byte data, int bits) {
-#if defined(SR_INVERT_OUTPUTS) && SR_INVERT_OUTPUTS != 0
-  data = ~data;
-#endif
-  // Make sure latch is low before shifting data
-  digitalWrite(SR_LATCH_PIN, LOW);
-  // Shift bits MSB first
-  for (int i = bits - 1; i >= 0; i--) {
-    digitalWrite(SR_SER_DATA_PIN, !!(data & (1 << i)));
-    delayMicroseconds(10);
-    digitalWrite(SR_CLK_PIN, HIGH);
-    delayMicroseconds(10);
-    digitalWrite(SR_CLK_PIN, LOW);
-    delayMicroseconds(10);
-  }
-  // Latch the data to output pins
-  digitalWrite(SR_LATCH_PIN, HIGH);
-  delayMicroseconds(10);
-  digitalWrite(SR_LATCH_PIN, LOW);
-}
-
-void BoardDriver::disableAllCols() {
-  if (lastEnabledCol == 7) {
-    // Sequential wrap-around: shift in a single 0 to push the 1 out of QH
-    loadShiftRegister(0x00, 1);
-  } else {
-    // Non-sequential or startup: load full byte of zeros
-    loadShiftRegister(0);
-  }
-  lastEnabledCol = -1; // Make next enableCol(0) call use optimized 1-bit shift because register is now all zeros
-}
-
-void BoardDriver::enableCol(int col) {
-  if (col == lastEnabledCol + 1) {
-    if (col == 0)
-      loadShiftRegister(0x01, 1); // Sequential wrap-around: register should be all zeros already, shift in a single 1 bit into QA
-    else
-      loadShiftRegister(0x00, 1); // Sequential access: shift in a single 0 bit to move the 1 we shifted earlier to the next column position (towards QH)
-  } else {
-    // Due to above logic, this condition should never occur, but just in case...
-    loadShiftRegister((byte)(1 << col));
-  }
-  lastEnabledCol = col;
-  delayMicroseconds(100); // Allow time for the column to stabilize, otherwise random readings might occur
-}
-
 void BoardDriver::readSensors() {
   unsigned long currentTime = millis();
+  int64_t scanMicros = esp_timer_get_time();
 
   for (int col = 0; col < NUM_COLS; col++) {
-    enableCol(col);
+    sensors->selectColumn(col);
     for (int row = 0; row < NUM_ROWS; row++) {
-      bool newReading = digitalRead(rowPins[row]) == LOW;
+      bool newReading = sensors->readRow(row);
       uint8_t logicalRow = toLogicalRow[swapAxes ? col : row];
       uint8_t logicalCol = toLogicalCol[swapAxes ? row : col];
       // Debounce logic
@@ -619,6 +537,9 @@ void BoardDriver::readSensors() {
           sensorDebounceTime[logicalRow][logicalCol] = currentTime;
         } else if (currentTime - sensorDebounceTime[logicalRow][logicalCol] >= DEBOUNCE_MS) {
           sensorState[logicalRow][logicalCol] = newReading;
+          // Date the change back to its first raw reading so the debounce window isn't counted
+          lastChangeMicros = scanMicros - (int64_t)(currentTime - sensorDebounceTime[logicalRow][logicalCol]) * 1000;
+          MoveTrace::recordSensorChange(lastChangeMicros);
         }
       } else {
         sensorRaw[logicalRow][logicalCol] = newReading;
@@ -626,7 +547,7 @@ void BoardDriver::readSensors() {
       }
     }
   }
-  disableAllCols();
+  sensors->releaseColumns();
 }
 
 bool BoardDriver::getSensorState(int row, int col) {
@@ -660,7 +581,7 @@ void BoardDriver::clearAllLEDs(bool show) {
     for (int col = 0; col < NUM_COLS; col++)
       currentColors[row][col] = LedColors::Off;
   for (int i = 0; i < LED_COUNT; i++)
-    strip.SetPixelColor(i, RgbColor(0));
+    leds->setPixel(i, LedColors::Off);
   if (show)
     showLEDs();
 }
@@ -670,22 +591,12 @@ void BoardDriver::setSquareLED(int row, int col, LedRGB color) {
   float multiplier = 1.0f;
   if ((row + col) % 2 == 1)
     multiplier = dimMultiplier / 100.0f; // Dim dark squares based on user setting
-  strip.SetPixelColor(getPixelIndex(row, col), RgbColor(color.r * multiplier, color.g * multiplier, color.b * multiplier));
+  leds->setPixel(getPixelIndex(row, col), LedColors::scaleColor(color, multiplier));
 }
 
 void BoardDriver::showLEDs() {
-  strip.Show();
-}
-
-void BoardDriver::showConnectingAnimation() {
-  LedGuard guard(this);
-  for (int i = 0; i < 8; i++) {
-    setSquareLED(3, i, LedColors::Blue);
-    setSquareLED(4, i, LedColors::Blue);
-    showLEDs();
-    delay(100);
-  }
-  clearAllLEDs();
+  leds->show();
+  MoveTrace::ledsShown();
 }
 
 void BoardDriver::blinkSquare(int row, int col, LedRGB color, int times, bool clearAfter, bool clearBefore) {
@@ -1005,7 +916,7 @@ void BoardDriver::doWaiting(std::atomic<bool>* stopFlag) {
 void BoardDriver::setBrightness(uint8_t value) {
   LedGuard guard(this);
   brightness = value > 255 ? 255 : (value < 10 ? 10 : value);
-  strip.SetBrightness(brightness);
+  leds->setBrightness(brightness);
   showLEDs();
 }
 
@@ -1020,41 +931,32 @@ void BoardDriver::setDimMultiplier(uint8_t value) {
 }
 
 void BoardDriver::loadLedSettings() {
-  if (!ChessUtils::ensureNvsInitialized()) {
+  if (!settings->isAvailable()) {
     Serial.println("NVS init failed - LED settings not loaded");
     return;
   }
-  Preferences prefs;
-  prefs.begin("ledSettings", true);
-  brightness = prefs.getUChar("brightness", BRIGHTNESS);
-  dimMultiplier = prefs.getUChar("dimMult", 70);
-  prefs.end();
+  brightness = settings->getUChar(LED_NS, "brightness", BRIGHTNESS);
+  dimMultiplier = settings->getUChar(LED_NS, "dimMult", 70);
   Serial.printf("LED settings loaded: brightness=%d, dimMultiplier=%d\n", brightness, dimMultiplier);
 }
 
 void BoardDriver::saveLedSettings() {
-  if (!ChessUtils::ensureNvsInitialized()) {
+  if (!settings->isAvailable()) {
     Serial.println("NVS init failed - LED settings not saved");
     return;
   }
-  Preferences prefs;
-  prefs.begin("ledSettings", false);
-  prefs.putUChar("brightness", brightness);
-  prefs.putUChar("dimMult", dimMultiplier);
-  prefs.end();
+  settings->putUChar(LED_NS, "brightness", brightness);
+  settings->putUChar(LED_NS, "dimMult", dimMultiplier);
   Serial.printf("LED settings saved: brightness=%d, dimMultiplier=%d\n", brightness, dimMultiplier);
 }
 
 void BoardDriver::triggerCalibration() {
   // Mark calibration as needed by clearing the saved calibration
-  if (!ChessUtils::ensureNvsInitialized()) {
+  if (!settings->isAvailable()) {
     Serial.println("NVS init failed - cannot trigger calibration");
     return;
   }
-  Preferences prefs;
-  prefs.begin("boardCal", false);
-  prefs.clear();
-  prefs.end();
+  settings->clear(CAL_NS);
   Serial.println("Board calibration cleared - rebooting ...");
   ESP.restart();
-}
\ No newline at end of file
+}
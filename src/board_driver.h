@@ -1,8 +1,9 @@
 #ifndef BOARD_DRIVER_H
 #define BOARD_DRIVER_H
 
+#include "cooperative_wait.h"
+#include "hal.h"
 #include "led_colors.h"
-#include <NeoPixelBrightnessBus.h>
 #include <atomic>
 #include <freertos/FreeRTOS.h>
 #include <freertos/queue.h>
@@ -12,6 +13,7 @@
 // ---------------------------
 // Hardware Configuration
 // ---------------------------
+// Pins used by the ESP32 HAL implementations (hal_esp32.h)
 
 // ---------------------------
 // WS2812B LED Data IN GPIO Pin
@@ -106,17 +108,19 @@ struct AnimationJob {
 // ---------------------------
 class BoardDriver {
  private:
-  NeoPixelBrightnessBus<NeoGrbFeature, NeoEsp32I2s0800KbpsMethod> strip;
-
-  // Animation queue system
-  static QueueHandle_t animationQueue;
-  static TaskHandle_t animationTaskHandle;
-  static SemaphoreHandle_t ledMutex;
+  LedOutput* leds;
+  SensorMatrix* sensors;
+  SettingsStore* settings;
+  CooperativeWait waits;
+
+  // Animation queue system (one queue, mutex and worker task per driver)
+  QueueHandle_t animationQueue;
+  TaskHandle_t animationTaskHandle;
+  SemaphoreHandle_t ledMutex;
   // Completion semaphore — signaled by the animation worker after finishing
   // a THINKING, WAITING, or SYNC job. Used by stopAndWaitForAnimation() and
   // waitForAnimationQueueDrain() to block until the animation is truly done.
-  static SemaphoreHandle_t animationDoneSemaphore;
-  static BoardDriver* instance;
+  SemaphoreHandle_t animationDoneSemaphore;
   static void animationWorkerTask(void* param);
   void executeAnimation(const AnimationJob& job);
   void doCapture(int row, int col);
@@ -130,7 +134,7 @@ class BoardDriver {
   bool sensorPrev[NUM_ROWS][NUM_COLS];
   bool sensorRaw[NUM_ROWS][NUM_COLS];
   unsigned long sensorDebounceTime[NUM_ROWS][NUM_COLS];
-  int lastEnabledCol; // Tracks last enabled column for efficient sequential shifting
+  int64_t lastChangeMicros; // esp_timer time of the raw edge behind the latest debounced change
 
   enum Axis {
     RowsAxis = 0,
@@ -152,6 +156,7 @@ class BoardDriver {
   bool loadCalibration();
   void saveCalibration();
   bool runCalibration();
+  void useIdentityCalibration(); // Raw row/column = square row/column, LED index = row * 8 + col
   void loadLedSettings();
   void readRawSensors(bool rawState[NUM_ROWS][NUM_COLS]);
   bool waitForBoardEmpty(unsigned long stableMs = 500);
@@ -160,18 +165,21 @@ class BoardDriver {
   bool calibrateAxis(Axis axis, uint8_t* axisPinsOrder, size_t NUM_PINS, bool firstAxisSwapped);
   String axisToChessRankFile(Axis axis) const { return (axis == RowsAxis) ? "Rank" : ((axis == ColsAxis) ? "File" : "Unknown"); };
 
-  void loadShiftRegister(byte data, int bits = 8);
-  void disableAllCols();
-  void enableCol(int col);
   int getPixelIndex(int row, int col);
+  String describeRaw(int row, int col) const { return sensors->describeRow(row) + " + " + sensors->describeColumn(col); }
 
  public:
-  BoardDriver();
+  BoardDriver(LedOutput* leds, SensorMatrix* sensors, SettingsStore* settings);
   void begin();
   void readSensors();
   bool getSensorState(int row, int col);
   bool getSensorPrev(int row, int col);
   void updateSensorPrev();
+  /// esp_timer time (µs) at which the most recent debounced sensor change first
+  /// appeared on the raw input, i.e. when the piece actually landed or lifted.
+  int64_t getLastChangeMicros() const { return lastChangeMicros; }
+  /// What blocking waits at this board sleep through, so its background service keeps running.
+  CooperativeWait& cooperativeWait() { return waits; }
 
   // LED Control
   void acquireLEDs(); // Block until LED strip available
@@ -196,7 +204,6 @@ class BoardDriver {
   void captureAnimation(int row, int col);
   void promotionAnimation(int col);
   void blinkSquare(int row, int col, LedRGB color, int times = 3, bool clearAfter = true, bool clearBefore = false);
-  void showConnectingAnimation();
   void flashBoardAnimation(LedRGB color, int times = 3);
 
   // Start a cancellable animation. Returns a heap-allocated stop flag.
@@ -222,6 +229,9 @@ class BoardDriver {
   void setDimMultiplier(uint8_t value);
   void saveLedSettings();
   void triggerCalibration();
+  /// Save the identity mapping as the calibration, for sensors and LEDs already
+  /// wired in square order (the native build's VirtualSensorMatrix). Call before begin().
+  void saveIdentityCalibration();
 };
 
 #endif // BOARD_DRIVER_H
@@ -101,7 +101,7 @@ int BoardMenu::trySelect(SelectorState& state, int8_t row, int8_t col, LedRGB co
     // Wait for piece removal so the next menu starts with a clean square
     while (bd_->getSensorState(r, c)) {
       bd_->readSensors();
-      delay(SENSOR_READ_DELAY_MS);
+      bd_->cooperativeWait().sleep(SENSOR_READ_DELAY_MS);
     }
     return id;
   }
@@ -132,7 +132,7 @@ int BoardMenu::waitForSelection() {
       hide();
       return result;
     }
-    delay(SENSOR_READ_DELAY_MS);
+    bd_->cooperativeWait().sleep(SENSOR_READ_DELAY_MS);
   }
 }
 
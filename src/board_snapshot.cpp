@@ -0,0 +1,44 @@
+#include "board_snapshot.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <stdlib.h>
+#include <string.h>
+
+static uint16_t fullMoveNumber(const char* fen) {
+  const char* field = strrchr(fen, ' ');
+  int number = field ? atoi(field + 1) : 0;
+  return number > 0 ? (uint16_t)number : 1;
+}
+
+BoardSnapshot::BoardSnapshot() : sequence(0) {
+  memset(&state, 0, sizeof(state));
+}
+
+void BoardSnapshot::publish(const char* fen, float evaluation, const char* lastMove) {
+  uint32_t seq = sequence.load(std::memory_order_relaxed);
+  sequence.store(seq + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  state.version++;
+  state.evaluation = evaluation;
+  state.moveNumber = fullMoveNumber(fen);
+  strlcpy(state.lastMove, lastMove ? lastMove : "", sizeof(state.lastMove));
+  strlcpy(state.fen, fen, sizeof(state.fen));
+
+  sequence.store(seq + 2, std::memory_order_release);
+}
+
+void BoardSnapshot::read(BoardState& out) const {
+  while (true) {
+    uint32_t before = sequence.load(std::memory_order_acquire);
+    if (before & 1) {
+      // Publish in progress. Sleep rather than spin: the reader may have preempted the writer on the same core
+      vTaskDelay(1);
+      continue;
+    }
+    memcpy(&out, &state, sizeof(out));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (sequence.load(std::memory_order_relaxed) == before)
+      return;
+  }
+}
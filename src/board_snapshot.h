@@ -0,0 +1,44 @@
+#ifndef BOARD_SNAPSHOT_H
+#define BOARD_SNAPSHOT_H
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+// ---------------------------
+// Board Snapshot
+// ---------------------------
+// The board state shown on the web page, published by the game loop and read
+// by the HTTP handlers on the AsyncTCP task. Stored in fixed buffers behind a
+// sequence lock: the writer never blocks, and a reader copies the state and
+// retries if a publish overlapped the copy (sleeping a tick if it caught the
+// writer mid-publish). Readers never see a half-written
+// FEN, and nothing is allocated on either side.
+
+static constexpr size_t BOARD_SNAPSHOT_FEN_SIZE = 96;  // Longest legal FEN is under 90 characters
+static constexpr size_t BOARD_SNAPSHOT_MOVE_SIZE = 6;  // UCI move with promotion + terminator
+
+struct BoardState {
+  uint32_t version;      // Incremented by every publish
+  float evaluation;      // Pawns, positive = White advantage
+  uint16_t moveNumber;   // Full-move number from the FEN
+  char lastMove[BOARD_SNAPSHOT_MOVE_SIZE]; // UCI, empty before the first move
+  char fen[BOARD_SNAPSHOT_FEN_SIZE];
+};
+
+/// Single writer (the game loop task), any number of readers on any task.
+class BoardSnapshot {
+ public:
+  BoardSnapshot();
+
+  /// Replace the published state. `fen` is truncated if it doesn't fit.
+  void publish(const char* fen, float evaluation, const char* lastMove);
+  /// Copy the latest complete state into `out`.
+  void read(BoardState& out) const;
+
+ private:
+  std::atomic<uint32_t> sequence; // Odd while a publish is in progress
+  BoardState state;
+};
+
+#endif // BOARD_SNAPSHOT_H
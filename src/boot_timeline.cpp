@@ -0,0 +1,33 @@
+#include "boot_timeline.h"
+#include <esp_timer.h>
+
+static uint32_t stageUs[(size_t)BootStage::COUNT];
+
+static const char* const STAGE_NAMES[(size_t)BootStage::COUNT] = {
+    "setup", "nvs", "filesystem", "board", "interactive", "ap", "sta", "mdns", "webServer", "ntp",
+};
+
+void BootTimeline::mark(BootStage stage) {
+  uint32_t& slot = stageUs[(size_t)stage];
+  if (slot == 0) // Aligned 32-bit store: a racing second mark can at worst overwrite with a later time
+    slot = (uint32_t)esp_timer_get_time();
+}
+
+uint32_t BootTimeline::timeUs(BootStage stage) {
+  return stageUs[(size_t)stage];
+}
+
+const char* BootTimeline::stageName(BootStage stage) {
+  return STAGE_NAMES[(size_t)stage];
+}
+
+void BootTimeline::print() {
+  Serial.println("============== Boot Timeline ==============");
+  for (size_t i = 0; i < (size_t)BootStage::COUNT; i++) {
+    if (stageUs[i] == 0)
+      Serial.printf("  %-12s      -\n", STAGE_NAMES[i]);
+    else
+      Serial.printf("  %-12s %6u ms\n", STAGE_NAMES[i], stageUs[i] / 1000);
+  }
+  Serial.println("===========================================");
+}
@@ -0,0 +1,40 @@
+#ifndef BOOT_TIMELINE_H
+#define BOOT_TIMELINE_H
+
+#include <Arduino.h>
+
+// ---------------------------
+// Boot Timeline
+// ---------------------------
+// Timestamps of the boot milestones, in microseconds since reset. setup()
+// brings the board up first (sensors, LEDs, resume prompt or game menu);
+// the network stack starts afterwards on a background task, so the gap
+// between INTERACTIVE and the WiFi milestones is the time the board no
+// longer waits for. Served by GET /debug/boot and printed once the network
+// stack is up.
+
+enum class BootStage : uint8_t {
+  SETUP_ENTERED,     // First line of setup()
+  NVS_READY,
+  FILESYSTEM_READY,  // LittleFS mounted, move history ready
+  BOARD_READY,       // LEDs, sensors and calibration
+  INTERACTIVE,       // Resume prompt or game menu accepts input
+  AP_READY,          // Soft AP up
+  STA_CONNECTED,     // First IP from a saved network
+  MDNS_READY,
+  WEB_SERVER_READY,  // Network startup finished
+  NTP_SYNCED,        // First SNTP time sync
+  COUNT
+};
+
+/// Static like MoveTrace. mark() may be called from any task; only the first mark of a stage counts.
+class BootTimeline {
+ public:
+  static void mark(BootStage stage);
+  /// Microseconds since reset at which `stage` was reached, 0 if not (yet).
+  static uint32_t timeUs(BootStage stage);
+  static const char* stageName(BootStage stage);
+  static void print();
+};
+
+#endif // BOOT_TIMELINE_H
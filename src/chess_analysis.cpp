@@ -0,0 +1,329 @@
+#include "chess_analysis.h"
+#include "chess_utils.h"
+#include "led_colors.h"
+#include "move_history.h"
+#include "wifi_manager_esp32.h"
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <string.h>
+
+ChessAnalysis::ChessAnalysis(BoardDriver* bd, ChessEngine* ce, WiFiManagerESP32* wm)
+    : ChessMoves(bd, ce, wm, nullptr),
+      workerHandle(nullptr),
+      stateMutex(nullptr),
+      workerExitSemaphore(nullptr),
+      shuttingDown(false),
+      helperCount(0),
+      generation(0),
+      finishedGeneration(0),
+      lineCount(0),
+      completedDepth(0),
+      searchedNodes(0),
+      searchMillis(0),
+      resultGeneration(0),
+      resultVersion(0),
+      lastPositionHash(0),
+      lastPublishedVersion(0),
+      hintShown(false) {}
+
+ChessAnalysis::~ChessAnalysis() {
+  if (workerHandle) {
+    // Abort the running iterations, wake the worker and helpers and wait until none touches a search
+    shuttingDown = true;
+    stopSearches();
+    xTaskNotifyGive(workerHandle);
+    for (int i = 0; i < helperCount; i++)
+      xTaskNotifyGive(helpers[i].handle);
+    for (int i = 0; i < 1 + helperCount; i++)
+      xSemaphoreTake(workerExitSemaphore, portMAX_DELAY);
+    workerHandle = nullptr;
+  }
+  if (stateMutex) vSemaphoreDelete(stateMutex);
+  if (workerExitSemaphore) vSemaphoreDelete(workerExitSemaphore);
+  wifiManager->clearAnalysis();
+}
+
+void ChessAnalysis::begin() {
+  Serial.println("=== Starting Analysis Mode ===");
+  // The table (48KB) is the first thing the mode takes from the heap and is freed
+  // with it, so it comes out of the largest free block and goes back in one
+  // piece instead of staying reserved in the arena for modes that need TLS
+  bool hasTable = search.begin();
+  initializeBoard();
+  waitForBoardSetup(board);
+
+  stateMutex = xSemaphoreCreateMutex();
+  workerExitSemaphore = xSemaphoreCreateCounting(1 + ANALYSIS_HELPERS, 0);
+  if (!hasTable)
+    Serial.println("WARNING: Not enough heap for the analysis hash table, searching without it");
+  if (xTaskCreatePinnedToCore(workerTask, "Analysis", ANALYSIS_TASK_STACK, this, ANALYSIS_TASK_PRIORITY, &workerHandle, ANALYSIS_TASK_CORE) != pdPASS) {
+    Serial.println("ERROR: Failed to start analysis task");
+    workerHandle = nullptr;
+    return;
+  }
+  // Helpers only help through the table: without one they would just burn core 1
+  for (int i = 0; hasTable && i < ANALYSIS_HELPERS; i++) {
+    Helper& helper = helpers[i];
+    helper.owner = this;
+    helper.search.shareTable(search);
+    helper.nodes.store(0);
+    char name[16];
+    snprintf(name, sizeof(name), "AnalysisHelp%d", i);
+    if (xTaskCreatePinnedToCore(helperTask, name, ANALYSIS_TASK_STACK, &helper, ANALYSIS_HELPER_PRIORITY, &helper.handle, ANALYSIS_HELPER_CORE) != pdPASS) {
+      Serial.printf("WARNING: Failed to start analysis helper %d, continuing with %d helper(s)\n", i, helperCount);
+      break;
+    }
+    helperCount++;
+  }
+  postPositionIfChanged();
+}
+
+void ChessAnalysis::update() {
+  if (wifiManager->getPendingAnalysisHint()) {
+    wifiManager->clearPendingAnalysisHint();
+    showBestMove();
+  }
+
+  ChessMoves::update();
+
+  if (!workerHandle) return;
+  postPositionIfChanged();
+  publishResults();
+}
+
+// ---------------------------
+// Loop Task Side
+// ---------------------------
+
+void ChessAnalysis::postPositionIfChanged() {
+  uint64_t hash = chessEngine->computeZobristHash(board, currentTurn);
+  if (hash == lastPositionHash && generation != 0)
+    return;
+  lastPositionHash = hash;
+  if (hintShown) clearHint();
+
+  xSemaphoreTake(stateMutex, portMAX_DELAY);
+  memcpy(pending.board, board, sizeof(board));
+  pending.turn = currentTurn;
+  pending.castlingRights = chessEngine->getCastlingRights();
+  chessEngine->getEnPassantTarget(pending.epRow, pending.epCol);
+  generation++;
+  xSemaphoreGive(stateMutex);
+
+  // Stop the previous position's search; the worker and helpers pick the new one up on their next wake-up
+  stopSearches();
+  xTaskNotifyGive(workerHandle);
+  for (int i = 0; i < helperCount; i++)
+    xTaskNotifyGive(helpers[i].handle);
+  // Drop the previous position's lines until the first iteration of the new search lands
+  wifiManager->updateAnalysis("{\"active\":true,\"depth\":0,\"lines\":[]}");
+}
+
+void ChessAnalysis::publishResults() {
+  SearchLine snapshot[SEARCH_MAX_LINES];
+  int count, depth;
+  uint32_t nodes;
+  unsigned long elapsed;
+
+  xSemaphoreTake(stateMutex, portMAX_DELAY);
+  if (resultVersion == lastPublishedVersion || resultGeneration != generation) {
+    xSemaphoreGive(stateMutex);
+    return;
+  }
+  lastPublishedVersion = resultVersion;
+  count = lineCount;
+  depth = completedDepth;
+  nodes = searchedNodes;
+  elapsed = searchMillis;
+  memcpy(snapshot, lines, sizeof(SearchLine) * count);
+  xSemaphoreGive(stateMutex);
+
+  String fen = ChessUtils::boardToFEN(board, currentTurn, chessEngine);
+
+  JsonDocument doc;
+  doc["active"] = true;
+  doc["fen"] = fen;
+  doc["depth"] = depth;
+  doc["nodes"] = nodes;
+  doc["timeMs"] = elapsed;
+  doc["threads"] = 1 + helperCount;
+  JsonArray linesJson = doc["lines"].to<JsonArray>();
+  for (int i = 0; i < count; i++) {
+    JsonObject lineJson = linesJson.add<JsonObject>();
+    lineJson["evaluation"] = serialized(String(snapshot[i].score / 100.0f, 2));
+    lineJson["mate"] = snapshot[i].mateIn;
+    JsonArray movesJson = lineJson["moves"].to<JsonArray>();
+    for (int m = 0; m < snapshot[i].length; m++) {
+      int fromRow, fromCol, toRow, toCol;
+      char promotion;
+      MoveHistory::decodeMove(snapshot[i].pv[m], fromRow, fromCol, toRow, toCol, promotion);
+      movesJson.add(ChessUtils::toUCIMove(fromRow, fromCol, toRow, toCol, promotion));
+    }
+  }
+  String output;
+  serializeJson(doc, output);
+  wifiManager->updateAnalysis(output);
+
+  // The search score is a better evaluation bar than the material count
+  if (count > 0) {
+    float evaluation = snapshot[0].mateIn != 0 ? (snapshot[0].mateIn > 0 ? 100.0f : -100.0f) : snapshot[0].score / 100.0f;
+    wifiManager->updateBoardState(fen, evaluation);
+  }
+}
+
+void ChessAnalysis::showBestMove() {
+  uint16_t best = 0;
+  xSemaphoreTake(stateMutex, portMAX_DELAY);
+  if (resultGeneration == generation && lineCount > 0)
+    best = lines[0].pv[0];
+  xSemaphoreGive(stateMutex);
+
+  if (best == 0) {
+    Serial.println("Analysis hint requested but no result is ready yet");
+    return;
+  }
+
+  int fromRow, fromCol, toRow, toCol;
+  char promotion;
+  MoveHistory::decodeMove(best, fromRow, fromCol, toRow, toCol, promotion);
+  Serial.printf("Analysis hint: %s\n", ChessUtils::toUCIMove(fromRow, fromCol, toRow, toCol, promotion).c_str());
+
+  boardDriver->waitForAnimationQueueDrain();
+  BoardDriver::LedGuard guard(boardDriver);
+  boardDriver->clearAllLEDs(false);
+  boardDriver->setSquareLED(fromRow, fromCol, LedColors::Cyan);
+  boardDriver->setSquareLED(toRow, toCol, LedColors::White);
+  boardDriver->showLEDs();
+  hintShown = true;
+}
+
+void ChessAnalysis::clearHint() {
+  boardDriver->waitForAnimationQueueDrain();
+  BoardDriver::LedGuard guard(boardDriver);
+  boardDriver->clearAllLEDs();
+  hintShown = false;
+}
+
+// ---------------------------
+// Worker Task Side (core 0)
+// ---------------------------
+
+void ChessAnalysis::workerTask(void* param) {
+  static_cast<ChessAnalysis*>(param)->workerLoop();
+}
+
+void ChessAnalysis::workerLoop() {
+  SearchLine found[SEARCH_MAX_LINES];
+
+  while (true) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    if (shuttingDown)
+      break;
+
+    // Clear the stop flag before reading the position: a stop() issued after this
+    // point always belongs to a newer position and correctly aborts this one
+    search.resetStop();
+    xSemaphoreTake(stateMutex, portMAX_DELAY);
+    PendingPosition position = pending;
+    uint32_t searchGeneration = generation;
+    xSemaphoreGive(stateMutex);
+
+    search.setPosition(position.board, position.turn, position.castlingRights, position.epRow, position.epCol);
+    unsigned long startMillis = millis();
+    uint32_t totalNodes = 0;
+
+    bool stopped = false;
+    for (int depth = 1; depth <= ANALYSIS_MAX_DEPTH; depth++) {
+      int count = search.searchRoot(depth, ANALYSIS_MULTI_PV, found);
+      totalNodes += search.getNodes();
+      if (count < 0) {
+        stopped = true;
+        break; // Stopped: a newer position (or shutdown) is waiting
+      }
+
+      xSemaphoreTake(stateMutex, portMAX_DELAY);
+      bool current = (searchGeneration == generation);
+      if (current) {
+        memcpy(lines, found, sizeof(SearchLine) * count);
+        lineCount = count;
+        completedDepth = depth;
+        searchedNodes = totalNodes + helperNodes();
+        searchMillis = millis() - startMillis;
+        resultGeneration = searchGeneration;
+        resultVersion++;
+      }
+      xSemaphoreGive(stateMutex);
+
+      if (!current || count == 0)
+        break; // Outdated, or no legal move (mate/stalemate) so deeper iterations add nothing
+    }
+
+    if (!stopped) {
+      // Done with this position: rest the helpers unless a newer position has already restarted them
+      xSemaphoreTake(stateMutex, portMAX_DELAY);
+      if (searchGeneration == generation) {
+        finishedGeneration = searchGeneration;
+        for (int i = 0; i < helperCount; i++)
+          helpers[i].search.stop();
+      }
+      xSemaphoreGive(stateMutex);
+    }
+  }
+
+  xSemaphoreGive(workerExitSemaphore);
+  vTaskDelete(nullptr);
+}
+
+void ChessAnalysis::stopSearches() {
+  search.stop();
+  for (int i = 0; i < helperCount; i++)
+    helpers[i].search.stop();
+}
+
+uint32_t ChessAnalysis::helperNodes() {
+  uint32_t total = 0;
+  for (int i = 0; i < helperCount; i++)
+    total += helpers[i].nodes.load();
+  return total;
+}
+
+// ---------------------------
+// Lazy SMP Helper Tasks (core 1)
+// ---------------------------
+
+void ChessAnalysis::helperTask(void* param) {
+  Helper* helper = static_cast<Helper*>(param);
+  helper->owner->helperLoop(*helper);
+}
+
+void ChessAnalysis::helperLoop(Helper& helper) {
+  SearchLine found[1];
+
+  while (true) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    if (shuttingDown)
+      break;
+
+    // Same ordering as the worker: a stop() after resetStop() belongs to a newer position
+    helper.search.resetStop();
+    xSemaphoreTake(stateMutex, portMAX_DELAY);
+    PendingPosition position = pending;
+    bool finished = (finishedGeneration == generation);
+    xSemaphoreGive(stateMutex);
+    if (finished)
+      continue;
+
+    helper.nodes.store(0);
+    helper.search.setPosition(position.board, position.turn, position.castlingRights, position.epRow, position.epCol);
+    // Staggered one ply deeper than the worker, so the entries it leaves are deep enough to cut the worker's next iteration
+    for (int depth = 2; depth <= ANALYSIS_MAX_DEPTH + 1; depth++) {
+      int count = helper.search.searchRoot(depth, 1, found);
+      helper.nodes.fetch_add(helper.search.getNodes());
+      if (count <= 0)
+        break; // Stopped, or nothing to search
+    }
+  }
+
+  xSemaphoreGive(workerExitSemaphore);
+  vTaskDelete(nullptr);
+}
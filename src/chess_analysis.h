@@ -0,0 +1,100 @@
+#ifndef CHESS_ANALYSIS_H
+#define CHESS_ANALYSIS_H
+
+#include "chess_moves.h"
+#include "chess_search.h"
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+// ---------------------------
+// Analysis Configuration
+// ---------------------------
+static constexpr int ANALYSIS_MULTI_PV = 3;    // Lines reported to the web UI
+static constexpr int ANALYSIS_MAX_DEPTH = 12;  // Iterative deepening stops here until the position changes
+static constexpr int ANALYSIS_TASK_STACK = 16384;
+static constexpr int ANALYSIS_TASK_CORE = 0;   // Loop task and AnimWorker live on core 1
+static constexpr UBaseType_t ANALYSIS_TASK_PRIORITY = 1;
+static constexpr int ANALYSIS_HELPERS = 1;     // Lazy SMP helper tasks, 0 for a single-core search
+static constexpr int ANALYSIS_HELPER_CORE = 1; // The core the main search leaves free
+static constexpr UBaseType_t ANALYSIS_HELPER_PRIORITY = 0; // Below the loop task, which preempts it the moment it wakes
+
+// ---------------------------
+// Analysis Game Mode Class
+// ---------------------------
+/// Over-the-board play (same rules as ChessMoves, nothing recorded to flash)
+/// with a local multi-PV search running continuously on core 0. Every board
+/// change, physical or from the web editor, bumps a generation counter and
+/// restarts the search; the transposition table is kept so the new search
+/// starts warm. Finished iterations are published to the web UI and the best
+/// move can be lit on the board on request.
+///
+/// Lazy SMP: helper tasks on the other core search the same position one ply
+/// deeper through the shared transposition table. Their results are never
+/// reported; the main search simply finds more of its tree already scored.
+class ChessAnalysis : public ChessMoves {
+ private:
+  ChessSearch search;
+  TaskHandle_t workerHandle;
+  SemaphoreHandle_t stateMutex;      // Guards the pending position and published results
+  SemaphoreHandle_t workerExitSemaphore; // Given once by the worker and once by each helper on exit
+  volatile bool shuttingDown;
+
+  struct Helper {
+    ChessAnalysis* owner;
+    ChessSearch search;              // Shares the main search's table
+    TaskHandle_t handle;
+    std::atomic<uint32_t> nodes;     // Nodes searched for the current generation
+  };
+  Helper helpers[ANALYSIS_HELPERS > 0 ? ANALYSIS_HELPERS : 1];
+  int helperCount;
+
+  // Position handoff (loop task -> worker), guarded by stateMutex
+  struct PendingPosition {
+    char board[8][8];
+    char turn;
+    uint8_t castlingRights;
+    int epRow;
+    int epCol;
+  } pending;
+  uint32_t generation;
+  uint32_t finishedGeneration;       // Main search is done with this generation, helpers can rest
+
+  // Published results (worker -> loop task), guarded by stateMutex
+  SearchLine lines[SEARCH_MAX_LINES];
+  int lineCount;
+  int completedDepth;
+  uint32_t searchedNodes;
+  unsigned long searchMillis;
+  uint32_t resultGeneration;
+  uint32_t resultVersion;
+
+  // Loop task state
+  uint64_t lastPositionHash;
+  uint32_t lastPublishedVersion;
+  bool hintShown;
+
+  static void workerTask(void* param);
+  void workerLoop();
+  static void helperTask(void* param);
+  void helperLoop(Helper& helper);
+  void stopSearches();
+  uint32_t helperNodes();
+
+  // Copy the current board into the handoff slot and restart the search if it changed
+  void postPositionIfChanged();
+  // Push the latest finished iteration to the web UI
+  void publishResults();
+  // Light the best move of the latest iteration (Cyan origin, White destination)
+  void showBestMove();
+  void clearHint();
+
+ public:
+  ChessAnalysis(BoardDriver* bd, ChessEngine* ce, WiFiManagerESP32* wm);
+  ~ChessAnalysis() override;
+  void begin() override;
+  void update() override;
+};
+
+#endif // CHESS_ANALYSIS_H
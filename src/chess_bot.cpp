@@ -1,19 +1,25 @@
 #include "chess_bot.h"
 #include "chess_utils.h"
+#include "heap_report.h"
+#include "logger.h"
 #include "led_colors.h"
 #include "move_history.h"
 #include "stockfish_api.h"
+#include "stockfish_cache.h"
 #include "wifi_manager_esp32.h"
 #include <Arduino.h>
 
-ChessBot::ChessBot(BoardDriver* bd, ChessEngine* ce, WiFiManagerESP32* wm, MoveHistory* mh, BotConfig cfg) : ChessGame(bd, ce, wm, mh), botConfig(cfg), currentEvaluation(0.0) {}
+ChessBot::ChessBot(BoardDriver* bd, ChessEngine* ce, WiFiManagerESP32* wm, MoveHistory* mh, BotConfig cfg) : ChessGame(bd, ce, wm, mh), botConfig(cfg), lanEngine(cfg.lanEngine), currentEvaluation(0.0), network(nullptr), cache(nullptr) {}
 
 void ChessBot::begin() {
   Serial.println("=== Starting Chess Bot Mode ===");
   Serial.printf("Player plays: %s\n", botConfig.playerIsWhite ? "White" : "Black");
   Serial.printf("Bot plays: %s\n", botConfig.playerIsWhite ? "Black" : "White");
   Serial.printf("Bot Difficulty: Depth %d, Timeout %dms\n", botConfig.stockfishSettings.depth, botConfig.stockfishSettings.timeoutMs);
+  if (botConfig.useLanEngine)
+    Serial.printf("Bot Engine: %s:%u, %ums per move\n", botConfig.lanEngine.host.c_str(), botConfig.lanEngine.port, botConfig.lanEngine.movetimeMs);
   Serial.println("====================================");
+  wifiManager->waitForNetworkStart(); // A game resumed at boot can get here before WiFi is up
   if (wifiManager->isWiFiConnected()) {
     initializeBoard();
     if (moveHistory->hasLiveGame()) {
@@ -21,12 +27,15 @@ void ChessBot::begin() {
       replaying = true;
       moveHistory->replayIntoGame(this);
       replaying = false;
+      restoreClock();
       wifiManager->updateBoardState(ChessUtils::boardToFEN(board, currentTurn, chessEngine), ChessUtils::evaluatePosition(board));
     } else {
       moveHistory->startGame(GAME_MODE_BOT, botConfig.playerIsWhite ? 'w' : 'b', (uint8_t)botConfig.stockfishSettings.depth);
+      saveClock();
       moveHistory->addFen(ChessUtils::boardToFEN(board, currentTurn, chessEngine));
     }
     waitForBoardSetup(board);
+    startClock();
   } else {
     Serial.println("Failed to connect to WiFi. Bot mode unavailable.");
     boardDriver->flashBoardAnimation(LedColors::Red);
@@ -42,6 +51,7 @@ void ChessBot::update() {
   boardDriver->readSensors();
 
   if (processResign()) return;
+  if (checkClock()) return;
 
   if ((botConfig.playerIsWhite && currentTurn == 'w') || (!botConfig.playerIsWhite && currentTurn == 'b')) {
     // Player's turn
@@ -62,16 +72,26 @@ void ChessBot::update() {
   boardDriver->updateSensorPrev();
 }
 
+void ChessBot::runNetwork(const std::function<void()>& work) {
+  if (network)
+    network->run(work);
+  else
+    work();
+}
+
+// Runs on the network actor: no LEDs, sensors or CooperativeWait here
 String ChessBot::makeStockfishRequest(const String& fen) {
   WiFiSSLClient client;
   client.setInsecure();
   String path = StockfishAPI::buildRequestURL(fen, botConfig.stockfishSettings.depth);
-  Serial.println("Stockfish request: " STOCKFISH_API_URL + path);
+  LOG_INFO("Stockfish request: " STOCKFISH_API_URL "%s", path.c_str());
   // Retry logic
   for (int attempt = 1; attempt <= botConfig.stockfishSettings.maxRetries; attempt++) {
     if (attempt > 1)
-      Serial.println("Attempt: " + String(attempt) + "/" + String(botConfig.stockfishSettings.maxRetries));
-    if (client.connect(STOCKFISH_API_URL, STOCKFISH_API_PORT)) {
+      LOG_INFO("Attempt: %d/%d", attempt, botConfig.stockfishSettings.maxRetries);
+    bool connected = client.connect(STOCKFISH_API_URL, STOCKFISH_API_PORT);
+    HeapReport::noteTlsConnect(connected);
+    if (connected) {
       client.println("GET " + path + " HTTP/1.1");
       client.println("Host: " STOCKFISH_API_URL);
       client.println("Connection: close");
@@ -94,66 +114,133 @@ String ChessBot::makeStockfishRequest(const String& fen) {
         return response;
     }
 
-    Serial.println("API request timeout or empty response");
+    LOG_WARN("API request timeout or empty response");
     if (attempt < botConfig.stockfishSettings.maxRetries) {
-      Serial.println("Retrying...");
+      LOG_INFO("Retrying...");
       delay(500);
     }
   }
 
-  Serial.println("All API request attempts failed");
+  LOG_ERROR("All API request attempts failed");
   return "";
 }
 
-bool ChessBot::parseStockfishResponse(const String& response, String& bestMove, float& evaluation) {
-  StockfishResponse stockfishResp;
+// Mate is shown as a large evaluation (positive or negative based on direction)
+static float evaluationOf(const StockfishResponse& stockfishResp) {
+  if (stockfishResp.hasMate)
+    return stockfishResp.mateInMoves > 0 ? 100.0f : -100.0f;
+  return stockfishResp.evaluation; // Already in pawns, White's point of view
+}
+
+void ChessBot::readStockfishResponse(const StockfishResponse& stockfishResp, String& bestMove, float& evaluation) {
+  bestMove = stockfishResp.bestMove;
+  if (stockfishResp.hasMate)
+    LOG_INFO("Mate in %d moves", stockfishResp.mateInMoves);
+  evaluation = evaluationOf(stockfishResp);
+}
+
+bool ChessBot::askStockfishOnline(StockfishResponse& stockfishResp) {
+  // Positions the API answered before (the opening, above all) skip the round trip
+  uint64_t hash = chessEngine->computeZobristHash(board, currentTurn);
+  uint8_t depth = (uint8_t)StockfishAPI::effectiveDepth(botConfig.stockfishSettings.depth);
+  if (cache && cache->lookup(hash, depth, stockfishResp)) {
+    LOG_INFO("Stockfish answer from cache");
+    return true;
+  }
+  boardDriver->waitForAnimationQueueDrain();
+  std::atomic<bool>* stopAnimation = boardDriver->startThinkingAnimation();
+  String fen = ChessUtils::boardToFEN(board, currentTurn, chessEngine);
+  String response;
+  runNetwork([&]() { response = makeStockfishRequest(fen); });
+  boardDriver->stopAndWaitForAnimation(stopAnimation);
   if (!StockfishAPI::parseResponse(response, stockfishResp)) {
-    Serial.printf("Failed to parse Stockfish response: %s\n", stockfishResp.errorMessage.c_str());
+    LOG_ERROR("Failed to parse Stockfish response: %s", stockfishResp.errorMessage.c_str());
     return false;
   }
-  bestMove = stockfishResp.bestMove;
-  if (stockfishResp.hasMate) {
-    Serial.printf("Mate in %d moves\n", stockfishResp.mateInMoves);
-    // Convert mate to a large evaluation (positive or negative based on direction)
-    evaluation = stockfishResp.mateInMoves > 0 ? 100.0f : -100.0f;
-  } else {
-    // Regular evaluation (already in pawns from API)
-    evaluation = stockfishResp.evaluation;
-  }
+  if (cache)
+    cache->store(hash, depth, stockfishResp);
   return true;
 }
 
-void ChessBot::makeBotMove() {
-  Serial.println("=== BOT MOVE CALCULATION ===");
+// The search runs on the engine server: the game loop only polls the socket
+// (through the network actor), so it can publish each new evaluation and send
+// `stop` when a web resign is relayed to it. A stopped search still returns a
+// move, which is played before the resign is confirmed, as with the HTTPS API.
+bool ChessBot::askLanEngine(StockfishResponse& stockfishResp) {
+  String fen = ChessUtils::boardToFEN(board, currentTurn, chessEngine);
   boardDriver->waitForAnimationQueueDrain();
   std::atomic<bool>* stopAnimation = boardDriver->startThinkingAnimation();
-  String bestMove;
-  String response = makeStockfishRequest(ChessUtils::boardToFEN(board, currentTurn, chessEngine));
+  bool started = false;
+  runNetwork([&]() { started = lanEngine.startSearch(fen, botConfig.stockfishSettings.depth); });
+
+  UciSearchState state = started ? UciSearchState::SEARCHING : UciSearchState::FAILED;
+  unsigned long startMs = millis();
+  unsigned long stopMs = 0;
+  unsigned long publishedMs = 0;
+  while (state == UciSearchState::SEARCHING) {
+    boardDriver->cooperativeWait().sleep(UCI_POLL_MS);
+    bool evalChanged = false;
+    runNetwork([&]() { state = lanEngine.poll(stockfishResp, evalChanged); });
+    if (evalChanged && millis() - publishedMs >= UCI_EVAL_PUBLISH_MS) {
+      currentEvaluation = evaluationOf(stockfishResp);
+      wifiManager->updateBoardState(fen, currentEvaluation);
+      publishedMs = millis();
+    }
+    if (state != UciSearchState::SEARCHING)
+      break;
+    if (stopMs == 0 && (resignPending || millis() - startMs > botConfig.lanEngine.movetimeMs + UCI_SEARCH_GRACE_MS)) {
+      LOG_INFO("Stopping the LAN engine (%s)", resignPending ? "resign pending" : "over its move time");
+      runNetwork([&]() { lanEngine.stop(); });
+      stopMs = millis();
+    } else if (stopMs != 0 && millis() - stopMs > UCI_STOP_GRACE_MS) {
+      LOG_ERROR("LAN engine did not answer stop");
+      runNetwork([&]() { lanEngine.disconnect(); });
+      state = UciSearchState::FAILED;
+    }
+  }
   boardDriver->stopAndWaitForAnimation(stopAnimation);
-  if (parseStockfishResponse(response, bestMove, currentEvaluation)) {
-    Serial.println("=== STOCKFISH EVALUATION ===");
-    Serial.printf("%s advantage: %.2f pawns\n", currentEvaluation > 0 ? "White" : "Black", currentEvaluation);
+  return state == UciSearchState::DONE;
+}
+
+void ChessBot::makeBotMove() {
+  LOG_INFO("=== BOT MOVE CALCULATION ===");
+  String bestMove;
+  StockfishResponse stockfishResp = {};
+  bool answered = false;
+  if (botConfig.useLanEngine) {
+    answered = askLanEngine(stockfishResp);
+    if (!answered) {
+      LOG_WARN("LAN engine unavailable, asking stockfish.online");
+      stockfishResp = {};
+    }
+  }
+  if (!answered)
+    answered = askStockfishOnline(stockfishResp);
+  if (answered) {
+    readStockfishResponse(stockfishResp, bestMove, currentEvaluation);
+    LOG_INFO("=== STOCKFISH EVALUATION ===");
+    LOG_INFO("%s advantage: %.2f pawns", currentEvaluation > 0 ? "White" : "Black", currentEvaluation);
 
     int fromRow, fromCol, toRow, toCol;
     char promotion;
     if (ChessUtils::parseUCIMove(bestMove, fromRow, fromCol, toRow, toCol, promotion)) {
-      Serial.printf("Stockfish UCI move: %s = (%d,%d) -> (%d,%d)%s%c\n", bestMove.c_str(), fromRow, fromCol, toRow, toCol, promotion == ' ' ? "" : " Promotion to: ", promotion);
-      Serial.println("============================");
+      LOG_INFO("Stockfish UCI move: %s = (%d,%d) -> (%d,%d)%s%c", bestMove.c_str(), fromRow, fromCol, toRow, toCol, promotion == ' ' ? "" : " Promotion to: ", promotion);
+      LOG_INFO("============================");
       // Verify the move is from the correct color piece
       char piece = board[fromRow][fromCol];
       bool botPlaysWhite = !botConfig.playerIsWhite;
       bool isBotPiece = (botPlaysWhite && piece >= 'A' && piece <= 'Z') || (!botPlaysWhite && piece >= 'a' && piece <= 'z');
       if (!isBotPiece) {
-        Serial.printf("ERROR: Bot tried to move a %s piece, but bot plays %s. Piece at source: %c\n", (piece >= 'A' && piece <= 'Z') ? "WHITE" : "BLACK", botPlaysWhite ? "WHITE" : "BLACK", piece);
+        LOG_ERROR("ERROR: Bot tried to move a %s piece, but bot plays %s. Piece at source: %c", (piece >= 'A' && piece <= 'Z') ? "WHITE" : "BLACK", botPlaysWhite ? "WHITE" : "BLACK", piece);
         return;
       }
       if (piece == ' ') {
-        Serial.println("ERROR: Bot tried to move from an empty square!");
+        LOG_ERROR("ERROR: Bot tried to move from an empty square!");
         return;
       }
       applyMove(fromRow, fromCol, toRow, toCol, (bestMove.length() >= 5) ? bestMove[4] : ' ', true);
     } else {
-      Serial.println("Failed to parse Stockfish UCI move: " + bestMove);
+      LOG_ERROR("Failed to parse Stockfish UCI move: %s", bestMove.c_str());
     }
   }
 }
@@ -176,7 +263,7 @@ void ChessBot::waitForRemoteMoveCompletion(int fromRow, int fromCol, int toRow,
   bool capturedPieceRemoved = false;
   bool moveCompleted = false;
 
-  Serial.println("Waiting for you to complete the remote move...");
+  LOG_INFO("Waiting for you to complete the remote move...");
 
   while (!moveCompleted) {
     boardDriver->readSensors();
@@ -188,16 +275,16 @@ void ChessBot::waitForRemoteMoveCompletion(int fromRow, int fromCol, int toRow,
       if (!boardDriver->getSensorState(captureCheckRow, toCol)) {
         capturedPieceRemoved = true;
         if (isEnPassant)
-          Serial.println("En passant captured pawn removed, now complete the move...");
+          LOG_INFO("En passant captured pawn removed, now complete the move...");
         else
-          Serial.println("Captured piece removed, now complete the move...");
+          LOG_INFO("Captured piece removed, now complete the move...");
       }
     }
 
     // Check if piece was picked up from source
     if (!piecePickedUp && !boardDriver->getSensorState(fromRow, fromCol)) {
       piecePickedUp = true;
-      Serial.println("Piece picked up, now place it on the destination...");
+      LOG_INFO("Piece picked up, now place it on the destination...");
     }
 
     // Check if piece was placed on destination
@@ -206,10 +293,10 @@ void ChessBot::waitForRemoteMoveCompletion(int fromRow, int fromCol, int toRow,
     if (piecePickedUp && boardDriver->getSensorState(toRow, toCol))
       if (!isCapture || (isCapture && capturedPieceRemoved)) {
         moveCompleted = true;
-        Serial.println("Move completed on physical board!");
+        LOG_INFO("Move completed on physical board!");
       }
 
-    delay(SENSOR_READ_DELAY_MS);
+    boardDriver->cooperativeWait().sleep(SENSOR_READ_DELAY_MS);
     boardDriver->updateSensorPrev();
   }
 
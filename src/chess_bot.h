@@ -3,27 +3,41 @@
 
 #include "chess_game.h"
 #include "chess_utils.h"
+#include "network_actor.h"
 #include "stockfish_api.h"
 #include "stockfish_settings.h"
+#include "uci_engine.h"
 
 // ESP32 WiFi includes
 #include <WiFi.h>
 #include <WiFiClientSecure.h>
 #define WiFiSSLClient WiFiClientSecure
 
+class StockfishCache;
+
 class ChessBot : public ChessGame {
  private:
   BotConfig botConfig;
+  UciEngine lanEngine; // Used when botConfig.useLanEngine is set
 
   // WiFi and API (Stockfish-specific)
   String makeStockfishRequest(const String& fen);
-  bool parseStockfishResponse(const String& response, String& bestMove, float& evaluation);
+  void readStockfishResponse(const StockfishResponse& response, String& bestMove, float& evaluation);
+  /// Cached answer, or a request to stockfish.online.
+  bool askStockfishOnline(StockfishResponse& response);
+  /// Search on the LAN engine, publishing its evaluation as it goes and stopping it if a resign comes in.
+  bool askLanEngine(StockfishResponse& response);
 
   // Game flow (Stockfish-specific)
   void makeBotMove();
 
  protected:
   float currentEvaluation; // Evaluation (in pawns, positive = White advantage)
+  NetworkActor* network;   // nullptr runs network calls on the game loop
+  StockfishCache* cache;   // nullptr asks the API every time
+
+  /// Run a blocking HTTPS call through the network actor (or inline without one).
+  void runNetwork(const std::function<void()>& work);
 
   // Remote move hooks (LED indicator + physical move wait)
   void waitForRemoteMoveCompletion(int fromRow, int fromCol, int toRow, int toCol, bool isCapture, bool isEnPassant = false, int enPassantCapturedPawnRow = -1) override;
@@ -32,6 +46,8 @@ class ChessBot : public ChessGame {
   ChessBot(BoardDriver* bd, ChessEngine* ce, WiFiManagerESP32* wm, MoveHistory* mh, BotConfig cfg);
   void begin() override;
   void update() override;
+  void setNetworkActor(NetworkActor* na) { network = na; }
+  void setStockfishCache(StockfishCache* sc) { cache = sc; }
 
   // Get current evaluation
   float getEvaluation() const { return currentEvaluation; }
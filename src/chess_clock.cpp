@@ -0,0 +1,181 @@
+#include "chess_clock.h"
+#include "move_history.h"
+#include <string.h>
+
+ChessClock::ChessClock()
+    : control{ClockMode::NONE, 0, 0},
+      remainingUs{0, 0},
+      turnStartUs(0),
+      running(' '),
+      flagged(' '),
+      flagTimer(nullptr) {
+  resetLatency();
+}
+
+ChessClock::~ChessClock() {
+  end();
+  if (flagTimer)
+    esp_timer_delete(flagTimer);
+}
+
+void ChessClock::begin(const TimeControl& tc) {
+  end();
+  control = tc;
+  control.baseMs = min(control.baseMs, CLOCK_MAX_BASE_MS);
+  control.incrementMs = min(control.incrementMs, CLOCK_MAX_INCREMENT_MS);
+  if (control.baseMs == 0)
+    control.mode = ClockMode::NONE;
+  remainingUs[0] = remainingUs[1] = (int64_t)control.baseMs * 1000;
+  resetLatency();
+
+  if (!flagTimer) {
+    esp_timer_create_args_t args = {};
+    args.callback = &ChessClock::onFlagTimer;
+    args.arg = this;
+    args.dispatch_method = ESP_TIMER_TASK;
+    args.name = "clockFlag";
+    if (esp_timer_create(&args, &flagTimer) != ESP_OK) {
+      Serial.println("ChessClock: failed to create flag timer, flags are only checked on moves");
+      flagTimer = nullptr;
+    }
+  }
+  if (isEnabled())
+    Serial.printf("ChessClock: %u min + %u s (%s)\n", control.baseMs / 60000, control.incrementMs / 1000, control.mode == ClockMode::BRONSTEIN ? "Bronstein delay" : "Fischer increment");
+}
+
+void ChessClock::restore(const ClockRecord& record) {
+  TimeControl tc = {(ClockMode)record.mode, (uint32_t)record.baseSeconds * 1000, record.incrementMs};
+  begin(tc);
+  if (!isEnabled())
+    return;
+  remainingUs[0] = (int64_t)record.remainingMs[0] * 1000;
+  remainingUs[1] = (int64_t)record.remainingMs[1] * 1000;
+  Serial.printf("ChessClock: restored White %u ms, Black %u ms\n", record.remainingMs[0], record.remainingMs[1]);
+}
+
+void ChessClock::end() {
+  if (flagTimer)
+    esp_timer_stop(flagTimer);
+  portENTER_CRITICAL(&lock);
+  control.mode = ClockMode::NONE;
+  running = ' ';
+  portEXIT_CRITICAL(&lock);
+  flagged.store(' ');
+}
+
+void ChessClock::start(char side) {
+  if (!isEnabled())
+    return;
+  int64_t now = esp_timer_get_time();
+  portENTER_CRITICAL(&lock);
+  running = side;
+  turnStartUs = now;
+  int64_t left = remainingUs[sideIndex(side)];
+  portEXIT_CRITICAL(&lock);
+  flagged.store(left > 0 ? ' ' : side);
+  armFlagTimer(left);
+}
+
+void ChessClock::stop() {
+  if (flagTimer)
+    esp_timer_stop(flagTimer);
+  int64_t now = esp_timer_get_time();
+  portENTER_CRITICAL(&lock);
+  if (running != ' ') {
+    int i = sideIndex(running);
+    remainingUs[i] = max((int64_t)0, remainingUs[i] - (now - turnStartUs));
+    running = ' ';
+  }
+  portEXIT_CRITICAL(&lock);
+}
+
+bool ChessClock::press(char side, int64_t eventUs) {
+  if (!isEnabled() || running != side)
+    return true;
+  if (flagTimer)
+    esp_timer_stop(flagTimer);
+
+  int64_t now = esp_timer_get_time();
+  // Clamp edges that predate this turn (e.g. a piece settled during setup) or have no timestamp
+  if (eventUs <= 0 || eventUs > now)
+    eventUs = now;
+  eventUs = max(eventUs, turnStartUs);
+
+  int i = sideIndex(side);
+  char next = (side == 'w') ? 'b' : 'w';
+  int64_t nextLeft = 0;
+  portENTER_CRITICAL(&lock);
+  int64_t used = eventUs - turnStartUs;
+  int64_t left = remainingUs[i] - used;
+  bool inTime = left > 0;
+  if (inTime) {
+    int64_t bonus = (int64_t)control.incrementMs * 1000;
+    if (control.mode == ClockMode::BRONSTEIN)
+      bonus = min(bonus, used);
+    remainingUs[i] = left + bonus;
+    // The opponent's clock starts at the instant the move was completed
+    running = next;
+    turnStartUs = eventUs;
+    nextLeft = remainingUs[sideIndex(next)] - (now - eventUs);
+  } else {
+    remainingUs[i] = 0;
+    running = ' ';
+  }
+  portEXIT_CRITICAL(&lock);
+
+  // The move may have landed before a flag that fired while the loop was catching up
+  flagged.store(inTime ? ' ' : side);
+  if (inTime)
+    armFlagTimer(nextLeft);
+
+  uint32_t latency = (uint32_t)(now - eventUs);
+  lastLatencyUs = latency;
+  maxLatencyUs = max(maxLatencyUs, latency);
+  totalLatencyUs += latency;
+  pressCount++;
+  if (latency > CLOCK_LATENCY_WARN_US)
+    Serial.printf("ChessClock: move-to-clock-stop latency %u us exceeds %u us (not charged to the player)\n", latency, CLOCK_LATENCY_WARN_US);
+  return inTime;
+}
+
+uint32_t ChessClock::getRemainingMs(char side) const {
+  int64_t now = esp_timer_get_time();
+  portENTER_CRITICAL(&lock);
+  int64_t left = remainingUs[sideIndex(side)];
+  if (running == side)
+    left -= now - turnStartUs;
+  portEXIT_CRITICAL(&lock);
+  return left > 0 ? (uint32_t)(left / 1000) : 0;
+}
+
+void ChessClock::toRecord(ClockRecord& record) const {
+  memset(&record, 0, sizeof(record));
+  record.mode = (uint8_t)control.mode;
+  record.baseSeconds = (uint16_t)(control.baseMs / 1000);
+  record.incrementMs = control.incrementMs;
+  record.remainingMs[0] = getRemainingMs('w');
+  record.remainingMs[1] = getRemainingMs('b');
+}
+
+void ChessClock::onFlagTimer(void* arg) {
+  // Runs in the esp_timer task: only publish the flag, the game loop ends the game
+  ChessClock* clock = static_cast<ChessClock*>(arg);
+  char side = clock->running;
+  if (side != ' ' && clock->getRemainingMs(side) == 0)
+    clock->flagged.store(side);
+}
+
+void ChessClock::armFlagTimer(int64_t remaining) {
+  if (!flagTimer)
+    return;
+  esp_timer_stop(flagTimer);
+  // +1 ms so the callback never sees a sliver of time left from rounding
+  esp_timer_start_once(flagTimer, (uint64_t)max((int64_t)0, remaining) + 1000);
+}
+
+void ChessClock::resetLatency() {
+  lastLatencyUs = 0;
+  maxLatencyUs = 0;
+  totalLatencyUs = 0;
+  pressCount = 0;
+}
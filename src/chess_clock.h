@@ -0,0 +1,104 @@
+#ifndef CHESS_CLOCK_H
+#define CHESS_CLOCK_H
+
+#include "board_driver.h"
+#include <Arduino.h>
+#include <atomic>
+#include <esp_timer.h>
+
+struct ClockRecord;
+
+// ---------------------------
+// Clock Configuration
+// ---------------------------
+static constexpr uint32_t CLOCK_MAX_BASE_MS = 180UL * 60 * 1000;  // 3 hours per side
+static constexpr uint32_t CLOCK_MAX_INCREMENT_MS = 60UL * 1000;   // Increment or delay per move
+static constexpr uint32_t CLOCK_LOW_TIME_MS = 10000;               // Warn the side to move below this
+static constexpr uint32_t CLOCK_LATENCY_WARN_US = (DEBOUNCE_MS + 2 * SENSOR_READ_DELAY_MS) * 1000UL;
+
+enum class ClockMode : uint8_t {
+  NONE = 0,     // Untimed game
+  FISCHER = 1,  // Increment added after every move
+  BRONSTEIN = 2 // Time used is given back after every move, up to the delay
+};
+
+struct TimeControl {
+  ClockMode mode;
+  uint32_t baseMs;      // Starting time per side
+  uint32_t incrementMs; // Fischer increment or Bronstein delay
+};
+
+// ---------------------------
+// Chess Clock
+// ---------------------------
+/// Two-sided game clock on the microsecond esp_timer time base. Moves are
+/// charged up to the sensor edge that completed them (BoardDriver's
+/// getLastChangeMicros()), not to when the game loop got around to noticing,
+/// so the 40 ms loop cadence and the debounce window never cost the player
+/// time. The gap between the two is recorded as the move-to-clock-stop
+/// latency. A one-shot esp_timer armed for the running side's remaining time
+/// raises the flag even while the game loop is blocked waiting on the board.
+///
+/// press() and the game-flow calls belong to the game loop; the getters may
+/// be called from any task (the web server reads the clock for /clock).
+class ChessClock {
+ public:
+  ChessClock();
+  ~ChessClock();
+
+  /// Reset both sides to the control's base time, stopped. ClockMode::NONE disables the clock.
+  void begin(const TimeControl& control);
+  /// Restore a clock saved in live.bin. The clock stays stopped until start().
+  void restore(const ClockRecord& record);
+  /// Disable the clock and cancel the flag timer.
+  void end();
+
+  bool isEnabled() const { return control.mode != ClockMode::NONE; }
+  bool isRunning() const { return running != ' '; }
+  const TimeControl& getTimeControl() const { return control; }
+
+  /// Start counting down for `side` ('w' or 'b').
+  void start(char side);
+  /// Stop both clocks, keeping the remaining time.
+  void stop();
+  /// `side` completed a move at eventUs (esp_timer time): charge the time used,
+  /// apply the increment or delay, and start the opponent's clock.
+  /// Returns false if `side` had already run out of time at eventUs.
+  bool press(char side, int64_t eventUs);
+
+  /// Side whose time ran out, or ' ' if none.
+  char getFlaggedSide() const { return flagged.load(); }
+  /// Side whose clock is running, or ' ' if stopped.
+  char getRunningSide() const { return running; }
+  /// Remaining time for `side` right now, in milliseconds (0 once flagged).
+  uint32_t getRemainingMs(char side) const;
+
+  /// Fill the live.bin clock block with the current state.
+  void toRecord(ClockRecord& record) const;
+
+  // Move-to-clock-stop latency (sensor edge to press()), in microseconds
+  uint32_t getLastLatencyUs() const { return lastLatencyUs; }
+  uint32_t getMaxLatencyUs() const { return maxLatencyUs; }
+  uint32_t getAverageLatencyUs() const { return pressCount > 0 ? (uint32_t)(totalLatencyUs / pressCount) : 0; }
+
+ private:
+  TimeControl control;
+  int64_t remainingUs[2]; // Indexed by sideIndex(): time left when the side's clock last stopped
+  int64_t turnStartUs;    // When the running side's clock started
+  volatile char running;  // 'w', 'b' or ' '
+  std::atomic<char> flagged;
+  esp_timer_handle_t flagTimer;
+  mutable portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+
+  uint32_t lastLatencyUs;
+  uint32_t maxLatencyUs;
+  uint64_t totalLatencyUs;
+  uint32_t pressCount;
+
+  static int sideIndex(char side) { return side == 'b' ? 1 : 0; }
+  static void onFlagTimer(void* arg);
+  void armFlagTimer(int64_t remaining);
+  void resetLatency();
+};
+
+#endif // CHESS_CLOCK_H
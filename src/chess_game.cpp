@@ -1,6 +1,10 @@
 #include "chess_game.h"
+#include "chess_clock.h"
 #include "chess_utils.h"
+#include "logger.h"
+#include "loop_stats.h"
 #include "move_history.h"
+#include "move_trace.h"
 #include "wifi_manager_esp32.h"
 #include <string.h>
 
@@ -21,7 +25,7 @@ const char ChessGame::INITIAL_BOARD[8][8] = {
     {'R', 'N', 'B', 'Q', 'K', 'B', 'N', 'R'}  // row 7 = rank 1 (White pieces, bottom row)
 };
 
-ChessGame::ChessGame(BoardDriver* bd, ChessEngine* ce, WiFiManagerESP32* wm, MoveHistory* mh) : boardDriver(bd), chessEngine(ce), wifiManager(wm), moveHistory(mh), currentTurn('w'), gameOver(false), replaying(false) {}
+ChessGame::ChessGame(BoardDriver* bd, ChessEngine* ce, WiFiManagerESP32* wm, MoveHistory* mh) : boardDriver(bd), chessEngine(ce), wifiManager(wm), moveHistory(mh), clock(nullptr), loopStats(nullptr), currentTurn('w'), gameOver(false), replaying(false), lowTimeWarned(false) {}
 
 void ChessGame::initializeBoard() {
   currentTurn = 'w';
@@ -29,11 +33,12 @@ void ChessGame::initializeBoard() {
   memcpy(board, INITIAL_BOARD, sizeof(INITIAL_BOARD));
   chessEngine->reset();
   chessEngine->recordPosition(board, currentTurn);
+  wifiManager->noteLastMove(-1, -1, -1, -1, ' ');
   wifiManager->updateBoardState(ChessUtils::boardToFEN(board, currentTurn, chessEngine), ChessUtils::evaluatePosition(board));
 }
 
-void ChessGame::waitForBoardSetup(const char targetBoard[8][8]) {
-  Serial.println("Set up the board in the required position...");
+void ChessGame::waitForBoardSetup(const char targetBoard[8][8], bool celebrate) {
+  LOG_INFO("Set up the board in the required position...");
 
   {
     BoardDriver::LedGuard guard(boardDriver);
@@ -80,12 +85,13 @@ void ChessGame::waitForBoardSetup(const char targetBoard[8][8]) {
       }
       boardDriver->showLEDs();
 
-      delay(SENSOR_READ_DELAY_MS);
+      boardDriver->cooperativeWait().sleep(SENSOR_READ_DELAY_MS);
     }
   } // LedGuard released
 
-  Serial.println("Board setup complete! Game starting...");
-  boardDriver->fireworkAnimation();
+  LOG_INFO("Board setup complete! Game starting...");
+  if (celebrate)
+    boardDriver->fireworkAnimation();
   boardDriver->readSensors();
   boardDriver->updateSensorPrev();
 }
@@ -113,7 +119,7 @@ void ChessGame::applyMove(int fromRow, int fromCol, int toRow, int toCol, char p
   board[toRow][toCol] = piece;
   board[fromRow][fromCol] = ' ';
 
-  Serial.printf("%s %s: %c %c%d -> %c%d\n", isRemoteMove ? "Remote" : "Player", isCastling ? "castling" : (isEnPassantCapture ? "en passant" : (capturedPiece != ' ' ? "capture" : "move")), piece, (char)('a' + fromCol), 8 - fromRow, (char)('a' + toCol), 8 - toRow);
+  LOG_INFO("%s %s: %c %c%d -> %c%d", isRemoteMove ? "Remote" : "Player", isCastling ? "castling" : (isEnPassantCapture ? "en passant" : (capturedPiece != ' ' ? "capture" : "move")), piece, (char)('a' + fromCol), 8 - fromRow, (char)('a' + toCol), 8 - toRow);
 
   if (isRemoteMove && !isCastling && !replaying)
     waitForRemoteMoveCompletion(fromRow, fromCol, toRow, toCol, capturedPiece != ' ', isEnPassantCapture, enPassantCapturedPawnRow);
@@ -132,12 +138,27 @@ void ChessGame::applyMove(int fromRow, int fromCol, int toRow, int toCol, char p
   if (chessEngine->isPawnPromotion(piece, toRow)) {
     promotion = promotion != ' ' && promotion != '\0' ? (ChessUtils::isWhitePiece(piece) ? toupper(promotion) : tolower(promotion)) : (ChessUtils::isWhitePiece(piece) ? 'Q' : 'q');
     board[toRow][toCol] = promotion;
-    Serial.printf("Pawn promoted to %c\n", promotion);
+    LOG_INFO("Pawn promoted to %c", promotion);
     if (!replaying) boardDriver->promotionAnimation(toCol);
   }
+  wifiManager->noteLastMove(fromRow, fromCol, toRow, toCol, chessEngine->isPawnPromotion(piece, toRow) ? promotion : ' ');
 
-  if (moveHistory && moveHistory->isRecording())
+  if (!replaying) {
+    MoveTrace::record(TraceStage::MOVE_APPLIED);
+    if (loopStats)
+      loopStats->moveStarted();
+  }
+
+  // Charge the mover up to when the piece landed, not when the loop noticed
+  if (clock && clock->isRunning() && !replaying) {
+    clock->press(ChessUtils::getPieceColor(piece), boardDriver->getLastChangeMicros());
+    lowTimeWarned = false;
+  }
+
+  if (moveHistory && moveHistory->isRecording()) {
+    saveClock();
     moveHistory->addMove(fromRow, fromCol, toRow, toCol, promotion);
+  }
 }
 
 bool ChessGame::tryPlayerMove(char playerColor, int& fromRow, int& fromCol, int& toRow, int& toCol) {
@@ -155,12 +176,12 @@ bool ChessGame::tryPlayerMove(char playerColor, int& fromRow, int& fromCol, int&
 
       // Check if it's the correct player's piece
       if (ChessUtils::getPieceColor(piece) != playerColor) {
-        Serial.printf("Wrong turn! It's %s's turn to move.\n", ChessUtils::colorName(playerColor));
+        LOG_INFO("Wrong turn! It's %s's turn to move.", ChessUtils::colorName(playerColor));
         showIllegalMoveFeedback(row, col);
         continue;
       }
 
-      Serial.printf("Piece pickup from %c%d\n", (char)('a' + col), 8 - row);
+      LOG_INFO("Piece pickup from %c%d", (char)('a' + col), 8 - row);
 
       // Generate possible moves
       int moveCount = 0;
@@ -209,7 +230,7 @@ bool ChessGame::tryPlayerMove(char playerColor, int& fromRow, int& fromCol, int&
         if (isKing && !resignTransitioned && (millis() - liftTimestamp >= RESIGN_HOLD_MS)) {
           resignTransitioned = true;
           resignFlagTimestamp = millis();
-          Serial.println("King held off square for 3s — resign gesture initiated");
+          LOG_INFO("King held off square for 3s — resign gesture initiated");
           showResignProgress(row, col, 0);
         }
 
@@ -251,7 +272,7 @@ bool ChessGame::tryPlayerMove(char playerColor, int& fromRow, int& fromCol, int&
                 return !boardDriver->getSensorState(r2, c2);
             };
             if ((board[r2][c2] != ' ' || isEnPassantCapture) && isCapturedPiecePickedUp()) {
-              Serial.printf("Capture initiated at %c%d\n", (char)('a' + c2), 8 - r2);
+              LOG_INFO("Capture initiated at %c%d", (char)('a' + c2), 8 - r2);
               // Store the target square and wait for the capturing piece to be placed there
               targetRow = r2;
               targetCol = c2;
@@ -268,12 +289,12 @@ bool ChessGame::tryPlayerMove(char playerColor, int& fromRow, int& fromCol, int&
                 boardDriver->readSensors();
                 // Allow cancellation by placing the piece back to its original position
                 if (boardDriver->getSensorState(row, col)) {
-                  Serial.println("Capture cancelled");
+                  LOG_INFO("Capture cancelled");
                   targetRow = row;
                   targetCol = col;
                   break;
                 }
-                delay(SENSOR_READ_DELAY_MS);
+                boardDriver->cooperativeWait().sleep(SENSOR_READ_DELAY_MS);
               }
               break;
             }
@@ -288,7 +309,7 @@ bool ChessGame::tryPlayerMove(char playerColor, int& fromRow, int& fromCol, int&
           }
         }
 
-        delay(SENSOR_READ_DELAY_MS);
+        boardDriver->cooperativeWait().sleep(SENSOR_READ_DELAY_MS);
       }
 
       // Clear highlights (single cleanup for all exit paths)
@@ -312,7 +333,7 @@ bool ChessGame::tryPlayerMove(char playerColor, int& fromRow, int& fromCol, int&
             continueResignGesture(row, col, ChessUtils::getPieceColor(piece));
           }
         } else {
-          Serial.println("Pickup cancelled");
+          LOG_INFO("Pickup cancelled");
         }
         return false;
       }
@@ -325,7 +346,7 @@ bool ChessGame::tryPlayerMove(char playerColor, int& fromRow, int& fromCol, int&
         }
 
       if (!legalMove) {
-        Serial.println("Illegal move, reverting");
+        LOG_INFO("Illegal move, reverting");
         return false;
       }
 
@@ -334,6 +355,7 @@ bool ChessGame::tryPlayerMove(char playerColor, int& fromRow, int& fromCol, int&
       toRow = targetRow;
       toCol = targetCol;
 
+      MoveTrace::record(TraceStage::MOVE_RESOLVED);
       return true;
     }
 
@@ -349,9 +371,13 @@ void ChessGame::advanceTurn() {
 void ChessGame::updateGameStatus() {
   advanceTurn();
 
+  // A flag that fell before the move was completed takes precedence over the move's result
+  if (checkClock())
+    return;
+
   if (chessEngine->isCheckmate(board, currentTurn)) {
     char winnerColor = (currentTurn == 'w') ? 'b' : 'w';
-    Serial.printf("CHECKMATE! %s wins!\n", ChessUtils::colorName(winnerColor));
+    LOG_INFO("CHECKMATE! %s wins!", ChessUtils::colorName(winnerColor));
     boardDriver->fireworkAnimation(ChessUtils::colorLed(winnerColor));
     gameOver = true;
     if (moveHistory) moveHistory->finishGame(RESULT_CHECKMATE, winnerColor);
@@ -359,7 +385,7 @@ void ChessGame::updateGameStatus() {
   }
 
   if (chessEngine->isStalemate(board, currentTurn)) {
-    Serial.println("STALEMATE! Game is a draw.");
+    LOG_INFO("STALEMATE! Game is a draw.");
     boardDriver->fireworkAnimation(LedColors::Cyan);
     gameOver = true;
     if (moveHistory) moveHistory->finishGame(RESULT_STALEMATE, 'd');
@@ -367,7 +393,7 @@ void ChessGame::updateGameStatus() {
   }
 
   if (chessEngine->isFiftyMoveRule()) {
-    Serial.println("DRAW by 50-move rule! No captures or pawn moves in the last 50 moves.");
+    LOG_INFO("DRAW by 50-move rule! No captures or pawn moves in the last 50 moves.");
     boardDriver->fireworkAnimation(LedColors::Cyan);
     gameOver = true;
     if (moveHistory) moveHistory->finishGame(RESULT_DRAW_50, 'd');
@@ -375,7 +401,7 @@ void ChessGame::updateGameStatus() {
   }
 
   if (chessEngine->isThreefoldRepetition()) {
-    Serial.println("DRAW by threefold repetition! Same position occurred 3 times.");
+    LOG_INFO("DRAW by threefold repetition! Same position occurred 3 times.");
     boardDriver->fireworkAnimation(LedColors::Cyan);
     gameOver = true;
     if (moveHistory) moveHistory->finishGame(RESULT_DRAW_3FOLD, 'd');
@@ -383,7 +409,7 @@ void ChessGame::updateGameStatus() {
   }
 
   if (chessEngine->isKingInCheck(board, currentTurn)) {
-    Serial.printf("%s is in CHECK!\n", ChessUtils::colorName(currentTurn));
+    LOG_INFO("%s is in CHECK!", ChessUtils::colorName(currentTurn));
 
     int kingRow = -1;
     int kingCol = -1;
@@ -391,7 +417,68 @@ void ChessGame::updateGameStatus() {
       boardDriver->blinkSquare(kingRow, kingCol, LedColors::Yellow, 3, true, true);
   }
 
-  Serial.printf("It's %s's turn !\n", ChessUtils::colorName(currentTurn));
+  LOG_INFO("It's %s's turn !", ChessUtils::colorName(currentTurn));
+}
+
+// ---------------------------
+// Clock
+// ---------------------------
+
+void ChessGame::restoreClock() {
+  if (!clock)
+    return;
+  ClockRecord record;
+  if (moveHistory && moveHistory->getLiveClock(record))
+    clock->restore(record);
+  else
+    clock->end();
+}
+
+void ChessGame::saveClock() {
+  if (!clock || !clock->isEnabled() || !moveHistory)
+    return;
+  ClockRecord record;
+  clock->toRecord(record);
+  moveHistory->setClock(record);
+}
+
+void ChessGame::startClock() {
+  if (!clock || !clock->isEnabled() || gameOver)
+    return;
+  clock->start(currentTurn);
+  lowTimeWarned = false;
+}
+
+bool ChessGame::checkClock() {
+  if (!clock || !clock->isEnabled() || gameOver)
+    return false;
+
+  int kingRow = -1;
+  int kingCol = -1;
+  char flaggedSide = clock->getFlaggedSide();
+  if (flaggedSide != ' ') {
+    clock->stop();
+    char winnerColor = (flaggedSide == 'w') ? 'b' : 'w';
+    LOG_INFO("TIME! %s ran out of time. %s wins!", ChessUtils::colorName(flaggedSide), ChessUtils::colorName(winnerColor));
+    if (chessEngine->findKingPosition(board, flaggedSide, kingRow, kingCol))
+      boardDriver->blinkSquare(kingRow, kingCol, LedColors::Red, 3, true, true);
+    boardDriver->fireworkAnimation(ChessUtils::colorLed(winnerColor));
+    gameOver = true;
+    if (moveHistory) {
+      saveClock();
+      moveHistory->finishGame(RESULT_TIMEOUT, winnerColor);
+    }
+    return true;
+  }
+
+  // Compact LED clock: the side to move's king blinks orange once when its time runs low
+  if (!lowTimeWarned && clock->getRunningSide() == currentTurn && clock->getRemainingMs(currentTurn) < CLOCK_LOW_TIME_MS) {
+    lowTimeWarned = true;
+    LOG_INFO("%s has less than %u seconds left", ChessUtils::colorName(currentTurn), CLOCK_LOW_TIME_MS / 1000);
+    if (chessEngine->findKingPosition(board, currentTurn, kingRow, kingCol))
+      boardDriver->blinkSquare(kingRow, kingCol, LedColors::Orange, 2);
+  }
+  return false;
 }
 
 void ChessGame::setBoardStateFromFEN(const String& fen) {
@@ -399,8 +486,9 @@ void ChessGame::setBoardStateFromFEN(const String& fen) {
   chessEngine->recordPosition(board, currentTurn);
   if (moveHistory && moveHistory->isRecording())
     moveHistory->addFen(fen);
+  wifiManager->noteLastMove(-1, -1, -1, -1, ' ');
   wifiManager->updateBoardState(ChessUtils::boardToFEN(board, currentTurn, chessEngine), ChessUtils::evaluatePosition(board));
-  Serial.println("Board state set from FEN: " + fen);
+  LOG_INFO("Board state set from FEN: %s", fen.c_str());
   ChessUtils::printBoard(board);
 }
 
@@ -454,7 +542,7 @@ void ChessGame::applyCastling(int kingFromRow, int kingFromCol, int kingToRow, i
 
   if (waitForKingCompletion) {
     // Handle LED prompts and wait for king move
-    Serial.printf("Castling: please move king from %c%d to %c%d\n", (char)('a' + kingFromCol), 8 - kingFromRow, (char)('a' + kingToCol), 8 - kingToRow);
+    LOG_INFO("Castling: please move king from %c%d to %c%d", (char)('a' + kingFromCol), 8 - kingFromRow, (char)('a' + kingToCol), 8 - kingToRow);
 
     boardDriver->clearAllLEDs(false);
     boardDriver->setSquareLED(kingFromRow, kingFromCol, LedColors::Cyan);
@@ -464,7 +552,7 @@ void ChessGame::applyCastling(int kingFromRow, int kingFromCol, int kingToRow, i
     // Wait for king to be lifted from its original square
     while (boardDriver->getSensorState(kingFromRow, kingFromCol)) {
       boardDriver->readSensors();
-      delay(SENSOR_READ_DELAY_MS);
+      boardDriver->cooperativeWait().sleep(SENSOR_READ_DELAY_MS);
     }
 
     // Wait for king to be placed on destination square
@@ -474,14 +562,14 @@ void ChessGame::applyCastling(int kingFromRow, int kingFromCol, int kingToRow, i
 
     while (!boardDriver->getSensorState(kingToRow, kingToCol)) {
       boardDriver->readSensors();
-      delay(SENSOR_READ_DELAY_MS);
+      boardDriver->cooperativeWait().sleep(SENSOR_READ_DELAY_MS);
     }
 
     boardDriver->clearAllLEDs();
   }
 
   // Handle LED prompts and wait for rook move
-  Serial.printf("Castling: please move rook from %c%d to %c%d\n", (char)('a' + rookFromCol), 8 - kingToRow, (char)('a' + rookToCol), 8 - kingToRow);
+  LOG_INFO("Castling: please move rook from %c%d to %c%d", (char)('a' + rookFromCol), 8 - kingToRow, (char)('a' + rookToCol), 8 - kingToRow);
 
   // Wait for rook to be lifted from its original square
   boardDriver->clearAllLEDs(false);
@@ -491,7 +579,7 @@ void ChessGame::applyCastling(int kingFromRow, int kingFromCol, int kingToRow, i
 
   while (boardDriver->getSensorState(kingToRow, rookFromCol)) {
     boardDriver->readSensors();
-    delay(SENSOR_READ_DELAY_MS);
+    boardDriver->cooperativeWait().sleep(SENSOR_READ_DELAY_MS);
   }
 
   // Wait for rook to be placed on destination square
@@ -501,7 +589,7 @@ void ChessGame::applyCastling(int kingFromRow, int kingFromCol, int kingToRow, i
 
   while (!boardDriver->getSensorState(kingToRow, rookToCol)) {
     boardDriver->readSensors();
-    delay(SENSOR_READ_DELAY_MS);
+    boardDriver->cooperativeWait().sleep(SENSOR_READ_DELAY_MS);
   }
 
   boardDriver->clearAllLEDs();
@@ -553,7 +641,7 @@ bool ChessGame::continueResignGesture(int row, int col, char color) {
         lifted = true;
         break;
       }
-      delay(SENSOR_READ_DELAY_MS);
+      boardDriver->cooperativeWait().sleep(SENSOR_READ_DELAY_MS);
     }
 
     if (!lifted) {
@@ -569,7 +657,7 @@ bool ChessGame::continueResignGesture(int row, int col, char color) {
         returned = true;
         break;
       }
-      delay(SENSOR_READ_DELAY_MS);
+      boardDriver->cooperativeWait().sleep(SENSOR_READ_DELAY_MS);
     }
 
     if (!returned) {
@@ -580,7 +668,7 @@ bool ChessGame::continueResignGesture(int row, int col, char color) {
     showResignProgress(row, col, lift + 1);
   }
 
-  Serial.printf("Resign gesture completed by %s\n", ChessUtils::colorName(color));
+  LOG_INFO("Resign gesture completed by %s", ChessUtils::colorName(color));
   delay(500);
   clearResignFeedback(row, col);
   return handleResign(color);
@@ -592,15 +680,15 @@ bool ChessGame::handleResign(char resignColor) {
   // so default to false (white-side). Subclasses can override.
   bool flipped = (resignColor == 'b');
 
-  Serial.printf("Resign confirmation for %s...\n", ChessUtils::colorName(resignColor));
+  LOG_INFO("Resign confirmation for %s...", ChessUtils::colorName(resignColor));
 
   if (!boardConfirm(boardDriver, flipped)) {
-    Serial.println("Resign cancelled");
+    LOG_INFO("Resign cancelled");
     return false;
   }
 
   char winnerColor = (resignColor == 'w') ? 'b' : 'w';
-  Serial.printf("RESIGNATION! %s resigns. %s wins!\n", ChessUtils::colorName(resignColor), ChessUtils::colorName(winnerColor));
+  LOG_INFO("RESIGNATION! %s resigns. %s wins!", ChessUtils::colorName(resignColor), ChessUtils::colorName(winnerColor));
 
   boardDriver->fireworkAnimation(ChessUtils::colorLed(winnerColor));
   if (moveHistory)
@@ -11,6 +11,8 @@
 // Forward declarations to avoid circular dependencies
 class WiFiManagerESP32;
 class MoveHistory;
+class ChessClock;
+class LoopStats;
 
 // Base class for chess game modes (shared state and common functionality)
 class ChessGame {
@@ -20,11 +22,14 @@ class ChessGame {
   ChessEngine* chessEngine;
   WiFiManagerESP32* wifiManager;
   MoveHistory* moveHistory; // nullptr for Lichess mode (moves already recorded on Lichess cloud)
+  ChessClock* clock;        // nullptr or disabled for untimed games
+  LoopStats* loopStats;     // nullptr if moves aren't measured
 
   char board[8][8];
   char currentTurn; // 'w' or 'b'
   bool gameOver;
   bool replaying; // True while replaying moves during resume (suppresses LEDs and physical move waits)
+  bool lowTimeWarned; // Low-time LED warning already shown this turn
 
   // --- Resign ---
   static constexpr unsigned long RESIGN_HOLD_MS = 3000;       // Duration king must stay off its square to initiate resign
@@ -39,11 +44,24 @@ class ChessGame {
 
   // Common initialization and game flow methods
   void initializeBoard();
-  void waitForBoardSetup(const char targetBoard[8][8]);
+  /// Block until the physical board matches targetBoard, guiding with LEDs.
+  /// celebrate=false skips the closing firework (used to undo a wrong move).
+  void waitForBoardSetup(const char targetBoard[8][8], bool celebrate = true);
   void applyMove(int fromRow, int fromCol, int toRow, int toCol, char promotion = ' ', bool isRemoteMove = false);
   bool tryPlayerMove(char playerColor, int& fromRow, int& fromCol, int& toRow, int& toCol);
   void updateGameStatus();
 
+  // --- Clock ---
+  /// Resume: restore the clock saved in live.bin, or disable it for an untimed game.
+  void restoreClock();
+  /// Copy the clock state into the live.bin clock block (written with the next header update).
+  void saveClock();
+  /// Start the clock for the side to move. Call once the board is set up.
+  void startClock();
+  /// Flag check and low-time warning. Call at the start of update() after readSensors().
+  /// Returns true if the game ended on time.
+  bool checkClock();
+
   // --- Resign ---
   /// Unified resign entry point. Call at the start of update() after readSensors().
   /// Returns true if the game loop should return early.
@@ -81,6 +99,8 @@ class ChessGame {
   void setBoardStateFromFEN(const String& fen);
   bool isGameOver() const { return gameOver; }
   void setResignPending(bool pending) { resignPending = pending; }
+  void setClock(ChessClock* c) { clock = c; }
+  void setLoopStats(LoopStats* stats) { loopStats = stats; }
 
   // Advance turn and record position (extracted from updateGameStatus for replay use)
   void advanceTurn();
@@ -11,6 +11,7 @@ static BotConfig dummyBotConfig = {StockfishSettings::medium(), false};
 ChessLichess::ChessLichess(BoardDriver* bd, ChessEngine* ce, WiFiManagerESP32* wm, LichessConfig cfg)
     : ChessBot(bd, ce, wm, nullptr, dummyBotConfig),
       lichessConfig(cfg),
+      lichessApi(cfg.apiToken),
       currentGameId(""),
       myColor('w'),
       lastKnownMoves(""),
@@ -20,6 +21,7 @@ ChessLichess::ChessLichess(BoardDriver* bd, ChessEngine* ce, WiFiManagerESP32* w
 
 void ChessLichess::begin() {
   Serial.println("=== Starting Lichess Mode ===");
+  wifiManager->waitForNetworkStart();
 
   if (!wifiManager->isWiFiConnected()) {
     Serial.println("Not connected to WiFi. Lichess mode unavailable.");
@@ -37,8 +39,9 @@ void ChessLichess::begin() {
   }
 
   String username;
-  LichessAPI::setToken(lichessConfig.apiToken);
-  if (!LichessAPI::verifyToken(username)) {
+  bool verified = false;
+  runNetwork([&]() { verified = lichessApi.verifyToken(username); });
+  if (!verified) {
     Serial.println("Invalid Lichess API token!");
     boardDriver->flashBoardAnimation(LedColors::Red);
     gameOver = true;
@@ -59,8 +62,10 @@ void ChessLichess::waitForLichessGame() {
   LichessEvent event;
   event.type = LichessEventType::UNKNOWN;
   while (!gameOver) {
-    if (!LichessAPI::pollForGameEvent(event) || event.type != LichessEventType::GAME_START) {
-      delay(2000);
+    bool polled = false;
+    runNetwork([&]() { polled = lichessApi.pollForGameEvent(event); });
+    if (!polled || event.type != LichessEventType::GAME_START) {
+      boardDriver->cooperativeWait().sleep(2000);
       continue;
     }
     break;
@@ -79,7 +84,9 @@ void ChessLichess::waitForLichessGame() {
   state.gameId = currentGameId;
   state.fen = event.fen; // Use FEN from initial event as fallback
 
-  if (LichessAPI::pollGameStream(currentGameId, state)) {
+  bool gotState = false;
+  runNetwork([&]() { gotState = lichessApi.pollGameStream(currentGameId, state); });
+  if (gotState) {
     Serial.println("Got full game state from stream");
   } else {
     // Fallback: Use data from the initial event
@@ -171,7 +178,9 @@ void ChessLichess::update() {
   LichessGameState state;
   state.myColor = myColor;
   state.gameId = currentGameId;
-  if (LichessAPI::pollGameStream(currentGameId, state)) {
+  bool gotState = false;
+  runNetwork([&]() { gotState = lichessApi.pollGameStream(currentGameId, state); });
+  if (gotState) {
     if (state.gameEnded) {
       Serial.println("Game ended! Status: " + state.status);
       if (state.winner.length() > 0)
@@ -219,12 +228,12 @@ void ChessLichess::sendMoveToLichess(int fromRow, int fromCol, int toRow, int to
   int attempt = 0;
   bool sent = false;
   while (attempt < maxRetries && !sent) {
-    if (LichessAPI::makeMove(currentGameId, uciMove)) {
-      sent = true;
+    runNetwork([&]() { sent = lichessApi.makeMove(currentGameId, uciMove); });
+    if (sent) {
       break;
     } else {
       Serial.printf("ERROR: Failed to send move to Lichess! Attempt %d/%d\n", attempt + 1, maxRetries);
-      delay(500);
+      boardDriver->cooperativeWait().sleep(500);
       attempt++;
     }
   }
@@ -261,7 +270,7 @@ bool ChessLichess::handleResign(char resignColor) {
 
   // Send resign to Lichess API
   Serial.println("Sending resign to Lichess...");
-  LichessAPI::resignGame(currentGameId);
+  runNetwork([&]() { lichessApi.resignGame(currentGameId); });
 
   char winnerColor = (resignColor == 'w') ? 'b' : 'w';
   Serial.printf("RESIGNATION! %s resigns on Lichess. %s wins!\n", ChessUtils::colorName(resignColor), ChessUtils::colorName(winnerColor));
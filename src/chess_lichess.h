@@ -13,6 +13,7 @@ struct LichessConfig {
 class ChessLichess : public ChessBot {
  private:
   LichessConfig lichessConfig;
+  LichessAPI lichessApi;
   String currentGameId;
   char myColor; // 'w' or 'b' - the color we play as
 
@@ -15,18 +15,22 @@ void ChessMoves::begin() {
     replaying = true;
     moveHistory->replayIntoGame(this);
     replaying = false;
+    restoreClock();
     wifiManager->updateBoardState(ChessUtils::boardToFEN(board, currentTurn, chessEngine), ChessUtils::evaluatePosition(board));
   } else {
     moveHistory->startGame(GAME_MODE_CHESS_MOVES);
+    saveClock();
     moveHistory->addFen(ChessUtils::boardToFEN(board, currentTurn, chessEngine));
   }
   waitForBoardSetup(board);
+  startClock();
 }
 
 void ChessMoves::update() {
   boardDriver->readSensors();
 
   if (processResign()) return;
+  if (checkClock()) return;
 
   int fromRow, fromCol, toRow, toCol;
   if (tryPlayerMove(currentTurn, fromRow, fromCol, toRow, toCol)) {
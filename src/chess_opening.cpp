@@ -0,0 +1,228 @@
+#include "chess_opening.h"
+#include "chess_utils.h"
+#include "led_colors.h"
+#include "move_history.h"
+#include "wifi_manager_esp32.h"
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+// Dummy BotConfig for parent constructor (replies come from the repertoire, not Stockfish)
+static BotConfig dummyBotConfig = {StockfishSettings::medium(), false};
+
+ChessOpening::ChessOpening(BoardDriver* bd, ChessEngine* ce, WiFiManagerESP32* wm, char color)
+    : ChessBot(bd, ce, wm, nullptr, dummyBotConfig),
+      childCount(0),
+      lineEndsHere(false),
+      playerColor(color),
+      lineLength(0),
+      linesCompleted(0),
+      mistakes(0),
+      hintShown(false) {}
+
+ChessOpening::~ChessOpening() {
+  wifiManager->clearOpening();
+}
+
+void ChessOpening::begin() {
+  Serial.println("=== Starting Opening Trainer ===");
+  if (!trie.begin()) {
+    Serial.println("No usable opening repertoire on flash. Build one with tools/opening_trie.py and upload it from the web interface.");
+    boardDriver->flashBoardAnimation(LedColors::Red);
+    gameOver = true;
+    return;
+  }
+  if (playerColor != 'w' && playerColor != 'b')
+    playerColor = trie.getSide();
+  Serial.printf("Training the repertoire as %s (%u lines)\n", ChessUtils::colorName(playerColor), trie.getLineCount());
+  Serial.println("====================================");
+
+  startLine();
+}
+
+void ChessOpening::update() {
+  if (gameOver)
+    return;
+
+  if (wifiManager->getPendingOpeningHint()) {
+    wifiManager->clearPendingOpeningHint();
+    showExpectedMoves();
+  }
+
+  boardDriver->readSensors();
+
+  if (processResign()) return;
+
+  if (currentTurn != playerColor) {
+    playOpponentMove();
+  } else {
+    int fromRow, fromCol, toRow, toCol;
+    if (tryPlayerMove(playerColor, fromRow, fromCol, toRow, toCol)) {
+      if (hintShown) clearHint();
+      int child = findChild(fromRow, fromCol, toRow, toCol);
+      if (child < 0) {
+        Serial.println("Not in the repertoire! Put the pieces back");
+        mistakes++;
+        publishStatus("wrong");
+        showIllegalMoveFeedback(toRow, toCol);
+        waitForBoardSetup(board, false);
+        showExpectedMoves();
+      } else {
+        int r1, c1, r2, c2;
+        char promotion;
+        MoveHistory::decodeMove(children[child].move, r1, c1, r2, c2, promotion);
+        applyMove(fromRow, fromCol, toRow, toCol, promotion);
+        updateGameStatus();
+        advance(children[child]);
+      }
+    }
+  }
+
+  boardDriver->updateSensorPrev();
+}
+
+// ---------------------------
+// Trainer Flow
+// ---------------------------
+
+void ChessOpening::startLine() {
+  initializeBoard();
+  lineLength = 0;
+  lineEndsHere = false;
+  OpeningNode root;
+  childCount = trie.readNode(0, root) ? trie.readChildren(root, children) : 0;
+  if (childCount == 0) {
+    Serial.println("Opening repertoire is empty");
+    boardDriver->flashBoardAnimation(LedColors::Red);
+    gameOver = true;
+    return;
+  }
+  publishStatus("setup");
+  waitForBoardSetup(board);
+  publishStatus("training");
+}
+
+void ChessOpening::advance(const OpeningNode& node) {
+  if (lineLength < OPENING_MAX_DEPTH)
+    lineMoves[lineLength++] = node.move;
+  childCount = trie.readChildren(node, children);
+  lineEndsHere = (node.flags & OPENING_NODE_LINE_END) != 0;
+  wifiManager->updateBoardState(ChessUtils::boardToFEN(board, currentTurn, chessEngine), ChessUtils::evaluatePosition(board));
+  if (childCount == 0 || gameOver)
+    finishLine();
+  else
+    publishStatus("training");
+}
+
+void ChessOpening::playOpponentMove() {
+  // Weight replies by the number of lines behind them so every line gets drilled.
+  // A line that stops here takes one share as well.
+  uint32_t total = lineEndsHere ? 1 : 0;
+  for (int i = 0; i < childCount; i++)
+    total += children[i].lineCount;
+  uint32_t pick = total > 0 ? (uint32_t)random(total) : 0;
+  if (lineEndsHere) {
+    if (pick == 0) {
+      finishLine();
+      return;
+    }
+    pick--;
+  }
+  int chosen = 0;
+  for (int i = 0; i < childCount; i++) {
+    if (pick < children[i].lineCount) {
+      chosen = i;
+      break;
+    }
+    pick -= children[i].lineCount;
+  }
+
+  OpeningNode node = children[chosen];
+  int fromRow, fromCol, toRow, toCol;
+  char promotion;
+  MoveHistory::decodeMove(node.move, fromRow, fromCol, toRow, toCol, promotion);
+  Serial.printf("Repertoire reply: %s (%d of %d choices)\n", ChessUtils::toUCIMove(fromRow, fromCol, toRow, toCol, promotion).c_str(), chosen + 1, childCount);
+  applyMove(fromRow, fromCol, toRow, toCol, promotion, true);
+  updateGameStatus();
+  advance(node);
+}
+
+int ChessOpening::findChild(int fromRow, int fromCol, int toRow, int toCol) const {
+  for (int i = 0; i < childCount; i++) {
+    int r1, c1, r2, c2;
+    char promotion;
+    MoveHistory::decodeMove(children[i].move, r1, c1, r2, c2, promotion);
+    if (r1 == fromRow && c1 == fromCol && r2 == toRow && c2 == toCol)
+      return i;
+  }
+  return -1;
+}
+
+void ChessOpening::showExpectedMoves() {
+  if (currentTurn != playerColor || childCount == 0)
+    return;
+
+  uint16_t maxLines = 1;
+  for (int i = 0; i < childCount; i++)
+    maxLines = max(maxLines, children[i].lineCount);
+
+  boardDriver->waitForAnimationQueueDrain();
+  BoardDriver::LedGuard guard(boardDriver);
+  boardDriver->clearAllLEDs(false);
+  for (int i = 0; i < childCount; i++) {
+    int fromRow, fromCol, toRow, toCol;
+    char promotion;
+    MoveHistory::decodeMove(children[i].move, fromRow, fromCol, toRow, toCol, promotion);
+    // Brighter destinations lead to more repertoire lines
+    float weight = 0.25f + 0.75f * children[i].lineCount / maxLines;
+    boardDriver->setSquareLED(fromRow, fromCol, LedColors::Cyan);
+    boardDriver->setSquareLED(toRow, toCol, LedColors::scaleColor(LedColors::White, weight));
+  }
+  boardDriver->showLEDs();
+  hintShown = true;
+}
+
+void ChessOpening::clearHint() {
+  boardDriver->waitForAnimationQueueDrain();
+  BoardDriver::LedGuard guard(boardDriver);
+  boardDriver->clearAllLEDs();
+  hintShown = false;
+}
+
+void ChessOpening::finishLine() {
+  linesCompleted++;
+  Serial.printf("Line complete! %d lines done, %d mistakes\n", linesCompleted, mistakes);
+  publishStatus("complete");
+  boardDriver->flashBoardAnimation(LedColors::Green, 2);
+  startLine();
+}
+
+void ChessOpening::publishStatus(const char* state) {
+  JsonDocument doc;
+  doc["active"] = true;
+  doc["state"] = state;
+  doc["color"] = playerColor == 'w' ? "white" : "black";
+  doc["completed"] = linesCompleted;
+  doc["mistakes"] = mistakes;
+  JsonArray moves = doc["moves"].to<JsonArray>();
+  for (int i = 0; i < lineLength; i++) {
+    int fromRow, fromCol, toRow, toCol;
+    char promotion;
+    MoveHistory::decodeMove(lineMoves[i], fromRow, fromCol, toRow, toCol, promotion);
+    moves.add(ChessUtils::toUCIMove(fromRow, fromCol, toRow, toCol, promotion));
+  }
+  // Expected moves are only revealed on the player's turn
+  JsonArray candidates = doc["candidates"].to<JsonArray>();
+  if (currentTurn == playerColor) {
+    for (int i = 0; i < childCount; i++) {
+      int fromRow, fromCol, toRow, toCol;
+      char promotion;
+      MoveHistory::decodeMove(children[i].move, fromRow, fromCol, toRow, toCol, promotion);
+      JsonObject candidate = candidates.add<JsonObject>();
+      candidate["move"] = ChessUtils::toUCIMove(fromRow, fromCol, toRow, toCol, promotion);
+      candidate["lines"] = children[i].lineCount;
+    }
+  }
+  String output;
+  serializeJson(doc, output);
+  wifiManager->updateOpening(output);
+}
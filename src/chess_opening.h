@@ -0,0 +1,49 @@
+#ifndef CHESS_OPENING_H
+#define CHESS_OPENING_H
+
+#include "chess_bot.h"
+#include "opening_trie.h"
+
+// ---------------------------
+// Opening Trainer Game Mode Class
+// ---------------------------
+/// Drills a repertoire stored as a move trie (see opening_trie.h). The board
+/// plays the opponent's side, picking replies weighted by how many repertoire
+/// lines follow them, through the same remote-move LED guidance as ChessBot.
+/// The player's moves must stay in the repertoire: a move outside it blinks
+/// red, the position is restored and the expected moves are lit. Each ply
+/// reads only the current node's child run from flash.
+class ChessOpening : public ChessBot {
+ private:
+  OpeningTrie trie;
+  OpeningNode children[OPENING_MAX_CHILDREN]; // Replies from the current position
+  int childCount;
+  bool lineEndsHere; // A shorter repertoire line stops at the current position
+  char playerColor;
+  uint16_t lineMoves[OPENING_MAX_DEPTH]; // Moves played on the current line, for the web UI
+  int lineLength;
+  int linesCompleted;
+  int mistakes;
+  bool hintShown;
+
+  // Set up the starting position and load the root's replies
+  void startLine();
+  // Move down the trie to `node` after its move was applied on the board
+  void advance(const OpeningNode& node);
+  void playOpponentMove();
+  // Index of the child matching a player move, or -1 if it leaves the repertoire
+  int findChild(int fromRow, int fromCol, int toRow, int toCol) const;
+  void showExpectedMoves();
+  void clearHint();
+  void finishLine();
+  void publishStatus(const char* state);
+
+ public:
+  /// playerColor ' ' trains the side the repertoire was compiled for.
+  ChessOpening(BoardDriver* bd, ChessEngine* ce, WiFiManagerESP32* wm, char playerColor = ' ');
+  ~ChessOpening() override;
+  void begin() override;
+  void update() override;
+};
+
+#endif // CHESS_OPENING_H
@@ -0,0 +1,195 @@
+#include "chess_puzzle.h"
+#include "board_menu.h"
+#include "chess_utils.h"
+#include "led_colors.h"
+#include "move_history.h"
+#include "wifi_manager_esp32.h"
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <string.h>
+
+// Dummy BotConfig for parent constructor (puzzle replies come from the pack, not Stockfish)
+static BotConfig dummyBotConfig = {StockfishSettings::medium(), false};
+
+ChessPuzzle::ChessPuzzle(BoardDriver* bd, ChessEngine* ce, WiFiManagerESP32* wm, int startRating)
+    : ChessBot(bd, ce, wm, nullptr, dummyBotConfig),
+      playerColor('w'),
+      solutionIndex(0),
+      targetRating(constrain(startRating, PUZZLE_MIN_RATING, PUZZLE_MAX_RATING)),
+      puzzleFailed(false),
+      solvedCount(0),
+      failedCount(0),
+      skipRequested(false) {
+  memset(&puzzle, 0, sizeof(puzzle));
+}
+
+ChessPuzzle::~ChessPuzzle() {
+  wifiManager->clearPuzzle();
+}
+
+void ChessPuzzle::begin() {
+  Serial.println("=== Starting Puzzle Mode ===");
+  if (!pack.begin()) {
+    Serial.println("No usable puzzle pack on flash. Build one with tools/puzzle_pack.py and upload it from the web interface.");
+    boardDriver->flashBoardAnimation(LedColors::Red);
+    gameOver = true;
+    return;
+  }
+  Serial.printf("Target rating: %d\n", targetRating);
+  Serial.println("====================================");
+
+  if (!startNextPuzzle()) {
+    boardDriver->flashBoardAnimation(LedColors::Red);
+    gameOver = true;
+  }
+}
+
+void ChessPuzzle::update() {
+  if (gameOver)
+    return;
+
+  boardDriver->readSensors();
+
+  processResign(); // A confirmed web resign skips the puzzle below
+
+  int fromRow, fromCol, toRow, toCol;
+  if (!skipRequested && tryPlayerMove(playerColor, fromRow, fromCol, toRow, toCol)) {
+    if (!checkPlayerMove(fromRow, fromCol, toRow, toCol)) {
+      Serial.println("Wrong move! Put the pieces back and try again");
+      puzzleFailed = true;
+      publishStatus("wrong");
+      showIllegalMoveFeedback(toRow, toCol);
+      waitForBoardSetup(board, false);
+      publishStatus("solving");
+    } else if (solutionIndex >= puzzle.moveCount) {
+      finishPuzzle();
+    } else {
+      playOpponentMove();
+      publishStatus("solving");
+    }
+  }
+
+  if (skipRequested) {
+    skipRequested = false;
+    Serial.println("Puzzle skipped");
+    puzzleFailed = true;
+    finishPuzzle();
+  }
+
+  boardDriver->updateSensorPrev();
+}
+
+bool ChessPuzzle::handleResign(char resignColor) {
+  if (!boardConfirm(boardDriver, resignColor == 'b')) {
+    Serial.println("Skip cancelled");
+    return false;
+  }
+  skipRequested = true;
+  return true;
+}
+
+// ---------------------------
+// Puzzle Flow
+// ---------------------------
+
+bool ChessPuzzle::startNextPuzzle() {
+  if (!pack.loadRandom(targetRating, puzzle)) {
+    Serial.println("Failed to read a puzzle from the pack");
+    return false;
+  }
+
+  solutionIndex = 0;
+  puzzleFailed = false;
+  gameOver = false; // A mating solution ends the game in updateGameStatus(), not the puzzle session
+  chessEngine->reset(); // Drop the previous puzzle's repetition history
+  setBoardStateFromFEN(String(puzzle.fen));
+  // The FEN is the position before the opponent's setup move, so the player is the side not to move
+  playerColor = (currentTurn == 'w') ? 'b' : 'w';
+
+  Serial.printf("Puzzle %s (rating %u): %s to play after the opponent's move\n", puzzle.id, puzzle.rating, ChessUtils::colorName(playerColor));
+  publishStatus("setup");
+  waitForBoardSetup(board);
+
+  playOpponentMove();
+  publishStatus("solving");
+  return true;
+}
+
+void ChessPuzzle::playOpponentMove() {
+  int fromRow, fromCol, toRow, toCol;
+  char promotion;
+  MoveHistory::decodeMove(puzzle.moves[solutionIndex], fromRow, fromCol, toRow, toCol, promotion);
+  Serial.printf("Opponent plays %s\n", ChessUtils::toUCIMove(fromRow, fromCol, toRow, toCol, promotion).c_str());
+  applyMove(fromRow, fromCol, toRow, toCol, promotion, true);
+  updateGameStatus();
+  solutionIndex++;
+  wifiManager->updateBoardState(ChessUtils::boardToFEN(board, currentTurn, chessEngine), ChessUtils::evaluatePosition(board));
+}
+
+bool ChessPuzzle::checkPlayerMove(int fromRow, int fromCol, int toRow, int toCol) {
+  int expFromRow, expFromCol, expToRow, expToCol;
+  char promotion;
+  MoveHistory::decodeMove(puzzle.moves[solutionIndex], expFromRow, expFromCol, expToRow, expToCol, promotion);
+  bool matches = (fromRow == expFromRow && fromCol == expFromCol && toRow == expToRow && toCol == expToCol);
+
+  // Like Lichess, any move that delivers mate is accepted as the final solution move
+  if (!matches && solutionIndex == puzzle.moveCount - 1) {
+    char testBoard[8][8];
+    memcpy(testBoard, board, sizeof(testBoard));
+    char piece = testBoard[fromRow][fromCol];
+    testBoard[toRow][toCol] = piece;
+    testBoard[fromRow][fromCol] = ' ';
+    if (toupper(piece) == 'P' && (toRow == 0 || toRow == 7))
+      testBoard[toRow][toCol] = ChessUtils::isWhitePiece(piece) ? 'Q' : 'q';
+    char opponentColor = (playerColor == 'w') ? 'b' : 'w';
+    if (chessEngine->isCheckmate(testBoard, opponentColor)) {
+      matches = true;
+      promotion = ' ';
+    }
+  }
+
+  if (!matches)
+    return false;
+
+  applyMove(fromRow, fromCol, toRow, toCol, promotion);
+  updateGameStatus();
+  solutionIndex++;
+  wifiManager->updateBoardState(ChessUtils::boardToFEN(board, currentTurn, chessEngine), ChessUtils::evaluatePosition(board));
+  return true;
+}
+
+void ChessPuzzle::finishPuzzle() {
+  if (puzzleFailed) {
+    failedCount++;
+    targetRating = max(targetRating - PUZZLE_RATING_STEP, PUZZLE_MIN_RATING);
+  } else {
+    solvedCount++;
+    targetRating = min(targetRating + PUZZLE_RATING_STEP, PUZZLE_MAX_RATING);
+  }
+  Serial.printf("Puzzle %s %s! Solved %d, failed %d, next target rating %d\n", puzzle.id, puzzleFailed ? "failed" : "solved", solvedCount, failedCount, targetRating);
+  publishStatus(puzzleFailed ? "failed" : "solved");
+  boardDriver->flashBoardAnimation(puzzleFailed ? LedColors::Orange : LedColors::Green, 2);
+
+  if (!startNextPuzzle()) {
+    boardDriver->flashBoardAnimation(LedColors::Red);
+    gameOver = true;
+  }
+}
+
+void ChessPuzzle::publishStatus(const char* state) {
+  JsonDocument doc;
+  doc["active"] = true;
+  doc["id"] = puzzle.id;
+  doc["rating"] = puzzle.rating;
+  doc["target"] = targetRating;
+  doc["toMove"] = playerColor == 'w' ? "white" : "black";
+  doc["state"] = state;
+  // Solution moves the player has already made (the setup move is not counted)
+  doc["progress"] = solutionIndex / 2;
+  doc["length"] = puzzle.moveCount / 2;
+  doc["solved"] = solvedCount;
+  doc["failed"] = failedCount;
+  String output;
+  serializeJson(doc, output);
+  wifiManager->updatePuzzle(output);
+}
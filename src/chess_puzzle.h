@@ -0,0 +1,49 @@
+#ifndef CHESS_PUZZLE_H
+#define CHESS_PUZZLE_H
+
+#include "chess_bot.h"
+#include "puzzle_pack.h"
+
+// ---------------------------
+// Puzzle Game Mode Class
+// ---------------------------
+/// Tactical puzzles from a pack on LittleFS (see puzzle_pack.h). The
+/// opponent's moves are played through the same remote-move LED guidance as
+/// ChessBot; the player's moves go through tryPlayerMove() and are checked
+/// against the stored solution one at a time. A wrong move is shown in red
+/// and the player puts the position back before trying again. The target
+/// rating moves up after a clean solve and down after a miss; the resign
+/// gesture skips the current puzzle (counted as a miss).
+class ChessPuzzle : public ChessBot {
+ private:
+  PuzzlePack pack;
+  PuzzleRecord puzzle;
+  char playerColor;
+  int solutionIndex; // Next move of puzzle.moves[] to be played
+  int targetRating;
+  bool puzzleFailed; // A wrong move was made on the current puzzle
+  int solvedCount;
+  int failedCount;
+  bool skipRequested; // Resign gesture confirmed: give up the current puzzle
+
+  // Load a new puzzle, guide the board setup and play the opponent's setup move
+  bool startNextPuzzle();
+  // Play the opponent's reply at solutionIndex through remote-move guidance
+  void playOpponentMove();
+  // Handle a legal move from tryPlayerMove(); returns false if it was wrong
+  bool checkPlayerMove(int fromRow, int fromCol, int toRow, int toCol);
+  void finishPuzzle();
+  void publishStatus(const char* state);
+
+ protected:
+  // Resigning gives up the current puzzle instead of ending the mode
+  bool handleResign(char resignColor) override;
+
+ public:
+  ChessPuzzle(BoardDriver* bd, ChessEngine* ce, WiFiManagerESP32* wm, int startRating = PUZZLE_DEFAULT_RATING);
+  ~ChessPuzzle() override;
+  void begin() override;
+  void update() override;
+};
+
+#endif // CHESS_PUZZLE_H
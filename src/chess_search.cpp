@@ -0,0 +1,489 @@
+#include "chess_search.h"
+#include "eval_weights.h"
+#include "move_history.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <new>
+#include <string.h>
+
+static inline int pieceTypeIndex(char piece) {
+  switch (toupper(piece)) {
+    case 'P': return 0;
+    case 'N': return 1;
+    case 'B': return 2;
+    case 'R': return 3;
+    case 'Q': return 4;
+    case 'K': return 5;
+    default: return -1;
+  }
+}
+
+// Square fields of a MoveHistory::encodeMove code: [from(6)][to(6)][promo(4)]
+static inline int moveFrom(uint16_t move) { return (move >> 10) & 0x3F; }
+static inline int moveTo(uint16_t move) { return (move >> 4) & 0x3F; }
+
+static constexpr int SCORE_INFINITY = 32000;
+static constexpr int MATE_THRESHOLD = SEARCH_MATE_SCORE - SEARCH_MAX_PLY;
+static constexpr uint32_t STOP_POLL_MASK = 1023; // Check the stop flag (and yield) every 1024 nodes
+
+// ---------------------------
+// Construction / Table Management
+// ---------------------------
+
+ChessSearch::ChessSearch() : sideToMove('w'), table(nullptr), tableMask(0), ownsTable(false), stopRequested(false), aborted(false), nodes(0), rootMoveCount(0) {
+  memset(board, ' ', sizeof(board));
+  memset(pvLength, 0, sizeof(pvLength));
+}
+
+ChessSearch::~ChessSearch() {
+  if (ownsTable)
+    delete[] table;
+}
+
+bool ChessSearch::begin(size_t ttEntries) {
+  // Round down to a power of two so the slot index is a mask
+  size_t entries = 1;
+  while (entries * 2 <= ttEntries)
+    entries *= 2;
+  if (ownsTable)
+    delete[] table;
+  table = new (std::nothrow) TTEntry[entries];
+  ownsTable = table != nullptr;
+  if (!table) {
+    tableMask = 0;
+    return false;
+  }
+  tableMask = (uint32_t)(entries - 1);
+  clearHashTable();
+  return true;
+}
+
+void ChessSearch::shareTable(const ChessSearch& owner) {
+  if (ownsTable)
+    delete[] table;
+  table = owner.table;
+  tableMask = owner.tableMask;
+  ownsTable = false;
+}
+
+void ChessSearch::clearHashTable() {
+  if (table)
+    memset(table, 0, sizeof(TTEntry) * (tableMask + 1));
+}
+
+void ChessSearch::setPosition(const char newBoard[8][8], char side, uint8_t castlingRights, int epRow, int epCol) {
+  memcpy(board, newBoard, sizeof(board));
+  sideToMove = side;
+  engine.reset();
+  engine.setCastlingRights(castlingRights);
+  if (epRow >= 0 && epCol >= 0)
+    engine.setEnPassantTarget(epRow, epCol);
+  rootMoveCount = 0; // Regenerated (and re-ordered) on the next searchRoot()
+}
+
+// ---------------------------
+// Evaluation
+// ---------------------------
+
+int ChessSearch::evaluate(const char board[8][8]) {
+  int score = 0;
+  for (int row = 0; row < 8; row++)
+    for (int col = 0; col < 8; col++) {
+      char piece = board[row][col];
+      int type = pieceTypeIndex(piece);
+      if (type < 0)
+        continue;
+      if (piece >= 'A' && piece <= 'Z')
+        score += EVAL_PIECE_VALUES[type] + EVAL_PST[type][row][col];
+      else
+        score -= EVAL_PIECE_VALUES[type] + EVAL_PST[type][7 - row][col];
+    }
+  return score;
+}
+
+int ChessSearch::evaluateSideToMove() const {
+  int score = evaluate(board);
+  return (sideToMove == 'w') ? score : -score;
+}
+
+// ---------------------------
+// Move Generation and Make/Unmake
+// ---------------------------
+
+int ChessSearch::generateMoves(uint16_t moves[], bool capturesOnly) {
+  int count = 0;
+  int targets[28][2];
+  for (int row = 0; row < 8; row++)
+    for (int col = 0; col < 8; col++) {
+      char piece = board[row][col];
+      if (piece == ' ')
+        continue;
+      bool isWhite = (piece >= 'A' && piece <= 'Z');
+      if (isWhite != (sideToMove == 'w'))
+        continue;
+
+      int targetCount = 0;
+      engine.getPossibleMoves(board, row, col, targetCount, targets);
+      for (int i = 0; i < targetCount && count < SEARCH_MAX_MOVES; i++) {
+        int toRow = targets[i][0];
+        int toCol = targets[i][1];
+        bool promotes = engine.isPawnPromotion(piece, toRow);
+        bool capture = board[toRow][toCol] != ' ' || (toupper(piece) == 'P' && toCol != col);
+        if (capturesOnly && !capture && !promotes)
+          continue;
+        // Queen promotion only: under-promotions almost never change the evaluation of a line
+        moves[count++] = MoveHistory::encodeMove(row, col, toRow, toCol, promotes ? 'q' : ' ');
+      }
+    }
+  return count;
+}
+
+bool ChessSearch::isCapture(uint16_t move) const {
+  int from = moveFrom(move);
+  int to = moveTo(move);
+  char piece = board[from / 8][from % 8];
+  return board[to / 8][to % 8] != ' ' || (toupper(piece) == 'P' && (from % 8) != (to % 8));
+}
+
+int ChessSearch::moveOrderScore(uint16_t move) const {
+  int from = moveFrom(move);
+  int to = moveTo(move);
+  int score = 0;
+  if (move & 0x0F)
+    score += EVAL_PIECE_VALUES[4];
+  char victim = board[to / 8][to % 8];
+  if (victim != ' ') {
+    // MVV-LVA: most valuable victim first, cheapest attacker breaks ties
+    char attacker = board[from / 8][from % 8];
+    score += 10 * EVAL_PIECE_VALUES[pieceTypeIndex(victim)] - EVAL_PIECE_VALUES[pieceTypeIndex(attacker)] / 10;
+  } else if (isCapture(move)) {
+    score += 10 * EVAL_PIECE_VALUES[0];
+  }
+  return score;
+}
+
+void ChessSearch::orderMoves(uint16_t moves[], int count, uint16_t ttMove) const {
+  int scores[SEARCH_MAX_MOVES];
+  for (int i = 0; i < count; i++)
+    scores[i] = (moves[i] == ttMove) ? SCORE_INFINITY : moveOrderScore(moves[i]);
+
+  // Insertion sort: move lists are short and mostly ordered already
+  for (int i = 1; i < count; i++) {
+    uint16_t move = moves[i];
+    int score = scores[i];
+    int j = i - 1;
+    while (j >= 0 && scores[j] < score) {
+      moves[j + 1] = moves[j];
+      scores[j + 1] = scores[j];
+      j--;
+    }
+    moves[j + 1] = move;
+    scores[j + 1] = score;
+  }
+}
+
+void ChessSearch::makeMove(uint16_t move, UndoState& undo) {
+  memcpy(undo.board, board, sizeof(board));
+  undo.castlingRights = engine.getCastlingRights();
+  engine.getEnPassantTarget(undo.epRow, undo.epCol);
+
+  int fromRow, fromCol, toRow, toCol;
+  char promotion;
+  MoveHistory::decodeMove(move, fromRow, fromCol, toRow, toCol, promotion);
+
+  char piece = board[fromRow][fromCol];
+  bool isWhite = (piece >= 'A' && piece <= 'Z');
+  char kind = toupper(piece);
+
+  // En passant: the captured pawn is beside the destination, not on it
+  if (kind == 'P' && fromCol != toCol && board[toRow][toCol] == ' ')
+    board[fromRow][toCol] = ' ';
+
+  // Castling: move the rook as well
+  if (kind == 'K' && (toCol - fromCol == 2 || fromCol - toCol == 2)) {
+    int rookFromCol = (toCol > fromCol) ? 7 : 0;
+    int rookToCol = (toCol > fromCol) ? 5 : 3;
+    board[fromRow][rookToCol] = board[fromRow][rookFromCol];
+    board[fromRow][rookFromCol] = ' ';
+  }
+
+  board[toRow][toCol] = (promotion != ' ') ? (isWhite ? toupper(promotion) : promotion) : piece;
+  board[fromRow][fromCol] = ' ';
+
+  // Castling rights: a king move drops both, a move from or onto a corner drops that side
+  uint8_t rights = undo.castlingRights;
+  if (kind == 'K')
+    rights &= isWhite ? ~0x03 : ~0x0C;
+  auto clearCorner = [&rights](int row, int col) {
+    if (row == 7 && col == 7) rights &= ~0x01;
+    if (row == 7 && col == 0) rights &= ~0x02;
+    if (row == 0 && col == 7) rights &= ~0x04;
+    if (row == 0 && col == 0) rights &= ~0x08;
+  };
+  clearCorner(fromRow, fromCol);
+  clearCorner(toRow, toCol);
+  engine.setCastlingRights(rights);
+
+  if (kind == 'P' && (toRow - fromRow == 2 || fromRow - toRow == 2))
+    engine.setEnPassantTarget((fromRow + toRow) / 2, fromCol);
+  else
+    engine.clearEnPassantTarget();
+
+  sideToMove = (sideToMove == 'w') ? 'b' : 'w';
+}
+
+void ChessSearch::unmakeMove(const UndoState& undo) {
+  memcpy(board, undo.board, sizeof(board));
+  engine.setCastlingRights(undo.castlingRights);
+  if (undo.epRow >= 0)
+    engine.setEnPassantTarget(undo.epRow, undo.epCol);
+  else
+    engine.clearEnPassantTarget();
+  sideToMove = (sideToMove == 'w') ? 'b' : 'w';
+}
+
+// ---------------------------
+// Transposition Table
+// ---------------------------
+
+bool ChessSearch::probeTable(uint64_t hash, int depth, int ply, int alpha, int beta, int& score, uint16_t& move) const {
+  if (!table)
+    return false;
+  // Read each word once: another task may be rewriting the slot
+  const volatile TTEntry& slot = table[(uint32_t)hash & tableMask];
+  uint32_t data0 = slot.data0;
+  uint32_t data1 = slot.data1;
+  uint32_t check = slot.check;
+  uint8_t flag = (data1 >> 8) & 0xFF;
+  if (flag == TT_EMPTY || (check ^ data0 ^ data1) != (uint32_t)(hash >> 32))
+    return false;
+
+  move = (uint16_t)(data0 >> 16);
+  if ((int)(data1 & 0xFF) < depth)
+    return false;
+
+  // Mate scores are stored relative to the node, convert back to distance from root
+  int stored = (int16_t)(data0 & 0xFFFF);
+  if (stored > MATE_THRESHOLD)
+    stored -= ply;
+  else if (stored < -MATE_THRESHOLD)
+    stored += ply;
+
+  if (flag == TT_EXACT || (flag == TT_LOWER && stored >= beta) || (flag == TT_UPPER && stored <= alpha)) {
+    score = stored;
+    return true;
+  }
+  return false;
+}
+
+void ChessSearch::storeTable(uint64_t hash, int depth, int ply, int score, uint8_t flag, uint16_t move) {
+  if (!table)
+    return;
+  volatile TTEntry& slot = table[(uint32_t)hash & tableMask];
+  uint32_t key = (uint32_t)(hash >> 32);
+  uint32_t oldData1 = slot.data1;
+  // Depth-preferred replacement, but always replace entries from another position
+  if (((oldData1 >> 8) & 0xFF) != TT_EMPTY && (slot.check ^ slot.data0 ^ oldData1) == key && (int)(oldData1 & 0xFF) > depth)
+    return;
+
+  if (score > MATE_THRESHOLD)
+    score += ply;
+  else if (score < -MATE_THRESHOLD)
+    score -= ply;
+
+  uint32_t data0 = (uint16_t)(int16_t)score | ((uint32_t)move << 16);
+  uint32_t data1 = (uint8_t)depth | ((uint32_t)flag << 8);
+  slot.data0 = data0;
+  slot.data1 = data1;
+  slot.check = key ^ data0 ^ data1;
+}
+
+// ---------------------------
+// Search
+// ---------------------------
+
+bool ChessSearch::pollStop() {
+  if ((++nodes & STOP_POLL_MASK) == 0) {
+    // Give the idle task a tick so a long search never trips the task watchdog
+    vTaskDelay(1);
+    if (stopRequested.load())
+      aborted = true;
+  }
+  return aborted;
+}
+
+bool ChessSearch::isRepetition(uint64_t hash, int ply) const {
+  // Same side to move every second ply
+  for (int i = ply - 2; i >= 0; i -= 2)
+    if (pathHash[i] == hash)
+      return true;
+  return false;
+}
+
+int ChessSearch::quiescence(int alpha, int beta, int ply) {
+  if (pollStop())
+    return 0;
+
+  int standPat = evaluateSideToMove();
+  if (ply >= SEARCH_MAX_PLY - 1 || standPat >= beta)
+    return standPat;
+  if (standPat > alpha)
+    alpha = standPat;
+
+  uint16_t moves[SEARCH_MAX_MOVES];
+  int count = generateMoves(moves, true);
+  orderMoves(moves, count, 0);
+
+  for (int i = 0; i < count; i++) {
+    UndoState undo;
+    makeMove(moves[i], undo);
+    int score = -quiescence(-beta, -alpha, ply + 1);
+    unmakeMove(undo);
+    if (aborted)
+      return 0;
+    if (score >= beta)
+      return score;
+    if (score > alpha)
+      alpha = score;
+  }
+  return alpha;
+}
+
+int ChessSearch::negamax(int depth, int alpha, int beta, int ply) {
+  pvLength[ply] = 0;
+  if (pollStop())
+    return 0;
+
+  uint64_t hash = engine.computeZobristHash(board, sideToMove);
+  pathHash[ply] = hash;
+  if (isRepetition(hash, ply))
+    return 0;
+
+  if (depth <= 0 || ply >= SEARCH_MAX_PLY - 1)
+    return quiescence(alpha, beta, ply);
+
+  int ttScore = 0;
+  uint16_t ttMove = 0;
+  if (probeTable(hash, depth, ply, alpha, beta, ttScore, ttMove))
+    return ttScore;
+
+  uint16_t moves[SEARCH_MAX_MOVES];
+  int count = generateMoves(moves, false);
+  if (count == 0)
+    return engine.isKingInCheck(board, sideToMove) ? -(SEARCH_MATE_SCORE - ply) : 0;
+  orderMoves(moves, count, ttMove);
+
+  int originalAlpha = alpha;
+  int bestScore = -SCORE_INFINITY;
+  uint16_t bestMove = 0;
+
+  for (int i = 0; i < count; i++) {
+    UndoState undo;
+    makeMove(moves[i], undo);
+    int score = -negamax(depth - 1, -beta, -alpha, ply + 1);
+    unmakeMove(undo);
+    if (aborted)
+      return 0;
+
+    if (score > bestScore) {
+      bestScore = score;
+      bestMove = moves[i];
+      if (score > alpha) {
+        alpha = score;
+        pvTable[ply][0] = moves[i];
+        memcpy(&pvTable[ply][1], pvTable[ply + 1], pvLength[ply + 1] * sizeof(uint16_t));
+        pvLength[ply] = pvLength[ply + 1] + 1;
+      }
+    }
+    if (alpha >= beta)
+      break;
+  }
+
+  uint8_t flag = (bestScore >= beta) ? TT_LOWER : (bestScore > originalAlpha ? TT_EXACT : TT_UPPER);
+  storeTable(hash, depth, ply, bestScore, flag, bestMove);
+  return bestScore;
+}
+
+int ChessSearch::searchRoot(int depth, int multiPv, SearchLine lines[]) {
+  aborted = false;
+  nodes = 0;
+  if (multiPv < 1)
+    multiPv = 1;
+  if (multiPv > SEARCH_MAX_LINES)
+    multiPv = SEARCH_MAX_LINES;
+  if (depth >= SEARCH_MAX_PLY)
+    depth = SEARCH_MAX_PLY - 1;
+
+  if (rootMoveCount == 0) {
+    rootMoveCount = generateMoves(rootMoves, false);
+    orderMoves(rootMoves, rootMoveCount, 0);
+    for (int i = 0; i < rootMoveCount; i++)
+      rootScores[i] = -SCORE_INFINITY;
+  }
+  if (rootMoveCount == 0)
+    return 0;
+
+  pathHash[0] = engine.computeZobristHash(board, sideToMove);
+  bool excluded[SEARCH_MAX_MOVES] = {false};
+  int linesFound = 0;
+
+  // Multi-PV: each pass searches the root moves not already reported as a better line
+  for (int pvIndex = 0; pvIndex < multiPv && pvIndex < rootMoveCount; pvIndex++) {
+    int alpha = -SCORE_INFINITY;
+    int bestIndex = -1;
+    uint16_t bestLine[SEARCH_MAX_PLY];
+    int bestLineLength = 0;
+
+    for (int i = 0; i < rootMoveCount; i++) {
+      if (excluded[i])
+        continue;
+      UndoState undo;
+      makeMove(rootMoves[i], undo);
+      int score = -negamax(depth - 1, -SCORE_INFINITY, -alpha, 1);
+      unmakeMove(undo);
+      if (aborted)
+        return -1;
+
+      if (score > alpha) {
+        alpha = score;
+        bestIndex = i;
+        bestLine[0] = rootMoves[i];
+        memcpy(&bestLine[1], pvTable[1], pvLength[1] * sizeof(uint16_t));
+        bestLineLength = pvLength[1] + 1;
+      }
+    }
+    if (bestIndex < 0)
+      break;
+
+    excluded[bestIndex] = true;
+    rootScores[bestIndex] = alpha;
+
+    SearchLine& line = lines[linesFound++];
+    int whiteScore = (sideToMove == 'w') ? alpha : -alpha;
+    line.score = (int16_t)whiteScore;
+    line.mateIn = 0;
+    if (alpha > MATE_THRESHOLD || alpha < -MATE_THRESHOLD) {
+      int plies = SEARCH_MATE_SCORE - (alpha > 0 ? alpha : -alpha);
+      int mateMoves = (plies + 1) / 2;
+      line.mateIn = (int8_t)(whiteScore > 0 ? mateMoves : -mateMoves);
+    }
+    line.length = (uint8_t)(bestLineLength < SEARCH_MAX_PV ? bestLineLength : SEARCH_MAX_PV);
+    memcpy(line.pv, bestLine, line.length * sizeof(uint16_t));
+  }
+
+  // Seed the next iteration's root ordering with this iteration's scores
+  for (int i = 1; i < rootMoveCount; i++) {
+    uint16_t move = rootMoves[i];
+    int score = rootScores[i];
+    int j = i - 1;
+    while (j >= 0 && rootScores[j] < score) {
+      rootMoves[j + 1] = rootMoves[j];
+      rootScores[j + 1] = rootScores[j];
+      j--;
+    }
+    rootMoves[j + 1] = move;
+    rootScores[j + 1] = score;
+  }
+
+  return linesFound;
+}
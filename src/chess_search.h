@@ -0,0 +1,135 @@
+#ifndef CHESS_SEARCH_H
+#define CHESS_SEARCH_H
+
+#include "chess_engine.h"
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+// ---------------------------
+// Search Configuration
+// ---------------------------
+static constexpr int SEARCH_MAX_LINES = 4;      // Upper bound for multi-PV
+static constexpr int SEARCH_MAX_PLY = 32;       // Hard recursion limit (main search + quiescence)
+static constexpr int SEARCH_MAX_PV = 8;         // Moves kept per reported line
+static constexpr int SEARCH_MAX_MOVES = 128;    // Legal moves per position (218 is the theoretical max, never seen in play)
+static constexpr int SEARCH_MATE_SCORE = 30000; // Mate scores are SEARCH_MATE_SCORE - ply
+static constexpr size_t SEARCH_DEFAULT_TT_ENTRIES = 4096; // 12 bytes each (~48KB), must be a power of two
+
+// ---------------------------
+// Search Result Line
+// ---------------------------
+struct SearchLine {
+  int16_t score;              // Centipawns from White's point of view
+  int8_t mateIn;              // Full moves to mate (+ White mates, - Black mates), 0 if none
+  uint8_t length;             // Number of moves in pv
+  uint16_t pv[SEARCH_MAX_PV]; // Moves packed with MoveHistory::encodeMove
+};
+
+// ---------------------------
+// Local Alpha-Beta Search
+// ---------------------------
+/// Negamax alpha-beta search with quiescence, a transposition table and
+/// multi-PV at the root. Move generation is delegated to a private ChessEngine
+/// copy so the rules stay in one place. The transposition table is kept
+/// across setPosition() calls, so a search restarted after a single move
+/// reuses everything it learned about the shared subtrees.
+///
+/// Several instances can share one table (Lazy SMP): each searches the same
+/// root on its own task and they cooperate only through the table entries,
+/// which are validated without locks.
+///
+/// Not thread-safe except for stop(), which may be called from any task.
+class ChessSearch {
+ public:
+  ChessSearch();
+  ~ChessSearch();
+
+  /// Allocate the transposition table. Returns false if the heap is too small.
+  bool begin(size_t ttEntries = SEARCH_DEFAULT_TT_ENTRIES);
+  /// Search with `owner`'s table instead of one of our own (Lazy SMP helper).
+  /// `owner` must outlive this instance and keep its table while we search.
+  void shareTable(const ChessSearch& owner);
+  void clearHashTable();
+
+  /// Load a position. Castling rights use the ChessEngine bitmask, epRow/epCol are -1 if none.
+  void setPosition(const char board[8][8], char sideToMove, uint8_t castlingRights, int epRow, int epCol);
+
+  /// Search the loaded position to a fixed depth and fill up to multiPv lines, best first.
+  /// Returns the number of lines filled, 0 if the side to move has no legal move, or -1 if stopped.
+  int searchRoot(int depth, int multiPv, SearchLine lines[]);
+
+  /// Abort the running searchRoot() as soon as possible. Cleared by the next resetStop().
+  void stop() { stopRequested.store(true); }
+  void resetStop() { stopRequested.store(false); }
+
+  uint32_t getNodes() const { return nodes; }
+
+  /// Static evaluation in centipawns from White's point of view (material + piece-square tables).
+  static int evaluate(const char board[8][8]);
+
+ private:
+  enum TTFlag : uint8_t { TT_EMPTY = 0, TT_EXACT, TT_LOWER, TT_UPPER };
+
+  // Written by several tasks without a lock: `check` is the key (upper 32 bits
+  // of the Zobrist hash, the lower bits select the slot) XORed with both data
+  // words, so an entry torn by two concurrent stores fails validation instead
+  // of pairing one position's key with another's score.
+  struct TTEntry {
+    uint32_t check;
+    uint32_t data0; // score (bits 0-15), move (bits 16-31)
+    uint32_t data1; // depth (bits 0-7), flag (bits 8-15)
+  };
+
+  // Saved irreversible state for unmakeMove()
+  struct UndoState {
+    char board[8][8];
+    uint8_t castlingRights;
+    int epRow;
+    int epCol;
+  };
+
+  ChessEngine engine;
+  char board[8][8];
+  char sideToMove;
+
+  TTEntry* table;
+  uint32_t tableMask;
+  bool ownsTable;
+
+  std::atomic<bool> stopRequested;
+  bool aborted;
+  uint32_t nodes;
+
+  // Triangular PV table: pvTable[ply] holds the best line found from that ply
+  uint16_t pvTable[SEARCH_MAX_PLY][SEARCH_MAX_PLY];
+  uint8_t pvLength[SEARCH_MAX_PLY];
+
+  // Hashes along the current search path for repetition detection
+  uint64_t pathHash[SEARCH_MAX_PLY];
+
+  // Root moves ordered by the previous iteration's scores
+  uint16_t rootMoves[SEARCH_MAX_MOVES];
+  int rootScores[SEARCH_MAX_MOVES];
+  int rootMoveCount;
+
+  int negamax(int depth, int alpha, int beta, int ply);
+  int quiescence(int alpha, int beta, int ply);
+
+  int generateMoves(uint16_t moves[], bool capturesOnly);
+  void orderMoves(uint16_t moves[], int count, uint16_t ttMove) const;
+  int moveOrderScore(uint16_t move) const;
+  bool isCapture(uint16_t move) const;
+
+  void makeMove(uint16_t move, UndoState& undo);
+  void unmakeMove(const UndoState& undo);
+
+  bool probeTable(uint64_t hash, int depth, int ply, int alpha, int beta, int& score, uint16_t& move) const;
+  void storeTable(uint64_t hash, int depth, int ply, int score, uint8_t flag, uint16_t move);
+
+  bool pollStop();
+  bool isRepetition(uint64_t hash, int ply) const;
+  int evaluateSideToMove() const;
+};
+
+#endif // CHESS_SEARCH_H
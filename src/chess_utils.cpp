@@ -40,7 +40,8 @@ uint8_t ChessUtils::castlingRightsFromString(const String& rightsStr) {
 }
 
 String ChessUtils::boardToFEN(const char board[8][8], char currentTurn, ChessEngine* chessEngine) {
-  String fen = "";
+  String fen;
+  fen.reserve(90); // Longest legal FEN: one allocation instead of regrowing per field
 
   // Board position - FEN expects rank 8 (Black pieces) first, rank 1 (White pieces) last
   // Our array: row 0 = rank 8 (Black), row 7 = rank 1 (White)
@@ -52,49 +53,56 @@ String ChessUtils::boardToFEN(const char board[8][8], char currentTurn, ChessEng
         emptyCount++;
       } else {
         if (emptyCount > 0) {
-          fen += String(emptyCount);
+          fen += (char)('0' + emptyCount);
           emptyCount = 0;
         }
         fen += board[row][col];
       }
     if (emptyCount > 0)
-      fen += String(emptyCount);
+      fen += (char)('0' + emptyCount);
     if (row < 7)
-      fen += "/";
+      fen += '/';
   }
 
   // Active color
-  fen += " " + String(currentTurn);
+  fen += ' ';
+  fen += currentTurn;
 
   // Castling availability
-  if (chessEngine != nullptr)
-    fen += " " + ChessUtils::castlingRightsToString(chessEngine->getCastlingRights());
-  else
+  if (chessEngine != nullptr) {
+    fen += ' ';
+    fen += ChessUtils::castlingRightsToString(chessEngine->getCastlingRights());
+  } else {
     fen += " KQkq";
+  }
 
   // En passant target square
   if (chessEngine != nullptr && chessEngine->hasEnPassantTarget()) {
     int epRow, epCol;
     chessEngine->getEnPassantTarget(epRow, epCol);
     // Convert row/col to algebraic notation (e.g., e3, e6)
-    char file = 'a' + epCol;
-    int rank = 8 - epRow;
-    fen += " " + String(file) + String(rank);
+    fen += ' ';
+    fen += (char)('a' + epCol);
+    fen += (char)('0' + (8 - epRow));
   } else {
     fen += " -";
   }
 
   // Halfmove clock
-  if (chessEngine != nullptr)
-    fen += " " + String(chessEngine->getHalfmoveClock());
-  else
+  if (chessEngine != nullptr) {
+    fen += ' ';
+    fen += chessEngine->getHalfmoveClock();
+  } else {
     fen += " 0";
+  }
 
   // Fullmove number
-  if (chessEngine != nullptr)
-    fen += " " + String(chessEngine->getFullmoveClock());
-  else
+  if (chessEngine != nullptr) {
+    fen += ' ';
+    fen += chessEngine->getFullmoveClock();
+  } else {
     fen += " 1";
+  }
 
   return fen;
 }
@@ -0,0 +1,50 @@
+#include "cooperative_wait.h"
+#include <esp_timer.h>
+
+CooperativeWait::CooperativeWait()
+    : registeredService(nullptr), serviceContext(nullptr), inService(false), lastTickUs(0), ticks(0), totalGapUs(0), maxGapUs(0), totalServiceUs(0), maxServiceUs(0) {}
+
+void CooperativeWait::setService(Service service, void* context) {
+  registeredService = service;
+  serviceContext = context;
+}
+
+void CooperativeWait::service() {
+  if (!registeredService || inService)
+    return;
+  inService = true;
+  int64_t start = esp_timer_get_time();
+  if (lastTickUs != 0) {
+    uint32_t gap = (uint32_t)(start - lastTickUs);
+    totalGapUs += gap;
+    maxGapUs = max(maxGapUs, gap);
+  }
+  registeredService(serviceContext);
+  int64_t end = esp_timer_get_time();
+  uint32_t elapsed = (uint32_t)(end - start);
+  ticks++;
+  totalServiceUs += elapsed;
+  maxServiceUs = max(maxServiceUs, elapsed);
+  lastTickUs = end;
+  inService = false;
+}
+
+void CooperativeWait::sleep(uint32_t ms) {
+  service();
+  delay(ms);
+}
+
+void CooperativeWait::reset() {
+  lastTickUs = 0;
+  ticks = 0;
+  totalGapUs = totalServiceUs = 0;
+  maxGapUs = maxServiceUs = 0;
+}
+
+void CooperativeWait::snapshot(CooperativeWaitStats& out) const {
+  out.ticks = ticks;
+  out.avgGapUs = ticks > 1 ? (uint32_t)(totalGapUs / (ticks - 1)) : 0;
+  out.maxGapUs = maxGapUs;
+  out.avgServiceUs = ticks > 0 ? (uint32_t)(totalServiceUs / ticks) : 0;
+  out.maxServiceUs = maxServiceUs;
+}
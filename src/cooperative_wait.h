@@ -0,0 +1,58 @@
+#ifndef COOPERATIVE_WAIT_H
+#define COOPERATIVE_WAIT_H
+
+#include <Arduino.h>
+
+// ---------------------------
+// Cooperative Waits
+// ---------------------------
+// Game modes wait for the player inside blocking loops (piece placement,
+// board setup, menu selection, castling prompts, remote replies). Those loops
+// call sleep() on their board's CooperativeWait (BoardDriver::cooperativeWait())
+// instead of delay(), which first runs the background service registered by main.cpp (WiFi reconnection, web resign
+// relay), so the board stays responsive while a mode is blocked on the
+// player. loop() runs the same service once per pass.
+//
+// The service only touches state that is safe to change mid-move; board edits
+// from the web still wait for loop(), since they replace the board a blocked
+// move is working on.
+
+struct CooperativeWaitStats {
+  uint32_t ticks;        // Service runs since reset
+  uint32_t avgGapUs;     // Time between consecutive service runs
+  uint32_t maxGapUs;
+  uint32_t avgServiceUs; // Time spent in the service itself
+  uint32_t maxServiceUs;
+};
+
+/// One per board, owned by its BoardDriver, which every waiting mode already holds.
+/// Called from the game loop task only.
+class CooperativeWait {
+ public:
+  using Service = void (*)(void* context);
+
+  CooperativeWait();
+
+  void setService(Service service, void* context);
+  /// Run the background service now (skipped if it is already running).
+  void service();
+  /// Run the service, then delay for `ms`. Use in place of delay() in wait loops.
+  void sleep(uint32_t ms);
+
+  void reset();
+  void snapshot(CooperativeWaitStats& out) const;
+
+ private:
+  Service registeredService;
+  void* serviceContext;
+  bool inService;
+
+  int64_t lastTickUs;
+  uint32_t ticks;
+  uint64_t totalGapUs;
+  uint32_t maxGapUs;
+  uint64_t totalServiceUs;
+  uint32_t maxServiceUs;
+};
+
+#endif // COOPERATIVE_WAIT_H
@@ -0,0 +1,87 @@
+#include "eco_trie.h"
+#include "move_history.h"
+#include <string.h>
+
+EcoTrie::EcoTrie() : loaded(false) {
+  memset(&header, 0, sizeof(header));
+}
+
+EcoTrie::~EcoTrie() {
+  end();
+}
+
+static bool isValidHeader(const EcoTrieHeader& h, size_t fileSize) {
+  if (memcmp(h.magic, "OCEC", 4) != 0 || h.version != ECO_TRIE_VERSION || h.nodeSize != sizeof(EcoNode) || h.nodeCount == 0)
+    return false;
+  return fileSize == sizeof(EcoTrieHeader) + (size_t)h.nodeCount * sizeof(EcoNode);
+}
+
+bool EcoTrie::validateFile(File& f, uint32_t& lineCount) {
+  EcoTrieHeader h;
+  if (!f.seek(0) || f.read((uint8_t*)&h, sizeof(h)) != sizeof(h) || !isValidHeader(h, f.size()))
+    return false;
+  lineCount = h.lineCount;
+  return true;
+}
+
+bool EcoTrie::begin(const char* path) {
+  end();
+  // Optional: without a table games are stored unclassified
+  if (!MoveHistory::quietExists(path))
+    return false;
+  file = LittleFS.open(path, "r");
+  if (!file)
+    return false;
+  if (file.read((uint8_t*)&header, sizeof(header)) != sizeof(header) || !isValidHeader(header, file.size())) {
+    Serial.println("ECO table header is invalid");
+    file.close();
+    return false;
+  }
+  loaded = true;
+  return true;
+}
+
+void EcoTrie::end() {
+  if (file)
+    file.close();
+  loaded = false;
+}
+
+bool EcoTrie::root(EcoNode& out) {
+  if (!loaded || !file.seek(sizeof(EcoTrieHeader)))
+    return false;
+  return file.read((uint8_t*)&out, sizeof(EcoNode)) == sizeof(EcoNode);
+}
+
+bool EcoTrie::child(const EcoNode& parent, uint16_t move, EcoNode& out) {
+  if (!loaded || parent.childCount == 0 || parent.firstChild + parent.childCount > header.nodeCount)
+    return false;
+  // Children are contiguous: one seek, then sequential reads until the move matches
+  if (!file.seek(sizeof(EcoTrieHeader) + parent.firstChild * sizeof(EcoNode)))
+    return false;
+  for (uint8_t i = 0; i < parent.childCount; i++) {
+    if (file.read((uint8_t*)&out, sizeof(EcoNode)) != sizeof(EcoNode))
+      return false;
+    if (out.move == move)
+      return true;
+  }
+  return false;
+}
+
+uint16_t EcoTrie::encode(const char* eco) {
+  if (!eco || eco[0] < 'A' || eco[0] > 'E' || !isdigit(eco[1]) || !isdigit(eco[2]))
+    return 0;
+  return (uint16_t)(1 + (eco[0] - 'A') * 100 + (eco[1] - '0') * 10 + (eco[2] - '0'));
+}
+
+void EcoTrie::format(uint16_t code, char out[4]) {
+  if (code == 0 || code > 500) {
+    out[0] = '\0';
+    return;
+  }
+  code--;
+  out[0] = (char)('A' + code / 100);
+  out[1] = (char)('0' + (code % 100) / 10);
+  out[2] = (char)('0' + code % 10);
+  out[3] = '\0';
+}
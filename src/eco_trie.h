@@ -0,0 +1,79 @@
+#ifndef ECO_TRIE_H
+#define ECO_TRIE_H
+
+#include <Arduino.h>
+#include <LittleFS.h>
+
+// ---------------------------
+// ECO Trie Format
+// ---------------------------
+// Compiled on a computer by tools/eco_trie.py from the Lichess
+// chess-openings tables (ECO code, name, SAN moves). All integers are
+// little-endian. Layout:
+//   EcoTrieHeader                      16 bytes
+//   EcoNode[nodeCount]                 12 bytes each, breadth-first
+// Same shape as the opening trainer's trie (opening_trie.h): node 0 is the
+// starting position and every node's children are one contiguous run. A node
+// where a named opening line ends carries its ECO code; a game is classified
+// by the deepest coded node its moves reach.
+
+static constexpr const char* ECO_TRIE_PATH = "/eco.bin";
+static constexpr const char* ECO_TRIE_TEMP_PATH = "/eco.tmp"; // Upload target until validated
+static constexpr uint8_t ECO_TRIE_VERSION = 1;
+static constexpr uint8_t ECO_MAX_DEPTH = 40; // Plies per line kept by the compiler
+
+struct __attribute__((packed)) EcoTrieHeader {
+  char magic[4];      // "OCEC"
+  uint8_t version;    // ECO_TRIE_VERSION
+  uint8_t nodeSize;   // sizeof(EcoNode), checked on load
+  uint8_t maxDepth;   // Longest line in plies
+  uint8_t reserved;
+  uint32_t nodeCount; // Including the root
+  uint32_t lineCount; // Named opening lines
+};
+static_assert(sizeof(EcoTrieHeader) == 16, "EcoTrieHeader must be 16 bytes");
+
+struct __attribute__((packed)) EcoNode {
+  uint16_t move;       // MoveHistory::encodeMove code of the move leading here (0 for the root)
+  uint16_t eco;        // EcoTrie::encode() code of the line ending here, 0 if none
+  uint8_t childCount;
+  uint8_t reserved;
+  uint16_t reserved2;
+  uint32_t firstChild; // Index of the first child (meaningless when childCount == 0)
+};
+static_assert(sizeof(EcoNode) == 12, "EcoNode must be 12 bytes");
+
+// ---------------------------
+// ECO Trie Reader
+// ---------------------------
+/// Like OpeningTrie, reads nodes on demand from the open file. Used by
+/// MoveHistory to classify a game as it is saved.
+class EcoTrie {
+ public:
+  EcoTrie();
+  ~EcoTrie();
+
+  /// Open the table and check its header. Returns false if missing or malformed.
+  bool begin(const char* path = ECO_TRIE_PATH);
+  void end();
+  bool isLoaded() const { return loaded; }
+
+  bool root(EcoNode& out);
+  /// Find the child of `parent` reached by `move`. Returns false if the table has no such line.
+  bool child(const EcoNode& parent, uint16_t move, EcoNode& out);
+
+  /// Validate an ECO table file (used by the upload endpoint before replacing the table).
+  static bool validateFile(File& file, uint32_t& lineCount);
+
+  /// "B90" <-> code (1 + letter * 100 + number), 0 for none.
+  static uint16_t encode(const char* eco);
+  /// Writes "" for code 0. `out` holds at least 4 chars.
+  static void format(uint16_t code, char out[4]);
+
+ private:
+  File file;
+  bool loaded;
+  EcoTrieHeader header;
+};
+
+#endif // ECO_TRIE_H
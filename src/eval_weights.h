@@ -0,0 +1,77 @@
+#ifndef EVAL_WEIGHTS_H
+#define EVAL_WEIGHTS_H
+
+#include <stdint.h>
+
+// ---------------------------
+// Evaluation Weights
+// ---------------------------
+// Material and piece-square tables used by ChessSearch::evaluate(), in
+// centipawns. This file is regenerated by tools/texel_tune.py, which fits the
+// weights to game results; keep the layout below so the tool can read the
+// current values back as its starting point.
+//
+// Source: hand-tuned defaults
+
+// Material values, indexed by "PNBRQK" order (the king is never traded, so it stays 0)
+static constexpr int16_t EVAL_PIECE_VALUES[6] = {100, 320, 330, 500, 900, 0};
+
+// Piece-square tables from White's point of view, [row][col] with row 0 = rank 8
+// (same orientation as the board array). Black pieces read the table mirrored (7 - row).
+static constexpr int16_t EVAL_PST[6][8][8] = {
+    // Pawn
+    {{0, 0, 0, 0, 0, 0, 0, 0},
+     {50, 50, 50, 50, 50, 50, 50, 50},
+     {10, 10, 20, 30, 30, 20, 10, 10},
+     {5, 5, 10, 25, 25, 10, 5, 5},
+     {0, 0, 0, 20, 20, 0, 0, 0},
+     {5, -5, -10, 0, 0, -10, -5, 5},
+     {5, 10, 10, -20, -20, 10, 10, 5},
+     {0, 0, 0, 0, 0, 0, 0, 0}},
+    // Knight
+    {{-50, -40, -30, -30, -30, -30, -40, -50},
+     {-40, -20, 0, 0, 0, 0, -20, -40},
+     {-30, 0, 10, 15, 15, 10, 0, -30},
+     {-30, 5, 15, 20, 20, 15, 5, -30},
+     {-30, 0, 15, 20, 20, 15, 0, -30},
+     {-30, 5, 10, 15, 15, 10, 5, -30},
+     {-40, -20, 0, 5, 5, 0, -20, -40},
+     {-50, -40, -30, -30, -30, -30, -40, -50}},
+    // Bishop
+    {{-20, -10, -10, -10, -10, -10, -10, -20},
+     {-10, 0, 0, 0, 0, 0, 0, -10},
+     {-10, 0, 5, 10, 10, 5, 0, -10},
+     {-10, 5, 5, 10, 10, 5, 5, -10},
+     {-10, 0, 10, 10, 10, 10, 0, -10},
+     {-10, 10, 10, 10, 10, 10, 10, -10},
+     {-10, 5, 0, 0, 0, 0, 5, -10},
+     {-20, -10, -10, -10, -10, -10, -10, -20}},
+    // Rook
+    {{0, 0, 0, 0, 0, 0, 0, 0},
+     {5, 10, 10, 10, 10, 10, 10, 5},
+     {-5, 0, 0, 0, 0, 0, 0, -5},
+     {-5, 0, 0, 0, 0, 0, 0, -5},
+     {-5, 0, 0, 0, 0, 0, 0, -5},
+     {-5, 0, 0, 0, 0, 0, 0, -5},
+     {-5, 0, 0, 0, 0, 0, 0, -5},
+     {0, 0, 0, 5, 5, 0, 0, 0}},
+    // Queen
+    {{-20, -10, -10, -5, -5, -10, -10, -20},
+     {-10, 0, 0, 0, 0, 0, 0, -10},
+     {-10, 0, 5, 5, 5, 5, 0, -10},
+     {-5, 0, 5, 5, 5, 5, 0, -5},
+     {0, 0, 5, 5, 5, 5, 0, -5},
+     {-10, 5, 5, 5, 5, 5, 0, -10},
+     {-10, 0, 5, 0, 0, 0, 0, -10},
+     {-20, -10, -10, -5, -5, -10, -10, -20}},
+    // King (middlegame: stay castled)
+    {{-30, -40, -40, -50, -50, -40, -40, -30},
+     {-30, -40, -40, -50, -50, -40, -40, -30},
+     {-30, -40, -40, -50, -50, -40, -40, -30},
+     {-30, -40, -40, -50, -50, -40, -40, -30},
+     {-20, -30, -30, -40, -40, -30, -30, -20},
+     {-10, -20, -20, -20, -20, -20, -20, -10},
+     {20, 20, 0, 0, 0, 0, 20, 20},
+     {20, 30, 10, 0, 0, 10, 30, 20}}};
+
+#endif // EVAL_WEIGHTS_H
@@ -0,0 +1,63 @@
+#include "game_arena.h"
+#include <stdlib.h>
+
+GameArena::GameArena() : storage(nullptr), capacity(0), used(0), highWater(0), resets(0), fallbacks(0) {}
+
+void GameArena::begin(uint8_t* buffer, size_t size) {
+  storage = buffer;
+  capacity = size;
+  used = 0;
+}
+
+void GameArena::reset() {
+  used = 0;
+  resets++;
+}
+
+void* GameArena::allocate(size_t size) {
+  size_t offset = (used + GAME_ARENA_ALIGN - 1) & ~(GAME_ARENA_ALIGN - 1);
+  if (!storage || size > capacity || offset > capacity - size)
+    return nullptr;
+  used = offset + size;
+  if (used > highWater)
+    highWater = used;
+  return storage + offset;
+}
+
+bool GameArena::contains(const void* p) const {
+  const uint8_t* byte = static_cast<const uint8_t*>(p);
+  return storage && byte >= storage && byte < storage + capacity;
+}
+
+void GameArena::release(size_t mark) {
+  if (mark < used)
+    used = mark;
+}
+
+void GameArena::snapshot(GameArenaStats& out) const {
+  out.capacity = capacity;
+  out.used = used;
+  out.highWater = highWater;
+  out.resets = resets;
+  out.fallbacks = fallbacks;
+}
+
+// ---------------------------
+// ArenaScratch
+// ---------------------------
+
+ArenaScratch::~ArenaScratch() {
+  free(heapBlock);
+  if (arena)
+    arena->release(start);
+}
+
+void* ArenaScratch::allocate(size_t size) {
+  void* p = arena ? arena->allocate(size) : nullptr;
+  if (p || heapBlock)
+    return p;
+  if (arena)
+    arena->noteFallback();
+  heapBlock = malloc(size);
+  return heapBlock;
+}
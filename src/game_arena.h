@@ -0,0 +1,105 @@
+#ifndef GAME_ARENA_H
+#define GAME_ARENA_H
+
+#include <Arduino.h>
+#include <new>
+#include <utility>
+
+// ---------------------------
+// Per-Game Arena
+// ---------------------------
+// Game-mode objects and per-game scratch buffers live in one static block
+// instead of the heap. A game session used to leave the heap with a hole
+// the size of its mode object plus whatever move-history buffers it had
+// churned through; over a long session that fragments the heap TLS needs
+// for its large contiguous record buffers. The arena is bump-allocated and
+// rewound in one step when the next mode starts, so nothing per-game is
+// ever freed back into the heap.
+//
+// Scratch buffers use ArenaScratch: allocations made through it are rewound
+// when it goes out of scope. Requests that don't fit fall back to the heap
+// and are counted, so an undersized arena shows up in GET /debug/heap.
+
+static constexpr size_t GAME_ARENA_SCRATCH_BYTES = 4096; // On top of the largest mode object (see main.cpp)
+static constexpr size_t GAME_ARENA_ALIGN = 8;
+
+struct GameArenaStats {
+  uint32_t capacity;
+  uint32_t used;
+  uint32_t highWater;   // Most bytes in use at once since boot
+  uint32_t resets;      // Mode starts
+  uint32_t fallbacks;   // Requests served by the heap because the arena was full
+};
+
+/// One per board, for its one active game mode: main.cpp owns it and hands it to
+/// MoveHistory for scratch. Used from the loop task only.
+class GameArena {
+ public:
+  GameArena();
+
+  /// Hand the arena its storage (a static buffer in main.cpp sized for the largest mode).
+  void begin(uint8_t* buffer, size_t size);
+  /// Rewind to empty. Every object created in the arena must have been destroyed first.
+  void reset();
+
+  /// Bump-allocate `size` bytes, or nullptr if the arena is full.
+  void* allocate(size_t size);
+  bool contains(const void* p) const;
+
+  /// Current fill level, to rewind to with release().
+  size_t mark() const { return used; }
+  void release(size_t mark);
+  void noteFallback() { fallbacks++; }
+
+  void snapshot(GameArenaStats& out) const;
+
+  /// Construct a T in the arena, or on the heap if it doesn't fit.
+  template <typename T, typename... Args>
+  T* create(Args&&... args) {
+    void* p = allocate(sizeof(T));
+    if (p)
+      return new (p) T(std::forward<Args>(args)...);
+    noteFallback();
+    return new T(std::forward<Args>(args)...);
+  }
+
+  /// Destroy an object from create(). Its arena bytes are reclaimed by the next reset().
+  template <typename T>
+  void destroy(T* obj) {
+    if (!obj)
+      return;
+    if (contains(obj))
+      obj->~T();
+    else
+      delete obj;
+  }
+
+ private:
+  uint8_t* storage;
+  size_t capacity;
+  size_t used;
+  size_t highWater;  // Most bytes in use at once since boot
+  uint32_t resets;
+  uint32_t fallbacks;
+};
+
+/// Scoped scratch memory from `arena`, rewound on destruction. At most one
+/// request per scope may fall back to the heap, which serves it outright if
+/// there is no arena.
+class ArenaScratch {
+ public:
+  explicit ArenaScratch(GameArena* arena) : arena(arena), start(arena ? arena->mark() : 0), heapBlock(nullptr) {}
+  ~ArenaScratch();
+  ArenaScratch(const ArenaScratch&) = delete;
+  ArenaScratch& operator=(const ArenaScratch&) = delete;
+
+  /// `size` bytes valid until this scope ends, or nullptr if neither the arena nor the heap has them.
+  void* allocate(size_t size);
+
+ private:
+  GameArena* arena;
+  size_t start;
+  void* heapBlock;
+};
+
+#endif // GAME_ARENA_H
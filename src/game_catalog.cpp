@@ -0,0 +1,282 @@
+#include "game_catalog.h"
+#include "eco_trie.h"
+#include "logger.h"
+#include "move_history.h"
+#include <algorithm>
+#include <string.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+static constexpr TickType_t QUERY_WAIT_TICKS = pdMS_TO_TICKS(1000); // A rewrite copies at most a few KB
+
+static bool readFileHeader(File& f, const char* magic, uint8_t recordSize, CatalogFileHeader& hdr) {
+  if (!f || f.read((uint8_t*)&hdr, sizeof(hdr)) != sizeof(hdr))
+    return false;
+  return memcmp(hdr.magic, magic, 4) == 0 && hdr.version == CATALOG_VERSION && hdr.recordSize == recordSize && f.size() >= sizeof(hdr) + (size_t)hdr.count * recordSize;
+}
+
+static void fillFileHeader(CatalogFileHeader& hdr, const char* magic, uint8_t recordSize, uint32_t count, uint32_t sequence) {
+  memcpy(hdr.magic, magic, 4);
+  hdr.version = CATALOG_VERSION;
+  hdr.recordSize = recordSize;
+  hdr.reserved = 0;
+  hdr.count = count;
+  hdr.sequence = sequence;
+}
+
+// Read summaries sequentially, CATALOG_COPY_CHUNK at a time. Returns false if the file is unreadable.
+static bool forEachSummary(const std::function<void(const GameSummary&)>& fn) {
+  if (!MoveHistory::quietExists(CATALOG_SUMMARY_PATH))
+    return true; // No games saved yet
+  File f = LittleFS.open(CATALOG_SUMMARY_PATH, "r");
+  CatalogFileHeader hdr;
+  if (!readFileHeader(f, "OCGS", sizeof(GameSummary), hdr)) {
+    if (f) f.close();
+    return false;
+  }
+  GameSummary chunk[CATALOG_COPY_CHUNK];
+  uint32_t left = hdr.count;
+  while (left > 0) {
+    size_t want = std::min((size_t)left, CATALOG_COPY_CHUNK);
+    if (f.read((uint8_t*)chunk, want * sizeof(GameSummary)) != want * sizeof(GameSummary))
+      break;
+    for (size_t i = 0; i < want; i++)
+      fn(chunk[i]);
+    left -= want;
+  }
+  f.close();
+  return left == 0;
+}
+
+bool CatalogFilter::matches(const GameSummary& s) const {
+  if (mode && s.mode != mode) return false;
+  if (result && s.result != result) return false;
+  if (winnerColor && s.winnerColor != winnerColor) return false;
+  if (playerColor && s.playerColor != playerColor) return false;
+  if (botDepth && s.botDepth != botDepth) return false;
+  if (minPlies && s.plies < minPlies) return false;
+  if (maxPlies && s.plies > maxPlies) return false;
+  if (ecoPrefix[0]) {
+    char eco[4];
+    EcoTrie::format(s.eco, eco);
+    if (strncmp(eco, ecoPrefix, strlen(ecoPrefix)) != 0) return false;
+  }
+  return true;
+}
+
+GameCatalog::GameCatalog() : mutex(xSemaphoreCreateMutex()), loaded(false), sequence(0) {
+  memset(&stats, 0, sizeof(stats));
+}
+
+void GameCatalog::begin() {
+  xSemaphoreTake(mutex, portMAX_DELAY);
+  // A rewrite writes summary.tmp and then replaces summary.bin with it. If power
+  // was lost in between, finish the rename, or drop the temp if summary.bin survived.
+  if (MoveHistory::quietExists(CATALOG_SUMMARY_TEMP_PATH)) {
+    if (MoveHistory::quietExists(CATALOG_SUMMARY_PATH))
+      LittleFS.remove(CATALOG_SUMMARY_TEMP_PATH);
+    else
+      LittleFS.rename(CATALOG_SUMMARY_TEMP_PATH, CATALOG_SUMMARY_PATH);
+  }
+
+  sequence = 0;
+  uint32_t count = 0;
+  if (MoveHistory::quietExists(CATALOG_SUMMARY_PATH)) {
+    File f = LittleFS.open(CATALOG_SUMMARY_PATH, "r");
+    CatalogFileHeader hdr;
+    bool ok = readFileHeader(f, "OCGS", sizeof(GameSummary), hdr);
+    if (f) f.close();
+    if (ok) {
+      sequence = hdr.sequence;
+      count = hdr.count;
+    } else {
+      LOG_ERROR("GameCatalog: dropping unreadable summary file");
+      LittleFS.remove(CATALOG_SUMMARY_PATH);
+    }
+  }
+
+  bool statsRead = false;
+  if (MoveHistory::quietExists(CATALOG_STATS_PATH)) {
+    File f = LittleFS.open(CATALOG_STATS_PATH, "r");
+    CatalogFileHeader hdr;
+    statsRead = readFileHeader(f, "OCGT", sizeof(CatalogStats), hdr) && hdr.count == 1 && hdr.sequence == sequence && f.read((uint8_t*)&stats, sizeof(stats)) == sizeof(stats);
+    if (f) f.close();
+  }
+  if (!statsRead) {
+    memset(&stats, 0, sizeof(stats));
+    forEachSummary([this](const GameSummary& s) { accumulate(s, 1); });
+    saveStats();
+    LOG_INFO("GameCatalog: stats rebuilt from %u summaries", count);
+  }
+  LOG_INFO("GameCatalog: %u games summarized", count);
+  loaded.store(true);
+  xSemaphoreGive(mutex);
+}
+
+std::vector<int> GameCatalog::gameIds() {
+  std::vector<int> ids;
+  xSemaphoreTake(mutex, portMAX_DELAY);
+  forEachSummary([&ids](const GameSummary& s) { ids.push_back(s.gameId); });
+  xSemaphoreGive(mutex);
+  return ids;
+}
+
+// sign is +1 to count a game in, -1 to take it back out
+void GameCatalog::accumulate(const GameSummary& s, int sign) {
+  stats.games += sign;
+  stats.plies += sign * (int)s.plies;
+  if (s.result < 7)
+    stats.byResult[s.result] += sign;
+
+  auto addColor = [sign](ColorResults& r, uint8_t winner) {
+    if (winner == 'w')
+      r.white += sign;
+    else if (winner == 'b')
+      r.black += sign;
+    else
+      r.draws += sign;
+  };
+  if (s.mode == GAME_MODE_CHESS_MOVES || s.mode == GAME_MODE_BOT)
+    addColor(stats.byMode[s.mode - 1], s.winnerColor);
+  int volume = s.eco ? (s.eco - 1) / 100 : CATALOG_ECO_VOLUMES - 1;
+  addColor(stats.byEcoVolume[volume], s.winnerColor);
+
+  if (s.mode == GAME_MODE_BOT && (s.playerColor == 'w' || s.playerColor == 'b')) {
+    auto addPlayer = [sign, &s](PlayerResults& r) {
+      if (s.winnerColor == s.playerColor)
+        r.wins += sign;
+      else if (s.winnerColor == 'w' || s.winnerColor == 'b')
+        r.losses += sign;
+      else
+        r.draws += sign;
+    };
+    addPlayer(s.playerColor == 'w' ? stats.botAsWhite : stats.botAsBlack);
+    addPlayer(stats.botByDepth[std::min(s.botDepth, CATALOG_MAX_BOT_DEPTH)]);
+  }
+}
+
+void GameCatalog::saveStats() {
+  File f = LittleFS.open(CATALOG_STATS_PATH, "w");
+  if (!f) {
+    LOG_ERROR("GameCatalog: failed to write stats");
+    return;
+  }
+  CatalogFileHeader hdr;
+  fillFileHeader(hdr, "OCGT", sizeof(CatalogStats), 1, sequence);
+  f.write((const uint8_t*)&hdr, sizeof(hdr));
+  f.write((const uint8_t*)&stats, sizeof(stats));
+  f.close();
+}
+
+// Copy the summaries to the temp file without `gameId`, inserting `insert` (if
+// any) in id order, then replace the summary file. `old` receives the dropped summary.
+bool GameCatalog::rewrite(uint16_t gameId, const GameSummary* insert, GameSummary& old, bool& hadOld) {
+  hadOld = false;
+  File out = LittleFS.open(CATALOG_SUMMARY_TEMP_PATH, "w");
+  if (!out) {
+    LOG_ERROR("GameCatalog: failed to create %s", CATALOG_SUMMARY_TEMP_PATH);
+    return false;
+  }
+  CatalogFileHeader hdr;
+  fillFileHeader(hdr, "OCGS", sizeof(GameSummary), 0, sequence);
+  out.write((const uint8_t*)&hdr, sizeof(hdr)); // Count patched below
+
+  uint32_t count = 0;
+  bool inserted = (insert == nullptr);
+  bool ok = true;
+  auto put = [&out, &count, &ok](const GameSummary& s) {
+    if (out.write((const uint8_t*)&s, sizeof(s)) != sizeof(s))
+      ok = false;
+    count++;
+  };
+  bool readOk = forEachSummary([&](const GameSummary& s) {
+    if (!inserted && s.gameId > insert->gameId) {
+      put(*insert);
+      inserted = true;
+    }
+    if (s.gameId == gameId) {
+      old = s;
+      hadOld = true;
+      return;
+    }
+    put(s);
+  });
+  if (!inserted)
+    put(*insert);
+
+  sequence++;
+  fillFileHeader(hdr, "OCGS", sizeof(GameSummary), count, sequence);
+  out.seek(0);
+  out.write((const uint8_t*)&hdr, sizeof(hdr));
+  out.close();
+  if (!ok) {
+    // Out of flash: keep the old file, whose stats are still the ones in RAM
+    LOG_ERROR("GameCatalog: failed to rewrite the summaries");
+    LittleFS.remove(CATALOG_SUMMARY_TEMP_PATH);
+    sequence--;
+    return false;
+  }
+  if (!readOk)
+    LOG_ERROR("GameCatalog: summary file was unreadable, rewritten from what was read");
+
+  if (MoveHistory::quietExists(CATALOG_SUMMARY_PATH))
+    LittleFS.remove(CATALOG_SUMMARY_PATH);
+  LittleFS.rename(CATALOG_SUMMARY_TEMP_PATH, CATALOG_SUMMARY_PATH);
+  return true;
+}
+
+bool GameCatalog::add(const GameSummary& s) {
+  if (!loaded.load())
+    return false;
+  xSemaphoreTake(mutex, portMAX_DELAY);
+  GameSummary old;
+  bool hadOld;
+  bool ok = rewrite(s.gameId, &s, old, hadOld);
+  if (ok) {
+    if (hadOld)
+      accumulate(old, -1); // A reused id whose old game was deleted before the catalog heard of it
+    accumulate(s, 1);
+    saveStats();
+  }
+  xSemaphoreGive(mutex);
+  return ok;
+}
+
+bool GameCatalog::remove(uint16_t gameId) {
+  if (!loaded.load())
+    return false; // MoveHistory drops the summaries of missing games once the catalog is loaded
+  xSemaphoreTake(mutex, portMAX_DELAY);
+  GameSummary old;
+  bool hadOld;
+  bool ok = rewrite(gameId, nullptr, old, hadOld);
+  if (ok) {
+    if (hadOld)
+      accumulate(old, -1);
+    saveStats(); // Even unchanged: the stats carry the new file sequence
+  }
+  xSemaphoreGive(mutex);
+  return ok && hadOld;
+}
+
+int GameCatalog::query(const CatalogFilter& filter, uint16_t offset, uint16_t limit, const std::function<void(const GameSummary&)>& visit) {
+  if (!loaded.load() || xSemaphoreTake(mutex, QUERY_WAIT_TICKS) != pdTRUE)
+    return -1;
+  int total = 0;
+  forEachSummary([&](const GameSummary& s) {
+    if (!filter.matches(s))
+      return;
+    if (total >= offset && total - offset < limit)
+      visit(s);
+    total++;
+  });
+  xSemaphoreGive(mutex);
+  return total;
+}
+
+bool GameCatalog::getStats(CatalogStats& out) {
+  if (!loaded.load() || xSemaphoreTake(mutex, QUERY_WAIT_TICKS) != pdTRUE)
+    return false;
+  out = stats;
+  xSemaphoreGive(mutex);
+  return true;
+}
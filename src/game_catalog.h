@@ -0,0 +1,138 @@
+#ifndef GAME_CATALOG_H
+#define GAME_CATALOG_H
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <functional>
+#include <vector>
+
+// ---------------------------
+// Game Catalog Format
+// ---------------------------
+// Per-game metadata computed once when a game is saved, so listing, filtering
+// and statistics don't open every game file. Written on the board by
+// MoveHistory::finishGame(). All integers are little-endian.
+//   /games/summary.bin: CatalogFileHeader, then GameSummary[count] sorted by id
+//   /games/stats.bin:   CatalogFileHeader, then CatalogStats
+// The stats are running totals: adding a summary adds it in, removing one
+// takes it out. If the stats file is lost, or power failed between the two
+// writes, they are summed from the summaries again.
+
+static constexpr const char* CATALOG_SUMMARY_PATH = "/games/summary.bin";
+static constexpr const char* CATALOG_SUMMARY_TEMP_PATH = "/games/summary.tmp";
+static constexpr const char* CATALOG_STATS_PATH = "/games/stats.bin";
+static constexpr uint8_t CATALOG_VERSION = 1;
+static constexpr uint8_t CATALOG_MAX_BOT_DEPTH = 20; // Deeper bot games are counted at this depth
+static constexpr uint8_t CATALOG_ECO_VOLUMES = 6;    // A-E, then unclassified
+static constexpr size_t CATALOG_COPY_CHUNK = 16;     // Summaries buffered while rewriting (384 bytes)
+
+struct __attribute__((packed)) CatalogFileHeader {
+  char magic[4];       // "OCGS" (summaries) or "OCGT" (stats)
+  uint8_t version;     // CATALOG_VERSION
+  uint8_t recordSize;  // sizeof(GameSummary) or sizeof(CatalogStats), checked on load
+  uint16_t reserved;
+  uint32_t count;      // Summaries (1 for the stats file)
+  uint32_t sequence;   // Bumped by every summary rewrite; stats with another value are stale
+};
+static_assert(sizeof(CatalogFileHeader) == 16, "CatalogFileHeader must be 16 bytes");
+
+struct __attribute__((packed)) GameSummary {
+  uint16_t gameId;
+  uint8_t mode;           // GameModeCode
+  uint8_t result;         // GameResult
+  uint8_t winnerColor;    // 'w', 'b', 'd'
+  uint8_t playerColor;    // Bot games: human's color, '?' otherwise
+  uint8_t botDepth;
+  uint8_t clockIncrement; // Seconds (capped at 255), 0 if untimed
+  uint16_t moveCount;     // As in GameHeader (incl. FEN markers)
+  uint16_t plies;         // Moves actually played
+  uint16_t eco;           // EcoTrie::encode() code, 0 if unclassified
+  uint16_t clockBase;     // Seconds per side, 0 if untimed
+  int8_t materialMin;     // Lowest and highest material balance reached, in pawns,
+  int8_t materialMax;     // from White's point of view (P=1, N=B=3, R=5, Q=9)
+  uint16_t reserved;
+  uint32_t timestamp;
+};
+static_assert(sizeof(GameSummary) == 24, "GameSummary must be 24 bytes");
+
+struct __attribute__((packed)) ColorResults {
+  uint16_t white; // White won
+  uint16_t black; // Black won
+  uint16_t draws;
+};
+
+struct __attribute__((packed)) PlayerResults {
+  uint16_t wins; // From the human's side of a bot game
+  uint16_t losses;
+  uint16_t draws;
+};
+
+struct __attribute__((packed)) CatalogStats {
+  uint32_t games;
+  uint32_t plies;
+  ColorResults byMode[2];                                 // Indexed by GameModeCode - 1
+  PlayerResults botAsWhite;
+  PlayerResults botAsBlack;
+  PlayerResults botByDepth[CATALOG_MAX_BOT_DEPTH + 1];
+  uint16_t byResult[7];                                   // Indexed by GameResult
+  ColorResults byEcoVolume[CATALOG_ECO_VOLUMES];
+};
+
+/// Games to list. Zero (or "") fields match everything.
+struct CatalogFilter {
+  uint8_t mode = 0;
+  uint8_t result = 0;
+  uint8_t winnerColor = 0;
+  uint8_t playerColor = 0;
+  uint8_t botDepth = 0;
+  char ecoPrefix[4] = "";  // "B", "B9" or "B90"
+  uint16_t minPlies = 0;
+  uint16_t maxPlies = 0;
+
+  bool matches(const GameSummary& s) const;
+};
+
+// ---------------------------
+// Game Catalog
+// ---------------------------
+/// The catalog of one games directory, owned by its MoveHistory. Loaded and
+/// added to by MoveHistory's catalog task, pruned from the loop task and read
+/// from the web server task, under a mutex.
+class GameCatalog {
+ public:
+  GameCatalog();
+
+  /// Load the stats (summing them from the summaries if needed). Call after the games directory exists.
+  /// Until then, queries report busy and changes are refused.
+  void begin();
+
+  /// Ids that have a summary, sorted (MoveHistory::begin() reconciles them with the game files).
+  std::vector<int> gameIds();
+
+  /// Add or replace the summary of `s.gameId`.
+  bool add(const GameSummary& s);
+  /// Drop the summary of a deleted game. Returns false if it had none.
+  bool remove(uint16_t gameId);
+
+  /// Call `visit` for the matching summaries from `offset` on, at most `limit` of them.
+  /// Returns how many games match in all, or -1 if the catalog is busy.
+  int query(const CatalogFilter& filter, uint16_t offset, uint16_t limit, const std::function<void(const GameSummary&)>& visit);
+
+  /// Copy the running totals. Returns false if the catalog is busy.
+  bool getStats(CatalogStats& out);
+
+ private:
+  SemaphoreHandle_t mutex;
+  std::atomic<bool> loaded;
+  CatalogStats stats;
+  uint32_t sequence; // Of the summary file on flash
+
+  bool rewrite(uint16_t gameId, const GameSummary* insert, GameSummary& old, bool& hadOld);
+  void accumulate(const GameSummary& s, int sign);
+  void saveStats();
+};
+
+#endif // GAME_CATALOG_H
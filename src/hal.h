@@ -0,0 +1,115 @@
+#ifndef HAL_H
+#define HAL_H
+
+#include "led_colors.h"
+#include <Arduino.h>
+
+// ---------------------------
+// Hardware Abstraction Layer
+// ---------------------------
+// The board's hardware surface as BoardDriver sees it: the LED strip, the
+// hall-sensor matrix and persistent settings. BoardDriver keeps the logic
+// (debounce, calibration, LED mapping, animations) and talks to the hardware
+// only through these interfaces, so a different MCU, LED driver or sensor
+// wiring only needs a new implementation injected from main.cpp.
+// WiFiConnector drives the WiFi station the same way, through WiFiLink.
+// The ESP32 implementations live in hal_esp32.h, the native build's in
+// host/hal_posix.h.
+//
+// Tasks, timing, files and sockets are not wrapped here: the firmware uses
+// the FreeRTOS, Arduino, LittleFS and WiFiClient APIs directly, and the native
+// build supplies POSIX implementations of those same APIs (lib/host_platform).
+
+static constexpr uint8_t HAL_SENSOR_ROWS = 8;
+static constexpr uint8_t HAL_SENSOR_COLS = 8;
+static constexpr uint8_t HAL_WIRING_COLUMN_PINS = 3;
+
+/// Addressable LED strip, indexed in wiring order (calibration maps squares to indices).
+class LedOutput {
+ public:
+  virtual ~LedOutput() = default;
+  virtual void begin() = 0;
+  virtual void setBrightness(uint8_t brightness) = 0;
+  virtual void setPixel(int index, LedRGB color) = 0;
+  /// Push the buffered colors to the strip.
+  virtual void show() = 0;
+};
+
+/// Identifies how the sensor matrix is wired, so a saved calibration is
+/// discarded when the wiring changes.
+struct SensorWiring {
+  uint8_t rowPins[HAL_SENSOR_ROWS];
+  uint8_t columnPins[HAL_WIRING_COLUMN_PINS];
+};
+
+/// Sensor matrix scanned one raw column at a time. Raw rows and columns are
+/// in wiring order; BoardDriver's calibration maps them to squares.
+class SensorMatrix {
+ public:
+  virtual ~SensorMatrix() = default;
+  virtual void begin() = 0;
+  /// Power raw column `col` (and only it) for the following readRow() calls.
+  virtual void selectColumn(int col) = 0;
+  virtual void releaseColumns() = 0;
+  /// True if the sensor at raw `row` of the selected column detects a magnet.
+  virtual bool readRow(int row) = 0;
+
+  virtual SensorWiring getWiring() const = 0;
+  /// Human-readable location of a raw row or column, for calibration diagnostics.
+  virtual String describeRow(int row) const = 0;
+  virtual String describeColumn(int col) const = 0;
+};
+
+/// Small persistent key-value settings grouped by namespace. Calls are
+/// self-contained (no open/close pairing) so they are safe from any task.
+class SettingsStore {
+ public:
+  virtual ~SettingsStore() = default;
+  /// False if the backing store can't be used (settings then keep their defaults).
+  virtual bool isAvailable() = 0;
+  virtual uint8_t getUChar(const char* ns, const char* key, uint8_t defaultValue) = 0;
+  virtual void putUChar(const char* ns, const char* key, uint8_t value) = 0;
+  /// Read exactly `len` bytes. Returns false if the key is missing or its stored length differs.
+  virtual bool getBytes(const char* ns, const char* key, void* buf, size_t len) = 0;
+  virtual void putBytes(const char* ns, const char* key, const void* buf, size_t len) = 0;
+  /// Remove every key in the namespace.
+  virtual void clear(const char* ns) = 0;
+};
+
+/// Where a network was last joined. Connecting with it skips the all-channel scan.
+struct WiFiFastConnect {
+  uint8_t bssid[6];
+  uint8_t channel; // 0 = nothing cached
+};
+
+/// IPv4 configuration DHCP handed out on a network (addresses in network byte
+/// order, as IPAddress stores them). Reusing it skips DHCP on a reconnect.
+struct WiFiLease {
+  uint32_t ip; // 0 = no lease
+  uint32_t gateway;
+  uint32_t subnet;
+  uint32_t dns;
+  unsigned long obtainedAt; // millis() when DHCP handed it out
+};
+
+/// WiFi station radio. connect() only starts an association; the outcome is
+/// reported asynchronously through the owner's link-up/link-down notifications.
+class WiFiLink {
+ public:
+  virtual ~WiFiLink() = default;
+  virtual void begin() = 0;
+  /// Start joining `ssid`. With a `hint`, join that BSSID on that channel without scanning.
+  /// With a `lease`, configure its addresses statically instead of running DHCP.
+  virtual void connect(const char* ssid, const char* password, const WiFiFastConnect* hint, const WiFiLease* lease) = 0;
+  /// After a join on a reused lease: hand the address back to DHCP, so the
+  /// server books it for the board again and renewals follow as usual.
+  virtual void renewLease() = 0;
+  /// Abandon the current association or attempt.
+  virtual void disconnect() = 0;
+  /// BSSID and channel of the current association. False if not associated.
+  virtual bool readFastConnect(WiFiFastConnect& out) = 0;
+  /// Addresses of the current association (obtainedAt left to the caller). False if none.
+  virtual bool readLease(WiFiLease& out) = 0;
+};
+
+#endif // HAL_H
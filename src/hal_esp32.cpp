@@ -0,0 +1,220 @@
+#include "hal_esp32.h"
+#include "board_driver.h"
+#include "chess_utils.h"
+#include <Preferences.h>
+#include <WiFi.h>
+
+static constexpr int rowPins[NUM_ROWS] = {ROW_PIN_0, ROW_PIN_1, ROW_PIN_2, ROW_PIN_3, ROW_PIN_4, ROW_PIN_5, ROW_PIN_6, ROW_PIN_7};
+
+// 74HC595 shift register pin mapping: bits are sent MSB first, so bit 7 shifts to QH, bit 0 stays at QA
+// col 0 -> QA (pin 15), col 1 -> QB (pin 1), ..., col 7 -> QH (pin 7)
+static int shiftRegPin(int col) {
+  const int pins[] = {15, 1, 2, 3, 4, 5, 6, 7}; // QA=15, QB=1, QC=2, QD=3, QE=4, QF=5, QG=6, QH=7
+  return (col >= 0 && col < 8) ? pins[col] : -1;
+}
+static char shiftRegOutput(int col) {
+  return (col >= 0 && col < 8) ? (char)('A' + col) : '?'; // col 0 -> 'A' (QA), col 7 -> 'H' (QH)
+}
+
+// ---------------------------
+// Esp32LedOutput
+// ---------------------------
+
+Esp32LedOutput::Esp32LedOutput(uint16_t count, uint8_t pin) : strip(count, pin) {}
+
+void Esp32LedOutput::begin() {
+  strip.Begin();
+}
+
+void Esp32LedOutput::setBrightness(uint8_t brightness) {
+  strip.SetBrightness(brightness);
+}
+
+void Esp32LedOutput::setPixel(int index, LedRGB color) {
+  strip.SetPixelColor(index, RgbColor(color.r, color.g, color.b));
+}
+
+void Esp32LedOutput::show() {
+  strip.Show();
+}
+
+// ---------------------------
+// Esp32SensorMatrix
+// ---------------------------
+
+Esp32SensorMatrix::Esp32SensorMatrix() : lastEnabledCol(-2) {}
+
+void Esp32SensorMatrix::begin() {
+  // Shift register pins as outputs
+  pinMode(SR_SER_DATA_PIN, OUTPUT);
+  pinMode(SR_CLK_PIN, OUTPUT);
+  pinMode(SR_LATCH_PIN, OUTPUT);
+  releaseColumns();
+  // Row pins as inputs
+  for (int c = 0; c < NUM_ROWS; c++)
+    pinMode(rowPins[c], INPUT);
+}
+
+void Esp32SensorMatrix::loadShiftRegister(byte data, int bits) {
+#if defined(SR_INVERT_OUTPUTS) && SR_INVERT_OUTPUTS != 0
+  data = ~data;
+#endif
+  // Make sure latch is low before shifting data
+  digitalWrite(SR_LATCH_PIN, LOW);
+  // Shift bits MSB first
+  for (int i = bits - 1; i >= 0; i--) {
+    digitalWrite(SR_SER_DATA_PIN, !!(data & (1 << i)));
+    delayMicroseconds(10);
+    digitalWrite(SR_CLK_PIN, HIGH);
+    delayMicroseconds(10);
+    digitalWrite(SR_CLK_PIN, LOW);
+    delayMicroseconds(10);
+  }
+  // Latch the data to output pins
+  digitalWrite(SR_LATCH_PIN, HIGH);
+  delayMicroseconds(10);
+  digitalWrite(SR_LATCH_PIN, LOW);
+}
+
+void Esp32SensorMatrix::releaseColumns() {
+  if (lastEnabledCol == 7) {
+    // Sequential wrap-around: shift in a single 0 to push the 1 out of QH
+    loadShiftRegister(0x00, 1);
+  } else {
+    // Non-sequential or startup: load full byte of zeros
+    loadShiftRegister(0);
+  }
+  lastEnabledCol = -1; // Make next selectColumn(0) call use optimized 1-bit shift because register is now all zeros
+}
+
+void Esp32SensorMatrix::selectColumn(int col) {
+  if (col == lastEnabledCol + 1) {
+    if (col == 0)
+      loadShiftRegister(0x01, 1); // Sequential wrap-around: register should be all zeros already, shift in a single 1 bit into QA
+    else
+      loadShiftRegister(0x00, 1); // Sequential access: shift in a single 0 bit to move the 1 we shifted earlier to the next column position (towards QH)
+  } else {
+    // Due to above logic, this condition should never occur, but just in case...
+    loadShiftRegister((byte)(1 << col));
+  }
+  lastEnabledCol = col;
+  delayMicroseconds(100); // Allow time for the column to stabilize, otherwise random readings might occur
+}
+
+bool Esp32SensorMatrix::readRow(int row) {
+  return digitalRead(rowPins[row]) == LOW;
+}
+
+SensorWiring Esp32SensorMatrix::getWiring() const {
+  SensorWiring wiring;
+  for (int i = 0; i < NUM_ROWS; i++)
+    wiring.rowPins[i] = (uint8_t)rowPins[i];
+  wiring.columnPins[0] = (uint8_t)SR_CLK_PIN;
+  wiring.columnPins[1] = (uint8_t)SR_LATCH_PIN;
+  wiring.columnPins[2] = (uint8_t)SR_SER_DATA_PIN;
+  return wiring;
+}
+
+String Esp32SensorMatrix::describeRow(int row) const {
+  return "GPIO " + String(rowPins[row]);
+}
+
+String Esp32SensorMatrix::describeColumn(int col) const {
+  return "74HC595 Q" + String(shiftRegOutput(col)) + ", pin " + String(shiftRegPin(col));
+}
+
+// ---------------------------
+// NvsSettingsStore
+// ---------------------------
+
+bool NvsSettingsStore::isAvailable() {
+  return ChessUtils::ensureNvsInitialized();
+}
+
+uint8_t NvsSettingsStore::getUChar(const char* ns, const char* key, uint8_t defaultValue) {
+  Preferences prefs;
+  prefs.begin(ns, true);
+  uint8_t value = prefs.getUChar(key, defaultValue);
+  prefs.end();
+  return value;
+}
+
+void NvsSettingsStore::putUChar(const char* ns, const char* key, uint8_t value) {
+  Preferences prefs;
+  prefs.begin(ns, false);
+  prefs.putUChar(key, value);
+  prefs.end();
+}
+
+bool NvsSettingsStore::getBytes(const char* ns, const char* key, void* buf, size_t len) {
+  Preferences prefs;
+  prefs.begin(ns, true);
+  bool ok = prefs.getBytesLength(key) == len && prefs.getBytes(key, buf, len) == len;
+  prefs.end();
+  return ok;
+}
+
+void NvsSettingsStore::putBytes(const char* ns, const char* key, const void* buf, size_t len) {
+  Preferences prefs;
+  prefs.begin(ns, false);
+  prefs.putBytes(key, buf, len);
+  prefs.end();
+}
+
+void NvsSettingsStore::clear(const char* ns) {
+  Preferences prefs;
+  prefs.begin(ns, false);
+  prefs.clear();
+  prefs.end();
+}
+
+// ---------------------------
+// Esp32WiFiLink
+// ---------------------------
+
+void Esp32WiFiLink::begin() {
+  WiFi.setAutoReconnect(false);
+}
+
+void Esp32WiFiLink::connect(const char* ssid, const char* password, const WiFiFastConnect* hint, const WiFiLease* lease) {
+  WiFi.enableSTA(true);
+  // A static configuration stays until replaced: all zeros switches DHCP back on
+  if (lease && lease->ip != 0)
+    WiFi.config(IPAddress(lease->ip), IPAddress(lease->gateway), IPAddress(lease->subnet), IPAddress(lease->dns));
+  else
+    WiFi.config(IPAddress((uint32_t)0), IPAddress((uint32_t)0), IPAddress((uint32_t)0));
+  if (hint && hint->channel != 0)
+    WiFi.begin(ssid, password, hint->channel, hint->bssid);
+  else
+    WiFi.begin(ssid, password);
+}
+
+void Esp32WiFiLink::renewLease() {
+  // All zeros restarts the DHCP client on the associated link; no rescan
+  WiFi.config(IPAddress((uint32_t)0), IPAddress((uint32_t)0), IPAddress((uint32_t)0));
+}
+
+void Esp32WiFiLink::disconnect() {
+  WiFi.disconnect();
+}
+
+bool Esp32WiFiLink::readFastConnect(WiFiFastConnect& out) {
+  if (WiFi.status() != WL_CONNECTED)
+    return false;
+  const uint8_t* bssid = WiFi.BSSID();
+  if (!bssid)
+    return false;
+  memcpy(out.bssid, bssid, sizeof(out.bssid));
+  out.channel = (uint8_t)WiFi.channel();
+  return true;
+}
+
+bool Esp32WiFiLink::readLease(WiFiLease& out) {
+  if (WiFi.status() != WL_CONNECTED)
+    return false;
+  out.ip = (uint32_t)WiFi.localIP();
+  out.gateway = (uint32_t)WiFi.gatewayIP();
+  out.subnet = (uint32_t)WiFi.subnetMask();
+  out.dns = (uint32_t)WiFi.dnsIP(0);
+  return out.ip != 0;
+}
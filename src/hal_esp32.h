@@ -0,0 +1,64 @@
+#ifndef HAL_ESP32_H
+#define HAL_ESP32_H
+
+#include "hal.h"
+#include <NeoPixelBrightnessBus.h>
+
+// ---------------------------
+// ESP32 HAL Implementations
+// ---------------------------
+// Pin assignments are in board_driver.h.
+
+/// WS2812B strip on the I2S0 peripheral (NeoPixelBus).
+class Esp32LedOutput : public LedOutput {
+ private:
+  NeoPixelBrightnessBus<NeoGrbFeature, NeoEsp32I2s0800KbpsMethod> strip;
+
+ public:
+  Esp32LedOutput(uint16_t count, uint8_t pin);
+  void begin() override;
+  void setBrightness(uint8_t brightness) override;
+  void setPixel(int index, LedRGB color) override;
+  void show() override;
+};
+
+/// Hall sensors on GPIO rows, columns powered through a 74HC595 shift register.
+class Esp32SensorMatrix : public SensorMatrix {
+ private:
+  int lastEnabledCol; // Tracks last enabled column for efficient sequential shifting
+  void loadShiftRegister(byte data, int bits = 8);
+
+ public:
+  Esp32SensorMatrix();
+  void begin() override;
+  void selectColumn(int col) override;
+  void releaseColumns() override;
+  bool readRow(int row) override;
+  SensorWiring getWiring() const override;
+  String describeRow(int row) const override;
+  String describeColumn(int col) const override;
+};
+
+/// NVS through Arduino Preferences. Each call opens and closes its namespace.
+class NvsSettingsStore : public SettingsStore {
+ public:
+  bool isAvailable() override;
+  uint8_t getUChar(const char* ns, const char* key, uint8_t defaultValue) override;
+  void putUChar(const char* ns, const char* key, uint8_t value) override;
+  bool getBytes(const char* ns, const char* key, void* buf, size_t len) override;
+  void putBytes(const char* ns, const char* key, const void* buf, size_t len) override;
+  void clear(const char* ns) override;
+};
+
+/// Arduino WiFi station. Arduino's own auto-reconnect is turned off so WiFiConnector owns retries.
+class Esp32WiFiLink : public WiFiLink {
+ public:
+  void begin() override;
+  void connect(const char* ssid, const char* password, const WiFiFastConnect* hint, const WiFiLease* lease) override;
+  void renewLease() override;
+  void disconnect() override;
+  bool readFastConnect(WiFiFastConnect& out) override;
+  bool readLease(WiFiLease& out) override;
+};
+
+#endif // HAL_ESP32_H
@@ -0,0 +1,56 @@
+#include "heap_report.h"
+#include <esp_heap_caps.h>
+#include <freertos/FreeRTOS.h>
+
+static portMUX_TYPE reportLock = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t bootLargestBlock = 0;
+static uint32_t tlsConnects = 0;
+static uint32_t tlsFailures = 0;
+static uint32_t tlsFailureLargestBlock = 0;
+static uint32_t gamesStarted = 0;
+static HeapGameSample history[HEAP_REPORT_GAMES];
+
+static uint32_t largestBlock() {
+  return (uint32_t)heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+}
+
+void HeapReport::noteBoot() {
+  bootLargestBlock = largestBlock();
+}
+
+void HeapReport::noteGameStart() {
+  HeapGameSample sample;
+  sample.freeBytes = (uint32_t)heap_caps_get_free_size(MALLOC_CAP_8BIT);
+  sample.largestBlock = largestBlock();
+  portENTER_CRITICAL(&reportLock);
+  sample.game = ++gamesStarted;
+  history[(gamesStarted - 1) % HEAP_REPORT_GAMES] = sample;
+  portEXIT_CRITICAL(&reportLock);
+}
+
+void HeapReport::noteTlsConnect(bool ok) {
+  uint32_t largest = ok ? 0 : largestBlock();
+  portENTER_CRITICAL(&reportLock);
+  tlsConnects++;
+  if (!ok) {
+    tlsFailures++;
+    tlsFailureLargestBlock = largest;
+  }
+  portEXIT_CRITICAL(&reportLock);
+}
+
+void HeapReport::snapshot(HeapReportSnapshot& out) {
+  out.freeBytes = (uint32_t)heap_caps_get_free_size(MALLOC_CAP_8BIT);
+  out.largestBlock = largestBlock();
+  out.minFreeBytes = (uint32_t)heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT);
+  out.bootLargestBlock = bootLargestBlock;
+  portENTER_CRITICAL(&reportLock);
+  out.tlsConnects = tlsConnects;
+  out.tlsFailures = tlsFailures;
+  out.tlsFailureLargestBlock = tlsFailureLargestBlock;
+  uint32_t count = gamesStarted < HEAP_REPORT_GAMES ? gamesStarted : HEAP_REPORT_GAMES;
+  for (uint32_t i = 0; i < count; i++)
+    out.games[i] = history[(gamesStarted - count + i) % HEAP_REPORT_GAMES];
+  out.gameCount = (uint8_t)count;
+  portEXIT_CRITICAL(&reportLock);
+}
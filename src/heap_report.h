@@ -0,0 +1,45 @@
+#ifndef HEAP_REPORT_H
+#define HEAP_REPORT_H
+
+#include <Arduino.h>
+
+// ---------------------------
+// Heap Fragmentation Report
+// ---------------------------
+// Tracks what matters for TLS over a long session: the largest free heap
+// block (mbedTLS needs its record buffers in one piece), sampled at every
+// game start, next to the outcome of every TLS connect. If the largest
+// block stays flat from game to game and connects keep succeeding, the
+// heap is not fragmenting. Served by GET /debug/heap.
+
+static constexpr uint8_t HEAP_REPORT_GAMES = 16; // Game starts kept in the history
+
+struct HeapGameSample {
+  uint32_t game;          // Mode starts since boot
+  uint32_t freeBytes;
+  uint32_t largestBlock;
+};
+
+struct HeapReportSnapshot {
+  uint32_t freeBytes;
+  uint32_t largestBlock;
+  uint32_t minFreeBytes;       // Low-water mark since boot (from the allocator)
+  uint32_t bootLargestBlock;   // Largest block once setup() finished, before the first game
+  uint32_t tlsConnects;
+  uint32_t tlsFailures;
+  uint32_t tlsFailureLargestBlock; // Largest block at the last failed connect, 0 if none failed
+  uint8_t gameCount;           // Valid entries in games, oldest first
+  HeapGameSample games[HEAP_REPORT_GAMES];
+};
+
+/// Static like LoopStats. Game starts are noted from the loop task, TLS
+/// connects from the network actor; the web task reads a snapshot under a spinlock.
+class HeapReport {
+ public:
+  static void noteBoot();
+  static void noteGameStart();
+  static void noteTlsConnect(bool ok);
+  static void snapshot(HeapReportSnapshot& out);
+};
+
+#endif // HEAP_REPORT_H
@@ -0,0 +1,56 @@
+#include "../microbench.h"
+#include <ArduinoJson.h>
+#include <host_platform.h>
+#include <stdio.h>
+
+// ---------------------------
+// Native Microbenchmarks
+// ---------------------------
+// The /debug/bench cases (microbench.h) as a Linux program, with the heap
+// allocations of every call counted through HostHeap. Prints the same JSON as
+// GET /debug/bench, so tools/microbench.py compares two native runs like two
+// board runs:
+//
+//   .pio/build/native_bench/program > after.json
+//   python tools/microbench.py after.json --baseline before.json
+//
+// Pass a file name to write the JSON there and keep the per-case log on stdout.
+
+int main(int argc, char** argv) {
+  const char* outPath = argc > 1 ? argv[1] : nullptr;
+  HostPlatform::setSerialEnabled(outPath != nullptr);
+  Microbench::setAllocationCounter(HostHeap::threadAllocations);
+
+  BenchResult results[BENCH_CASE_COUNT];
+  uint32_t elapsedMs = 0;
+  uint8_t count = Microbench::runNow(results, elapsedMs);
+
+  JsonDocument doc;
+  doc["running"] = false;
+  doc["build"] = "native";
+  doc["version"] = __DATE__ " " __TIME__;
+  doc["batches"] = BENCH_BATCHES;
+  doc["elapsedMs"] = elapsedMs;
+  JsonArray cases = doc["cases"].to<JsonArray>();
+  for (uint8_t i = 0; i < count; i++) {
+    JsonObject c = cases.add<JsonObject>();
+    c["name"] = results[i].name;
+    c["calls"] = results[i].callsPerBatch;
+    c["minNs"] = results[i].minNs;
+    c["medianNs"] = results[i].medianNs;
+    c["heapBlocks"] = results[i].heapBlocks;
+    c["allocsPerCall"] = serialized(String(results[i].allocsPerCall, 2));
+  }
+  String output;
+  serializeJson(doc, output);
+
+  FILE* out = outPath ? fopen(outPath, "w") : stdout;
+  if (!out) {
+    fprintf(stderr, "Cannot write %s\n", outPath);
+    return 1;
+  }
+  fprintf(out, "%s\n", output.c_str());
+  if (outPath)
+    fclose(out);
+  return 0;
+}
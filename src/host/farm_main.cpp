@@ -0,0 +1,332 @@
+#include "../board_driver.h"
+#include "../chess_bot.h"
+#include "../chess_clock.h"
+#include "../chess_engine.h"
+#include "../chess_moves.h"
+#include "../chess_utils.h"
+#include "../game_arena.h"
+#include "../logger.h"
+#include "../loop_stats.h"
+#include "../move_history.h"
+#include "../stockfish_cache.h"
+#include "../wifi_manager_esp32.h"
+#include "hal_posix.h"
+#include "sim_player.h"
+#include "sim_servers.h"
+#include <ArduinoJson.h>
+#include <LittleFS.h>
+#include <atomic>
+#include <host_platform.h>
+#include <memory>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+// ---------------------------
+// Native Board Farm
+// ---------------------------
+// Hundreds of simulated boards in one process, each with its own BoardDriver,
+// ChessEngine, MoveHistory, arena, caches, settings, flash directory and SimPlayer, played by
+// a pool of worker threads at CPU speed. Games alternate between ChessMoves
+// with the player on both sides and ChessBot against the Stockfish stub,
+// which every board shares. What it checks is that nothing one board does
+// leaks into another: a board whose state another one changed under it stops
+// making progress or ends its games wrongly, and the counts below stop adding
+// up. What it reports is aggregate throughput:
+//
+//   movesPerSec        moves played by all boards per second of wall time
+//   movesPerCpuSec     ... per second of worker CPU time (the pool's efficiency)
+//
+// A worker takes the next board that hasn't played, points its thread's flash
+// at the board's directory, sets the board up the way setup() does and plays
+// all of that board's games. Nothing else is bound to the thread: every object
+// main.cpp keeps in a global is a member of the board. Clocks are virtual, so
+// blocking waits and debounces cost only the CPU they use.
+//
+//   .pio/build/native_farm/program [--boards=N] [--threads=T] [--games=G] [--seed=S] [out.json]
+//
+// Exits 1 if a finished game is missing from its board's history or catalog,
+// and 2 at once if a board stops making progress.
+
+static constexpr int FARM_DEFAULT_BOARDS = 200;
+static constexpr int FARM_DEFAULT_THREADS = 8;
+static constexpr int FARM_DEFAULT_GAMES = 4;        // Per board
+static constexpr uint32_t FARM_MAX_PLIES = 600;     // As in gamesim_main.cpp
+static constexpr uint32_t FARM_STALL_MS = 600000;   // Virtual time without a magnet change or a move
+
+static constexpr size_t largerOf(size_t a, size_t b) { return a > b ? a : b; }
+static constexpr size_t FARM_ARENA_BYTES = largerOf(sizeof(ChessMoves), sizeof(ChessBot)) + GAME_ARENA_ALIGN + GAME_ARENA_SCRATCH_BYTES;
+
+enum class FarmMode { MOVES, BOT };
+static const char* const FARM_MODE_NAMES[] = {"moves", "bot"};
+
+/// Everything main.cpp keeps in globals, once per board.
+struct SimBoard {
+  int index;
+  PosixLedOutput ledOutput{LED_COUNT};
+  VirtualSensorMatrix sensorMatrix;
+  FileSettingsStore settingsStore; // Under the thread's data directory
+  SimWiFiLink wifiLink;
+  BoardDriver boardDriver{&ledOutput, &sensorMatrix, &settingsStore};
+  ChessEngine chessEngine;
+  ChessClock chessClock;
+  MoveHistory moveHistory;
+  LoopStats loopStats;
+  StockfishCache stockfishCache;
+  WiFiManagerESP32 wifiManager{&boardDriver, &moveHistory, &wifiLink};
+  SimPlayer player{&boardDriver, &sensorMatrix, &ledOutput, &wifiManager};
+  ChessGame* activeGame = nullptr;
+  alignas(GAME_ARENA_ALIGN) uint8_t gameArenaStorage[FARM_ARENA_BYTES];
+  GameArena gameArena;
+
+  unsigned long lastProgressMs = 0;
+  uint32_t games[2] = {};
+  uint32_t finished = 0;
+  uint32_t abandoned = 0;
+  uint64_t moves[2] = {};
+  uint32_t historyMismatches = 0; // Finished games this board's flash or catalog didn't record as such
+
+  explicit SimBoard(int index) : index(index) {}
+};
+
+static StockfishStub stockfishStub;
+static String farmDir;
+static std::atomic<int> nextBoard{0};
+
+// main.cpp's serviceBackground(), plus the player's hands
+static void serviceBoard(void* context) {
+  SimBoard* board = (SimBoard*)context;
+  board->wifiManager.update();
+  uint32_t planned = board->player.ownMoves() + board->player.promptedMoves();
+  board->player.step();
+  if (board->player.ownMoves() + board->player.promptedMoves() != planned)
+    board->lastProgressMs = millis();
+  if (millis() - board->lastProgressMs > FARM_STALL_MS) {
+    fprintf(stderr, "STALLED: board %d at %s\n", board->index, board->wifiManager.getCurrentFen().c_str());
+    exit(2);
+  }
+}
+
+// setup() in main.cpp, for a board taking over the calling worker thread
+static void bindBoard(SimBoard& board) {
+  String dir = farmDir + "/board" + String(board.index);
+  HostPlatform::makeDirs(dir.c_str());
+  HostPlatform::setThreadDataDir(dir.c_str());
+  LittleFS.begin(true);
+  board.gameArena.begin(board.gameArenaStorage, sizeof(board.gameArenaStorage));
+  board.moveHistory.setArena(&board.gameArena);
+  board.moveHistory.setLoopStats(&board.loopStats);
+  board.moveHistory.begin();
+  board.stockfishCache.setLoopStats(&board.loopStats);
+  board.stockfishCache.begin();
+  board.boardDriver.saveIdentityCalibration();
+  board.boardDriver.begin();
+  board.wifiManager.begin();
+  board.wifiManager.setClock(&board.chessClock);
+  board.lastProgressMs = millis(); // The thread's clock has run through the boards before this one
+  board.boardDriver.cooperativeWait().setService(serviceBoard, &board);
+  board.moveHistory.startCatalogTask();
+}
+
+// initializeSelectedMode() in main.cpp, as gamesim_main.cpp plays it
+static void startGame(SimBoard& board, FarmMode mode, int game, uint32_t seed) {
+  board.moveHistory.discardLiveGame();
+  board.gameArena.destroy(board.activeGame);
+  board.activeGame = nullptr;
+  board.gameArena.reset();
+  board.chessClock.end();
+  board.loopStats.reset();
+  board.boardDriver.cooperativeWait().reset();
+
+  uint32_t salt = seed * 2654435761u + (uint32_t)board.index * 40503u + (uint32_t)game * 97u;
+  char humanColor = mode == FarmMode::MOVES ? ' ' : (game % 2 ? 'b' : 'w');
+  board.player.startGame(humanColor, salt);
+  board.lastProgressMs = millis();
+  if (mode == FarmMode::MOVES) {
+    board.activeGame = board.gameArena.create<ChessMoves>(&board.boardDriver, &board.chessEngine, &board.wifiManager, &board.moveHistory);
+  } else {
+    BotConfig botConfig = {StockfishSettings::medium(), humanColor == 'w'};
+    ChessBot* bot = board.gameArena.create<ChessBot>(&board.boardDriver, &board.chessEngine, &board.wifiManager, &board.moveHistory, botConfig);
+    bot->setStockfishCache(&board.stockfishCache);
+    board.activeGame = bot;
+  }
+  board.chessClock.begin(board.wifiManager.getTimeControl());
+  board.activeGame->setClock(&board.chessClock);
+  board.activeGame->setLoopStats(&board.loopStats);
+  board.activeGame->begin();
+  board.player.setActive(true);
+  board.lastProgressMs = millis();
+}
+
+static int newestGameId() {
+  std::vector<int> ids = MoveHistory::listGameIds();
+  return ids.empty() ? 0 : ids.back();
+}
+
+/// The game just finished is the newest on this board's flash, and the catalog
+/// in RAM, which another board's games would corrupt, counts what is there
+/// once the board's catalog task has caught up.
+static bool historyConsistent(SimBoard& board, int newestBefore) {
+  while (board.moveHistory.isCataloguing())
+    HostClock::realSleepMicros(1000);
+  std::vector<int> ids = MoveHistory::listGameIds();
+  CatalogStats stats;
+  return !ids.empty() && ids.back() == newestBefore + 1 && board.moveHistory.getCatalogStats(stats) && stats.games == ids.size();
+}
+
+static void playGame(SimBoard& board, FarmMode mode, int game, uint32_t seed) {
+  int newestBefore = newestGameId();
+  startGame(board, mode, game, seed);
+  uint32_t movesSeen = 0;
+  while (!board.activeGame->isGameOver()) {
+    if (movesSeen >= FARM_MAX_PLIES) {
+      board.abandoned++;
+      break;
+    }
+    // loop() in main.cpp
+    board.boardDriver.cooperativeWait().service();
+    board.loopStats.beginIteration();
+    board.activeGame->update();
+    board.loopStats.endIteration();
+    LoopStatsSnapshot stats;
+    board.loopStats.snapshot(stats);
+    if (stats.moves > movesSeen) {
+      board.moves[(int)mode] += stats.moves - movesSeen;
+      movesSeen = stats.moves;
+      board.lastProgressMs = millis();
+    }
+    delay(SENSOR_READ_DELAY_MS);
+  }
+  if (board.activeGame->isGameOver()) {
+    board.finished++;
+    if (!historyConsistent(board, newestBefore))
+      board.historyMismatches++;
+  }
+  board.chessClock.stop();
+  board.player.setActive(false);
+  board.games[(int)mode]++;
+}
+
+static void runWorker(std::vector<std::unique_ptr<SimBoard>>* boards, int games, uint32_t seed, uint64_t* cpuUs) {
+  uint64_t startCpuUs = HostClock::threadCpuMicros();
+  for (int i = nextBoard++; i < (int)boards->size(); i = nextBoard++) {
+    SimBoard& board = *(*boards)[i];
+    bindBoard(board);
+    for (int game = 0; game < games; game++)
+      playGame(board, (board.index + game) % 2 ? FarmMode::BOT : FarmMode::MOVES, game, seed);
+    board.gameArena.destroy(board.activeGame);
+    board.activeGame = nullptr;
+    board.chessClock.end();
+  }
+  HostPlatform::setThreadDataDir(nullptr);
+  *cpuUs = HostClock::threadCpuMicros() - startCpuUs;
+}
+
+int main(int argc, char** argv) {
+  int boardCount = FARM_DEFAULT_BOARDS;
+  int threadCount = FARM_DEFAULT_THREADS;
+  int games = FARM_DEFAULT_GAMES;
+  uint32_t seed = 1;
+  const char* outPath = nullptr;
+  for (int i = 1; i < argc; i++) {
+    if (strncmp(argv[i], "--boards=", 9) == 0)
+      boardCount = max(1, atoi(argv[i] + 9));
+    else if (strncmp(argv[i], "--threads=", 10) == 0)
+      threadCount = max(1, atoi(argv[i] + 10));
+    else if (strncmp(argv[i], "--games=", 8) == 0)
+      games = max(1, atoi(argv[i] + 8));
+    else if (strncmp(argv[i], "--seed=", 7) == 0)
+      seed = (uint32_t)strtoul(argv[i] + 7, nullptr, 10);
+    else
+      outPath = argv[i];
+  }
+  threadCount = min(threadCount, boardCount);
+
+  HostClock::setVirtual(true);
+  HostPlatform::setSerialEnabled(false);
+  // Blank flash for every board, so a run doesn't depend on the one before
+  farmDir = String(HostPlatform::dataDir()) + "/farm";
+  HostPlatform::removeTree(farmDir.c_str());
+  HostPlatform::makeDirs(farmDir.c_str());
+
+  Log::begin();
+  ChessUtils::ensureNvsInitialized();
+  stockfishStub.setSalt(seed);
+  if (!stockfishStub.start(STOCKFISH_API_URL, STOCKFISH_API_PORT)) {
+    fprintf(stderr, "Cannot start the Stockfish stub\n");
+    return 1;
+  }
+
+  std::vector<std::unique_ptr<SimBoard>> boards;
+  for (int i = 0; i < boardCount; i++)
+    boards.emplace_back(new SimBoard(i));
+
+  std::vector<std::thread> workers;
+  std::vector<uint64_t> workerCpuUs(threadCount, 0);
+  uint64_t startUs = HostClock::realMicros();
+  for (int t = 0; t < threadCount; t++)
+    workers.emplace_back(runWorker, &boards, games, seed, &workerCpuUs[t]);
+  for (std::thread& worker : workers)
+    worker.join();
+  uint64_t wallUs = HostClock::realMicros() - startUs;
+  stockfishStub.stop();
+
+  uint64_t cpuUs = 0;
+  for (uint64_t us : workerCpuUs)
+    cpuUs += us;
+  uint32_t finished = 0, abandoned = 0, mismatches = 0;
+  uint64_t modeGames[2] = {}, modeMoves[2] = {};
+  for (const auto& board : boards) {
+    finished += board->finished;
+    abandoned += board->abandoned;
+    mismatches += board->historyMismatches;
+    for (int m = 0; m < 2; m++) {
+      modeGames[m] += board->games[m];
+      modeMoves[m] += board->moves[m];
+    }
+  }
+  uint64_t totalMoves = modeMoves[0] + modeMoves[1];
+  float wallSec = wallUs / 1e6f;
+  float cpuSec = cpuUs / 1e6f;
+
+  JsonDocument doc;
+  doc["boards"] = boardCount;
+  doc["threads"] = threadCount;
+  doc["gamesPerBoard"] = games;
+  doc["seed"] = seed;
+  doc["games"] = modeGames[0] + modeGames[1];
+  doc["finished"] = finished;
+  doc["abandoned"] = abandoned;
+  doc["historyMismatches"] = mismatches;
+  doc["moves"] = totalMoves;
+  doc["wallMs"] = wallUs / 1000;
+  doc["workerCpuMs"] = cpuUs / 1000;
+  doc["movesPerSec"] = serialized(String(wallSec > 0 ? totalMoves / wallSec : 0.0f, 1));
+  doc["movesPerCpuSec"] = serialized(String(cpuSec > 0 ? totalMoves / cpuSec : 0.0f, 1));
+  doc["stockfishRequests"] = stockfishStub.requests();
+  JsonArray modes = doc["modes"].to<JsonArray>();
+  for (int m = 0; m < 2; m++) {
+    JsonObject mode = modes.add<JsonObject>();
+    mode["mode"] = FARM_MODE_NAMES[m];
+    mode["games"] = modeGames[m];
+    mode["moves"] = modeMoves[m];
+  }
+
+  String output;
+  serializeJson(doc, output);
+  FILE* out = outPath ? fopen(outPath, "w") : stdout;
+  if (!out) {
+    fprintf(stderr, "Cannot write %s\n", outPath);
+    return 1;
+  }
+  fprintf(out, "%s\n", output.c_str());
+  if (outPath)
+    fclose(out);
+  if (mismatches > 0) {
+    fprintf(stderr, "%u finished games missing from their board's history or catalog\n", mismatches);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,56 @@
+#include "../profiler.h"
+#include <Arduino.h>
+#include <host_platform.h>
+
+// ---------------------------
+// Native Firmware Entry Point
+// ---------------------------
+// Runs the unmodified setup()/loop() from main.cpp as a Linux process, with
+// the emulated flash under the directory given on the command line (default:
+// $LIBRECHESS_HOST_DIR, else .pio/host). Pass --virtual-time to run waits at
+// CPU speed (see HostClock), and --profile=SECONDS:FILE to sample the first
+// SECONDS after setup() into FILE for tools/symbolize_profile.py.
+
+void setup();
+void loop();
+
+static bool saveProfile(const char* path) {
+  FILE* f = fopen(path, "wb");
+  if (!f)
+    return false;
+  uint8_t chunk[1024];
+  size_t offset = 0, n;
+  while ((n = Profiler::readCapture(offset, chunk, sizeof(chunk))) > 0) {
+    fwrite(chunk, 1, n, f);
+    offset += n;
+  }
+  fclose(f);
+  return offset > 0;
+}
+
+int main(int argc, char** argv) {
+  setvbuf(stdout, nullptr, _IOLBF, 0); // Serial lines show up as they're printed, even through a pipe
+  int profileSeconds = 0;
+  const char* profilePath = nullptr;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--virtual-time") == 0) {
+      HostClock::setVirtual(true);
+    } else if (strncmp(argv[i], "--profile=", 10) == 0) {
+      profileSeconds = atoi(argv[i] + 10);
+      const char* colon = strchr(argv[i], ':');
+      profilePath = colon ? colon + 1 : "profile.bin";
+    } else {
+      HostPlatform::setDataDir(argv[i]);
+    }
+  }
+  setup();
+  if (profileSeconds > 0 && !Profiler::start((uint8_t)min(profileSeconds, (int)PROFILE_MAX_SECONDS)))
+    profileSeconds = 0;
+  for (;;) {
+    loop();
+    if (profileSeconds > 0 && !Profiler::isRunning()) {
+      profileSeconds = 0;
+      printf("%s %s\n", saveProfile(profilePath) ? "Profile written to" : "Could not write the profile to", profilePath);
+    }
+  }
+}
@@ -0,0 +1,396 @@
+#include "../board_driver.h"
+#include "../chess_bot.h"
+#include "../chess_clock.h"
+#include "../chess_engine.h"
+#include "../chess_lichess.h"
+#include "../chess_moves.h"
+#include "../chess_utils.h"
+#include "../game_arena.h"
+#include "../logger.h"
+#include "../loop_stats.h"
+#include "../move_history.h"
+#include "../stockfish_cache.h"
+#include "../wifi_manager_esp32.h"
+#include "hal_posix.h"
+#include "sim_player.h"
+#include "sim_servers.h"
+#include <ArduinoJson.h>
+#include <LittleFS.h>
+#include <host_platform.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+// ---------------------------
+// Native Game-Loop Simulation
+// ---------------------------
+// Release gate for the game loop: the firmware's main loop, unchanged, plays
+// scripted games in each networked and local mode. A SimPlayer moves the
+// magnets on the virtual board; ChessBot asks a local Stockfish stub and
+// ChessLichess a local Lichess stub, both answered by SimEngine. Every number
+// is the firmware's own share of the game thread: the player's work is timed
+// and counted around each step and taken out.
+//
+//   cpuUsPerMove / maxMoveCpuUs   thread CPU time from one move to the next
+//   allocsPerMove / maxMoveAllocs operator new calls, likewise
+//   flashWritesPerMove, ...       HostFs write calls and bytes, likewise
+//   maxIterationUs                CPU time of the slowest loop iteration
+//   p99IterationUs                ... and of the 99th percentile one
+//
+// Clocks are virtual, so a game runs at CPU speed and the numbers don't depend
+// on what else the host is doing. Network calls run inline on the game thread
+// (no NetworkActor), so their parsing is counted too; there is no TLS.
+//
+//   .pio/build/native_gamesim/program [--games=N] [--seed=S] [--baseline=old.json] [out.json]
+//
+// With --baseline the program exits 1 if a mode got slower or allocates or
+// writes more than the baseline run allows (GATE_* below); compare runs with
+// the same games and seed. A game that stops making progress exits 2 at once.
+
+static constexpr int GAMESIM_DEFAULT_GAMES = 1000;     // Per mode
+static constexpr uint32_t GAMESIM_MAX_PLIES = 600;     // The 50-move rule ends greedy games long before this
+static constexpr uint32_t GAMESIM_STALL_MS = 600000;   // Virtual time without a magnet change or a move
+static constexpr float GATE_CPU_SLACK = 0.20f;         // Run-to-run noise of host CPU time on a quiet machine
+static constexpr float GATE_P99_SLACK = 0.25f;
+static constexpr float GATE_MAX_ITERATION_SLACK = 1.0f; // A single worst case is noisy: catch only gross stalls
+static constexpr uint32_t ITERATION_BUCKET_US = 10;    // Histogram for the percentile
+static constexpr uint32_t ITERATION_BUCKETS = 2000;    // The last one holds everything from 20 ms up
+static constexpr float GATE_COUNT_SLACK = 0.02f;       // Allocations and flash writes are deterministic
+
+PosixLedOutput ledOutput(LED_COUNT);
+VirtualSensorMatrix sensorMatrix;
+FileSettingsStore settingsStore;
+SimWiFiLink wifiLink;
+BoardDriver boardDriver(&ledOutput, &sensorMatrix, &settingsStore);
+ChessEngine chessEngine;
+ChessClock chessClock;
+MoveHistory moveHistory;
+LoopStats loopStats;
+StockfishCache stockfishCache;
+WiFiManagerESP32 wifiManager(&boardDriver, &moveHistory, &wifiLink);
+ChessGame* activeGame = nullptr;
+
+static SimPlayer player(&boardDriver, &sensorMatrix, &ledOutput, &wifiManager);
+static StockfishStub stockfishStub;
+static LichessStub lichessStub;
+
+static constexpr size_t largerOf(size_t a, size_t b) { return a > b ? a : b; }
+alignas(GAME_ARENA_ALIGN) static uint8_t gameArenaStorage[largerOf(sizeof(ChessMoves), largerOf(sizeof(ChessBot), sizeof(ChessLichess))) + GAME_ARENA_ALIGN + GAME_ARENA_SCRATCH_BYTES];
+static GameArena gameArena;
+
+enum class SimMode { MOVES, BOT, LICHESS };
+static const char* const SIM_MODE_NAMES[] = {"moves", "bot", "lichess"};
+
+/// Work the player did on the game thread, taken out of the firmware's share
+static uint64_t playerCpuUs = 0;
+static uint64_t playerAllocs = 0;
+static unsigned long lastProgressMs = 0;
+static const char* currentModeName = "";
+static int currentGame = 0;
+
+static uint64_t firmwareCpuUs() { return HostClock::threadCpuMicros() - playerCpuUs; }
+static uint64_t firmwareAllocs() { return HostHeap::threadAllocations() - playerAllocs; }
+
+// main.cpp's serviceBackground(), plus the player's hands
+static void serviceSim(void*) {
+  wifiManager.update();
+
+  uint64_t cpuUs = HostClock::threadCpuMicros();
+  uint64_t allocs = HostHeap::threadAllocations();
+  uint32_t planned = player.ownMoves() + player.promptedMoves();
+  player.step();
+  if (player.ownMoves() + player.promptedMoves() != planned)
+    lastProgressMs = millis();
+  playerCpuUs += HostClock::threadCpuMicros() - cpuUs;
+  playerAllocs += HostHeap::threadAllocations() - allocs;
+
+  // A game the player and the firmware disagree about never ends; the blocking
+  // wait it is stuck in never returns to the loop either
+  if (millis() - lastProgressMs > GAMESIM_STALL_MS) {
+    fprintf(stderr, "STALLED: %s game %d at %s\n", currentModeName, currentGame, wifiManager.getCurrentFen().c_str());
+    exit(2);
+  }
+}
+
+struct ModeResult {
+  uint32_t games;
+  uint32_t finished;   // Ended by the firmware (mate, stalemate, draw)
+  uint32_t abandoned;  // Still running at GAMESIM_MAX_PLIES
+  uint64_t moves;
+  uint64_t iterations;
+  uint64_t cpuUs;
+  uint64_t maxMoveCpuUs;
+  uint64_t allocs;
+  uint64_t maxMoveAllocs;
+  uint64_t flashWrites;
+  uint64_t flashBytes;
+  uint64_t maxMoveFlashWrites;
+  uint64_t maxIterationUs;
+  uint64_t wallMs;
+  uint32_t iterationHistogram[ITERATION_BUCKETS];
+};
+
+// initializeSelectedMode() in main.cpp, for the three modes played here
+static void startGame(SimMode mode, int index, uint32_t seed) {
+  moveHistory.discardLiveGame();
+  gameArena.destroy(activeGame);
+  activeGame = nullptr;
+  gameArena.reset();
+  chessClock.end();
+  loopStats.reset();
+  boardDriver.cooperativeWait().reset();
+
+  uint32_t salt = seed * 2654435761u + (uint32_t)index * 40503u + (uint32_t)mode;
+  char humanColor = mode == SimMode::MOVES ? ' ' : (index % 2 ? 'b' : 'w');
+  player.startGame(humanColor, salt);
+  switch (mode) {
+    case SimMode::MOVES:
+      activeGame = gameArena.create<ChessMoves>(&boardDriver, &chessEngine, &wifiManager, &moveHistory);
+      break;
+    case SimMode::BOT: {
+      stockfishStub.setSalt(salt ^ 0x9e3779b9u);
+      BotConfig botConfig = {StockfishSettings::medium(), humanColor == 'w'};
+      ChessBot* bot = gameArena.create<ChessBot>(&boardDriver, &chessEngine, &wifiManager, &moveHistory, botConfig);
+      bot->setStockfishCache(&stockfishCache);
+      activeGame = bot;
+      break;
+    }
+    case SimMode::LICHESS:
+      lichessStub.newGame("sim" + String(index), humanColor, salt ^ 0x9e3779b9u);
+      activeGame = gameArena.create<ChessLichess>(&boardDriver, &chessEngine, &wifiManager, LichessConfig{"sim-token"});
+      break;
+  }
+  if (mode != SimMode::LICHESS) {
+    chessClock.begin(wifiManager.getTimeControl());
+    activeGame->setClock(&chessClock);
+  }
+  activeGame->setLoopStats(&loopStats);
+  activeGame->begin();
+  player.setActive(true);
+  lastProgressMs = millis();
+}
+
+static void playGame(SimMode mode, int index, uint32_t seed, ModeResult& result) {
+  currentGame = index;
+  uint64_t markCpuUs = firmwareCpuUs();
+  uint64_t markAllocs = firmwareAllocs();
+  HostFsStats markFs = HostFs::stats();
+  startGame(mode, index, seed);
+
+  uint32_t movesSeen = 0;
+  while (!activeGame->isGameOver()) {
+    if (movesSeen >= GAMESIM_MAX_PLIES) {
+      result.abandoned++;
+      break;
+    }
+    // loop() in main.cpp
+    uint64_t iterationStartUs = firmwareCpuUs();
+    boardDriver.cooperativeWait().service();
+    loopStats.beginIteration();
+    activeGame->update();
+    loopStats.endIteration();
+    uint64_t iterationUs = firmwareCpuUs() - iterationStartUs;
+    result.maxIterationUs = max(result.maxIterationUs, iterationUs);
+    result.iterationHistogram[min(iterationUs / ITERATION_BUCKET_US, (uint64_t)ITERATION_BUCKETS - 1)]++;
+    result.iterations++;
+
+    LoopStatsSnapshot stats;
+    loopStats.snapshot(stats);
+    if (stats.moves > movesSeen) {
+      // Everything since the previous move is charged to this one: the wait
+      // for the player's pickup, the move itself and its flash writes
+      uint64_t cpuUs = firmwareCpuUs() - markCpuUs;
+      uint64_t allocs = firmwareAllocs() - markAllocs;
+      HostFsStats fs = HostFs::stats();
+      uint64_t writes = fs.writeCalls - markFs.writeCalls;
+      result.moves += stats.moves - movesSeen;
+      result.cpuUs += cpuUs;
+      result.allocs += allocs;
+      result.flashWrites += writes;
+      result.flashBytes += fs.bytesWritten - markFs.bytesWritten;
+      result.maxMoveCpuUs = max(result.maxMoveCpuUs, cpuUs);
+      result.maxMoveAllocs = max(result.maxMoveAllocs, allocs);
+      result.maxMoveFlashWrites = max(result.maxMoveFlashWrites, writes);
+      markCpuUs = firmwareCpuUs();
+      markAllocs = firmwareAllocs();
+      markFs = fs;
+      movesSeen = stats.moves;
+      lastProgressMs = millis();
+    }
+    delay(SENSOR_READ_DELAY_MS);
+  }
+  if (activeGame->isGameOver())
+    result.finished++;
+  chessClock.stop();
+  player.setActive(false);
+  result.games++;
+}
+
+static ModeResult runMode(SimMode mode, int games, uint32_t seed) {
+  ModeResult result = {};
+  currentModeName = SIM_MODE_NAMES[(int)mode];
+  uint64_t startUs = HostClock::realMicros();
+  for (int i = 0; i < games; i++) {
+    playGame(mode, i, seed, result);
+    if ((i + 1) % 50 == 0 || i + 1 == games)
+      fprintf(stderr, "%-8s %4d/%d games, %llu moves\n", currentModeName, i + 1, games, (unsigned long long)result.moves);
+  }
+  result.wallMs = (HostClock::realMicros() - startUs) / 1000;
+  return result;
+}
+
+static float perMove(uint64_t total, uint64_t moves) {
+  return moves ? (float)total / (float)moves : 0.0f;
+}
+
+static uint32_t percentileIterationUs(const ModeResult& r, float fraction) {
+  uint64_t rank = (uint64_t)(r.iterations * fraction);
+  uint64_t seen = 0;
+  for (uint32_t i = 0; i < ITERATION_BUCKETS; i++) {
+    seen += r.iterationHistogram[i];
+    if (seen > rank)
+      return (i + 1) * ITERATION_BUCKET_US; // Upper edge of the bucket
+  }
+  return ITERATION_BUCKETS * ITERATION_BUCKET_US;
+}
+
+static void addModeResult(JsonArray out, SimMode mode, const ModeResult& r) {
+  JsonObject m = out.add<JsonObject>();
+  m["mode"] = SIM_MODE_NAMES[(int)mode];
+  m["games"] = r.games;
+  m["finished"] = r.finished;
+  m["abandoned"] = r.abandoned;
+  m["moves"] = r.moves;
+  m["iterations"] = r.iterations;
+  m["cpuUsPerMove"] = serialized(String(perMove(r.cpuUs, r.moves), 1));
+  m["maxMoveCpuUs"] = r.maxMoveCpuUs;
+  m["allocsPerMove"] = serialized(String(perMove(r.allocs, r.moves), 2));
+  m["maxMoveAllocs"] = r.maxMoveAllocs;
+  m["flashWritesPerMove"] = serialized(String(perMove(r.flashWrites, r.moves), 2));
+  m["flashBytesPerMove"] = serialized(String(perMove(r.flashBytes, r.moves), 1));
+  m["maxMoveFlashWrites"] = r.maxMoveFlashWrites;
+  m["maxIterationUs"] = r.maxIterationUs;
+  m["p99IterationUs"] = percentileIterationUs(r, 0.99f);
+  m["wallMs"] = r.wallMs;
+}
+
+/// One metric against the baseline. False (and a line on stderr) if it grew past `slack`.
+static bool withinBaseline(const char* mode, const char* key, JsonObject now, JsonObject before, float slack) {
+  float current = now[key].as<float>();
+  float baseline = before[key].as<float>();
+  float limit = baseline * (1.0f + slack) + 0.5f; // The half unit keeps zero baselines from failing on noise
+  bool ok = current <= limit;
+  fprintf(stderr, "%-8s %-20s %12.2f  baseline %12.2f  %s\n", mode, key, current, baseline, ok ? "ok" : "REGRESSED");
+  return ok;
+}
+
+static bool passesGate(const String& output, const char* baselinePath) {
+  JsonDocument doc; // Parsed back: the serialized() ratios only read as numbers from JSON text
+  deserializeJson(doc, output);
+  FILE* f = fopen(baselinePath, "r");
+  if (!f) {
+    fprintf(stderr, "Cannot read %s\n", baselinePath);
+    return false;
+  }
+  std::string text;
+  char chunk[1024];
+  size_t n;
+  while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0)
+    text.append(chunk, n);
+  fclose(f);
+  JsonDocument baseline;
+  if (deserializeJson(baseline, text.c_str())) {
+    fprintf(stderr, "Cannot parse %s\n", baselinePath);
+    return false;
+  }
+  if (baseline["games"].as<int>() != doc["games"].as<int>() || baseline["seed"].as<uint32_t>() != doc["seed"].as<uint32_t>())
+    fprintf(stderr, "Warning: baseline played other games (games/seed differ)\n");
+
+  bool ok = true;
+  for (JsonObject now : doc["modes"].as<JsonArray>()) {
+    const char* mode = now["mode"];
+    for (JsonObject before : baseline["modes"].as<JsonArray>()) {
+      if (before["mode"].as<String>() != mode)
+        continue;
+      ok &= withinBaseline(mode, "cpuUsPerMove", now, before, GATE_CPU_SLACK);
+      ok &= withinBaseline(mode, "p99IterationUs", now, before, GATE_P99_SLACK);
+      ok &= withinBaseline(mode, "maxIterationUs", now, before, GATE_MAX_ITERATION_SLACK);
+      ok &= withinBaseline(mode, "allocsPerMove", now, before, GATE_COUNT_SLACK);
+      ok &= withinBaseline(mode, "flashWritesPerMove", now, before, GATE_COUNT_SLACK);
+      ok &= withinBaseline(mode, "flashBytesPerMove", now, before, GATE_COUNT_SLACK);
+    }
+  }
+  return ok;
+}
+
+int main(int argc, char** argv) {
+  int games = GAMESIM_DEFAULT_GAMES;
+  uint32_t seed = 1;
+  const char* baselinePath = nullptr;
+  const char* outPath = nullptr;
+  for (int i = 1; i < argc; i++) {
+    if (strncmp(argv[i], "--games=", 8) == 0)
+      games = max(1, atoi(argv[i] + 8));
+    else if (strncmp(argv[i], "--seed=", 7) == 0)
+      seed = (uint32_t)strtoul(argv[i] + 7, nullptr, 10);
+    else if (strncmp(argv[i], "--baseline=", 11) == 0)
+      baselinePath = argv[i] + 11;
+    else
+      outPath = argv[i];
+  }
+
+  HostClock::setVirtual(true);
+  HostPlatform::setSerialEnabled(false);
+  // A blank flash, so every run starts from the same history and cache
+  String dataDir = String(HostPlatform::dataDir()) + "/gamesim";
+  HostPlatform::removeTree(dataDir.c_str());
+  HostPlatform::makeDirs(dataDir.c_str());
+  HostPlatform::setDataDir(dataDir.c_str());
+
+  // setup() in main.cpp, minus the network actor
+  Log::begin();
+  ChessUtils::ensureNvsInitialized();
+  LittleFS.begin(true);
+  gameArena.begin(gameArenaStorage, sizeof(gameArenaStorage));
+  moveHistory.setArena(&gameArena);
+  moveHistory.setLoopStats(&loopStats);
+  moveHistory.begin();
+  stockfishCache.setLoopStats(&loopStats);
+  stockfishCache.begin();
+  boardDriver.saveIdentityCalibration();
+  boardDriver.begin();
+  wifiManager.begin();
+  wifiManager.setClock(&chessClock);
+  boardDriver.cooperativeWait().setService(serviceSim, nullptr);
+  moveHistory.startCatalogTask();
+  if (!stockfishStub.start(STOCKFISH_API_URL, STOCKFISH_API_PORT) || !lichessStub.start(LICHESS_API_HOST, LICHESS_API_PORT)) {
+    fprintf(stderr, "Cannot start the stub servers\n");
+    return 1;
+  }
+
+  JsonDocument doc;
+  doc["games"] = games;
+  doc["seed"] = seed;
+  JsonArray modes = doc["modes"].to<JsonArray>();
+  for (SimMode mode : {SimMode::MOVES, SimMode::BOT, SimMode::LICHESS}) {
+    HostFs::resetStats();
+    addModeResult(modes, mode, runMode(mode, games, seed));
+  }
+  stockfishStub.stop();
+  lichessStub.stop();
+
+  String output;
+  serializeJson(doc, output);
+  FILE* out = outPath ? fopen(outPath, "w") : stdout;
+  if (!out) {
+    fprintf(stderr, "Cannot write %s\n", outPath);
+    return 1;
+  }
+  fprintf(out, "%s\n", output.c_str());
+  if (outPath)
+    fclose(out);
+  if (baselinePath && !passesGate(output, baselinePath))
+    return 1;
+  return 0;
+}
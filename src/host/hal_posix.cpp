@@ -0,0 +1,295 @@
+#include "hal_posix.h"
+#include <dirent.h>
+#include <host_platform.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// ---------------------------
+// PosixLedOutput
+// ---------------------------
+
+PosixLedOutput::PosixLedOutput(uint16_t count) : buffer(count, LedRGB{0, 0, 0}), shown(count, LedRGB{0, 0, 0}) {}
+
+void PosixLedOutput::setBrightness(uint8_t value) {
+  std::lock_guard<std::mutex> lock(mutex);
+  brightness = value;
+}
+
+void PosixLedOutput::setPixel(int index, LedRGB color) {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (index >= 0 && index < (int)buffer.size())
+    buffer[index] = color;
+}
+
+void PosixLedOutput::show() {
+  std::lock_guard<std::mutex> lock(mutex);
+  shown = buffer;
+  shows++;
+}
+
+LedRGB PosixLedOutput::pixel(int index) const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return index >= 0 && index < (int)shown.size() ? shown[index] : LedRGB{0, 0, 0};
+}
+
+uint8_t PosixLedOutput::getBrightness() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return brightness;
+}
+
+uint32_t PosixLedOutput::showCount() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return shows;
+}
+
+// ---------------------------
+// VirtualSensorMatrix
+// ---------------------------
+
+void VirtualSensorMatrix::selectColumn(int col) {
+  if (col == 0 || selectedCol < 0)
+    latched = magnets.load();
+  selectedCol = col;
+}
+
+bool VirtualSensorMatrix::readRow(int row) {
+  if (selectedCol < 0 || row < 0 || row >= HAL_SENSOR_ROWS)
+    return false;
+  return (latched >> (row * HAL_SENSOR_COLS + selectedCol)) & 1;
+}
+
+SensorWiring VirtualSensorMatrix::getWiring() const {
+  // Pin numbers no ESP32 has, so a calibration saved on hardware is never reused here
+  SensorWiring wiring;
+  for (int i = 0; i < HAL_SENSOR_ROWS; i++)
+    wiring.rowPins[i] = (uint8_t)(200 + i);
+  for (int i = 0; i < HAL_WIRING_COLUMN_PINS; i++)
+    wiring.columnPins[i] = (uint8_t)(210 + i);
+  return wiring;
+}
+
+String VirtualSensorMatrix::describeRow(int row) const {
+  return "virtual row " + String(row);
+}
+
+String VirtualSensorMatrix::describeColumn(int col) const {
+  return "virtual column " + String(col);
+}
+
+void VirtualSensorMatrix::setOccupied(int row, int col, bool occupied) {
+  uint64_t bit = 1ULL << (row * HAL_SENSOR_COLS + col);
+  if (occupied)
+    magnets.fetch_or(bit);
+  else
+    magnets.fetch_and(~bit);
+}
+
+bool VirtualSensorMatrix::isOccupied(int row, int col) const {
+  return (magnets.load() >> (row * HAL_SENSOR_COLS + col)) & 1;
+}
+
+void VirtualSensorMatrix::setFromBoard(const char board[8][8]) {
+  uint64_t bits = 0;
+  for (int row = 0; row < 8; row++)
+    for (int col = 0; col < 8; col++)
+      if (board[row][col] != ' ')
+        bits |= 1ULL << (row * HAL_SENSOR_COLS + col);
+  magnets.store(bits);
+}
+
+// ---------------------------
+// FileSettingsStore
+// ---------------------------
+
+std::string FileSettingsStore::namespaceDir(const char* ns) const {
+  std::string dir = root.empty() ? std::string(HostPlatform::dataDir()) + "/nvs" : root;
+  return dir + "/" + ns;
+}
+
+std::string FileSettingsStore::keyPath(const char* ns, const char* key) const {
+  return namespaceDir(ns) + "/" + key;
+}
+
+bool FileSettingsStore::isAvailable() {
+  std::string dir = root.empty() ? std::string(HostPlatform::dataDir()) + "/nvs" : root;
+  return HostPlatform::makeDirs(dir.c_str());
+}
+
+uint8_t FileSettingsStore::getUChar(const char* ns, const char* key, uint8_t defaultValue) {
+  uint8_t value;
+  return getBytes(ns, key, &value, sizeof(value)) ? value : defaultValue;
+}
+
+void FileSettingsStore::putUChar(const char* ns, const char* key, uint8_t value) {
+  putBytes(ns, key, &value, sizeof(value));
+}
+
+bool FileSettingsStore::getBytes(const char* ns, const char* key, void* buf, size_t len) {
+  std::string path = keyPath(ns, key);
+  struct stat st;
+  if (stat(path.c_str(), &st) != 0 || (size_t)st.st_size != len)
+    return false;
+  FILE* f = fopen(path.c_str(), "rb");
+  if (!f)
+    return false;
+  bool ok = fread(buf, 1, len, f) == len;
+  fclose(f);
+  return ok;
+}
+
+void FileSettingsStore::putBytes(const char* ns, const char* key, const void* buf, size_t len) {
+  if (!isAvailable())
+    return;
+  mkdir(namespaceDir(ns).c_str(), 0755);
+  // Write aside and rename, so a crash never leaves a value of the wrong length
+  std::string path = keyPath(ns, key);
+  std::string temp = path + ".tmp";
+  FILE* f = fopen(temp.c_str(), "wb");
+  if (!f)
+    return;
+  bool ok = fwrite(buf, 1, len, f) == len;
+  ok = fclose(f) == 0 && ok;
+  if (!ok || rename(temp.c_str(), path.c_str()) != 0)
+    unlink(temp.c_str());
+}
+
+void FileSettingsStore::clear(const char* ns) {
+  std::string dir = namespaceDir(ns);
+  DIR* d = opendir(dir.c_str());
+  if (!d)
+    return;
+  while (struct dirent* entry = readdir(d))
+    if (entry->d_type == DT_REG)
+      unlink((dir + "/" + entry->d_name).c_str());
+  closedir(d);
+}
+
+// ---------------------------
+// SimWiFiLink
+// ---------------------------
+
+int SimWiFiLink::addAccessPoint(const char* ssid, const char* password, uint8_t channel) {
+  AccessPoint ap;
+  ap.ssid = ssid;
+  ap.password = password ? password : "";
+  ap.channel = channel;
+  ap.up = true;
+  int id = (int)accessPoints.size();
+  const uint8_t bssid[6] = {0x02, 0x5c, 0x00, 0x00, 0x01, (uint8_t)id}; // Locally administered
+  memcpy(ap.bssid, bssid, sizeof(ap.bssid));
+  // 10.0.<id>.100 behind a gateway and DNS at .1, in network byte order like IPAddress
+  const uint8_t ip[4] = {10, 0, (uint8_t)id, 100}, gateway[4] = {10, 0, (uint8_t)id, 1}, subnet[4] = {255, 255, 255, 0};
+  memcpy(&ap.lease.ip, ip, 4);
+  memcpy(&ap.lease.gateway, gateway, 4);
+  memcpy(&ap.lease.subnet, subnet, 4);
+  ap.lease.dns = ap.lease.gateway;
+  ap.lease.obtainedAt = 0;
+  accessPoints.push_back(ap);
+  return id;
+}
+
+void SimWiFiLink::setAccessPointUp(int id, bool up) {
+  accessPoints[id].up = up;
+  if (!up && associated == id)
+    dropLink();
+}
+
+void SimWiFiLink::setAccessPointChannel(int id, uint8_t channel) {
+  accessPoints[id].channel = channel;
+  if (associated == id)
+    dropLink(); // Clients are kicked when the router changes channel
+}
+
+void SimWiFiLink::replaceAccessPointBssid(int id) {
+  accessPoints[id].bssid[4]++;
+  if (associated == id)
+    dropLink();
+}
+
+int SimWiFiLink::findJoinable(const char* ssid, const char* password) const {
+  for (size_t i = 0; i < accessPoints.size(); i++) {
+    const AccessPoint& ap = accessPoints[i];
+    if (ap.up && ap.ssid == ssid && ap.password == (password ? password : ""))
+      return (int)i;
+  }
+  return -1;
+}
+
+void SimWiFiLink::connect(const char* ssid, const char* password, const WiFiFastConnect* hint, const WiFiLease* lease) {
+  counters.connects++;
+  if (associated >= 0)
+    dropLink(); // Joining elsewhere leaves the current network first
+  int target = findJoinable(ssid, password);
+  if (hint && hint->channel != 0) {
+    counters.fastConnects++;
+    // Only the cached BSSID on the cached channel is probed: no scan
+    bool hintValid = target >= 0 && accessPoints[target].channel == hint->channel && memcmp(accessPoints[target].bssid, hint->bssid, 6) == 0;
+    pendingAp = hintValid ? target : -1;
+    attemptDoneAt = clock + (hintValid ? fastJoinMs : failMs);
+  } else {
+    pendingAp = target;
+    attemptDoneAt = clock + (target >= 0 ? scanJoinMs : failMs);
+  }
+  staticAddress = false;
+  if (pendingAp >= 0) {
+    const WiFiLease& offered = accessPoints[pendingAp].lease;
+    staticAddress = lease && lease->ip == offered.ip && lease->subnet == offered.subnet && lease->gateway == offered.gateway;
+    if (staticAddress)
+      counters.leaseReuses++;
+    else
+      attemptDoneAt += dhcpMs;
+  }
+  attemptPending = true;
+}
+
+void SimWiFiLink::renewLease() {
+  if (associated < 0)
+    return;
+  counters.leaseRenewals++;
+  staticAddress = false; // The server confirms the same fixed lease
+}
+
+void SimWiFiLink::disconnect() {
+  counters.disconnects++;
+  attemptPending = false;
+  if (associated >= 0)
+    dropLink();
+}
+
+void SimWiFiLink::dropLink() {
+  associated = -1;
+  if (connector)
+    connector->notifyLinkDown(clock);
+}
+
+void SimWiFiLink::advance(unsigned long now) {
+  clock = now;
+  if (!attemptPending || (long)(now - attemptDoneAt) < 0)
+    return;
+  attemptPending = false;
+  // The access point may have gone away while the attempt was running
+  if (pendingAp >= 0 && accessPoints[pendingAp].up) {
+    associated = pendingAp;
+    if (connector)
+      connector->notifyLinkUp();
+  } else if (connector) {
+    connector->notifyLinkDown(now);
+  }
+}
+
+bool SimWiFiLink::readFastConnect(WiFiFastConnect& out) {
+  if (associated < 0)
+    return false;
+  memcpy(out.bssid, accessPoints[associated].bssid, sizeof(out.bssid));
+  out.channel = accessPoints[associated].channel;
+  return true;
+}
+
+bool SimWiFiLink::readLease(WiFiLease& out) {
+  if (associated < 0)
+    return false;
+  out = accessPoints[associated].lease;
+  return true;
+}
@@ -0,0 +1,170 @@
+#ifndef HAL_POSIX_H
+#define HAL_POSIX_H
+
+#include "../hal.h"
+#include "../wifi_connector.h"
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// ---------------------------
+// POSIX HAL Implementations
+// ---------------------------
+// What main.cpp injects in the native build (see hal.h): an LED strip that
+// keeps its pixels in memory, a sensor matrix whose magnets are set by the
+// caller, settings in files and a simulated WiFi radio. Tests and harnesses
+// drive them directly.
+
+/// LED strip held in memory. show() copies the buffer to what a viewer would see.
+class PosixLedOutput : public LedOutput {
+ private:
+  mutable std::mutex mutex;
+  std::vector<LedRGB> buffer;
+  std::vector<LedRGB> shown;
+  uint8_t brightness = 255;
+  uint32_t shows = 0;
+
+ public:
+  explicit PosixLedOutput(uint16_t count);
+  void begin() override {}
+  void setBrightness(uint8_t value) override;
+  void setPixel(int index, LedRGB color) override;
+  void show() override;
+
+  /// Last shown color of strip index `index` (before brightness scaling).
+  LedRGB pixel(int index) const;
+  uint8_t getBrightness() const;
+  uint32_t showCount() const;
+};
+
+/// Sensor matrix whose magnets are placed by the caller, from any thread.
+/// Raw rows and columns are in square order, so an identity calibration
+/// (BoardDriver::saveIdentityCalibration) maps raw (row, col) to the square
+/// at the same board row and column.
+class VirtualSensorMatrix : public SensorMatrix {
+ private:
+  std::atomic<uint64_t> magnets{0}; // Bit row * 8 + col
+  int selectedCol = -1;
+  uint64_t latched = 0;             // Snapshot taken when column 0 is selected, so one scan is consistent
+
+ public:
+  void begin() override {}
+  void selectColumn(int col) override;
+  void releaseColumns() override { selectedCol = -1; }
+  bool readRow(int row) override;
+  SensorWiring getWiring() const override;
+  String describeRow(int row) const override;
+  String describeColumn(int col) const override;
+
+  void setOccupied(int row, int col, bool occupied);
+  bool isOccupied(int row, int col) const;
+  /// Set every square at once: bit row * 8 + col.
+  void setOccupancy(uint64_t bits) { magnets.store(bits); }
+  uint64_t occupancy() const { return magnets.load(); }
+  /// A magnet on every square `board` has a piece on (' ' = empty).
+  void setFromBoard(const char board[8][8]);
+};
+
+/// SettingsStore as one file per key, `<dir>/<namespace>/<key>` holding the raw
+/// bytes. With the default directory this is the same layout the native
+/// Preferences uses, so settings written either way are visible to both.
+class FileSettingsStore : public SettingsStore {
+ private:
+  std::string root; // Empty = <HostPlatform::dataDir()>/nvs, resolved per call
+
+  std::string namespaceDir(const char* ns) const;
+  std::string keyPath(const char* ns, const char* key) const;
+
+ public:
+  FileSettingsStore() = default;
+  explicit FileSettingsStore(const char* dir) : root(dir) {}
+  bool isAvailable() override;
+  uint8_t getUChar(const char* ns, const char* key, uint8_t defaultValue) override;
+  void putUChar(const char* ns, const char* key, uint8_t value) override;
+  bool getBytes(const char* ns, const char* key, void* buf, size_t len) override;
+  void putBytes(const char* ns, const char* key, const void* buf, size_t len) override;
+  void clear(const char* ns) override;
+};
+
+/// Simulated WiFi radio with a set of access points and association latencies.
+///
+/// connect() schedules the outcome; advance(now) delivers whatever is due to
+/// the connector as link-up/link-down notifications, standing in for the
+/// ESP32's WiFi event task. An access point can be taken down (a blip), moved
+/// to another channel or have its BSSID replaced while the connector runs.
+/// Each access point's DHCP server hands out one fixed lease on its own subnet
+/// (10.0.<id>.0/24); a join that brings that lease along skips DHCP and stays
+/// on a static address until renewLease().
+class SimWiFiLink : public WiFiLink {
+ public:
+  // Defaults in the range an ESP32 shows against a home router
+  static constexpr unsigned long DEFAULT_FAST_JOIN_MS = 150;   // Known BSSID and channel: auth + assoc
+  static constexpr unsigned long DEFAULT_SCAN_JOIN_MS = 2600;  // All-channel scan first
+  static constexpr unsigned long DEFAULT_DHCP_MS = 900;        // Added to a join without a valid lease
+  static constexpr unsigned long DEFAULT_FAIL_MS = 2400;       // Scan that finds nothing joinable
+
+  struct AccessPoint {
+    std::string ssid;
+    std::string password;
+    uint8_t bssid[6];
+    uint8_t channel;
+    bool up;
+    WiFiLease lease; // What its DHCP server hands out
+  };
+
+  struct Stats {
+    uint32_t connects;     // connect() calls
+    uint32_t fastConnects; // ... with a hint
+    uint32_t leaseReuses;  // ... with a lease the access point accepted (no DHCP)
+    uint32_t leaseRenewals; // renewLease() calls on an associated link
+    uint32_t disconnects;
+  };
+
+  unsigned long fastJoinMs = DEFAULT_FAST_JOIN_MS;
+  unsigned long scanJoinMs = DEFAULT_SCAN_JOIN_MS;
+  unsigned long dhcpMs = DEFAULT_DHCP_MS;
+  unsigned long failMs = DEFAULT_FAIL_MS;
+
+  /// Add an access point, up. Returns its id for the calls below.
+  int addAccessPoint(const char* ssid, const char* password, uint8_t channel);
+  /// Bring an access point down or back up. Taking down the one the link is on drops the link.
+  void setAccessPointUp(int id, bool up);
+  void setAccessPointChannel(int id, uint8_t channel);
+  /// Give an access point a new BSSID (the router was replaced).
+  void replaceAccessPointBssid(int id);
+  const AccessPoint& accessPoint(int id) const { return accessPoints[id]; }
+
+  /// Where notifications go, and the clock they are stamped with.
+  void attach(WiFiConnector* connector) { this->connector = connector; }
+  /// Deliver the outcome of the pending attempt if it is due at `now`.
+  void advance(unsigned long now);
+  /// Access point the link is associated with, -1 if none.
+  int associatedWith() const { return associated; }
+  /// The link is up on a reused lease that DHCP hasn't taken back over.
+  bool onStaticAddress() const { return associated >= 0 && staticAddress; }
+  Stats stats() const { return counters; }
+
+  void begin() override {}
+  void connect(const char* ssid, const char* password, const WiFiFastConnect* hint, const WiFiLease* lease) override;
+  void renewLease() override;
+  void disconnect() override;
+  bool readFastConnect(WiFiFastConnect& out) override;
+  bool readLease(WiFiLease& out) override;
+
+ private:
+  std::vector<AccessPoint> accessPoints;
+  WiFiConnector* connector = nullptr;
+  unsigned long clock = 0;   // Last advance() time
+  int associated = -1;
+  int pendingAp = -1;        // Access point the pending attempt will join, -1 = it will fail
+  bool attemptPending = false;
+  bool staticAddress = false; // The pending or current join uses a reused lease
+  unsigned long attemptDoneAt = 0;
+  Stats counters = {};
+
+  int findJoinable(const char* ssid, const char* password) const;
+  void dropLink();
+};
+
+#endif // HAL_POSIX_H
@@ -0,0 +1,241 @@
+#include "../profiler.h"
+#include <atomic>
+#include <host_platform.h>
+#include <link.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <ucontext.h>
+
+// ---------------------------
+// Profiler: Native Build
+// ---------------------------
+// The tick hook becomes SIGPROF from an ITIMER_PROF timer. That timer runs on
+// the process's CPU time, so the kernel signals whichever thread is using the
+// CPU and an idle process is not sampled. The board would record its idle
+// task there instead, so a window can't close on its sample count alone; it
+// also closes after its length in real time. The handler only appends, as
+// the tick hooks do.
+//
+// PCs are stored minus the program's load bias, which gives the link-time
+// addresses addr2line expects for a PIE. PCs outside the program's code are
+// stored as PROFILE_OUTSIDE. The core bit is the core the sampled thread's task
+// was pinned to. The build id is the SHA-256 of /proc/self/exe, so the
+// symbolizer checks it against the ELF exactly as on the board.
+
+extern "C" char __executable_start; // Linker-defined bounds of the program's code
+extern "C" char etext;
+
+static uint32_t* samples = nullptr;
+static std::atomic<uint32_t> nextSample(0);
+static uint32_t targetSamples = 0;
+static std::atomic<bool> capturing(false);
+static bool handlerInstalled = false;
+static bool hasCapture = false; // startUs can't mark it: the real clock reads 0 on its first call
+static uintptr_t loadBias = 0;
+static int64_t startUs = 0;
+static int64_t deadlineUs = 0;
+static std::atomic<int64_t> endUs(0);
+static ProfileHeader header;
+
+static int findLoadBias(struct dl_phdr_info* info, size_t, void*) {
+  loadBias = (uintptr_t)info->dlpi_addr;
+  return 1; // The first object is the program itself
+}
+
+static void setTimer(uint32_t intervalUs) {
+  struct itimerval timer = {};
+  timer.it_interval.tv_usec = intervalUs;
+  timer.it_value.tv_usec = intervalUs;
+  setitimer(ITIMER_PROF, &timer, nullptr);
+}
+
+// Safe in the signal handler: setitimer() and clock_gettime() are async-signal-safe
+static void closeWindow() {
+  bool expected = true;
+  if (!capturing.compare_exchange_strong(expected, false))
+    return;
+  setTimer(0);
+  endUs.store((int64_t)HostClock::realMicros());
+}
+
+static uintptr_t interruptedPc(void* context) {
+  const ucontext_t* uc = static_cast<const ucontext_t*>(context);
+#if defined(__x86_64__)
+  return (uintptr_t)uc->uc_mcontext.gregs[REG_RIP];
+#elif defined(__aarch64__)
+  return (uintptr_t)uc->uc_mcontext.pc;
+#else
+  (void)uc;
+  return 0; // Unknown architecture: every sample counts as outside the program
+#endif
+}
+
+static void sampleSignal(int, siginfo_t*, void* context) {
+  if (!capturing.load(std::memory_order_relaxed))
+    return;
+  if ((int64_t)HostClock::realMicros() >= deadlineUs) {
+    closeWindow();
+    return;
+  }
+  uint32_t index = nextSample.fetch_add(1);
+  if (index >= targetSamples) {
+    closeWindow();
+    return;
+  }
+  uintptr_t pc = interruptedPc(context);
+  bool inProgram = pc >= (uintptr_t)&__executable_start && pc < (uintptr_t)&etext;
+  uint32_t sample = inProgram ? (uint32_t)(pc - loadBias) : PROFILE_OUTSIDE;
+  samples[index] = sample | (HostPlatform::taskCore() ? PROFILE_CORE_BIT : 0);
+}
+
+bool Profiler::start(uint8_t seconds) {
+  if (capturing.load())
+    return false;
+  if (!samples) {
+    samples = (uint32_t*)malloc(PROFILE_MAX_SAMPLES * sizeof(uint32_t));
+    if (!samples)
+      return false;
+  }
+  if (!handlerInstalled) {
+    dl_iterate_phdr(findLoadBias, nullptr);
+    struct sigaction action = {};
+    action.sa_sigaction = sampleSignal;
+    action.sa_flags = SA_SIGINFO | SA_RESTART; // Don't fail the firmware's blocking calls with EINTR
+    sigemptyset(&action.sa_mask);
+    if (sigaction(SIGPROF, &action, nullptr) != 0)
+      return false;
+    handlerInstalled = true;
+  }
+
+  seconds = constrain(seconds, (uint8_t)1, PROFILE_MAX_SECONDS);
+  targetSamples = min(PROFILE_MAX_SAMPLES, (uint32_t)seconds * PROFILE_SAMPLE_HZ * portNUM_PROCESSORS);
+  nextSample.store(0);
+  startUs = (int64_t)HostClock::realMicros();
+  deadlineUs = startUs + (int64_t)seconds * 1000000;
+  endUs.store(0);
+  hasCapture = true;
+  capturing.store(true);
+  // PROFILE_SAMPLE_HZ per core: both cores' worth of CPU time gets that many samples each
+  setTimer(1000000 / (PROFILE_SAMPLE_HZ * portNUM_PROCESSORS));
+  return true;
+}
+
+bool Profiler::isRunning() {
+  if (capturing.load() && (int64_t)HostClock::realMicros() >= deadlineUs)
+    closeWindow(); // An idle process gets no signal to close its own window
+  return capturing.load();
+}
+
+void Profiler::release() {
+  closeWindow();
+  HostClock::realSleepMicros(2000); // Let a handler that already passed the capturing check finish its store
+  free(samples);
+  samples = nullptr;
+  hasCapture = false;
+}
+
+// ---------------------------
+// Build Id
+// ---------------------------
+
+static const uint32_t SHA256_K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+static inline uint32_t rotr(uint32_t x, int n) { return (x >> n) | (x << (32 - n)); }
+
+static void sha256Block(uint32_t state[8], const uint8_t block[64]) {
+  uint32_t w[64];
+  for (int i = 0; i < 16; i++)
+    w[i] = (uint32_t)block[4 * i] << 24 | (uint32_t)block[4 * i + 1] << 16 | (uint32_t)block[4 * i + 2] << 8 | block[4 * i + 3];
+  for (int i = 16; i < 64; i++) {
+    uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+    uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+    w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+  }
+  uint32_t a = state[0], b = state[1], c = state[2], d = state[3], e = state[4], f = state[5], g = state[6], h = state[7];
+  for (int i = 0; i < 64; i++) {
+    uint32_t t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + SHA256_K[i] + w[i];
+    uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+    h = g; g = f; f = e; e = d + t1;
+    d = c; c = b; b = a; a = t1 + t2;
+  }
+  state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+  state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+}
+
+// SHA-256 of the running program, as esp_app_desc_t::app_elf_sha256 is of the firmware ELF
+static void programSha256(uint8_t out[32]) {
+  memset(out, 0, 32);
+  FILE* f = fopen("/proc/self/exe", "rb");
+  if (!f)
+    return;
+  uint32_t state[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+  uint8_t block[64];
+  uint64_t totalBytes = 0;
+  size_t n;
+  while ((n = fread(block, 1, sizeof(block), f)) == sizeof(block)) {
+    sha256Block(state, block);
+    totalBytes += n;
+  }
+  fclose(f);
+  totalBytes += n;
+  // Padding: 0x80, zeros, then the length in bits (one or two final blocks)
+  block[n++] = 0x80;
+  if (n > 56) {
+    memset(block + n, 0, 64 - n);
+    sha256Block(state, block);
+    n = 0;
+  }
+  memset(block + n, 0, 56 - n);
+  for (int i = 0; i < 8; i++)
+    block[56 + i] = (uint8_t)((totalBytes * 8) >> (56 - 8 * i));
+  sha256Block(state, block);
+  for (int i = 0; i < 8; i++)
+    for (int j = 0; j < 4; j++)
+      out[4 * i + j] = (uint8_t)(state[i] >> (24 - 8 * j));
+}
+
+// ---------------------------
+// Capture File
+// ---------------------------
+
+size_t Profiler::captureSize() {
+  if (isRunning() || !samples || !hasCapture)
+    return 0;
+  return sizeof(ProfileHeader) + min(nextSample.load(), targetSamples) * sizeof(uint32_t);
+}
+
+size_t Profiler::readCapture(size_t offset, uint8_t* out, size_t len) {
+  size_t total = captureSize();
+  if (offset >= total)
+    return 0;
+  if (offset == 0) {
+    memcpy(header.magic, PROFILE_MAGIC, sizeof(header.magic));
+    header.version = PROFILE_VERSION;
+    header.sampleHz = PROFILE_SAMPLE_HZ;
+    header.sampleCount = (total - sizeof(ProfileHeader)) / sizeof(uint32_t);
+    header.durationMs = (uint32_t)((endUs.load() - startUs) / 1000);
+    programSha256(header.elfSha256);
+  }
+  size_t copied = 0;
+  len = min(len, total - offset);
+  if (offset < sizeof(ProfileHeader)) {
+    size_t n = min(len, sizeof(ProfileHeader) - offset);
+    memcpy(out, (const uint8_t*)&header + offset, n);
+    copied = n;
+  }
+  if (copied < len)
+    memcpy(out + copied, (const uint8_t*)samples + (offset + copied - sizeof(ProfileHeader)), len - copied);
+  return len;
+}
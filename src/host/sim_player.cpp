@@ -0,0 +1,298 @@
+#include "sim_player.h"
+#include "../chess_utils.h"
+#include "../wifi_manager_esp32.h"
+#include <string.h>
+
+// ---------------------------
+// SimPosition
+// ---------------------------
+
+static const char START_BOARD[8][8] = {
+    {'r', 'n', 'b', 'q', 'k', 'b', 'n', 'r'},
+    {'p', 'p', 'p', 'p', 'p', 'p', 'p', 'p'},
+    {' ', ' ', ' ', ' ', ' ', ' ', ' ', ' '},
+    {' ', ' ', ' ', ' ', ' ', ' ', ' ', ' '},
+    {' ', ' ', ' ', ' ', ' ', ' ', ' ', ' '},
+    {' ', ' ', ' ', ' ', ' ', ' ', ' ', ' '},
+    {'P', 'P', 'P', 'P', 'P', 'P', 'P', 'P'},
+    {'R', 'N', 'B', 'Q', 'K', 'B', 'N', 'R'},
+};
+
+void SimPosition::reset() {
+  memcpy(board, START_BOARD, sizeof(board));
+  turn = 'w';
+  engine.reset();
+  engine.recordPosition(board, turn);
+}
+
+void SimPosition::load(const String& fen) {
+  engine.reset();
+  ChessUtils::fenToBoard(fen, board, turn, &engine);
+  engine.recordPosition(board, turn);
+}
+
+String SimPosition::fen() {
+  return ChessUtils::boardToFEN(board, turn, &engine);
+}
+
+bool SimPosition::apply(const String& uci) {
+  int fromRow, fromCol, toRow, toCol;
+  char promotion;
+  if (!ChessUtils::parseUCIMove(uci, fromRow, fromCol, toRow, toCol, promotion))
+    return false;
+  if (board[fromRow][fromCol] == ' ' || ChessUtils::getPieceColor(board[fromRow][fromCol]) != turn)
+    return false;
+  int moveCount = 0;
+  int moves[28][2];
+  engine.getPossibleMoves(board, fromRow, fromCol, moveCount, moves);
+  for (int i = 0; i < moveCount; i++)
+    if (moves[i][0] == toRow && moves[i][1] == toCol) {
+      apply(fromRow, fromCol, toRow, toCol, promotion);
+      return true;
+    }
+  return false;
+}
+
+void SimPosition::apply(int fromRow, int fromCol, int toRow, int toCol, char promotion) {
+  char piece = board[fromRow][fromCol];
+  char captured = board[toRow][toCol];
+  if (ChessUtils::isEnPassantMove(fromRow, fromCol, toRow, toCol, piece, captured)) {
+    int pawnRow = ChessUtils::getEnPassantCapturedPawnRow(toRow, piece);
+    captured = board[pawnRow][toCol];
+    board[pawnRow][toCol] = ' ';
+  }
+  if (toupper(piece) == 'P' && abs(toRow - fromRow) == 2)
+    engine.setEnPassantTarget((fromRow + toRow) / 2, fromCol);
+  else
+    engine.clearEnPassantTarget();
+  engine.updateHalfmoveClock(piece, captured);
+  board[toRow][toCol] = piece;
+  board[fromRow][fromCol] = ' ';
+
+  if (ChessUtils::isCastlingMove(fromRow, fromCol, toRow, toCol, piece)) {
+    int rookFromCol = toCol > fromCol ? 7 : 0;
+    int rookToCol = toCol > fromCol ? 5 : 3;
+    board[toRow][rookToCol] = board[toRow][rookFromCol];
+    board[toRow][rookFromCol] = ' ';
+  }
+
+  // Castling rights, as ChessGame::updateCastlingRightsAfterMove()
+  uint8_t rights = engine.getCastlingRights();
+  if (piece == 'K')
+    rights &= ~(0x01 | 0x02);
+  else if (piece == 'k')
+    rights &= ~(0x04 | 0x08);
+  auto cornerRight = [](int row, int col) -> uint8_t {
+    if (row == 7 && col == 7) return 0x01;
+    if (row == 7 && col == 0) return 0x02;
+    if (row == 0 && col == 7) return 0x04;
+    if (row == 0 && col == 0) return 0x08;
+    return 0;
+  };
+  if (toupper(piece) == 'R')
+    rights &= ~cornerRight(fromRow, fromCol);
+  if (toupper(captured) == 'R')
+    rights &= ~cornerRight(toRow, toCol);
+  engine.setCastlingRights(rights);
+
+  if (engine.isPawnPromotion(piece, toRow)) {
+    char promoted = promotion != ' ' && promotion != '\0' ? promotion : 'q';
+    board[toRow][toCol] = ChessUtils::isWhitePiece(piece) ? toupper(promoted) : tolower(promoted);
+  }
+  engine.incrementFullmoveClock(turn);
+  turn = turn == 'w' ? 'b' : 'w';
+  engine.recordPosition(board, turn);
+}
+
+// ---------------------------
+// SimEngine
+// ---------------------------
+
+static int pieceValue(char piece) {
+  switch (toupper(piece)) {
+    case 'P': return 1;
+    case 'N': return 3;
+    case 'B': return 3;
+    case 'R': return 5;
+    case 'Q': return 9;
+    default: return 0;
+  }
+}
+
+// splitmix64 finalizer: spreads the position hash over every bit the choice uses
+static uint64_t mixBits(uint64_t x) {
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9ULL;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+String SimEngine::bestMove(const String& fen, uint32_t salt) {
+  SimPosition pos;
+  pos.load(fen);
+
+  struct Candidate {
+    int8_t fromRow, fromCol, toRow, toCol;
+  };
+  Candidate candidates[256]; // No position has more legal moves
+  int count = 0;
+  int bestCapture = -1;
+  int bestCaptureValue = 0;
+  for (int row = 0; row < 8; row++)
+    for (int col = 0; col < 8; col++) {
+      char piece = pos.board[row][col];
+      if (piece == ' ' || ChessUtils::getPieceColor(piece) != pos.turn)
+        continue;
+      int moveCount = 0;
+      int moves[28][2];
+      pos.engine.getPossibleMoves(pos.board, row, col, moveCount, moves);
+      for (int i = 0; i < moveCount && count < 256; i++) {
+        int toRow = moves[i][0], toCol = moves[i][1];
+        char target = pos.board[toRow][toCol];
+        int value = ChessUtils::isEnPassantMove(row, col, toRow, toCol, piece, target) ? 1 : pieceValue(target);
+        if (value > bestCaptureValue) {
+          bestCaptureValue = value;
+          bestCapture = count;
+        }
+        candidates[count++] = {(int8_t)row, (int8_t)col, (int8_t)toRow, (int8_t)toCol};
+      }
+    }
+  if (count == 0)
+    return "";
+
+  auto uciOf = [&](const Candidate& c) {
+    bool promotes = pos.engine.isPawnPromotion(pos.board[c.fromRow][c.fromCol], c.toRow);
+    return ChessUtils::toUCIMove(c.fromRow, c.fromCol, c.toRow, c.toCol, promotes ? 'q' : ' ');
+  };
+  for (int i = 0; i < count; i++) {
+    SimPosition next = pos;
+    next.apply(candidates[i].fromRow, candidates[i].fromCol, candidates[i].toRow, candidates[i].toCol);
+    if (next.engine.isCheckmate(next.board, next.turn))
+      return uciOf(candidates[i]);
+  }
+
+  int epRow, epCol;
+  pos.engine.getEnPassantTarget(epRow, epCol);
+  uint64_t hash = mixBits(pos.engine.computeZobristHash(pos.board, pos.turn) ^ ((uint64_t)pos.engine.getCastlingRights() << 56) ^ ((uint64_t)(epCol + 1) << 48) ^ salt);
+  if (bestCapture >= 0 && (hash & 3) != 0) // Three times out of four
+    return uciOf(candidates[bestCapture]);
+  return uciOf(candidates[(hash >> 2) % count]);
+}
+
+// ---------------------------
+// SimPlayer
+// ---------------------------
+
+SimPlayer::SimPlayer(BoardDriver* driver, VirtualSensorMatrix* sensors, PosixLedOutput* leds, WiFiManagerESP32* wifi)
+    : driver(driver), sensors(sensors), leds(leds), wifi(wifi), humanColor(' '), salt(0), active(false), actionCount(0), nextAction(0), actionApplied(false), ownMoveCount(0), promptedMoveCount(0) {}
+
+void SimPlayer::startGame(char humanColor, uint32_t salt) {
+  this->humanColor = humanColor;
+  this->salt = salt;
+  active = false;
+  actionCount = 0;
+  nextAction = 0;
+  actionApplied = false;
+  actedFen = "";
+  ownMoveCount = 0;
+  promptedMoveCount = 0;
+  sensors->setFromBoard(START_BOARD);
+}
+
+void SimPlayer::push(int row, int col, bool occupied) {
+  actions[actionCount++] = {(int8_t)row, (int8_t)col, occupied};
+}
+
+void SimPlayer::step() {
+  if (!active)
+    return;
+  if (nextAction < actionCount) {
+    const Action& action = actions[nextAction];
+    if (!actionApplied) {
+      sensors->setOccupied(action.row, action.col, action.occupied);
+      actionApplied = true;
+    } else if (driver->getSensorState(action.row, action.col) == action.occupied) {
+      nextAction++; // Debounced: the firmware has seen it
+      actionApplied = false;
+    }
+    return;
+  }
+
+  // Nothing in hand: wait for the firmware to publish the position after the last move
+  String fen = wifi->getCurrentFen();
+  if (fen.length() == 0 || fen == actedFen)
+    return;
+  SimPosition pos;
+  pos.load(fen);
+  int fromRow, fromCol, toRow, toCol;
+  if (humanColor == ' ' || pos.turn == humanColor) {
+    String move = SimEngine::bestMove(fen, salt);
+    char promotion;
+    if (!ChessUtils::parseUCIMove(move, fromRow, fromCol, toRow, toCol, promotion))
+      return; // No legal move: the firmware ends the game
+    queueMove(pos, fromRow, fromCol, toRow, toCol, false);
+    ownMoveCount++;
+  } else {
+    if (!readPrompt(fromRow, fromCol, toRow, toCol))
+      return; // The opponent is still thinking
+    queueMove(pos, fromRow, fromCol, toRow, toCol, true);
+    promptedMoveCount++;
+  }
+  actedFen = fen;
+}
+
+bool SimPlayer::readPrompt(int& fromRow, int& fromCol, int& toRow, int& toCol) const {
+  int sources = 0, targets = 0;
+  for (int row = 0; row < 8; row++)
+    for (int col = 0; col < 8; col++) {
+      // Dark squares are dimmed, so compare channels rather than exact colors
+      LedRGB c = leds->pixel(row * 8 + col);
+      bool cyan = c.r == 0 && c.g > 0 && c.g == c.b;
+      bool white = c.r > 0 && c.r == c.g && c.g == c.b;
+      bool red = c.r > 0 && c.g == 0 && c.b == 0;
+      if (cyan) {
+        fromRow = row;
+        fromCol = col;
+        sources++;
+      } else if (white || red) {
+        toRow = row;
+        toCol = col;
+        targets++;
+      }
+    }
+  return sources == 1 && targets == 1;
+}
+
+void SimPlayer::queueMove(const SimPosition& pos, int fromRow, int fromCol, int toRow, int toCol, bool prompted) {
+  actionCount = 0;
+  nextAction = 0;
+  actionApplied = false;
+  char piece = pos.board[fromRow][fromCol];
+  char target = pos.board[toRow][toCol];
+
+  if (ChessUtils::isCastlingMove(fromRow, fromCol, toRow, toCol, piece)) {
+    push(fromRow, fromCol, false);
+    push(toRow, toCol, true);
+    push(fromRow, toCol > fromCol ? 7 : 0, false);
+    push(fromRow, toCol > fromCol ? 5 : 3, true);
+    return;
+  }
+
+  int capturedRow = -1;
+  if (target != ' ')
+    capturedRow = toRow;
+  else if (ChessUtils::isEnPassantMove(fromRow, fromCol, toRow, toCol, piece, target))
+    capturedRow = ChessUtils::getEnPassantCapturedPawnRow(toRow, piece);
+
+  if (capturedRow < 0) {
+    push(fromRow, fromCol, false);
+  } else if (prompted) {
+    push(capturedRow, toCol, false);
+    push(fromRow, fromCol, false);
+  } else {
+    push(fromRow, fromCol, false);
+    push(capturedRow, toCol, false);
+  }
+  push(toRow, toCol, true);
+}
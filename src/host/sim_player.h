@@ -0,0 +1,99 @@
+#ifndef SIM_PLAYER_H
+#define SIM_PLAYER_H
+
+#include "../board_driver.h"
+#include "../chess_engine.h"
+#include "hal_posix.h"
+#include <Arduino.h>
+
+class WiFiManagerESP32;
+
+// ---------------------------
+// Simulated Games
+// ---------------------------
+// The pieces the native game-loop harnesses play with: a position that
+// follows the firmware's move rules, a stand-in engine that answers for the
+// Stockfish and Lichess stubs, and a scripted player that moves magnets on a
+// VirtualSensorMatrix the way a person follows the board.
+
+/// A position and the rules ChessGame::applyMove() plays by (castling rook,
+/// en passant, queen by default on promotion).
+class SimPosition {
+ public:
+  char board[8][8];
+  char turn;
+  ChessEngine engine;
+
+  SimPosition() { reset(); }
+  void reset();
+  void load(const String& fen);
+  String fen();
+
+  /// Apply a move given in UCI. False if it isn't legal here.
+  bool apply(const String& uci);
+  void apply(int fromRow, int fromCol, int toRow, int toCol, char promotion = ' ');
+};
+
+/// Deterministic stand-in for an engine: the same position and salt always
+/// give the same move. It mates when it can and mostly takes the most
+/// valuable capture, so scripted games end in a couple of hundred plies.
+class SimEngine {
+ public:
+  /// Best move of `fen` in UCI (promotions as queens), "" if there is none.
+  static String bestMove(const String& fen, uint32_t salt);
+};
+
+/// Plays one side, or both, on the virtual board. step() runs from the
+/// cooperative-wait service, so it acts whenever the firmware polls the
+/// sensors: one magnet change at a time, each held until the firmware has
+/// debounced it. Its own moves come from SimEngine on the FEN the firmware
+/// publishes; the opponent's moves are read off the LED prompt
+/// (waitForRemoteMoveCompletion(), castling prompts) and carried out as shown.
+/// Relies on the identity calibration: LED index = row * 8 + col.
+class SimPlayer {
+ public:
+  SimPlayer(BoardDriver* driver, VirtualSensorMatrix* sensors, PosixLedOutput* leds, WiFiManagerESP32* wifi);
+
+  /// New game from the standard position: the player moves for `humanColor`
+  /// ('w' or 'b'), or for both sides if it is ' '. Places every piece's magnet.
+  void startGame(char humanColor, uint32_t salt);
+  /// Act only once the mode's begin() has returned: its setup wait reads the magnets too.
+  void setActive(bool active) { this->active = active; }
+  void step();
+
+  uint32_t ownMoves() const { return ownMoveCount; }
+  uint32_t promptedMoves() const { return promptedMoveCount; }
+
+ private:
+  struct Action {
+    int8_t row;
+    int8_t col;
+    bool occupied; // Magnet placed (true) or lifted
+  };
+  static constexpr int MAX_ACTIONS = 4; // Castling: king lift and place, rook lift and place
+
+  BoardDriver* driver;
+  VirtualSensorMatrix* sensors;
+  PosixLedOutput* leds;
+  WiFiManagerESP32* wifi;
+  char humanColor;
+  uint32_t salt;
+  bool active;
+  Action actions[MAX_ACTIONS];
+  int actionCount;
+  int nextAction;
+  bool actionApplied;     // actions[nextAction] is on the matrix, waiting for the debounce
+  String actedFen;        // Published position the queued move was planned from
+  uint32_t ownMoveCount;
+  uint32_t promptedMoveCount;
+
+  void push(int row, int col, bool occupied);
+  /// The remote move the LEDs ask for: one Cyan square and one White or Red one.
+  bool readPrompt(int& fromRow, int& fromCol, int& toRow, int& toCol) const;
+  /// Queue the magnet changes of a move. A prompted capture lifts the captured
+  /// piece first, as the red square asks; an own capture lifts the mover first,
+  /// since tryPlayerMove() starts from the pickup.
+  void queueMove(const SimPosition& pos, int fromRow, int fromCol, int toRow, int toCol, bool prompted);
+};
+
+#endif // SIM_PLAYER_H
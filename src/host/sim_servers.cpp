@@ -0,0 +1,225 @@
+#include "sim_servers.h"
+#include "../chess_utils.h"
+#include <ArduinoJson.h>
+#include <arpa/inet.h>
+#include <host_platform.h>
+#include <netinet/in.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// ---------------------------
+// SimHttpServer
+// ---------------------------
+
+SimHttpServer::~SimHttpServer() {
+  stop();
+}
+
+bool SimHttpServer::start(const char* host, uint16_t port) {
+  listenFd = socket(AF_INET, SOCK_STREAM, 0);
+  if (listenFd < 0)
+    return false;
+  sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = 0; // Any free port
+  socklen_t len = sizeof(addr);
+  if (bind(listenFd, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(listenFd, 16) != 0 || getsockname(listenFd, (sockaddr*)&addr, &len) != 0) {
+    close(listenFd);
+    listenFd = -1;
+    return false;
+  }
+  boundPort = ntohs(addr.sin_port);
+  running = true;
+  acceptThread = std::thread([this] { serve(); });
+  HostNet::redirect(host, port, "127.0.0.1", boundPort);
+  return true;
+}
+
+void SimHttpServer::stop() {
+  if (!running.exchange(false))
+    return;
+  shutdown(listenFd, SHUT_RDWR); // Wakes accept()
+  close(listenFd);
+  listenFd = -1;
+  acceptThread.join();
+}
+
+void SimHttpServer::serve() {
+  while (running) {
+    int fd = accept(listenFd, nullptr, nullptr);
+    if (fd < 0)
+      continue;
+    serveOne(fd);
+    close(fd);
+  }
+}
+
+void SimHttpServer::serveOne(int fd) {
+  timeval timeout = {2, 0}; // A client that never finishes its request
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+  std::string request;
+  char buffer[1024];
+  size_t headerEnd = std::string::npos;
+  size_t contentLength = 0;
+  while (true) {
+    if (headerEnd == std::string::npos && (headerEnd = request.find("\r\n\r\n")) != std::string::npos) {
+      headerEnd += 4;
+      size_t field = request.find("Content-Length:");
+      if (field != std::string::npos && field < headerEnd)
+        contentLength = strtoul(request.c_str() + field + 15, nullptr, 10);
+    }
+    if (headerEnd != std::string::npos && request.size() >= headerEnd + contentLength)
+      break;
+    ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+    if (n <= 0)
+      return;
+    request.append(buffer, n);
+  }
+
+  size_t methodEnd = request.find(' ');
+  size_t pathEnd = request.find(' ', methodEnd + 1);
+  if (methodEnd == std::string::npos || pathEnd == std::string::npos)
+    return;
+  String method(request.substr(0, methodEnd).c_str());
+  String path(request.substr(methodEnd + 1, pathEnd - methodEnd - 1).c_str());
+  String body(request.substr(headerEnd, contentLength).c_str());
+  requestCount++;
+
+  int status = 200;
+  const char* contentType = "application/json";
+  String content = handle(method, path, body, status, contentType);
+  char head[160];
+  snprintf(head, sizeof(head), "HTTP/1.1 %d %s\r\nContent-Type: %s\r\nContent-Length: %u\r\nConnection: close\r\n\r\n", status, status == 200 ? "OK" : "Error", contentType, (unsigned)content.length());
+  std::string response = std::string(head) + content.c_str();
+  send(fd, response.data(), response.size(), MSG_NOSIGNAL);
+}
+
+// ---------------------------
+// StockfishStub
+// ---------------------------
+
+static String urlDecode(const String& text) {
+  String out;
+  for (size_t i = 0; i < text.length(); i++) {
+    if (text[i] == '%' && i + 2 < text.length()) {
+      char hex[3] = {text[i + 1], text[i + 2], '\0'};
+      out += (char)strtol(hex, nullptr, 16);
+      i += 2;
+    } else {
+      out += text[i];
+    }
+  }
+  return out;
+}
+
+String StockfishStub::handle(const String& method, const String& path, const String&, int& status, const char*&) {
+  int fenStart = path.indexOf("fen=");
+  int fenEnd = path.indexOf('&', fenStart);
+  if (method != "GET" || fenStart < 0) {
+    status = 400;
+    return "{\"success\":false,\"error\":\"bad request\"}";
+  }
+  String fen = urlDecode(path.substring(fenStart + 4, fenEnd < 0 ? path.length() : fenEnd));
+  String move = SimEngine::bestMove(fen, salt.load());
+  if (move.length() == 0)
+    return "{\"success\":false,\"error\":\"no legal move\"}";
+
+  SimPosition pos;
+  pos.load(fen);
+  JsonDocument doc;
+  doc["success"] = true;
+  doc["evaluation"] = ChessUtils::evaluatePosition(pos.board);
+  doc["bestmove"] = "bestmove " + move;
+  doc["continuation"] = move;
+  String out;
+  serializeJson(doc, out);
+  return out;
+}
+
+// ---------------------------
+// LichessStub
+// ---------------------------
+
+void LichessStub::newGame(const String& gameId, char boardColor, uint32_t salt) {
+  std::lock_guard<std::mutex> lock(mutex);
+  this->gameId = gameId;
+  this->boardColor = boardColor;
+  this->salt = salt;
+  position.reset();
+  moves = "";
+  pollsUntilReply = REPLY_POLLS;
+}
+
+void LichessStub::appendMove(const String& uci) {
+  if (moves.length() > 0)
+    moves += ' ';
+  moves += uci;
+}
+
+String LichessStub::gameFull() {
+  JsonDocument doc;
+  doc["type"] = "gameFull";
+  doc["id"] = gameId;
+  JsonObject board = doc[boardColor == 'w' ? "white" : "black"].to<JsonObject>();
+  board["id"] = "sim";
+  board["name"] = "sim";
+  JsonObject opponent = doc[boardColor == 'w' ? "black" : "white"].to<JsonObject>();
+  opponent["aiLevel"] = 1;
+  doc["initialFen"] = "startpos";
+  JsonObject state = doc["state"].to<JsonObject>();
+  state["type"] = "gameState";
+  state["moves"] = moves;
+  state["status"] = "started";
+  String out;
+  serializeJson(doc, out);
+  return out + "\n";
+}
+
+String LichessStub::handle(const String& method, const String& path, const String&, int& status, const char*& contentType) {
+  std::lock_guard<std::mutex> lock(mutex);
+  String gamePath = "/api/board/game/" + gameId + "/";
+  if (method == "GET" && path == "/api/account")
+    return "{\"id\":\"sim\",\"username\":\"sim\"}";
+  if (method == "GET" && path == "/api/account/playing") {
+    JsonDocument doc;
+    JsonObject game = doc["nowPlaying"].to<JsonArray>().add<JsonObject>();
+    game["gameId"] = gameId;
+    game["fen"] = position.fen();
+    game["color"] = boardColor == 'w' ? "white" : "black";
+    String out;
+    serializeJson(doc, out);
+    return out;
+  }
+  if (method == "GET" && path == "/api/board/game/stream/" + gameId) {
+    if (position.turn != boardColor) {
+      if (pollsUntilReply > 0) {
+        pollsUntilReply--;
+      } else {
+        String reply = SimEngine::bestMove(position.fen(), salt);
+        if (reply.length() > 0 && position.apply(reply))
+          appendMove(reply);
+        pollsUntilReply = REPLY_POLLS;
+      }
+    }
+    contentType = "application/x-ndjson";
+    return gameFull();
+  }
+  if (method == "POST" && path.startsWith(gamePath + "move/")) {
+    String uci = path.substring(gamePath.length() + 5);
+    if (position.turn != boardColor || !position.apply(uci)) {
+      status = 400;
+      return "{\"error\":\"Not your turn, or invalid move\"}";
+    }
+    appendMove(uci);
+    pollsUntilReply = REPLY_POLLS;
+    return "{\"ok\":true}";
+  }
+  if (method == "POST" && path == gamePath + "resign")
+    return "{\"ok\":true}";
+  status = 404;
+  return "{\"error\":\"Not found\"}";
+}
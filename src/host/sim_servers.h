@@ -0,0 +1,85 @@
+#ifndef SIM_SERVERS_H
+#define SIM_SERVERS_H
+
+#include "sim_player.h"
+#include <Arduino.h>
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+// ---------------------------
+// Stub Servers
+// ---------------------------
+// Local stand-ins for stockfish.online and lichess.org, answered by SimEngine.
+// The native WiFiClientSecure is plain TCP, so HostNet::redirect() sends the
+// firmware's connections here unchanged.
+
+/// Minimal HTTP/1.1 server on 127.0.0.1: one request per connection (the
+/// clients all send "Connection: close"), answered in a single write and
+/// closed, which is when the clients' read loops end.
+class SimHttpServer {
+ public:
+  SimHttpServer() : listenFd(-1), boundPort(0), running(false), requestCount(0) {}
+  virtual ~SimHttpServer();
+
+  /// Listen on a free port and redirect connections for host:port to it.
+  bool start(const char* host, uint16_t port);
+  void stop();
+  uint32_t requests() const { return requestCount.load(); }
+
+ protected:
+  /// Response body for one request; `status` starts at 200.
+  virtual String handle(const String& method, const String& path, const String& body, int& status, const char*& contentType) = 0;
+
+ private:
+  int listenFd;
+  uint16_t boundPort;
+  std::atomic<bool> running;
+  std::atomic<uint32_t> requestCount;
+  std::thread acceptThread;
+
+  void serve();
+  void serveOne(int fd);
+};
+
+/// GET /api/s/v2.php?fen=...&depth=N, as StockfishAPI::buildRequestURL() asks.
+class StockfishStub : public SimHttpServer {
+ public:
+  StockfishStub() : salt(0) {}
+  void setSalt(uint32_t salt) { this->salt.store(salt); }
+
+ protected:
+  String handle(const String& method, const String& path, const String& body, int& status, const char*& contentType) override;
+
+ private:
+  std::atomic<uint32_t> salt;
+};
+
+/// The Board API calls LichessAPI makes, for one game at a time against an
+/// opponent the stub plays itself. The opponent's reply shows up in the game
+/// stream REPLY_POLLS polls after the board's move, so the firmware first sees
+/// its own move echoed, as it does from lichess.org.
+class LichessStub : public SimHttpServer {
+ public:
+  static constexpr int REPLY_POLLS = 2;
+
+  /// Next game: the board plays `boardColor` ('w' or 'b') from the standard position.
+  void newGame(const String& gameId, char boardColor, uint32_t salt);
+
+ protected:
+  String handle(const String& method, const String& path, const String& body, int& status, const char*& contentType) override;
+
+ private:
+  std::mutex mutex;
+  String gameId;
+  char boardColor = 'w';
+  uint32_t salt = 0;
+  SimPosition position;
+  String moves; // Space-separated UCI, as the stream reports them
+  int pollsUntilReply = REPLY_POLLS;
+
+  String gameFull();
+  void appendMove(const String& uci);
+};
+
+#endif // SIM_SERVERS_H
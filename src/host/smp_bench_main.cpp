@@ -0,0 +1,197 @@
+#include "../chess_analysis.h"
+#include "../chess_search.h"
+#include "../chess_utils.h"
+#include <ArduinoJson.h>
+#include <algorithm>
+#include <atomic>
+#include <host_platform.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <thread>
+
+// ---------------------------
+// Native Lazy SMP Benchmark
+// ---------------------------
+// Analysis mode's search on fixed positions, alone and with one Lazy SMP
+// helper (ChessAnalysis::helperLoop: same root, one ply deeper, multi-PV 1,
+// sharing the table), timed to each depth of iterative deepening.
+//
+// Wall time only shows the speedup on a host with a core free for the helper.
+// The main search's own CPU time and node count to each depth don't depend on
+// that: they show what the shared table saves the search that reports, which
+// is what the board's second core buys. Waits run on virtual time, so the
+// search's tick yield every 1024 nodes costs nothing here (on the board it
+// costs 1 ms).
+//
+//   .pio/build/native_smp_bench/program [depth] [out.json]
+
+static constexpr int SMP_BENCH_DEFAULT_DEPTH = 5;
+static constexpr int SMP_BENCH_REPEATS = 3; // Median of these per position and thread count
+
+static const char* const SMP_BENCH_FENS[] = {
+    "r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - 2 3",
+    "r1bq1rk1/pp2bppp/2n1pn2/2pp4/3P4/2PBPN2/PP1N1PPP/R1BQ1RK1 w - - 0 8",
+    "2r2rk1/pp1q1ppp/2n1pn2/3p4/3P4/1QN1PN2/PP3PPP/2R2RK1 w - - 4 15",
+    "8/5pk1/6p1/3R4/5P2/6P1/r5KP/8 w - - 0 40",
+};
+static constexpr int SMP_BENCH_POSITIONS = sizeof(SMP_BENCH_FENS) / sizeof(SMP_BENCH_FENS[0]);
+
+struct DepthMark {
+  uint32_t wallMs;
+  uint32_t mainCpuMs;  // CPU time of the main search's thread
+  uint32_t mainNodes;  // Nodes the main search has visited
+};
+
+struct SmpRun {
+  DepthMark marks[ANALYSIS_MAX_DEPTH + 1]; // Index = completed depth
+  uint64_t totalNodes;                     // Main plus helper
+  uint32_t wallMs;
+};
+
+struct Position {
+  char board[8][8];
+  char turn;
+  uint8_t castlingRights;
+  int epRow, epCol;
+};
+
+static ChessSearch mainSearch;
+static ChessSearch helperSearch;
+
+static Position loadPosition(const char* fen) {
+  Position p;
+  ChessEngine engine;
+  ChessUtils::fenToBoard(String(fen), p.board, p.turn, &engine);
+  p.castlingRights = engine.getCastlingRights();
+  engine.getEnPassantTarget(p.epRow, p.epCol);
+  return p;
+}
+
+static SmpRun runOnce(const Position& p, int maxDepth, bool withHelper) {
+  SmpRun run = {};
+  mainSearch.begin(); // A cold table every run, as when analysis starts
+  mainSearch.setPosition(p.board, p.turn, p.castlingRights, p.epRow, p.epCol);
+  mainSearch.resetStop();
+
+  std::atomic<uint64_t> helperNodes{0};
+  std::thread helper;
+  if (withHelper) {
+    helperSearch.shareTable(mainSearch);
+    helperSearch.setPosition(p.board, p.turn, p.castlingRights, p.epRow, p.epCol);
+    helperSearch.resetStop();
+    helper = std::thread([&] {
+      SearchLine found[1];
+      for (int depth = 2; depth <= maxDepth + 1; depth++) {
+        int count = helperSearch.searchRoot(depth, 1, found);
+        helperNodes += helperSearch.getNodes();
+        if (count <= 0)
+          break;
+      }
+    });
+  }
+
+  SearchLine lines[SEARCH_MAX_LINES];
+  uint64_t startUs = HostClock::realMicros();
+  uint64_t startCpuUs = HostClock::threadCpuMicros();
+  uint64_t mainNodes = 0;
+  for (int depth = 1; depth <= maxDepth; depth++) {
+    int count = mainSearch.searchRoot(depth, ANALYSIS_MULTI_PV, lines);
+    mainNodes += mainSearch.getNodes();
+    run.marks[depth].wallMs = (uint32_t)((HostClock::realMicros() - startUs) / 1000);
+    run.marks[depth].mainCpuMs = (uint32_t)((HostClock::threadCpuMicros() - startCpuUs) / 1000);
+    run.marks[depth].mainNodes = (uint32_t)mainNodes;
+    if (count <= 0)
+      break;
+  }
+  run.wallMs = run.marks[maxDepth].wallMs;
+
+  if (withHelper) {
+    helperSearch.stop();
+    helper.join();
+  }
+  run.totalNodes = mainNodes + helperNodes.load();
+  return run;
+}
+
+static uint32_t median(uint32_t values[SMP_BENCH_REPEATS]) {
+  std::sort(values, values + SMP_BENCH_REPEATS);
+  return values[SMP_BENCH_REPEATS / 2];
+}
+
+/// Per-depth medians over the repeats, plus nodes per second of wall time.
+static void addThreadResult(JsonArray out, const Position& p, int maxDepth, bool withHelper, uint32_t& finalWallMs, uint32_t& finalCpuMs) {
+  SmpRun runs[SMP_BENCH_REPEATS];
+  for (int r = 0; r < SMP_BENCH_REPEATS; r++)
+    runs[r] = runOnce(p, maxDepth, withHelper);
+
+  JsonObject result = out.add<JsonObject>();
+  result["threads"] = withHelper ? 2 : 1;
+  JsonArray depths = result["depths"].to<JsonArray>();
+  for (int depth = 1; depth <= maxDepth; depth++) {
+    uint32_t wall[SMP_BENCH_REPEATS], cpu[SMP_BENCH_REPEATS], nodes[SMP_BENCH_REPEATS];
+    for (int r = 0; r < SMP_BENCH_REPEATS; r++) {
+      wall[r] = runs[r].marks[depth].wallMs;
+      cpu[r] = runs[r].marks[depth].mainCpuMs;
+      nodes[r] = runs[r].marks[depth].mainNodes;
+    }
+    JsonObject d = depths.add<JsonObject>();
+    d["depth"] = depth;
+    d["wallMs"] = median(wall);
+    d["mainCpuMs"] = median(cpu);
+    d["mainNodes"] = median(nodes);
+    if (depth == maxDepth) {
+      finalWallMs = median(wall);
+      finalCpuMs = median(cpu);
+    }
+  }
+  uint32_t nps[SMP_BENCH_REPEATS];
+  for (int r = 0; r < SMP_BENCH_REPEATS; r++)
+    nps[r] = runs[r].wallMs ? (uint32_t)(runs[r].totalNodes * 1000 / runs[r].wallMs) : 0;
+  result["nodesPerSec"] = median(nps);
+}
+
+static float ratio(uint32_t single, uint32_t smp) {
+  return smp ? (float)single / (float)smp : 0.0f;
+}
+
+int main(int argc, char** argv) {
+  int maxDepth = argc > 1 ? constrain(atoi(argv[1]), 1, ANALYSIS_MAX_DEPTH) : SMP_BENCH_DEFAULT_DEPTH;
+  const char* outPath = argc > 2 ? argv[2] : nullptr;
+  HostClock::setVirtual(true);
+  HostPlatform::setSerialEnabled(false);
+
+  JsonDocument doc;
+  doc["depth"] = maxDepth;
+  doc["repeats"] = SMP_BENCH_REPEATS;
+  doc["hostCores"] = std::thread::hardware_concurrency();
+  JsonArray positions = doc["positions"].to<JsonArray>();
+  float wallSpeedups = 0, cpuSpeedups = 0;
+  for (int i = 0; i < SMP_BENCH_POSITIONS; i++) {
+    Position p = loadPosition(SMP_BENCH_FENS[i]);
+    JsonObject position = positions.add<JsonObject>();
+    position["fen"] = SMP_BENCH_FENS[i];
+    JsonArray threads = position["threads"].to<JsonArray>();
+    uint32_t wall1, cpu1, wall2, cpu2;
+    addThreadResult(threads, p, maxDepth, false, wall1, cpu1);
+    addThreadResult(threads, p, maxDepth, true, wall2, cpu2);
+    position["wallSpeedup"] = serialized(String(ratio(wall1, wall2), 2));
+    position["mainCpuSpeedup"] = serialized(String(ratio(cpu1, cpu2), 2));
+    wallSpeedups += ratio(wall1, wall2);
+    cpuSpeedups += ratio(cpu1, cpu2);
+    fprintf(stderr, "%d/%d  1 thread %5u ms  2 threads %5u ms wall, %5u ms main CPU\n", i + 1, SMP_BENCH_POSITIONS, wall1, wall2, cpu2);
+  }
+  doc["meanWallSpeedup"] = serialized(String(wallSpeedups / SMP_BENCH_POSITIONS, 2));
+  doc["meanMainCpuSpeedup"] = serialized(String(cpuSpeedups / SMP_BENCH_POSITIONS, 2));
+
+  String output;
+  serializeJson(doc, output);
+  FILE* out = outPath ? fopen(outPath, "w") : stdout;
+  if (!out) {
+    fprintf(stderr, "Cannot write %s\n", outPath);
+    return 1;
+  }
+  fprintf(out, "%s\n", output.c_str());
+  if (outPath)
+    fclose(out);
+  return 0;
+}
@@ -0,0 +1,166 @@
+#include "../chess_engine.h"
+#include "../chess_search.h"
+#include "../chess_utils.h"
+#include "../move_history.h"
+#include <host_platform.h>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ---------------------------
+// Native Texel Self-Play
+// ---------------------------
+// The firmware's own search, move rules and evaluation for tools/texel_tune.py,
+// so the weights are fitted to positions ChessSearch reaches and scored the way
+// ChessSearch::evaluate() scores them.
+//
+// "play" plays one engine-vs-engine game from the start position at a fixed
+// depth. The first plies pick at random (seeded) among the multi-PV lines close
+// to the best, so games differ; after that the best line is played. It prints
+// the quiet positions (side to move not in check, move played not a capture)
+// one FEN per line, then "result 1-0", "result 0-1" or "result 1/2-1/2".
+// "eval" reads FENs on stdin and prints ChessSearch::evaluate() for each, which
+// the tuner checks its feature model against.
+//
+//   .pio/build/native_texel/program play <seed> [depth]
+//   .pio/build/native_texel/program eval < positions.fen
+
+static constexpr int TEXEL_DEFAULT_DEPTH = 2;
+static constexpr int TEXEL_RANDOM_PLIES = 8;       // Opening plies picked at random among near-best lines
+static constexpr int TEXEL_RANDOM_MARGIN_CP = 50;  // How far below the best a random pick may be
+static constexpr int TEXEL_SKIP_OPENING_PLIES = 8; // Positions before this are mostly book-like, not printed
+static constexpr int TEXEL_MAX_PLIES = 200;        // Adjudicated as a draw after this
+
+static const char* const TEXEL_START_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+static ChessSearch search;
+
+// Play an encodeMove() code with the full game rules: en passant, castling,
+// promotion, castling rights, the en passant square, both clocks and the
+// repetition history. Returns whether it captured.
+static bool playMove(char board[8][8], ChessEngine& engine, char& sideToMove, uint16_t move) {
+  int fromRow, fromCol, toRow, toCol;
+  char promotion;
+  MoveHistory::decodeMove(move, fromRow, fromCol, toRow, toCol, promotion);
+
+  char piece = board[fromRow][fromCol];
+  char captured = board[toRow][toCol];
+  bool isWhite = ChessUtils::isWhitePiece(piece);
+  char kind = toupper(piece);
+  if (kind == 'P' && fromCol != toCol && captured == ' ') {
+    captured = board[fromRow][toCol]; // En passant
+    board[fromRow][toCol] = ' ';
+  }
+  if (kind == 'K' && abs(toCol - fromCol) == 2) {
+    int rookFromCol = (toCol > fromCol) ? 7 : 0;
+    board[fromRow][(toCol > fromCol) ? 5 : 3] = board[fromRow][rookFromCol];
+    board[fromRow][rookFromCol] = ' ';
+  }
+  board[toRow][toCol] = (promotion != ' ') ? (isWhite ? toupper(promotion) : promotion) : piece;
+  board[fromRow][fromCol] = ' ';
+
+  uint8_t rights = engine.getCastlingRights();
+  if (kind == 'K')
+    rights &= isWhite ? ~0x03 : ~0x0C;
+  auto clearCorner = [&rights](int row, int col) {
+    if (row == 7 && col == 7) rights &= ~0x01;
+    if (row == 7 && col == 0) rights &= ~0x02;
+    if (row == 0 && col == 7) rights &= ~0x04;
+    if (row == 0 && col == 0) rights &= ~0x08;
+  };
+  clearCorner(fromRow, fromCol);
+  clearCorner(toRow, toCol);
+  engine.setCastlingRights(rights);
+
+  if (kind == 'P' && abs(toRow - fromRow) == 2)
+    engine.setEnPassantTarget((fromRow + toRow) / 2, fromCol);
+  else
+    engine.clearEnPassantTarget();
+  engine.updateHalfmoveClock(piece, captured);
+  engine.incrementFullmoveClock(sideToMove);
+  sideToMove = (sideToMove == 'w') ? 'b' : 'w';
+  engine.recordPosition(board, sideToMove);
+  return captured != ' ';
+}
+
+// Index of the line to play: the best, or in the opening a seeded pick among
+// the lines within TEXEL_RANDOM_MARGIN_CP of it (scores are from White's side)
+static int chooseLine(const SearchLine lines[], int count, char sideToMove, int ply, std::mt19937& rng) {
+  if (ply >= TEXEL_RANDOM_PLIES)
+    return 0;
+  int sign = (sideToMove == 'w') ? 1 : -1;
+  int best = sign * lines[0].score;
+  int candidates = 1;
+  while (candidates < count && sign * lines[candidates].score >= best - TEXEL_RANDOM_MARGIN_CP)
+    candidates++;
+  return (int)(rng() % (uint32_t)candidates);
+}
+
+static int playGame(uint32_t seed, int depth) {
+  std::mt19937 rng(seed);
+  ChessEngine engine;
+  char board[8][8];
+  char sideToMove = 'w';
+  ChessUtils::fenToBoard(TEXEL_START_FEN, board, sideToMove, &engine);
+  engine.clearPositionHistory();
+  engine.recordPosition(board, sideToMove);
+
+  const char* result = "1/2-1/2";
+  SearchLine lines[SEARCH_MAX_LINES];
+  for (int ply = 0; ply < TEXEL_MAX_PLIES; ply++) {
+    int epRow, epCol;
+    engine.getEnPassantTarget(epRow, epCol);
+    search.setPosition(board, sideToMove, engine.getCastlingRights(), epRow, epCol);
+    int count = search.searchRoot(depth, ply < TEXEL_RANDOM_PLIES ? SEARCH_MAX_LINES : 1, lines);
+    bool inCheck = engine.isKingInCheck(board, sideToMove);
+    if (count == 0) {
+      if (inCheck)
+        result = (sideToMove == 'w') ? "0-1" : "1-0";
+      break;
+    }
+
+    String fen = ChessUtils::boardToFEN(board, sideToMove, &engine);
+    uint16_t move = lines[chooseLine(lines, count, sideToMove, ply, rng)].pv[0];
+    bool captured = playMove(board, engine, sideToMove, move);
+    // Quiet positions only: the static evaluation is meaningless mid-exchange
+    if (ply >= TEXEL_SKIP_OPENING_PLIES && !inCheck && !captured)
+      printf("%s\n", fen.c_str());
+    if (engine.isFiftyMoveRule() || engine.isThreefoldRepetition())
+      break;
+  }
+  printf("result %s\n", result);
+  return 0;
+}
+
+static int evaluatePositions() {
+  char line[128];
+  char board[8][8];
+  char sideToMove;
+  ChessEngine engine;
+  while (fgets(line, sizeof(line), stdin)) {
+    line[strcspn(line, "\r\n")] = '\0';
+    if (line[0] == '\0')
+      continue;
+    ChessUtils::fenToBoard(line, board, sideToMove, &engine);
+    printf("%d\n", ChessSearch::evaluate(board));
+  }
+  return 0;
+}
+
+int main(int argc, char** argv) {
+  HostClock::setVirtual(true);
+  HostPlatform::setSerialEnabled(false);
+  if (argc > 1 && strcmp(argv[1], "eval") == 0)
+    return evaluatePositions();
+  if (argc > 2 && strcmp(argv[1], "play") == 0) {
+    if (!search.begin()) {
+      fprintf(stderr, "No memory for the transposition table\n");
+      return 1;
+    }
+    int depth = argc > 3 ? constrain(atoi(argv[3]), 1, SEARCH_MAX_PLY / 2) : TEXEL_DEFAULT_DEPTH;
+    return playGame((uint32_t)strtoul(argv[2], nullptr, 10), depth);
+  }
+  fprintf(stderr, "usage: %s play <seed> [depth] | eval < positions.fen\n", argv[0]);
+  return 2;
+}
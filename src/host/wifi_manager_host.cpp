@@ -0,0 +1,86 @@
+#include "../wifi_manager_esp32.h"
+#include "hal_posix.h"
+#include <host_platform.h>
+
+// ---------------------------
+// WiFiManagerESP32: Native Build
+// ---------------------------
+// The manager without the web server, AP or mDNS. Settings load from the
+// emulated NVS as on the board, and the connector runs unchanged against the
+// SimWiFiLink main.cpp injects: every saved network gets a matching simulated
+// access point (plus one for a "host" network if none is saved), and WiFi.status()
+// follows the simulated link so the Lichess and Stockfish clients see the same
+// connectivity the game modes do.
+
+static SimWiFiLink* simLink(WiFiLink* link) {
+  return static_cast<SimWiFiLink*>(link); // The native build always injects a SimWiFiLink
+}
+
+void WiFiManagerESP32::begin() {
+  Serial.println("=== Starting LibreChess WiFi Manager (native) ===");
+  loadSettings();
+  if (networkCount == 0) {
+    savedNetworks[0].ssid = "host";
+    savedNetworks[0].password = "";
+    networkCount = 1;
+  }
+
+  SimWiFiLink* link = simLink(wifiLink);
+  for (uint8_t i = 0; i < networkCount; i++)
+    link->addAccessPoint(savedNetworks[i].ssid.c_str(), savedNetworks[i].password.c_str(), 1 + i * 5);
+  link->attach(&connector);
+  link->begin();
+
+  networkStarting = true;
+  connector.requestConnect(-1);
+  do {
+    update();
+    delay(NETWORK_START_POLL_MS);
+  } while (connector.state() == WiFiState::CONNECTING);
+  networkStarting = false;
+}
+
+void WiFiManagerESP32::waitForNetworkStart() {
+  while (networkStarting.load())
+    boardDriver->cooperativeWait().sleep(NETWORK_START_POLL_MS);
+}
+
+void WiFiManagerESP32::update() {
+  simLink(wifiLink)->advance(millis());
+  serviceWiFi();
+}
+
+void WiFiManagerESP32::serviceWiFi() {
+  WiFiConnectorEvent event = connector.tick(millis());
+  if (applyStagedNetwork() || connector.registryChanged())
+    saveNetworks();
+  switch (event) {
+    case WiFiConnectorEvent::CONNECTED:
+      handleWiFiConnected();
+      break;
+    case WiFiConnectorEvent::LOST:
+      handleWiFiDisconnected();
+      break;
+    case WiFiConnectorEvent::GAVE_UP:
+      HostNet::setStationConnected(false);
+      Serial.println("WiFi: no saved network could be joined");
+      break;
+    case WiFiConnectorEvent::NONE:
+      break;
+  }
+}
+
+void WiFiManagerESP32::handleWiFiConnected() {
+  int8_t index = connector.connectedIndex();
+  HostNet::setStationConnected(true);
+  Serial.printf("WiFi STA connected to '%s' (simulated)\n", savedNetworks[index].ssid.c_str());
+  if (connector.wasReconnect())
+    Serial.printf("  Reconnected in %lu ms\n", (unsigned long)connector.lastReconnectMs());
+  if (connector.cacheRefreshed())
+    saveFastConnect(index);
+}
+
+void WiFiManagerESP32::handleWiFiDisconnected() {
+  HostNet::setStationConnected(false);
+  Serial.println("WiFi STA disconnected — reconnecting");
+}
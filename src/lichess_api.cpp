@@ -1,29 +1,18 @@
 #include "lichess_api.h"
+#include "heap_report.h"
+#include "logger.h"
 #include <ArduinoJson.h>
 #include <WiFi.h>
 #include <WiFiClientSecure.h>
 
-// Static member initialization
-String LichessAPI::apiToken = "";
-
-void LichessAPI::setToken(const String& token) {
-  apiToken = token;
-}
-
-String LichessAPI::getToken() {
-  return apiToken;
-}
-
-bool LichessAPI::hasToken() {
-  return apiToken.length() > 0;
-}
-
 String LichessAPI::makeHttpRequest(const String& method, const String& path, const String& body) {
   WiFiClientSecure client;
   client.setInsecure();
 
-  if (!client.connect(LICHESS_API_HOST, LICHESS_API_PORT)) {
-    Serial.println("Lichess API: Connection failed");
+  bool connected = client.connect(LICHESS_API_HOST, LICHESS_API_PORT);
+  HeapReport::noteTlsConnect(connected);
+  if (!connected) {
+    LOG_ERROR("Lichess API: Connection failed");
     return "";
   }
 
@@ -50,7 +39,7 @@ String LichessAPI::makeHttpRequest(const String& method, const String& path, con
   unsigned long timeout = millis() + 10000;
   while (client.connected() && !client.available()) {
     if (millis() > timeout) {
-      Serial.println("Lichess API: Request timeout");
+      LOG_WARN("Lichess API: Request timeout");
       client.stop();
       return "";
     }
@@ -85,13 +74,13 @@ bool LichessAPI::verifyToken(String& username) {
   JsonDocument doc;
   DeserializationError error = deserializeJson(doc, response);
   if (error) {
-    Serial.println("Lichess API: JSON parse error in verifyToken");
+    LOG_ERROR("Lichess API: JSON parse error in verifyToken");
     return false;
   }
 
   if (doc.containsKey("username")) {
     username = doc["username"].as<String>();
-    Serial.println("Lichess API: Verified token for user: " + username);
+    LOG_INFO("Lichess API: Verified token for user: %s", username.c_str());
     return true;
   }
 
@@ -103,7 +92,9 @@ bool LichessAPI::pollForGameEvent(LichessEvent& event) {
   WiFiClientSecure client;
   client.setInsecure();
 
-  if (!client.connect(LICHESS_API_HOST, LICHESS_API_PORT)) {
+  bool connected = client.connect(LICHESS_API_HOST, LICHESS_API_PORT);
+  HeapReport::noteTlsConnect(connected);
+  if (!connected) {
     return false;
   }
 
@@ -162,7 +153,7 @@ bool LichessAPI::pollForGameEvent(LichessEvent& event) {
     String color = game["color"].as<String>();
     event.myColor = (color == "white") ? 'w' : 'b';
 
-    Serial.println("Lichess: Found active game: " + event.gameId);
+    LOG_INFO("Lichess: Found active game: %s", event.gameId.c_str());
     return true;
   }
 
@@ -186,7 +177,9 @@ bool LichessAPI::pollGameStream(const String& gameId, LichessGameState& state) {
   WiFiClientSecure client;
   client.setInsecure();
 
-  if (!client.connect(LICHESS_API_HOST, LICHESS_API_PORT)) {
+  bool connected = client.connect(LICHESS_API_HOST, LICHESS_API_PORT);
+  HeapReport::noteTlsConnect(connected);
+  if (!connected) {
     return false;
   }
 
@@ -267,18 +260,18 @@ bool LichessAPI::pollGameStream(const String& gameId, LichessGameState& state) {
   client.stop();
 
   if (!foundData || jsonLine.length() == 0) {
-    Serial.println("Lichess: No JSON data received from game stream");
+    LOG_INFO("Lichess: No JSON data received from game stream");
     return false;
   }
 
-  Serial.println("Lichess: Game stream JSON: " + jsonLine.substring(0, min((size_t)200, jsonLine.length())));
+  LOG_INFO("Lichess: Game stream JSON: %s", jsonLine.c_str()); // Truncated to LOG_LINE_SIZE
 
   // Try to parse as gameFull first, then as gameState
   if (parseGameFullEvent(jsonLine, state)) {
     return true;
   }
 
-  Serial.println("Lichess: parseGameFullEvent failed, trying parseGameStateEvent");
+  LOG_WARN("Lichess: parseGameFullEvent failed, trying parseGameStateEvent");
   return parseGameStateEvent(jsonLine, state);
 }
 
@@ -313,7 +306,7 @@ bool LichessAPI::parseGameFullEvent(const String& json, LichessGameState& state)
   JsonDocument doc;
   DeserializationError error = deserializeJson(doc, json);
   if (error) {
-    Serial.println("Lichess: JSON parse error in parseGameFullEvent");
+    LOG_ERROR("Lichess: JSON parse error in parseGameFullEvent");
     return false;
   }
 
@@ -407,11 +400,11 @@ bool LichessAPI::makeMove(const String& gameId, const String& move) {
   }
 
   if (doc.containsKey("ok") && doc["ok"].as<bool>()) {
-    Serial.println("Lichess: Move sent successfully: " + move);
+    LOG_INFO("Lichess: Move sent successfully: %s", move.c_str());
     return true;
   }
 
-  Serial.println("Lichess: Move failed: " + response);
+  LOG_ERROR("Lichess: Move failed: %s", response.c_str());
   return false;
 }
 
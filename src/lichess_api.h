@@ -38,37 +38,42 @@ struct LichessEvent {
   char myColor; // 'w' or 'b'
 };
 
+/// Lichess Board API client. Each instance carries its own token, so two
+/// clients (e.g. a game and a token check from the web page) never share
+/// credentials.
 class LichessAPI {
  public:
+  explicit LichessAPI(const String& token = "") : apiToken(token) {}
+
   // Set the API token (Personal Access Token)
-  static void setToken(const String& token);
-  static String getToken();
-  static bool hasToken();
+  void setToken(const String& token) { apiToken = token; }
+  const String& getToken() const { return apiToken; }
+  bool hasToken() const { return apiToken.length() > 0; }
 
   // Account verification
-  static bool verifyToken(String& username);
+  bool verifyToken(String& username);
 
   // Stream events to find new games
   // Returns true if a new game event was found
-  static bool pollForGameEvent(LichessEvent& event);
+  bool pollForGameEvent(LichessEvent& event);
 
   // Get current game state
-  static bool getGameState(const String& gameId, LichessGameState& state);
+  bool getGameState(const String& gameId, LichessGameState& state);
 
   // Stream game state (for ongoing game updates)
   // Returns true if there's new state data
-  static bool pollGameStream(const String& gameId, LichessGameState& state);
+  bool pollGameStream(const String& gameId, LichessGameState& state);
 
   // Make a move in the current game
   // move: UCI format (e.g., "e2e4", "e7e8q" for promotion)
-  static bool makeMove(const String& gameId, const String& move);
+  bool makeMove(const String& gameId, const String& move);
 
   // Resign the game
-  static bool resignGame(const String& gameId);
+  bool resignGame(const String& gameId);
 
  private:
-  static String apiToken;
-  static String makeHttpRequest(const String& method, const String& path, const String& body = "");
+  String apiToken;
+  String makeHttpRequest(const String& method, const String& path, const String& body = "");
   static bool parseGameFullEvent(const String& json, LichessGameState& state);
   static bool parseGameStateEvent(const String& json, LichessGameState& state);
 };
@@ -0,0 +1,138 @@
+#include "logger.h"
+#include <esp_timer.h>
+#include <stdarg.h>
+#include <string.h>
+
+// ---------------------------
+// Ring State
+// ---------------------------
+// Lines are numbered from 0; line n lives in slot n % LOG_RING_ENTRIES.
+// [drainedSeq, nextSeq) is waiting for Serial, and the last LOG_RING_ENTRIES
+// lines stay readable for the web log. A writer that would overwrite an
+// undrained line drops its own line instead of blocking.
+
+static portMUX_TYPE logLock = portMUX_INITIALIZER_UNLOCKED;
+static LogLine ring[LOG_RING_ENTRIES];
+static uint32_t nextSeq = 0;
+static uint32_t drainedSeq = 0;
+static TaskHandle_t drainTask = nullptr;
+
+static uint32_t dropped = 0;
+static uint32_t callerLines = 0;
+static uint64_t totalCallerUs = 0;
+static uint32_t maxCallerUs = 0;
+static uint64_t serialUs = 0;
+
+static void drainTaskMain(void*) {
+  LogLine line;
+  while (true) {
+    bool pending = true;
+    while (pending) {
+      portENTER_CRITICAL(&logLock);
+      pending = drainedSeq != nextSeq;
+      if (pending) {
+        memcpy(&line, &ring[drainedSeq % LOG_RING_ENTRIES], sizeof(line));
+        drainedSeq++;
+      }
+      portEXIT_CRITICAL(&logLock);
+      if (pending) {
+        int64_t start = esp_timer_get_time();
+        Serial.println(line.text);
+        uint64_t spent = (uint64_t)(esp_timer_get_time() - start);
+        portENTER_CRITICAL(&logLock); // 64-bit: snapshot() and resetStats() run on other tasks
+        serialUs += spent;
+        portEXIT_CRITICAL(&logLock);
+      }
+    }
+    vTaskDelay(pdMS_TO_TICKS(LOG_DRAIN_INTERVAL_MS));
+  }
+}
+
+void Log::begin() {
+#ifndef LOG_SYNCHRONOUS
+  if (drainTask)
+    return;
+  if (xTaskCreatePinnedToCore(drainTaskMain, "LogDrain", LOG_TASK_STACK, nullptr, LOG_TASK_PRIORITY, &drainTask, LOG_TASK_CORE) != pdPASS) {
+    Serial.println("Log: failed to start drain task, logging synchronously");
+    drainTask = nullptr;
+  }
+#endif
+}
+
+void Log::write(LogLevel level, const char* format, ...) {
+  int64_t start = esp_timer_get_time();
+  LogLine line;
+  line.ms = millis();
+  line.level = level;
+  va_list args;
+  va_start(args, format);
+  vsnprintf(line.text, sizeof(line.text), format, args);
+  va_end(args);
+
+  bool buffered = drainTask != nullptr;
+  portENTER_CRITICAL(&logLock);
+  if (buffered && nextSeq - drainedSeq >= LOG_RING_ENTRIES) {
+    dropped++;
+  } else {
+    line.seq = nextSeq;
+    memcpy(&ring[nextSeq % LOG_RING_ENTRIES], &line, sizeof(line));
+    nextSeq++;
+    if (!buffered)
+      drainedSeq = nextSeq;
+  }
+  portEXIT_CRITICAL(&logLock);
+
+  if (!buffered)
+    Serial.println(line.text);
+
+  uint32_t elapsed = (uint32_t)(esp_timer_get_time() - start);
+  portENTER_CRITICAL(&logLock);
+  callerLines++;
+  totalCallerUs += elapsed;
+  maxCallerUs = max(maxCallerUs, elapsed);
+  portEXIT_CRITICAL(&logLock);
+}
+
+size_t Log::readRecent(uint32_t fromSeq, LogLine* out, size_t maxLines) {
+  size_t count = 0;
+  portENTER_CRITICAL(&logLock);
+  uint32_t oldest = nextSeq > LOG_RING_ENTRIES ? nextSeq - LOG_RING_ENTRIES : 0;
+  uint32_t seq = max(fromSeq, oldest);
+  // Newest lines win when the caller's buffer is smaller than what is available
+  if (nextSeq - seq > maxLines)
+    seq = nextSeq - maxLines;
+  for (; seq < nextSeq; seq++)
+    memcpy(&out[count++], &ring[seq % LOG_RING_ENTRIES], sizeof(LogLine));
+  portEXIT_CRITICAL(&logLock);
+  return count;
+}
+
+void Log::snapshot(LogStats& out) {
+  portENTER_CRITICAL(&logLock);
+  out.lines = nextSeq;
+  out.dropped = dropped;
+  out.avgCallerUs = callerLines > 0 ? (uint32_t)(totalCallerUs / callerLines) : 0;
+  out.maxCallerUs = maxCallerUs;
+  out.serialUs = (uint32_t)serialUs;
+  portEXIT_CRITICAL(&logLock);
+}
+
+void Log::resetStats() {
+  portENTER_CRITICAL(&logLock);
+  dropped = 0;
+  callerLines = 0;
+  totalCallerUs = 0;
+  maxCallerUs = 0;
+  serialUs = 0;
+  portEXIT_CRITICAL(&logLock);
+}
+
+const char* Log::levelName(LogLevel level) {
+  switch (level) {
+    case LogLevel::DEBUG: return "debug";
+    case LogLevel::INFO: return "info";
+    case LogLevel::WARN: return "warn";
+    case LogLevel::ERROR: return "error";
+  }
+  return "?";
+}
@@ -0,0 +1,89 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <Arduino.h>
+
+// ---------------------------
+// Buffered Logging
+// ---------------------------
+// Serial output at 115200 baud costs ~87 µs per character, so a 60-character
+// line blocks its caller for ~5 ms. The game path (moves, history, Lichess
+// polling) logs through LOG_*() instead: the line is formatted on the caller
+// into a fixed ring buffer and the "LogDrain" task writes it to Serial later.
+// The ring also keeps the most recent lines for GET /debug/log.
+//
+// Build flags (build_flags in platformio.ini):
+//   -DLOG_LEVEL=LOG_LEVEL_WARN  strip LOG_DEBUG/LOG_INFO calls at compile time
+//   -DLOG_SYNCHRONOUS           write to Serial on the caller, as before, to
+//                               compare callerUs in /debug/log with and without buffering
+
+#define LOG_LEVEL_DEBUG 0
+#define LOG_LEVEL_INFO 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_ERROR 3
+#define LOG_LEVEL_NONE 4
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+static constexpr size_t LOG_LINE_SIZE = 128;       // Longer lines are truncated
+static constexpr size_t LOG_RING_ENTRIES = 32;     // ~4.4KB; also the length of the web log
+static constexpr uint32_t LOG_DRAIN_INTERVAL_MS = 20;
+static constexpr int LOG_TASK_STACK = 3072;
+static constexpr UBaseType_t LOG_TASK_PRIORITY = 1; // Lowest above idle
+static constexpr BaseType_t LOG_TASK_CORE = 0;      // Away from the game loop
+
+enum class LogLevel : uint8_t { DEBUG, INFO, WARN, ERROR };
+
+struct LogLine {
+  uint32_t seq;  // Monotonic line number since boot
+  uint32_t ms;   // millis() when logged
+  LogLevel level;
+  char text[LOG_LINE_SIZE];
+};
+
+struct LogStats {
+  uint32_t lines;
+  uint32_t dropped;      // Lines lost because the drain task fell a full ring behind
+  uint32_t avgCallerUs;  // Time a LOG_*() call spends on its caller
+  uint32_t maxCallerUs;
+  uint32_t serialUs;     // Total time the drain task spent writing to Serial
+};
+
+/// Static like MoveTrace: callable from any task, never from an ISR.
+class Log {
+ public:
+  /// Start the drain task. Lines logged before this (or without the task) go straight to Serial.
+  static void begin();
+  static void write(LogLevel level, const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+  /// Copy retained lines with seq >= `fromSeq`, oldest first. Returns the number copied.
+  static size_t readRecent(uint32_t fromSeq, LogLine* out, size_t maxLines);
+  static void snapshot(LogStats& out);
+  static void resetStats();
+  static const char* levelName(LogLevel level);
+};
+
+#if LOG_LEVEL <= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(...) Log::write(LogLevel::DEBUG, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) do {} while (0)
+#endif
+#if LOG_LEVEL <= LOG_LEVEL_INFO
+#define LOG_INFO(...) Log::write(LogLevel::INFO, __VA_ARGS__)
+#else
+#define LOG_INFO(...) do {} while (0)
+#endif
+#if LOG_LEVEL <= LOG_LEVEL_WARN
+#define LOG_WARN(...) Log::write(LogLevel::WARN, __VA_ARGS__)
+#else
+#define LOG_WARN(...) do {} while (0)
+#endif
+#if LOG_LEVEL <= LOG_LEVEL_ERROR
+#define LOG_ERROR(...) Log::write(LogLevel::ERROR, __VA_ARGS__)
+#else
+#define LOG_ERROR(...) do {} while (0)
+#endif
+
+#endif // LOGGER_H
@@ -0,0 +1,94 @@
+#include "loop_stats.h"
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
+
+static int32_t allocatedBlocks() {
+  multi_heap_info_t info;
+  heap_caps_get_info(&info, MALLOC_CAP_8BIT);
+  return (int32_t)info.allocated_blocks;
+}
+
+LoopStats::LoopStats() : iterationStartUs(0), moveStartUs(0), moveStartBlocks(0), moveStartFlashWrites(0) {
+  reset();
+}
+
+void LoopStats::reset() {
+  iterations = slowIterations = 0;
+  totalIterationUs = 0;
+  maxIterationUs = 0;
+  moveOpen = false;
+  moves = 0;
+  totalMoveUs = 0;
+  maxMoveUs = 0;
+  totalMoveBlocks = 0;
+  maxMoveBlocks = INT32_MIN;
+  maxMoveFlashWrites = 0;
+  flashWrites = flashBytes = 0;
+  minFreeHeap = UINT32_MAX;
+}
+
+void LoopStats::beginIteration() {
+  iterationStartUs = esp_timer_get_time();
+}
+
+void LoopStats::endIteration() {
+  int64_t now = esp_timer_get_time();
+  uint32_t elapsed = (uint32_t)(now - iterationStartUs);
+  iterations++;
+  totalIterationUs += elapsed;
+  maxIterationUs = max(maxIterationUs, elapsed);
+  if (elapsed > LOOP_SLOW_ITERATION_US)
+    slowIterations++;
+
+  if (moveOpen) {
+    moveOpen = false;
+    uint32_t moveUs = (uint32_t)(now - moveStartUs);
+    int32_t blocks = allocatedBlocks() - moveStartBlocks;
+    moves++;
+    totalMoveUs += moveUs;
+    maxMoveUs = max(maxMoveUs, moveUs);
+    totalMoveBlocks += blocks;
+    maxMoveBlocks = max(maxMoveBlocks, blocks);
+    maxMoveFlashWrites = max(maxMoveFlashWrites, flashWrites - moveStartFlashWrites);
+  }
+  minFreeHeap = min(minFreeHeap, (uint32_t)heap_caps_get_free_size(MALLOC_CAP_8BIT));
+}
+
+void LoopStats::moveStarted() {
+  moveOpen = true;
+  moveStartUs = esp_timer_get_time();
+  moveStartBlocks = allocatedBlocks();
+  moveStartFlashWrites = flashWrites;
+}
+
+void LoopStats::noteFlashWrite(size_t bytes) {
+  flashWrites++;
+  flashBytes += bytes;
+}
+
+void LoopStats::snapshot(LoopStatsSnapshot& out) const {
+  out.iterations = iterations;
+  out.slowIterations = slowIterations;
+  out.avgIterationUs = iterations > 0 ? (uint32_t)(totalIterationUs / iterations) : 0;
+  out.maxIterationUs = maxIterationUs;
+  out.moves = moves;
+  out.avgMoveUs = moves > 0 ? (uint32_t)(totalMoveUs / moves) : 0;
+  out.maxMoveUs = maxMoveUs;
+  out.avgMoveHeapBlocks = moves > 0 ? (int32_t)(totalMoveBlocks / (int64_t)moves) : 0;
+  out.maxMoveHeapBlocks = moves > 0 ? maxMoveBlocks : 0;
+  out.maxMoveFlashWrites = maxMoveFlashWrites;
+  out.flashWrites = flashWrites;
+  out.flashBytes = flashBytes;
+  out.minFreeHeap = minFreeHeap == UINT32_MAX ? 0 : minFreeHeap;
+}
+
+void LoopStats::printSummary(const char* label) const {
+  LoopStatsSnapshot s;
+  snapshot(s);
+  if (s.iterations == 0)
+    return;
+  Serial.printf("=== Loop stats: %s ===\n", label);
+  Serial.printf("Iterations: %u (avg %u us, max %u us, %u over %u us)\n", s.iterations, s.avgIterationUs, s.maxIterationUs, s.slowIterations, LOOP_SLOW_ITERATION_US);
+  Serial.printf("Moves: %u (avg %u us, max %u us), heap blocks per move avg %d max %d\n", s.moves, s.avgMoveUs, s.maxMoveUs, s.avgMoveHeapBlocks, s.maxMoveHeapBlocks);
+  Serial.printf("Flash: %u writes, %u bytes (max %u writes per move), min free heap %u\n", s.flashWrites, s.flashBytes, s.maxMoveFlashWrites, s.minFreeHeap);
+}
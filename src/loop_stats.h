@@ -0,0 +1,79 @@
+#ifndef LOOP_STATS_H
+#define LOOP_STATS_H
+
+#include <Arduino.h>
+
+// ---------------------------
+// Game Loop Statistics
+// ---------------------------
+// On-device regression numbers for the game loop: how long each loop
+// iteration takes, what a move costs once it is known (clock, flash writes,
+// game status, LED feedback), how many heap blocks it leaves behind and how
+// much it writes to flash. Reset when a mode starts, summarized on the serial
+// log when it ends and served by GET /debug/loop, so two firmware builds can
+// be compared by playing the same games on each.
+
+static constexpr uint32_t LOOP_SLOW_ITERATION_US = 100000; // Iterations above this are counted as slow
+
+struct LoopStatsSnapshot {
+  uint32_t iterations;
+  uint32_t slowIterations;
+  uint32_t avgIterationUs;
+  uint32_t maxIterationUs;
+
+  uint32_t moves;
+  uint32_t avgMoveUs;
+  uint32_t maxMoveUs;
+  int32_t avgMoveHeapBlocks; // Net heap blocks left allocated per move
+  int32_t maxMoveHeapBlocks;
+  uint32_t maxMoveFlashWrites;
+
+  uint32_t flashWrites;      // Write calls since the mode started
+  uint32_t flashBytes;
+  uint32_t minFreeHeap;      // Lowest free heap seen at an iteration boundary
+};
+
+/// One per board, owned by main.cpp and handed to the objects holding the hooks
+/// (ChessGame, MoveHistory, StockfishCache) by their setLoopStats().
+/// Updated from the game loop task only. /debug/loop reads a snapshot from the
+/// web task; a torn read can mix two iterations, which is fine for diagnostics.
+class LoopStats {
+ public:
+  LoopStats();
+
+  void reset();
+  /// Bracket one pass of the active mode's update().
+  void beginIteration();
+  void endIteration();
+  /// A move was applied; its cost runs to the end of the current iteration.
+  void moveStarted();
+  /// A flash write of `bytes` was issued from the game loop.
+  void noteFlashWrite(size_t bytes);
+
+  void snapshot(LoopStatsSnapshot& out) const;
+  void printSummary(const char* label) const;
+
+ private:
+  int64_t iterationStartUs;
+  uint32_t iterations;
+  uint32_t slowIterations;
+  uint64_t totalIterationUs;
+  uint32_t maxIterationUs;
+
+  bool moveOpen;
+  int64_t moveStartUs;
+  int32_t moveStartBlocks;
+  uint32_t moveStartFlashWrites;
+  uint32_t moves;
+  uint64_t totalMoveUs;
+  uint32_t maxMoveUs;
+  int64_t totalMoveBlocks;
+  int32_t maxMoveBlocks;
+  uint32_t maxMoveFlashWrites;
+
+  uint32_t flashWrites;
+  uint32_t flashBytes;
+  uint32_t minFreeHeap;
+};
+
+#endif // LOOP_STATS_H
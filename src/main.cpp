@@ -1,13 +1,29 @@
 #include "board_driver.h"
+#include "boot_timeline.h"
+#include "chess_analysis.h"
 #include "chess_bot.h"
+#include "chess_clock.h"
 #include "chess_engine.h"
 #include "chess_lichess.h"
 #include "chess_moves.h"
+#include "chess_opening.h"
+#include "chess_puzzle.h"
 #include "chess_utils.h"
+#include "game_arena.h"
+#ifdef LIBRECHESS_HOST
+#include "host/hal_posix.h"
+#else
+#include "hal_esp32.h"
+#endif
+#include "heap_report.h"
 #include "led_colors.h"
+#include "logger.h"
+#include "loop_stats.h"
 #include "menu_config.h"
 #include "move_history.h"
+#include "network_actor.h"
 #include "sensor_test.h"
+#include "stockfish_cache.h"
 #ifdef FACTORY_RESET
 #include <nvs_flash.h>
 #endif
@@ -24,19 +40,46 @@ enum GameMode {
   MODE_CHESS_MOVES = 1,
   MODE_BOT = 2,
   MODE_LICHESS = 3,
-  MODE_SENSOR_TEST = 4
+  MODE_SENSOR_TEST = 4,
+  MODE_ANALYSIS = 5,
+  MODE_PUZZLE = 6,
+  MODE_OPENING = 7
 };
 
 BotConfig botConfig = {StockfishSettings::medium(), true};
 LichessConfig lichessConfig = {""};
 
-BoardDriver boardDriver;
+#ifdef LIBRECHESS_HOST
+// Native build (see src/host/): magnets are placed through sensorMatrix, WiFi is simulated
+PosixLedOutput ledOutput(LED_COUNT);
+VirtualSensorMatrix sensorMatrix;
+FileSettingsStore settingsStore;
+SimWiFiLink wifiLink;
+#else
+Esp32LedOutput ledOutput(LED_COUNT, LED_PIN);
+Esp32SensorMatrix sensorMatrix;
+NvsSettingsStore settingsStore;
+Esp32WiFiLink wifiLink;
+#endif
+BoardDriver boardDriver(&ledOutput, &sensorMatrix, &settingsStore);
 ChessEngine chessEngine;
+ChessClock chessClock;
 MoveHistory moveHistory;
-WiFiManagerESP32 wifiManager(&boardDriver, &moveHistory);
+NetworkActor networkActor;
+LoopStats loopStats;
+StockfishCache stockfishCache;
+WiFiManagerESP32 wifiManager(&boardDriver, &moveHistory, &wifiLink);
 ChessGame* activeGame = nullptr;
 SensorTest* sensorTest = nullptr;
 
+// Game-mode objects and per-game scratch live in a static arena (see game_arena.h), sized for the largest mode
+static constexpr size_t largerOf(size_t a, size_t b) { return a > b ? a : b; }
+static constexpr size_t GAME_MODE_BYTES =
+    largerOf(sizeof(ChessMoves), largerOf(sizeof(ChessBot), largerOf(sizeof(ChessLichess), largerOf(sizeof(ChessAnalysis),
+    largerOf(sizeof(ChessPuzzle), largerOf(sizeof(ChessOpening), sizeof(SensorTest)))))));
+alignas(GAME_ARENA_ALIGN) static uint8_t gameArenaStorage[GAME_MODE_BYTES + GAME_ARENA_ALIGN + GAME_ARENA_SCRATCH_BYTES];
+GameArena gameArena;
+
 GameMode currentMode = MODE_SELECTION;
 bool modeInitialized = false;
 bool resumingGame = false;
@@ -45,16 +88,23 @@ void enterGameSelection();
 void handleMenuResult(int result);
 void initializeSelectedMode(GameMode mode);
 void checkForResumableGame();
+void serviceBackground(void* context);
 
 void setup() {
+  BootTimeline::mark(BootStage::SETUP_ENTERED);
   Serial.begin(115200);
-  delay(3000);
+#ifdef BOOT_SERIAL_WAIT_MS
+  // Give a serial monitor time to attach before the banner (add -DBOOT_SERIAL_WAIT_MS=3000 to build_flags)
+  delay(BOOT_SERIAL_WAIT_MS);
+#endif
   Serial.println();
   Serial.println("================================================");
   Serial.println("         LibreChess Starting Up");
   Serial.println("================================================");
+  Log::begin();
   if (!ChessUtils::ensureNvsInitialized())
     Serial.println("WARNING: NVS init failed (Preferences may not work)");
+  BootTimeline::mark(BootStage::NVS_READY);
 
 #ifdef FACTORY_RESET
   // Wipe all NVS data — add -DFACTORY_RESET to build_flags in platformio.ini,
@@ -70,16 +120,36 @@ void setup() {
     Serial.println("ERROR: LittleFS mount failed!");
   else
     Serial.println("LittleFS mounted successfully");
+  gameArena.begin(gameArenaStorage, sizeof(gameArenaStorage));
+  moveHistory.setArena(&gameArena);
+  moveHistory.setLoopStats(&loopStats);
   moveHistory.begin();
+  stockfishCache.setLoopStats(&loopStats);
+  stockfishCache.begin();
+  BootTimeline::mark(BootStage::FILESYSTEM_READY);
+#ifdef LIBRECHESS_HOST
+  boardDriver.saveIdentityCalibration(); // The virtual matrix is wired in square order
+#endif
   boardDriver.begin();
+  BootTimeline::mark(BootStage::BOARD_READY);
+  // Returns right away: AP, saved networks, mDNS, web server and NTP come up on a background task
   wifiManager.begin();
+  wifiManager.setClock(&chessClock);
+  wifiManager.setNetworkActor(&networkActor);
+  wifiManager.setLoopStats(&loopStats);
+  wifiManager.setGameArena(&gameArena);
+  wifiManager.setStockfishCache(&stockfishCache);
+  boardDriver.cooperativeWait().setService(serviceBackground, nullptr);
+  networkActor.setCooperativeWait(&boardDriver.cooperativeWait());
+  networkActor.begin();
   Serial.println();
 
   // Configure menu system
   initMenus(&boardDriver);
 
-  // Kick off NTP time sync (non-blocking, will resolve in background)
-  configTime(0, 0, "pool.ntp.org", "time.nist.gov");
+  HeapReport::noteBoot();
+  // The position index and game catalog load on core 0 while the menu comes up
+  moveHistory.startCatalogTask();
   // Check for a live game that can be resumed
   checkForResumableGame();
   if (currentMode != MODE_SELECTION)
@@ -117,6 +187,7 @@ void checkForResumableGame() {
       return;
   }
 
+  BootTimeline::mark(BootStage::INTERACTIVE); // The resume prompt starts here
   Serial.printf("  Found: %s game — confirm resume?\n", modeName);
   Serial.println("  Green = Resume, Red = Discard");
   boardDriver.blinkSquare(3, 3, indicatorColor, 2);
@@ -144,10 +215,21 @@ void checkForResumableGame() {
   Serial.println("================================================");
 }
 
-void loop() {
+// Runs from loop() and from the blocking waits inside game modes (see cooperative_wait.h)
+void serviceBackground(void* context) {
   // WiFi reconnection state machine
   wifiManager.update();
 
+  // Relay web resign flag to the active game
+  if (currentMode != MODE_SELECTION && activeGame != nullptr && wifiManager.getPendingResign()) {
+    activeGame->setResignPending(true);
+    wifiManager.clearPendingResign();
+  }
+}
+
+void loop() {
+  boardDriver.cooperativeWait().service();
+
   // Check for pending board edits from WiFi (FEN-based)
   String editFen;
   if (wifiManager.getPendingBoardEdit(editFen)) {
@@ -182,6 +264,15 @@ void loop() {
       case 4:
         currentMode = MODE_SENSOR_TEST;
         break;
+      case 5:
+        currentMode = MODE_ANALYSIS;
+        break;
+      case 6:
+        currentMode = MODE_PUZZLE;
+        break;
+      case 7:
+        currentMode = MODE_OPENING;
+        break;
       default:
         Serial.println("Invalid game mode selected via WiFi");
         selectedMode = 0;
@@ -210,16 +301,15 @@ void loop() {
     delay(1); // HACK: Ensure any starting animations acquire the LED mutex before proceeding
   }
 
+  loopStats.beginIteration();
   switch (currentMode) {
     case MODE_CHESS_MOVES:
     case MODE_BOT:
     case MODE_LICHESS:
+    case MODE_ANALYSIS:
+    case MODE_PUZZLE:
+    case MODE_OPENING:
       if (activeGame != nullptr) {
-        // Relay web resign flag to the active game
-        if (wifiManager.getPendingResign()) {
-          activeGame->setResignPending(true);
-          wifiManager.clearPendingResign();
-        }
         if (activeGame->isGameOver())
           enterGameSelection();
         else
@@ -238,21 +328,28 @@ void loop() {
       enterGameSelection();
       break;
   }
+  loopStats.endIteration();
 
   delay(SENSOR_READ_DELAY_MS);
 }
 
 void enterGameSelection() {
+  chessClock.stop(); // Keep the final times readable on the web page until the next game
+  loopStats.printSummary("game over");
   currentMode = MODE_SELECTION;
   modeInitialized = false;
   navigator.clear();
   navigator.push(&gameMenu);
+  BootTimeline::mark(BootStage::INTERACTIVE); // Only the first game menu after boot counts
   Serial.println("=============== Game Selection Mode ===============");
-  Serial.println("Four LEDs are lit in the center of the board:");
+  Serial.println("Seven LEDs are lit in the center of the board:");
   Serial.println("  Blue:   Chess Moves (Human vs Human)");
   Serial.println("  Green:  Chess Bot (Human vs AI)");
   Serial.println("  Yellow: Lichess (Play online games)");
   Serial.println("  Red:    Sensor Test");
+  Serial.println("  Cyan:   Analysis (local engine, right of center)");
+  Serial.println("  Purple: Puzzles (right of center)");
+  Serial.println("  Lime:   Opening Trainer (left of center)");
   Serial.println("Place any chess piece on a LED to select that mode");
   Serial.println("===================================================");
 }
@@ -283,6 +380,24 @@ void handleMenuResult(int result) {
       modeInitialized = false;
       navigator.clear();
       break;
+    case MenuId::ANALYSIS:
+      Serial.println("Mode: 'Analysis' selected!");
+      currentMode = MODE_ANALYSIS;
+      modeInitialized = false;
+      navigator.clear();
+      break;
+    case MenuId::PUZZLE:
+      Serial.println("Mode: 'Puzzles' selected!");
+      currentMode = MODE_PUZZLE;
+      modeInitialized = false;
+      navigator.clear();
+      break;
+    case MenuId::OPENING:
+      Serial.println("Mode: 'Opening Trainer' selected!");
+      currentMode = MODE_OPENING;
+      modeInitialized = false;
+      navigator.clear();
+      break;
 
     // Bot difficulty menu (ids 10–17 → level 1–8)
     case MenuId::DIFF_1: case MenuId::DIFF_2: case MenuId::DIFF_3: case MenuId::DIFF_4:
@@ -331,34 +446,63 @@ void initializeSelectedMode(GameMode mode) {
     moveHistory.discardLiveGame(); // Discard any incomplete live game that wasn't properly finished or resumed (finishGame already removes live files for completed games)
 
   // Clean up previous game/test
-  delete activeGame;
+  gameArena.destroy(activeGame);
   activeGame = nullptr;
-  delete sensorTest;
+  gameArena.destroy(sensorTest);
   sensorTest = nullptr;
+  gameArena.reset();
+  chessClock.end();
+  loopStats.reset();
+  boardDriver.cooperativeWait().reset();
+  HeapReport::noteGameStart();
 
   switch (mode) {
     case MODE_CHESS_MOVES:
       Serial.println("Starting 'Chess Moves'...");
-      activeGame = new ChessMoves(&boardDriver, &chessEngine, &wifiManager, &moveHistory);
-      activeGame->begin();
+      activeGame = gameArena.create<ChessMoves>(&boardDriver, &chessEngine, &wifiManager, &moveHistory);
+      chessClock.begin(wifiManager.getTimeControl());
+      activeGame->setClock(&chessClock);
       break;
-    case MODE_BOT:
+    case MODE_BOT: {
       Serial.printf("Starting 'Chess Bot' (Depth: %d, Player is %s)...\n", botConfig.stockfishSettings.depth, botConfig.playerIsWhite ? "White" : "Black");
-      activeGame = new ChessBot(&boardDriver, &chessEngine, &wifiManager, &moveHistory, botConfig);
-      activeGame->begin();
+      ChessBot* bot = gameArena.create<ChessBot>(&boardDriver, &chessEngine, &wifiManager, &moveHistory, botConfig);
+      bot->setNetworkActor(&networkActor);
+      bot->setStockfishCache(&stockfishCache);
+      activeGame = bot;
+      chessClock.begin(wifiManager.getTimeControl());
+      activeGame->setClock(&chessClock);
       break;
-    case MODE_LICHESS:
+    }
+    case MODE_LICHESS: {
       Serial.println("Starting 'Lichess Mode'...");
-      activeGame = new ChessLichess(&boardDriver, &chessEngine, &wifiManager, lichessConfig);
-      activeGame->begin();
+      ChessLichess* lichess = gameArena.create<ChessLichess>(&boardDriver, &chessEngine, &wifiManager, lichessConfig);
+      lichess->setNetworkActor(&networkActor);
+      activeGame = lichess;
+      break;
+    }
+    case MODE_ANALYSIS:
+      Serial.println("Starting 'Analysis'...");
+      activeGame = gameArena.create<ChessAnalysis>(&boardDriver, &chessEngine, &wifiManager);
+      break;
+    case MODE_PUZZLE:
+      Serial.println("Starting 'Puzzles'...");
+      activeGame = gameArena.create<ChessPuzzle>(&boardDriver, &chessEngine, &wifiManager, wifiManager.getPuzzleRating());
+      break;
+    case MODE_OPENING:
+      Serial.println("Starting 'Opening Trainer'...");
+      activeGame = gameArena.create<ChessOpening>(&boardDriver, &chessEngine, &wifiManager, wifiManager.getOpeningColor());
       break;
     case MODE_SENSOR_TEST:
       Serial.println("Starting 'Sensor Test'...");
-      sensorTest = new SensorTest(&boardDriver);
+      sensorTest = gameArena.create<SensorTest>(&boardDriver);
       sensorTest->begin();
       break;
     default:
       enterGameSelection();
       break;
   }
+  if (activeGame) {
+    activeGame->setLoopStats(&loopStats);
+    activeGame->begin();
+  }
 }
\ No newline at end of file
@@ -14,6 +14,9 @@ namespace MenuId {
   constexpr int8_t BOT         = 1;
   constexpr int8_t LICHESS     = 2;
   constexpr int8_t SENSOR_TEST = 3;
+  constexpr int8_t ANALYSIS    = 4;
+  constexpr int8_t PUZZLE      = 5;
+  constexpr int8_t OPENING     = 6;
 
   // Bot difficulty (1-based level, offset by 10)
   constexpr int8_t DIFF_1 = 10; // Beginner
@@ -42,6 +45,9 @@ static constexpr MenuItem gameMenuItems[] = {
     {3, 4, LedColors::Green,  MenuId::BOT},          // Chess Bot (Human vs AI)
     {4, 3, LedColors::Yellow, MenuId::LICHESS},       // Lichess (Online play)
     {4, 4, LedColors::Red,    MenuId::SENSOR_TEST},   // Sensor Test
+    {3, 5, LedColors::Cyan,   MenuId::ANALYSIS},      // Analysis (local engine)
+    {4, 5, LedColors::Purple, MenuId::PUZZLE},        // Puzzles (tactics from flash)
+    {3, 2, LedColors::Lime,   MenuId::OPENING},       // Opening Trainer (repertoire from flash)
 };
 
 static constexpr MenuItem botDifficultyItems[] = {
@@ -0,0 +1,210 @@
+#include "microbench.h"
+#include "chess_engine.h"
+#include "chess_search.h"
+#include "chess_utils.h"
+#include "move_history.h"
+#include <algorithm>
+#include <atomic>
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
+
+// Fixed inputs: opening, a middlegame with an en passant square, a promotion race and a bare endgame
+static const char* const BENCH_FENS[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r1bqk2r/ppp2ppp/2n2n2/3pP3/1b6/2N2N2/PPPP1PPP/R1BQKB1R w KQkq d6 0 6",
+    "8/1P4k1/8/8/8/8/5p2/1K6 w - - 0 57",
+    "8/8/4k3/8/2R5/8/4K3/8 w - - 12 80",
+};
+static constexpr int BENCH_POSITIONS = sizeof(BENCH_FENS) / sizeof(BENCH_FENS[0]);
+
+struct BenchMove {
+  const char* uci;
+  int fromRow, fromCol, toRow, toCol;
+  char promotion;
+};
+static const BenchMove BENCH_MOVES[BENCH_POSITIONS] = {
+    {"e2e4", 6, 4, 4, 4, ' '},
+    {"e5d6", 3, 4, 2, 3, ' '},
+    {"b7b8q", 1, 1, 0, 1, 'q'},
+    {"c4c6", 4, 2, 2, 2, ' '},
+};
+
+static char boards[BENCH_POSITIONS][8][8];
+static char turns[BENCH_POSITIONS];
+static ChessEngine engines[BENCH_POSITIONS];
+static String fens[BENCH_POSITIONS];
+static String ucis[BENCH_POSITIONS];
+static uint16_t encoded[BENCH_POSITIONS];
+static char scratchBoard[8][8];
+static ChessEngine scratchEngine;
+
+// Each case returns something derived from its result so the call can't be optimized away
+typedef uint32_t (*BenchFn)(int position);
+
+static uint32_t benchBoardToFEN(int p) {
+  return ChessUtils::boardToFEN(boards[p], turns[p], &engines[p]).length();
+}
+
+static uint32_t benchFenToBoard(int p) {
+  char turn;
+  ChessUtils::fenToBoard(fens[p], scratchBoard, turn, &scratchEngine);
+  return turn;
+}
+
+static uint32_t benchToUCIMove(int p) {
+  const BenchMove& m = BENCH_MOVES[p];
+  return ChessUtils::toUCIMove(m.fromRow, m.fromCol, m.toRow, m.toCol, m.promotion).length();
+}
+
+static uint32_t benchParseUCIMove(int p) {
+  int fromRow, fromCol, toRow, toCol;
+  char promotion;
+  return ChessUtils::parseUCIMove(ucis[p], fromRow, fromCol, toRow, toCol, promotion) ? toCol : 0;
+}
+
+static uint32_t benchEvaluatePosition(int p) {
+  return (uint32_t)(int32_t)ChessUtils::evaluatePosition(boards[p]);
+}
+
+static uint32_t benchEncodeMove(int p) {
+  const BenchMove& m = BENCH_MOVES[p];
+  return MoveHistory::encodeMove(m.fromRow, m.fromCol, m.toRow, m.toCol, m.promotion);
+}
+
+static uint32_t benchDecodeMove(int p) {
+  int fromRow, fromCol, toRow, toCol;
+  char promotion;
+  MoveHistory::decodeMove(encoded[p], fromRow, fromCol, toRow, toCol, promotion);
+  return toRow + promotion;
+}
+
+static uint32_t benchZobristHash(int p) {
+  return (uint32_t)engines[p].computeZobristHash(boards[p], turns[p]);
+}
+
+static uint32_t benchSearchEvaluate(int p) {
+  return (uint32_t)ChessSearch::evaluate(boards[p]);
+}
+
+struct BenchCase {
+  const char* name;
+  BenchFn fn;
+  uint32_t callsPerBatch; // Sized so a batch takes roughly a millisecond
+};
+
+static const BenchCase BENCH_CASES[BENCH_CASE_COUNT] = {
+    {"boardToFEN", benchBoardToFEN, 200},
+    {"fenToBoard", benchFenToBoard, 200},
+    {"toUCIMove", benchToUCIMove, 1000},
+    {"parseUCIMove", benchParseUCIMove, 4000},
+    {"evaluatePosition", benchEvaluatePosition, 1000},
+    {"encodeMove", benchEncodeMove, 8000},
+    {"decodeMove", benchDecodeMove, 8000},
+    {"computeZobristHash", benchZobristHash, 1000},
+    {"searchEvaluate", benchSearchEvaluate, 1000},
+};
+
+static BenchResult lastResults[BENCH_CASE_COUNT];
+static uint8_t lastCount = 0;
+static uint32_t lastElapsedMs = 0;
+static std::atomic<bool> running(false);
+static volatile uint32_t sink;
+static Microbench::AllocationCounter allocationCounter = nullptr;
+
+static int32_t allocatedBlocks() {
+  multi_heap_info_t info;
+  heap_caps_get_info(&info, MALLOC_CAP_8BIT);
+  return (int32_t)info.allocated_blocks;
+}
+
+static void prepareInputs() {
+  for (int p = 0; p < BENCH_POSITIONS; p++) {
+    fens[p] = BENCH_FENS[p];
+    ChessUtils::fenToBoard(fens[p], boards[p], turns[p], &engines[p]);
+    ucis[p] = BENCH_MOVES[p].uci;
+    const BenchMove& m = BENCH_MOVES[p];
+    encoded[p] = MoveHistory::encodeMove(m.fromRow, m.fromCol, m.toRow, m.toCol, m.promotion);
+  }
+}
+
+static void runCase(const BenchCase& c, BenchResult& result) {
+  uint32_t batchNs[BENCH_BATCHES];
+  uint32_t acc = 0;
+  for (int p = 0; p < BENCH_POSITIONS; p++)
+    acc += c.fn(p); // Warm the cache and let String buffers settle before measuring
+
+  uint32_t calls = c.callsPerBatch * BENCH_CALL_SCALE;
+  int32_t blocksBefore = allocatedBlocks();
+  uint64_t allocsBefore = allocationCounter ? allocationCounter() : 0;
+  for (uint8_t b = 0; b < BENCH_BATCHES; b++) {
+    int64_t started = esp_timer_get_time();
+    for (uint32_t i = 0; i < calls; i++)
+      acc += c.fn(i % BENCH_POSITIONS);
+    batchNs[b] = (uint32_t)((esp_timer_get_time() - started) * 1000 / calls);
+  }
+  result.allocsPerCall = allocationCounter ? (float)(allocationCounter() - allocsBefore) / ((float)calls * BENCH_BATCHES) : -1.0f;
+  result.heapBlocks = allocatedBlocks() - blocksBefore;
+  sink = acc;
+
+  std::sort(batchNs, batchNs + BENCH_BATCHES);
+  result.name = c.name;
+  result.callsPerBatch = calls;
+  result.minNs = batchNs[0];
+  result.medianNs = batchNs[BENCH_BATCHES / 2];
+}
+
+static void runAll() {
+  unsigned long started = millis();
+  prepareInputs();
+  for (uint8_t i = 0; i < BENCH_CASE_COUNT; i++) {
+    runCase(BENCH_CASES[i], lastResults[i]);
+    Serial.printf("Bench: %-20s min %6u ns  median %6u ns  heap blocks %d\n", lastResults[i].name, lastResults[i].minNs, lastResults[i].medianNs, lastResults[i].heapBlocks);
+  }
+  lastCount = BENCH_CASE_COUNT;
+  lastElapsedMs = millis() - started;
+}
+
+static void benchTask(void*) {
+  runAll();
+  running.store(false);
+  vTaskDelete(nullptr);
+}
+
+bool Microbench::start() {
+  bool expected = false;
+  if (!running.compare_exchange_strong(expected, true))
+    return false;
+  lastCount = 0;
+  if (xTaskCreatePinnedToCore(benchTask, "Bench", BENCH_TASK_STACK, nullptr, BENCH_TASK_PRIORITY, nullptr, BENCH_TASK_CORE) != pdPASS) {
+    Serial.println("Bench: failed to start task");
+    running.store(false);
+    return false;
+  }
+  return true;
+}
+
+uint8_t Microbench::runNow(BenchResult out[BENCH_CASE_COUNT], uint32_t& elapsedMs) {
+  bool expected = false;
+  if (!running.compare_exchange_strong(expected, true))
+    return 0;
+  runAll();
+  running.store(false);
+  return results(out, elapsedMs);
+}
+
+void Microbench::setAllocationCounter(AllocationCounter counter) {
+  allocationCounter = counter;
+}
+
+bool Microbench::isRunning() {
+  return running.load();
+}
+
+uint8_t Microbench::results(BenchResult out[BENCH_CASE_COUNT], uint32_t& elapsedMs) {
+  if (running.load())
+    return 0;
+  for (uint8_t i = 0; i < lastCount; i++)
+    out[i] = lastResults[i];
+  elapsedMs = lastElapsedMs;
+  return lastCount;
+}
@@ -0,0 +1,56 @@
+#ifndef MICROBENCH_H
+#define MICROBENCH_H
+
+#include <Arduino.h>
+
+// ---------------------------
+// Microbenchmarks
+// ---------------------------
+// Times the small helpers that run on every move and every web poll (FEN and
+// UCI codecs, the material evaluation, the move history codec and the Zobrist
+// hash) and the search's piece-square evaluation on the device itself, where
+// the numbers matter. Each case runs a fixed number of batches of a fixed
+// number of calls over a fixed set of positions, so two firmware builds can be
+// compared with tools/microbench.py.
+//
+// POST /debug/bench starts a run on its own task; GET /debug/bench returns the
+// results once it has finished. The native build runs the same cases from
+// src/host/bench_main.cpp, where allocations can also be counted.
+
+static constexpr uint8_t BENCH_BATCHES = 15;           // Min and median are taken over batches
+static constexpr int BENCH_TASK_STACK = 8192;
+static constexpr UBaseType_t BENCH_TASK_PRIORITY = 1;
+static constexpr uint8_t BENCH_TASK_CORE = 0;          // Off the game loop's core so a run doesn't stall the board
+static constexpr uint8_t BENCH_CASE_COUNT = 9;
+#ifdef LIBRECHESS_HOST
+static constexpr uint32_t BENCH_CALL_SCALE = 20;       // A host core is that much faster: keeps batches near a millisecond
+#else
+static constexpr uint32_t BENCH_CALL_SCALE = 1;
+#endif
+
+struct BenchResult {
+  const char* name;
+  uint32_t callsPerBatch;
+  uint32_t minNs;            // Per call, fastest batch
+  uint32_t medianNs;         // Per call, median batch
+  int32_t heapBlocks;        // Net heap blocks left allocated by the whole case (should be 0)
+  float allocsPerCall;       // Heap allocations per call, -1 without an allocation counter (on the board)
+};
+
+/// Static like Profiler: one run at a time, started and read from the web server task.
+class Microbench {
+ public:
+  /// Allocations made so far by the calling task. The IDF heap can't count them.
+  using AllocationCounter = uint64_t (*)();
+
+  /// Start a run on the benchmark task. Returns false if one is already running.
+  static bool start();
+  /// Run on the calling task and fill `out`. Returns the number of cases.
+  static uint8_t runNow(BenchResult out[BENCH_CASE_COUNT], uint32_t& elapsedMs);
+  static void setAllocationCounter(AllocationCounter counter);
+  static bool isRunning();
+  /// Copy the results of the last finished run. Returns the number of cases (0 if none has finished).
+  static uint8_t results(BenchResult out[BENCH_CASE_COUNT], uint32_t& elapsedMs);
+};
+
+#endif // MICROBENCH_H
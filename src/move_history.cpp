@@ -1,13 +1,25 @@
 #include "move_history.h"
+#include "chess_engine.h"
 #include "chess_game.h"
 #include "chess_utils.h"
+#include "eco_trie.h"
+#include "game_arena.h"
+#include "game_catalog.h"
+#include "logger.h"
+#include "loop_stats.h"
+#include "move_trace.h"
+#include "position_index.h"
 #include <ArduinoJson.h>
 #include <algorithm>
 #include <sys/stat.h>
 #include <time.h>
 
-MoveHistory::MoveHistory() : recording(false) {
+// Placement, side to move and castling rights of the standard start (ECO lines begin there)
+static const char* const START_POSITION = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq";
+
+MoveHistory::MoveHistory() : recording(false), loopStats(nullptr), arena(nullptr), catalogQueue(nullptr), catalogPending(0) {
   memset(&header, 0, sizeof(header));
+  memset(&clockRecord, 0, sizeof(clockRecord));
 }
 
 void MoveHistory::begin() {
@@ -15,6 +27,80 @@ void MoveHistory::begin() {
     LittleFS.mkdir(GAMES_DIR);
 }
 
+bool MoveHistory::startCatalogTask() {
+  if (catalogQueue)
+    return true;
+  catalogPending.fetch_add(1);
+  catalogQueue = xQueueCreate(CATALOG_QUEUE_LENGTH, sizeof(uint16_t));
+  if (!catalogQueue || xTaskCreatePinnedToCore(catalogTaskEntry, "Catalog", CATALOG_TASK_STACK, this, CATALOG_TASK_PRIORITY, nullptr, CATALOG_TASK_CORE) != pdPASS) {
+    LOG_ERROR("MoveHistory: failed to start catalog task, cataloguing on the caller");
+    if (catalogQueue)
+      vQueueDelete(catalogQueue);
+    catalogQueue = nullptr;
+    loadCatalog();
+    catalogPending.fetch_sub(1);
+    return false;
+  }
+  return true;
+}
+
+void MoveHistory::catalogTaskEntry(void* param) {
+  static_cast<MoveHistory*>(param)->runCatalogTask();
+}
+
+void MoveHistory::runCatalogTask() {
+  loadCatalog();
+  catalogPending.fetch_sub(1);
+  uint16_t id;
+  while (true) {
+    if (xQueueReceive(catalogQueue, &id, portMAX_DELAY) != pdTRUE)
+      continue;
+    catalogFinishedGame(id);
+    catalogPending.fetch_sub(1);
+  }
+}
+
+void MoveHistory::catalogFinishedGame(int id) {
+  unsigned long started = millis();
+  EcoTrie eco;
+  eco.begin();
+  catalogGame(id, listGameIds(), eco, true, true);
+  LOG_INFO("MoveHistory: game %d catalogued in %lu ms", id, millis() - started);
+}
+
+void MoveHistory::loadCatalog() {
+  unsigned long started = millis();
+  positionIndex.begin();
+  catalog.begin();
+
+  // Games stored before the index and catalog existed (or after they were lost)
+  // are indexed and summarized once; summaries of games deleted behind the
+  // catalog's back (or before it was loaded) are dropped
+  auto ids = listGameIds();
+  auto summarized = catalog.gameIds();
+  for (int id : summarized)
+    if (!std::binary_search(ids.begin(), ids.end(), id))
+      catalog.remove((uint16_t)id);
+  bool index = positionIndex.isEmpty();
+  if (index && !ids.empty())
+    LOG_INFO("MoveHistory: building the position index for %u stored games", (unsigned)ids.size());
+  EcoTrie eco;
+  eco.begin(); // Optional: without it games are summarized unclassified
+  for (int id : ids) {
+    bool summarize = !std::binary_search(summarized.begin(), summarized.end(), id);
+    if (index || summarize)
+      catalogGame(id, ids, eco, index, summarize);
+  }
+  LOG_INFO("MoveHistory: catalog ready in %lu ms", millis() - started);
+}
+
+// Every flash write from the game loop goes through here so LoopStats can count them
+size_t MoveHistory::writeTracked(File& f, const uint8_t* data, size_t len) {
+  if (loopStats)
+    loopStats->noteFlashWrite(len);
+  return f.write(data, len);
+}
+
 uint32_t MoveHistory::getTimestamp() {
   time_t now = time(nullptr);
   // time() returns small values before NTP sync
@@ -115,8 +201,9 @@ void MoveHistory::enforceStorageLimits() {
   // 1. Enforce MAX_GAMES
   while ((int)ids.size() > MAX_GAMES) {
     LittleFS.remove(gamePath(ids.front()));
+    catalog.remove((uint16_t)ids.front());
     ids.erase(ids.begin());
-    Serial.println("MoveHistory: deleted oldest game (max game limit)");
+    LOG_INFO("MoveHistory: deleted oldest game (max game limit)");
   }
 
   // 2. Enforce MAX_USAGE_PERCENT
@@ -126,8 +213,9 @@ void MoveHistory::enforceStorageLimits() {
     if (total == 0 || (float)used / (float)total <= MAX_USAGE_PERCENT)
       break;
     LittleFS.remove(gamePath(ids.front()));
+    catalog.remove((uint16_t)ids.front());
     ids.erase(ids.begin());
-    Serial.println("MoveHistory: deleted oldest game (storage limit)");
+    LOG_INFO("MoveHistory: deleted oldest game (storage limit)");
   }
 }
 
@@ -142,11 +230,13 @@ void MoveHistory::startGame(uint8_t mode, uint8_t playerColor, uint8_t botDepth)
   header.playerColor = playerColor;
   header.botDepth = botDepth;
   header.timestamp = getTimestamp();
+  memset(&clockRecord, 0, sizeof(clockRecord));
 
-  // Write initial header to live.bin
+  // Write initial header and an empty clock block to live.bin
   File f = LittleFS.open(LIVE_MOVES_PATH, "w");
   if (f) {
-    f.write((const uint8_t*)&header, sizeof(header));
+    writeTracked(f, (const uint8_t*)&header, sizeof(header));
+    writeTracked(f, (const uint8_t*)&clockRecord, sizeof(clockRecord));
     f.close();
   }
 
@@ -155,7 +245,7 @@ void MoveHistory::startGame(uint8_t mode, uint8_t playerColor, uint8_t botDepth)
   if (ft) ft.close();
 
   recording = true;
-  Serial.println("MoveHistory: new live game started");
+  LOG_INFO("MoveHistory: new live game started");
 }
 
 void MoveHistory::addMove(int fromRow, int fromCol, int toRow, int toCol, char promotion) {
@@ -164,10 +254,11 @@ void MoveHistory::addMove(int fromRow, int fromCol, int toRow, int toCol, char p
   uint16_t encoded = encodeMove(fromRow, fromCol, toRow, toCol, promotion);
   File f = LittleFS.open(LIVE_MOVES_PATH, "a");
   if (f) {
-    f.write((const uint8_t*)&encoded, 2);
+    writeTracked(f, (const uint8_t*)&encoded, 2);
     f.close();
     header.moveCount++;
     updateLiveHeader();
+    MoveTrace::record(TraceStage::HISTORY_WRITTEN);
   }
 }
 
@@ -178,7 +269,7 @@ void MoveHistory::addFen(const String& fen) {
   uint16_t marker = FEN_MARKER;
   File fm = LittleFS.open(LIVE_MOVES_PATH, "a");
   if (fm) {
-    fm.write((const uint8_t*)&marker, 2);
+    writeTracked(fm, (const uint8_t*)&marker, 2);
     fm.close();
     header.moveCount++;
   }
@@ -188,8 +279,8 @@ void MoveHistory::addFen(const String& fen) {
   if (ft) {
     uint8_t len = (uint8_t)min((int)fen.length(), 255);
     header.lastFenOffset = (uint16_t)ft.size(); // Offset of this entry = current file size
-    ft.write(len);
-    ft.write((const uint8_t*)fen.c_str(), len);
+    writeTracked(ft, &len, 1);
+    writeTracked(ft, (const uint8_t*)fen.c_str(), len);
     ft.close();
     header.fenEntryCnt++;
   }
@@ -201,7 +292,8 @@ void MoveHistory::updateLiveHeader() {
   File f = LittleFS.open(LIVE_MOVES_PATH, "r+");
   if (f) {
     f.seek(0);
-    f.write((const uint8_t*)&header, sizeof(header));
+    writeTracked(f, (const uint8_t*)&header, sizeof(header));
+    writeTracked(f, (const uint8_t*)&clockRecord, sizeof(clockRecord));
     f.close();
   }
 }
@@ -218,24 +310,18 @@ void MoveHistory::finishGame(uint8_t result, char winnerColor) {
 
   updateLiveHeader();
 
-  // Read FEN table
-  std::vector<uint8_t> fenData;
+  // Append FEN table to live.bin, a chunk at a time so no buffer the size of the table is needed
   if (quietExists(LIVE_FEN_PATH)) {
     File ft = LittleFS.open(LIVE_FEN_PATH, "r");
-    if (ft) {
-      fenData.resize(ft.size());
-      ft.read(fenData.data(), fenData.size());
-      ft.close();
-    }
-  }
-
-  // Append FEN table to live.bin
-  if (!fenData.empty()) {
-    File fm = LittleFS.open(LIVE_MOVES_PATH, "a");
-    if (fm) {
-      fm.write(fenData.data(), fenData.size());
-      fm.close();
+    File fm = ft ? LittleFS.open(LIVE_MOVES_PATH, "a") : File();
+    if (ft && fm) {
+      uint8_t chunk[FEN_COPY_CHUNK];
+      size_t n;
+      while ((n = ft.read(chunk, sizeof(chunk))) > 0)
+        writeTracked(fm, chunk, n);
     }
+    if (fm) fm.close();
+    if (ft) ft.close();
   }
 
   // Enforce limits before writing new file
@@ -247,14 +333,196 @@ void MoveHistory::finishGame(uint8_t result, char winnerColor) {
   LittleFS.rename(LIVE_MOVES_PATH, dest.c_str());
   discardLiveGame();
 
-  Serial.printf("MoveHistory: game saved as %s (%d moves) (%d FEN entries)\n", dest.c_str(), header.moveCount, header.fenEntryCnt);
+  LOG_INFO("MoveHistory: game saved as %s (%d moves) (%d FEN entries)", dest.c_str(), header.moveCount, header.fenEntryCnt);
+
+  // The replay and index merge take long enough to stall the board while it
+  // shows the result, so the catalog task does them
+  uint16_t queued = (uint16_t)id;
+  catalogPending.fetch_add(1);
+  if (catalogQueue && xQueueSend(catalogQueue, &queued, 0) == pdTRUE)
+    return;
+  catalogPending.fetch_sub(1);
+  catalogFinishedGame(id);
+}
+
+// Play an encodeMove() code on a bare board, keeping the castling rights and en
+// passant square in `engine` up to date for computeZobristHash() (as ChessSearch::makeMove)
+static void replayMove(char board[8][8], ChessEngine& engine, char& sideToMove, uint16_t move) {
+  int fromRow, fromCol, toRow, toCol;
+  char promotion;
+  MoveHistory::decodeMove(move, fromRow, fromCol, toRow, toCol, promotion);
+
+  char piece = board[fromRow][fromCol];
+  bool isWhite = ChessUtils::isWhitePiece(piece);
+  char kind = toupper(piece);
+  if (kind == 'P' && fromCol != toCol && board[toRow][toCol] == ' ')
+    board[fromRow][toCol] = ' '; // En passant
+  if (kind == 'K' && abs(toCol - fromCol) == 2) {
+    int rookFromCol = (toCol > fromCol) ? 7 : 0;
+    board[fromRow][(toCol > fromCol) ? 5 : 3] = board[fromRow][rookFromCol];
+    board[fromRow][rookFromCol] = ' ';
+  }
+  board[toRow][toCol] = (promotion != ' ') ? (isWhite ? toupper(promotion) : promotion) : piece;
+  board[fromRow][fromCol] = ' ';
+
+  uint8_t rights = engine.getCastlingRights();
+  if (kind == 'K')
+    rights &= isWhite ? ~0x03 : ~0x0C;
+  auto clearCorner = [&rights](int row, int col) {
+    if (row == 7 && col == 7) rights &= ~0x01;
+    if (row == 7 && col == 0) rights &= ~0x02;
+    if (row == 0 && col == 7) rights &= ~0x04;
+    if (row == 0 && col == 0) rights &= ~0x08;
+  };
+  clearCorner(fromRow, fromCol);
+  clearCorner(toRow, toCol);
+  engine.setCastlingRights(rights);
+
+  if (kind == 'P' && abs(toRow - fromRow) == 2)
+    engine.setEnPassantTarget((fromRow + toRow) / 2, fromCol);
+  else
+    engine.clearEnPassantTarget();
+  sideToMove = (sideToMove == 'w') ? 'b' : 'w';
+}
+
+// Material balance in pawns from White's point of view
+static int materialBalance(const char board[8][8]) {
+  int balance = 0;
+  for (int row = 0; row < 8; row++)
+    for (int col = 0; col < 8; col++) {
+      char piece = board[row][col];
+      int value = 0;
+      switch (toupper(piece)) {
+        case 'P': value = 1; break;
+        case 'N':
+        case 'B': value = 3; break;
+        case 'R': value = 5; break;
+        case 'Q': value = 9; break;
+      }
+      balance += ChessUtils::isWhitePiece(piece) ? value : -value;
+    }
+  return balance;
+}
+
+bool MoveHistory::catalogGame(int id, const std::vector<int>& liveIds, EcoTrie& eco, bool index, bool summarize) {
+  File f = LittleFS.open(gamePath(id), "r");
+  GameHeader hdr;
+  size_t movesOffset = readHeader(f, hdr);
+  if (movesOffset == 0 || hdr.fenEntryCnt == 0 || hdr.moveCount == 0) {
+    if (f) f.close();
+    return false;
+  }
+  ClockRecord clk;
+  memset(&clk, 0, sizeof(clk));
+  if (movesOffset > sizeof(GameHeader))
+    f.read((uint8_t*)&clk, sizeof(clk));
+
+  // Every move entry (move or FEN marker) leads to one position. One scratch
+  // block holds the replay engine (its repetition history is too big for the
+  // stack), the positions and the moves.
+  ArenaScratch scratch(nullptr); // Also run by the catalog task, which mustn't touch the loop's arena
+  uint8_t* block = static_cast<uint8_t*>(scratch.allocate(sizeof(ChessEngine) + hdr.moveCount * (sizeof(PositionEntry) + sizeof(uint16_t))));
+  if (!block) {
+    LOG_ERROR("MoveHistory: no memory to catalog game %d", id);
+    f.close();
+    return false;
+  }
+  ChessEngine* engine = new (block) ChessEngine();
+  PositionEntry* entries = reinterpret_cast<PositionEntry*>(block + sizeof(ChessEngine));
+  uint16_t* moves = reinterpret_cast<uint16_t*>(entries + hdr.moveCount);
+  f.seek(movesOffset); // Past the clock block
+  if (f.read((uint8_t*)moves, hdr.moveCount * sizeof(uint16_t)) != hdr.moveCount * sizeof(uint16_t)) {
+    f.close();
+    return false;
+  }
+
+  size_t fenOffset = movesOffset + hdr.moveCount * sizeof(uint16_t);
+  char board[8][8];
+  char sideToMove = 'w';
+  uint16_t ply = 0;
+  size_t count = 0;
+  int materialMin = 0, materialMax = 0;
+  // The opening is classified along the moves from the standard start, up to
+  // the first board edit or the first move the ECO table doesn't know
+  EcoNode ecoNode;
+  bool ecoWalking = false;
+  uint16_t ecoCode = 0;
+  for (uint16_t i = 0; i < hdr.moveCount; i++) {
+    if (moves[i] == FEN_MARKER) {
+      // FEN entries are stored in marker order: 1-byte length + FEN string
+      char buf[256];
+      f.seek(fenOffset);
+      uint8_t len = f.read();
+      if (f.read((uint8_t*)buf, len) != len)
+        break;
+      buf[len] = '\0';
+      fenOffset += 1 + len;
+      ChessUtils::fenToBoard(String(buf), board, sideToMove, engine);
+      ecoWalking = (count == 0) && eco.isLoaded() && strncmp(buf, START_POSITION, strlen(START_POSITION)) == 0 && eco.root(ecoNode);
+    } else {
+      if (count == 0)
+        break; // Moves before the first FEN: not a game this firmware wrote
+      entries[count - 1].move = moves[i];
+      replayMove(board, *engine, sideToMove, moves[i]);
+      ply++;
+      if (ecoWalking) {
+        EcoNode next;
+        ecoWalking = eco.child(ecoNode, moves[i], next);
+        ecoNode = next;
+        if (ecoWalking && ecoNode.eco != 0)
+          ecoCode = ecoNode.eco;
+      }
+    }
+    int balance = materialBalance(board);
+    if (count == 0 || balance < materialMin) materialMin = balance;
+    if (count == 0 || balance > materialMax) materialMax = balance;
+    PositionEntry& e = entries[count++];
+    e.hash = engine->computeZobristHash(board, sideToMove);
+    e.gameId = (uint16_t)id;
+    e.ply = ply;
+    e.move = 0;
+    e.reserved = 0;
+  }
+  f.close();
+  if (count == 0)
+    return false;
+
+  bool ok = true;
+  if (summarize) {
+    GameSummary s;
+    memset(&s, 0, sizeof(s));
+    s.gameId = (uint16_t)id;
+    s.mode = hdr.mode;
+    s.result = hdr.result;
+    s.winnerColor = hdr.winnerColor;
+    s.playerColor = hdr.playerColor ? hdr.playerColor : '?';
+    s.botDepth = hdr.botDepth;
+    s.moveCount = hdr.moveCount;
+    s.plies = ply;
+    s.eco = ecoCode;
+    if (clk.mode != 0) {
+      s.clockBase = clk.baseSeconds;
+      s.clockIncrement = (uint8_t)std::min<uint32_t>(clk.incrementMs / 1000, 255);
+    }
+    s.materialMin = (int8_t)materialMin;
+    s.materialMax = (int8_t)materialMax;
+    s.timestamp = hdr.timestamp;
+    ok = catalog.add(s);
+  }
+  if (index)
+    ok = positionIndex.addGame((uint16_t)id, entries, count, liveIds) && ok;
+  return ok;
 }
 
 bool MoveHistory::quietExists(const char* path) {
+#ifdef LIBRECHESS_HOST
+  return LittleFS.exists(path); // No VFS mount point, and no error logs to avoid
+#else
   // Use POSIX stat() to avoid VFS open() error logs from LittleFS.exists()
   struct stat st;
   String fullPath = "/littlefs" + String(path);
   return (stat(fullPath.c_str(), &st) == 0);
+#endif
 }
 
 void MoveHistory::discardLiveGame() {
@@ -267,16 +535,22 @@ bool MoveHistory::hasLiveGame() {
   return quietExists(LIVE_MOVES_PATH);
 }
 
+size_t MoveHistory::readHeader(File& f, GameHeader& hdr) {
+  if (!f || f.size() < sizeof(GameHeader) || f.read((uint8_t*)&hdr, sizeof(hdr)) != sizeof(hdr))
+    return 0;
+  if (hdr.version == 1)
+    return sizeof(GameHeader);
+  if (hdr.version == FORMAT_VERSION && f.size() >= sizeof(GameHeader) + sizeof(ClockRecord))
+    return sizeof(GameHeader) + sizeof(ClockRecord);
+  return 0;
+}
+
 bool MoveHistory::getLiveGameInfo(uint8_t& mode, uint8_t& playerColor, uint8_t& botDepth) {
   File f = LittleFS.open(LIVE_MOVES_PATH, "r");
-  if (!f || f.size() < sizeof(GameHeader))
-    return false;
-
   GameHeader hdr;
-  f.read((uint8_t*)&hdr, sizeof(hdr));
-  f.close();
-
-  if (hdr.version != FORMAT_VERSION) return false;
+  size_t movesOffset = readHeader(f, hdr);
+  if (f) f.close();
+  if (movesOffset == 0) return false;
 
   mode = hdr.mode;
   playerColor = hdr.playerColor;
@@ -284,27 +558,44 @@ bool MoveHistory::getLiveGameInfo(uint8_t& mode, uint8_t& playerColor, uint8_t&
   return true;
 }
 
+bool MoveHistory::getLiveClock(ClockRecord& record) {
+  File f = LittleFS.open(LIVE_MOVES_PATH, "r");
+  GameHeader hdr;
+  size_t movesOffset = readHeader(f, hdr);
+  bool ok = movesOffset > sizeof(GameHeader) && f.read((uint8_t*)&record, sizeof(record)) == sizeof(record);
+  if (f) f.close();
+  return ok && record.mode != 0;
+}
+
 bool MoveHistory::replayIntoGame(ChessGame* game) {
   if (!game) return false;
 
   // Read live header and moves
   File fm = LittleFS.open(LIVE_MOVES_PATH, "r");
-  if (!fm || fm.size() < sizeof(GameHeader)) return false;
-
   GameHeader hdr;
-  fm.read((uint8_t*)&hdr, sizeof(hdr));
-  if (hdr.version != FORMAT_VERSION) {
-    fm.close();
+  size_t movesOffset = readHeader(fm, hdr);
+  if (movesOffset == 0) {
+    if (fm) fm.close();
     return false;
   }
+  ClockRecord clk;
+  memset(&clk, 0, sizeof(clk));
+  if (movesOffset > sizeof(GameHeader))
+    fm.read((uint8_t*)&clk, sizeof(clk));
   if (hdr.fenEntryCnt == 0) {
-    Serial.println("MoveHistory: no FEN in live game, cannot resume");
+    LOG_INFO("MoveHistory: no FEN in live game, cannot resume");
     fm.close();
     return false;
   }
 
-  // Read all 2-byte move entries
-  std::vector<uint16_t> moves(hdr.moveCount);
+  // Read all 2-byte move entries into per-game scratch
+  ArenaScratch scratch(arena);
+  uint16_t* moves = static_cast<uint16_t*>(scratch.allocate(hdr.moveCount * sizeof(uint16_t)));
+  if (!moves) {
+    LOG_ERROR("MoveHistory: no memory for %u moves", hdr.moveCount);
+    fm.close();
+    return false;
+  }
   for (uint16_t i = 0; i < hdr.moveCount; i++) {
     uint16_t val;
     if (fm.read((uint8_t*)&val, 2) != 2) {
@@ -323,23 +614,22 @@ bool MoveHistory::replayIntoGame(ChessGame* game) {
     ft.seek(hdr.lastFenOffset);
     uint8_t len = ft.read();
     if (len > 0) {
-      char* buf = new char[len + 1];
+      char buf[256]; // Length is a single byte
       ft.read((uint8_t*)buf, len);
       buf[len] = '\0';
       lastFen = String(buf);
-      delete[] buf;
     }
     ft.close();
   }
 
   if (lastFen.isEmpty()) {
-    Serial.println("MoveHistory: failed to read last FEN");
+    LOG_ERROR("MoveHistory: failed to read last FEN");
     return false;
   }
 
   // Find last FEN marker in moves (scan backwards)
   int lastFenIdx = -1;
-  for (int i = (int)moves.size() - 1; i >= 0; i--) {
+  for (int i = (int)hdr.moveCount - 1; i >= 0; i--) {
     if (moves[i] == FEN_MARKER) {
       lastFenIdx = i;
       break;
@@ -347,18 +637,18 @@ bool MoveHistory::replayIntoGame(ChessGame* game) {
   }
 
   if (lastFenIdx < 0) {
-    Serial.println("MoveHistory: FEN marker not found in moves");
+    LOG_INFO("MoveHistory: FEN marker not found in moves");
     return false;
   }
 
-  Serial.println("MoveHistory: resuming from FEN: " + lastFen);
+  LOG_INFO("MoveHistory: resuming from FEN: %s", lastFen.c_str());
 
   // Set board state from last FEN
   recording = false;
   game->setBoardStateFromFEN(lastFen);
 
   // Replay UCI moves after the last FEN marker
-  for (int i = lastFenIdx + 1; i < (int)moves.size(); i++) {
+  for (int i = lastFenIdx + 1; i < (int)hdr.moveCount; i++) {
     if (moves[i] == FEN_MARKER) continue;
     int fromRow, fromCol, toRow, toCol;
     char promotion;
@@ -367,37 +657,194 @@ bool MoveHistory::replayIntoGame(ChessGame* game) {
     game->advanceTurn();
   }
 
-  // Restore header for continued recording
+  // Restore header for continued recording. A version 1 live file is rewritten
+  // as version 2 first, so header updates have room for the clock block.
+  if (hdr.version != FORMAT_VERSION) {
+    hdr.version = FORMAT_VERSION;
+    File fr = LittleFS.open(LIVE_MOVES_PATH, "w");
+    if (fr) {
+      writeTracked(fr, (const uint8_t*)&hdr, sizeof(hdr));
+      writeTracked(fr, (const uint8_t*)&clk, sizeof(clk));
+      writeTracked(fr, (const uint8_t*)moves, hdr.moveCount * sizeof(uint16_t));
+      fr.close();
+    }
+  }
   header = hdr;
+  clockRecord = clk;
   recording = true;
 
-  Serial.printf("MoveHistory: replayed %d moves from last FEN marker, game resumed\n", (moves.size() - 1) - lastFenIdx);
+  LOG_INFO("MoveHistory: replayed %d moves from last FEN marker, game resumed", (hdr.moveCount - 1) - lastFenIdx);
   return true;
 }
 
-String MoveHistory::getGameListJSON() {
-  auto ids = listGameIds();
+String MoveHistory::getGameListJSON(const CatalogFilter& filter, uint16_t offset, uint16_t limit) {
   JsonDocument doc;
   JsonArray arr = doc["games"].to<JsonArray>();
 
-  for (int id : ids) {
-    File f = LittleFS.open(gamePath(id), "r");
-    if (!f || f.size() < sizeof(GameHeader)) continue;
+  int total = catalog.query(filter, offset, limit, [&arr](const GameSummary& s) {
+    JsonObject obj = arr.add<JsonObject>();
+    obj["id"] = s.gameId;
+    obj["mode"] = s.mode;
+    obj["result"] = s.result;
+    obj["winner"] = String((char)s.winnerColor);
+    obj["playerColor"] = String((char)s.playerColor);
+    obj["botDepth"] = s.botDepth;
+    obj["moveCount"] = s.moveCount;
+    obj["plies"] = s.plies;
+    obj["timestamp"] = s.timestamp;
+    char eco[4];
+    EcoTrie::format(s.eco, eco);
+    if (eco[0])
+      obj["eco"] = eco;
+    obj["materialMin"] = s.materialMin;
+    obj["materialMax"] = s.materialMax;
+    obj["materialSwing"] = s.materialMax - s.materialMin;
+    if (s.clockBase != 0 || s.clockIncrement != 0) {
+      obj["clockBase"] = s.clockBase;
+      obj["clockIncrement"] = s.clockIncrement;
+    }
+  });
+  if (total < 0)
+    return String();
+  doc["total"] = total;
+  doc["offset"] = offset;
 
-    GameHeader hdr;
-    f.read((uint8_t*)&hdr, sizeof(hdr));
-    f.close();
+  String out;
+  serializeJson(doc, out);
+  return out;
+}
 
-    JsonObject obj = arr.add<JsonObject>();
-    obj["id"] = id;
+String MoveHistory::getGameStatsJSON() {
+  CatalogStats stats;
+  if (!catalog.getStats(stats))
+    return String();
+
+  auto colorJson = [](JsonObject obj, const ColorResults& r) {
+    obj["white"] = r.white;
+    obj["black"] = r.black;
+    obj["draws"] = r.draws;
+  };
+  auto playerJson = [](JsonObject obj, const PlayerResults& r) {
+    obj["games"] = r.wins + r.losses + r.draws;
+    obj["wins"] = r.wins;
+    obj["losses"] = r.losses;
+    obj["draws"] = r.draws;
+  };
+
+  JsonDocument doc;
+  doc["games"] = stats.games;
+  doc["plies"] = stats.plies;
+  colorJson(doc["chessMoves"].to<JsonObject>(), stats.byMode[GAME_MODE_CHESS_MOVES - 1]);
+  colorJson(doc["bot"].to<JsonObject>(), stats.byMode[GAME_MODE_BOT - 1]);
+  playerJson(doc["botAsWhite"].to<JsonObject>(), stats.botAsWhite);
+  playerJson(doc["botAsBlack"].to<JsonObject>(), stats.botAsBlack);
+  JsonArray depths = doc["botByDepth"].to<JsonArray>();
+  for (uint8_t d = 0; d <= CATALOG_MAX_BOT_DEPTH; d++) {
+    const PlayerResults& r = stats.botByDepth[d];
+    if (r.wins + r.losses + r.draws == 0)
+      continue;
+    JsonObject obj = depths.add<JsonObject>();
+    obj["depth"] = d;
+    playerJson(obj, r);
+  }
+  JsonArray results = doc["byResult"].to<JsonArray>();
+  for (uint8_t r = 0; r < 7; r++)
+    results.add(stats.byResult[r]);
+  JsonObject volumes = doc["byEcoVolume"].to<JsonObject>();
+  for (uint8_t v = 0; v + 1 < CATALOG_ECO_VOLUMES; v++)
+    colorJson(volumes[String((char)('A' + v))].to<JsonObject>(), stats.byEcoVolume[v]);
+  colorJson(volumes["none"].to<JsonObject>(), stats.byEcoVolume[CATALOG_ECO_VOLUMES - 1]);
+
+  String out;
+  serializeJson(doc, out);
+  return out;
+}
+
+String MoveHistory::getPositionSearchJSON(uint64_t hash) {
+  PositionEntry matches[SEARCH_MAX_GAMES];
+  uint32_t total = 0;
+  int found = positionIndex.lookup(hash, matches, SEARCH_MAX_GAMES, total);
+  if (found < 0)
+    return String();
+  // Newest games first
+  std::sort(matches, matches + found, [](const PositionEntry& a, const PositionEntry& b) { return a.gameId > b.gameId; });
+
+  struct MoveStats {
+    uint16_t move;
+    uint16_t games, white, draws, black;
+  };
+  MoveStats moveStats[SEARCH_MAX_GAMES];
+  int moveStatCount = 0;
+  uint16_t white = 0, draws = 0, black = 0;
+
+  JsonDocument doc;
+  char hex[17];
+  snprintf(hex, sizeof(hex), "%08lx%08lx", (unsigned long)(hash >> 32), (unsigned long)(hash & 0xFFFFFFFF));
+  doc["hash"] = hex;
+  doc["positions"] = total;
+  JsonArray games = doc["games"].to<JsonArray>();
+  for (int i = 0; i < found; i++) {
+    const PositionEntry& m = matches[i];
+    File f = LittleFS.open(gamePath(m.gameId), "r");
+    GameHeader hdr;
+    size_t movesOffset = readHeader(f, hdr);
+    if (f) f.close();
+    if (movesOffset == 0)
+      continue; // Deleted since it was indexed
+
+    JsonObject obj = games.add<JsonObject>();
+    obj["id"] = m.gameId;
+    obj["ply"] = m.ply;
     obj["mode"] = hdr.mode;
     obj["result"] = hdr.result;
     obj["winner"] = String((char)hdr.winnerColor);
-    obj["playerColor"] = hdr.playerColor ? String((char)hdr.playerColor) : String("?");
-    obj["botDepth"] = hdr.botDepth;
-    obj["moveCount"] = hdr.moveCount;
     obj["timestamp"] = hdr.timestamp;
+    if (hdr.winnerColor == 'w')
+      white++;
+    else if (hdr.winnerColor == 'b')
+      black++;
+    else
+      draws++;
+    if (m.move == 0)
+      continue;
+
+    int fromRow, fromCol, toRow, toCol;
+    char promotion;
+    decodeMove(m.move, fromRow, fromCol, toRow, toCol, promotion);
+    obj["move"] = ChessUtils::toUCIMove(fromRow, fromCol, toRow, toCol, promotion);
+    int s = 0;
+    while (s < moveStatCount && moveStats[s].move != m.move)
+      s++;
+    if (s == moveStatCount)
+      moveStats[moveStatCount++] = {m.move, 0, 0, 0, 0};
+    moveStats[s].games++;
+    if (hdr.winnerColor == 'w')
+      moveStats[s].white++;
+    else if (hdr.winnerColor == 'b')
+      moveStats[s].black++;
+    else
+      moveStats[s].draws++;
+  }
+
+  doc["white"] = white;
+  doc["draws"] = draws;
+  doc["black"] = black;
+  std::sort(moveStats, moveStats + moveStatCount, [](const MoveStats& a, const MoveStats& b) { return a.games > b.games; });
+  JsonArray next = doc["moves"].to<JsonArray>();
+  for (int i = 0; i < moveStatCount; i++) {
+    int fromRow, fromCol, toRow, toCol;
+    char promotion;
+    decodeMove(moveStats[i].move, fromRow, fromCol, toRow, toCol, promotion);
+    JsonObject obj = next.add<JsonObject>();
+    obj["move"] = ChessUtils::toUCIMove(fromRow, fromCol, toRow, toCol, promotion);
+    obj["games"] = moveStats[i].games;
+    obj["white"] = moveStats[i].white;
+    obj["draws"] = moveStats[i].draws;
+    obj["black"] = moveStats[i].black;
   }
+  JsonObject index = doc["index"].to<JsonObject>();
+  index["runs"] = positionIndex.runCount();
+  index["positions"] = positionIndex.entryCount();
 
   String out;
   serializeJson(doc, out);
@@ -407,5 +854,7 @@ String MoveHistory::getGameListJSON() {
 bool MoveHistory::deleteGame(int id) {
   String path = gamePath(id);
   if (!quietExists(path.c_str())) return false;
-  return LittleFS.remove(path);
+  if (!LittleFS.remove(path)) return false;
+  catalog.remove((uint16_t)id);
+  return true;
 }
@@ -1,12 +1,21 @@
 #ifndef MOVE_HISTORY_H
 #define MOVE_HISTORY_H
 
+#include "game_catalog.h"
+#include "position_index.h"
 #include <Arduino.h>
 #include <LittleFS.h>
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
 #include <vector>
 
-// Forward declaration
+// Forward declarations
 class ChessGame;
+class EcoTrie;
+class GameArena;
+class LoopStats;
 
 enum GameResult : uint8_t {
   RESULT_IN_PROGRESS = 0,
@@ -14,7 +23,8 @@ enum GameResult : uint8_t {
   RESULT_STALEMATE = 2,
   RESULT_DRAW_50 = 3,
   RESULT_DRAW_3FOLD = 4,
-  RESULT_RESIGNATION = 5
+  RESULT_RESIGNATION = 5,
+  RESULT_TIMEOUT = 6
 };
 
 enum GameModeCode : uint8_t {
@@ -23,7 +33,7 @@ enum GameModeCode : uint8_t {
 };
 
 struct __attribute__((packed)) GameHeader {
-  uint8_t version;        // Format version (currently 1)
+  uint8_t version;        // Format version (currently 2)
   uint8_t mode;           // GameModeCode
   uint8_t result;         // GameResult
   uint8_t winnerColor;    // 'w', 'b', 'd' (draw), '?' (in-progress)
@@ -36,6 +46,26 @@ struct __attribute__((packed)) GameHeader {
 };
 static_assert(sizeof(GameHeader) == 16, "GameHeader must be 16 bytes");
 
+// Format version 2 stores a clock block right after the header (zeroed for
+// untimed games), so moves start at offset 32. Version 1 files have no clock
+// block and their moves start at offset 16.
+struct __attribute__((packed)) ClockRecord {
+  uint8_t mode;            // ClockMode, 0 = untimed
+  uint8_t reserved;
+  uint16_t baseSeconds;    // Starting time per side
+  uint32_t incrementMs;    // Fischer increment or Bronstein delay
+  uint32_t remainingMs[2]; // White, Black — as of the last recorded move
+};
+static_assert(sizeof(ClockRecord) == 16, "ClockRecord must be 16 bytes");
+
+// ---------------------------
+// Catalog Task Configuration
+// ---------------------------
+static constexpr int CATALOG_TASK_STACK = 8192;         // As the loop task that catalogued games before (replay, ECO walk, merges)
+static constexpr UBaseType_t CATALOG_TASK_PRIORITY = 1;
+static constexpr BaseType_t CATALOG_TASK_CORE = 0;      // Off the game loop's core
+static constexpr UBaseType_t CATALOG_QUEUE_LENGTH = 8;  // Finished games waiting to be catalogued
+
 class MoveHistory {
  public:
   MoveHistory();
@@ -43,16 +73,35 @@ class MoveHistory {
   // Call after LittleFS is mounted to create the /games directory
   void begin();
 
+  // Start the catalog task: it loads the position index and game catalog and
+  // builds them from the stored games if missing, away from the boot path,
+  // then catalogues each game finishGame() hands it. Runs the same work on
+  // the caller if the task can't be started.
+  bool startCatalogTask();
+
+  // True while the catalog task is loading or has finished games left to catalogue
+  bool isCataloguing() const { return catalogPending.load() > 0; }
+
+  // Count flash writes from the game loop in `stats`
+  void setLoopStats(LoopStats* stats) { loopStats = stats; }
+  // Take the live game's replay scratch from `arena` (the heap if never set)
+  void setArena(GameArena* a) { arena = a; }
+
   // Call once when a new game begins (writes header + starting FEN)
   void startGame(uint8_t mode, uint8_t playerColor = '?', uint8_t botDepth = 0);
 
   // Append a move (2-byte UCI encoding) to the live file
   void addMove(int fromRow, int fromCol, int toRow, int toCol, char promotion = ' ');
 
+  // Set the clock block written with the next header update (call before addMove)
+  void setClock(const ClockRecord& record) { clockRecord = record; }
+
   // Append a FEN marker to the live moves file and write the FEN string into the live FEN table file
   void addFen(const String& fen);
 
-  // Finalize the live game: update header, merge FEN table, rename to a completed-game file, enforce storage limits
+  // Finalize the live game: update header, merge FEN table, rename to a completed-game file, enforce storage limits,
+  // and queue it for the catalog task to add its positions to the position index and its summary (opening, length,
+  // material) to the game catalog
   void finishGame(uint8_t result, char winnerColor);
 
   void discardLiveGame();
@@ -65,6 +114,9 @@ class MoveHistory {
   // Read mode/config from the live header (for mode selection)
   bool getLiveGameInfo(uint8_t& mode, uint8_t& playerColor, uint8_t& botDepth);
 
+  // Read the clock block of the live game. Returns false for untimed or version 1 games.
+  bool getLiveClock(ClockRecord& record);
+
   // Replay the live game into a ChessGame instance:
   //  1. Finds the last FEN marker and its FEN string
   //  2. Calls game->setBoardStateFromFEN() with that FEN
@@ -72,10 +124,22 @@ class MoveHistory {
   // Recording is suppressed automatically during replay
   bool replayIntoGame(ChessGame* game);
 
-  // JSON array of game metadata (id, mode, result, timestamp …)
-  String getGameListJSON();
+  // JSON page of the catalogued games matching `filter` (id, mode, result, opening, length …)
+  // with the total match count. Empty if the catalog is busy.
+  String getGameListJSON(const CatalogFilter& filter, uint16_t offset, uint16_t limit);
+
+  // Copy the catalog's running totals. Returns false if the catalog is busy.
+  bool getCatalogStats(CatalogStats& out) { return catalog.getStats(out); }
 
-  // Delete a single completed game by id
+  // JSON of the running result totals by mode, color, bot depth and opening volume.
+  // Empty if the catalog is busy.
+  String getGameStatsJSON();
+
+  // JSON of the stored games that reached the position with Zobrist hash `hash`, with
+  // result and next-move statistics. Empty if the index is busy merging.
+  String getPositionSearchJSON(uint64_t hash);
+
+  // Delete a single completed game and its summary by id (its index entries are dropped by later merges)
   bool deleteGame(int id);
   // LittleFS.exists() wrapper that suppresses noisy vfs_api log output
   static bool quietExists(const char* path);
@@ -86,6 +150,9 @@ class MoveHistory {
   // Delete oldest games until count ≤ MAX_GAMES and LittleFS usage ≤ MAX_USAGE_PERCENT
   void enforceStorageLimits();
 
+  // Collect sorted list of existing game ids
+  static std::vector<int> listGameIds();
+
   // Encode a move into 2 bytes: [from(6)][to(6)][promo(4)]
   static uint16_t encodeMove(int fromRow, int fromCol, int toRow, int toCol, char promotion);
 
@@ -95,27 +162,49 @@ class MoveHistory {
  private:
   bool recording;
   GameHeader header;
+  ClockRecord clockRecord;
+  PositionIndex positionIndex;
+  GameCatalog catalog;
+  LoopStats* loopStats;
+  GameArena* arena;
+  QueueHandle_t catalogQueue;      // Ids of finished games for the catalog task
+  std::atomic<int> catalogPending;  // The initial load plus queued games not catalogued yet
 
   static constexpr const char* GAMES_DIR = "/games";
   static constexpr const char* LIVE_MOVES_PATH = "/games/live.bin";
   static constexpr const char* LIVE_FEN_PATH = "/games/live_fen.bin";
   static constexpr int MAX_GAMES = 50;
   static constexpr float MAX_USAGE_PERCENT = 0.80f;
-  static constexpr uint8_t FORMAT_VERSION = 1;
+  static constexpr uint8_t FORMAT_VERSION = 2;
   static constexpr uint16_t FEN_MARKER = 0xFFFF;
+  static constexpr size_t FEN_COPY_CHUNK = 256; // Stack buffer for appending the FEN table in finishGame()
+  static constexpr int SEARCH_MAX_GAMES = 32;    // Games listed by getPositionSearchJSON() (16 bytes of stack each)
 
   // Map promotion character to 4-bit code and back
   static uint8_t promoCharToCode(char p);
   static char promoCodeToChar(uint8_t code);
 
-  // Rewrite the header stored at offset 0 of live.bin
+  size_t writeTracked(File& f, const uint8_t* data, size_t len);
+
+  // Rewrite the header and clock block stored at offset 0 of live.bin
   void updateLiveHeader();
 
+  // Read and check a game header; returns the offset of the first move, or 0 if unsupported
+  static size_t readHeader(File& f, GameHeader& hdr);
+
   // Find the lowest available game id (1-based)
   int nextGameId();
 
-  // Collect sorted list of existing game ids
-  std::vector<int> listGameIds();
+  // Load the index and catalog, then index and summarize the stored games they lack
+  void loadCatalog();
+  static void catalogTaskEntry(void* param);
+  void runCatalogTask();
+  // Add a finished game to the position index and the catalog
+  void catalogFinishedGame(int id);
+
+  // Replay a stored game once to add every position it reached to the position
+  // index (`index`) and/or its summary to the game catalog (`summarize`)
+  bool catalogGame(int id, const std::vector<int>& liveIds, EcoTrie& eco, bool index, bool summarize);
 
   // Obtain a Unix timestamp (returns 0 if NTP has not synced)
   static uint32_t getTimestamp();
@@ -0,0 +1,139 @@
+#include "move_trace.h"
+#include <esp_timer.h>
+#include <string.h>
+#include <xtensa/core-macros.h>
+
+// ---------------------------
+// Recorder State
+// ---------------------------
+// Written from the game loop, the animation task (LED frames) and the web
+// server task, so every update happens under one spinlock. Each record is a
+// handful of stores; nothing here allocates or blocks.
+
+static portMUX_TYPE traceLock = portMUX_INITIALIZER_UNLOCKED;
+static TraceEvent ring[MOVE_TRACE_CAPACITY];
+static size_t ringHead = 0;  // Next slot to write
+static size_t ringCount = 0;
+static TraceHistogram histograms[(size_t)TraceStage::COUNT];
+
+static uint16_t moveNumber = 0; // Incremented by MOVE_APPLIED
+static int64_t edgeUs = 0;      // Latest SENSOR_EDGE, the origin of sinceEdgeUs
+static bool awaitingLeds = false;
+static bool awaitingWeb = false;
+
+static const char* const STAGE_NAMES[] = {"sensor edge", "debounce accepted", "move resolved", "move applied", "history written", "LEDs shown", "web published"};
+static_assert(sizeof(STAGE_NAMES) / sizeof(STAGE_NAMES[0]) == (size_t)TraceStage::COUNT, "Missing stage name");
+
+static uint8_t bucketFor(uint32_t us) {
+  uint8_t bucket = 0;
+  while (us > 0 && bucket < MOVE_TRACE_BUCKETS - 1) {
+    us >>= 1;
+    bucket++;
+  }
+  return bucket;
+}
+
+// Caller holds traceLock
+static void recordLocked(TraceStage stage, int64_t nowUs, uint32_t cycles) {
+  if (stage == TraceStage::MOVE_APPLIED) {
+    moveNumber++;
+    awaitingLeds = true;
+    awaitingWeb = true;
+  }
+  // Stages before MOVE_APPLIED belong to the move being made
+  uint16_t move = stage < TraceStage::MOVE_APPLIED ? moveNumber + 1 : moveNumber;
+  uint32_t sinceEdge = (uint32_t)max((int64_t)0, nowUs - edgeUs);
+
+  TraceEvent& e = ring[ringHead];
+  e.timeUs = (uint32_t)nowUs;
+  e.cycles = cycles;
+  e.move = move;
+  e.stage = stage;
+  e.core = (uint8_t)xPortGetCoreID();
+  e.sinceEdgeUs = stage == TraceStage::SENSOR_EDGE ? 0 : sinceEdge;
+  ringHead = (ringHead + 1) % MOVE_TRACE_CAPACITY;
+  if (ringCount < MOVE_TRACE_CAPACITY)
+    ringCount++;
+
+  if (stage != TraceStage::SENSOR_EDGE) {
+    TraceHistogram& h = histograms[(size_t)stage];
+    h.count++;
+    h.totalUs += sinceEdge;
+    h.maxUs = max(h.maxUs, sinceEdge);
+    h.buckets[bucketFor(sinceEdge)]++;
+  }
+}
+
+void MoveTrace::record(TraceStage stage) {
+  uint32_t cycles = XTHAL_GET_CCOUNT();
+  int64_t now = esp_timer_get_time();
+  portENTER_CRITICAL(&traceLock);
+  recordLocked(stage, now, cycles);
+  portEXIT_CRITICAL(&traceLock);
+}
+
+void MoveTrace::recordSensorChange(int64_t rawEdgeUs) {
+  uint32_t cycles = XTHAL_GET_CCOUNT();
+  int64_t now = esp_timer_get_time();
+  portENTER_CRITICAL(&traceLock);
+  edgeUs = rawEdgeUs;
+  recordLocked(TraceStage::SENSOR_EDGE, rawEdgeUs, 0);
+  recordLocked(TraceStage::DEBOUNCE_ACCEPTED, now, cycles);
+  portEXIT_CRITICAL(&traceLock);
+}
+
+void MoveTrace::ledsShown() {
+  if (!awaitingLeds)
+    return;
+  uint32_t cycles = XTHAL_GET_CCOUNT();
+  int64_t now = esp_timer_get_time();
+  portENTER_CRITICAL(&traceLock);
+  if (awaitingLeds) {
+    awaitingLeds = false;
+    recordLocked(TraceStage::LEDS_SHOWN, now, cycles);
+  }
+  portEXIT_CRITICAL(&traceLock);
+}
+
+void MoveTrace::webPublished() {
+  if (!awaitingWeb)
+    return;
+  uint32_t cycles = XTHAL_GET_CCOUNT();
+  int64_t now = esp_timer_get_time();
+  portENTER_CRITICAL(&traceLock);
+  if (awaitingWeb) {
+    awaitingWeb = false;
+    recordLocked(TraceStage::WEB_PUBLISHED, now, cycles);
+  }
+  portEXIT_CRITICAL(&traceLock);
+}
+
+size_t MoveTrace::snapshot(TraceEvent out[], size_t capacity) {
+  portENTER_CRITICAL(&traceLock);
+  size_t count = min(ringCount, capacity);
+  size_t start = (ringHead + MOVE_TRACE_CAPACITY - ringCount) % MOVE_TRACE_CAPACITY;
+  for (size_t i = 0; i < count; i++)
+    out[i] = ring[(start + i) % MOVE_TRACE_CAPACITY];
+  portEXIT_CRITICAL(&traceLock);
+  return count;
+}
+
+void MoveTrace::histogram(TraceStage stage, TraceHistogram& out) {
+  portENTER_CRITICAL(&traceLock);
+  out = histograms[(size_t)stage];
+  portEXIT_CRITICAL(&traceLock);
+}
+
+void MoveTrace::clear() {
+  portENTER_CRITICAL(&traceLock);
+  ringHead = 0;
+  ringCount = 0;
+  memset(histograms, 0, sizeof(histograms));
+  awaitingLeds = false;
+  awaitingWeb = false;
+  portEXIT_CRITICAL(&traceLock);
+}
+
+const char* MoveTrace::stageName(TraceStage stage) {
+  return stage < TraceStage::COUNT ? STAGE_NAMES[(size_t)stage] : "unknown";
+}
@@ -0,0 +1,70 @@
+#ifndef MOVE_TRACE_H
+#define MOVE_TRACE_H
+
+#include <Arduino.h>
+
+// ---------------------------
+// Move Pipeline Tracing
+// ---------------------------
+// Tracepoints along the path from a piece landing to every kind of feedback,
+// so perceived lag can be pinned on debounce, legality checking, LED
+// contention, flash writes or the web relay. Events go to a fixed ring buffer
+// (no heap) and are exported as Chrome trace JSON by GET /debug/trace; open
+// it in chrome://tracing or ui.perfetto.dev.
+
+static constexpr size_t MOVE_TRACE_CAPACITY = 256;   // Events kept (16 bytes each)
+static constexpr uint8_t MOVE_TRACE_BUCKETS = 21;    // Histogram buckets: [0,1) µs, then [2^(i-1), 2^i) µs, last is open-ended
+
+enum class TraceStage : uint8_t {
+  SENSOR_EDGE = 0,    // First raw reading of a change (back-dated from the debounce accept)
+  DEBOUNCE_ACCEPTED,  // readSensors() committed the change
+  MOVE_RESOLVED,      // tryPlayerMove() returned a legal move
+  MOVE_APPLIED,       // applyMove() updated the board (before clock and history)
+  HISTORY_WRITTEN,    // MoveHistory::addMove() finished its flash writes
+  LEDS_SHOWN,         // First LED frame pushed after the move
+  WEB_PUBLISHED,      // New FEN handed to the web server
+  COUNT
+};
+
+struct TraceEvent {
+  uint32_t timeUs;   // esp_timer time, low 32 bits (common time base across cores)
+  uint32_t cycles;   // CPU cycle counter of the recording core, 0 if back-dated
+  uint16_t move;     // Move number the event belongs to
+  TraceStage stage;
+  uint8_t core;
+  uint32_t sinceEdgeUs; // Time since the SENSOR_EDGE that started this move
+};
+static_assert(sizeof(TraceEvent) == 16, "TraceEvent must be 16 bytes");
+
+/// Per-stage latency measured from the sensor edge that completed the move.
+struct TraceHistogram {
+  uint32_t count;
+  uint32_t maxUs;
+  uint64_t totalUs;
+  uint32_t buckets[MOVE_TRACE_BUCKETS];
+};
+
+/// Static recorder: tracepoints sit in BoardDriver, ChessGame, MoveHistory and
+/// the web server, so threading a pointer through all of them would cost more
+/// than the feature. record() is ISR-free but safe from any task.
+class MoveTrace {
+ public:
+  static void record(TraceStage stage);
+  /// Record a change whose first raw reading was at edgeUs, then its debounce accept.
+  static void recordSensorChange(int64_t edgeUs);
+  /// Called on every LED frame; records LEDS_SHOWN for the first frame after a move.
+  static void ledsShown();
+  /// Called on every web board update; records WEB_PUBLISHED for the first one after a move.
+  static void webPublished();
+
+  /// Copy the ring buffer, oldest first. Returns the number of events copied.
+  static size_t snapshot(TraceEvent out[], size_t capacity);
+  static void histogram(TraceStage stage, TraceHistogram& out);
+  static void clear();
+
+  static const char* stageName(TraceStage stage);
+  /// Lower bound of histogram bucket i in µs.
+  static uint32_t bucketFloorUs(uint8_t bucket) { return bucket == 0 ? 0 : (1UL << (bucket - 1)); }
+};
+
+#endif // MOVE_TRACE_H
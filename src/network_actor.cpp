@@ -0,0 +1,71 @@
+#include "network_actor.h"
+#include <esp_timer.h>
+
+static uint32_t nowUs() {
+  return (uint32_t)esp_timer_get_time();
+}
+
+NetworkActor::NetworkActor() : taskHandle(nullptr), wait(nullptr), nextJobId(0), jobs(0), totalRunUs(0), maxRunUs(0) {}
+
+bool NetworkActor::begin() {
+  if (taskHandle)
+    return true;
+  if (xTaskCreatePinnedToCore(taskEntry, "NetActor", NET_TASK_STACK, this, NET_TASK_PRIORITY, &taskHandle, NET_TASK_CORE) != pdPASS) {
+    Serial.println("NetworkActor: failed to start task, network calls will run on the game loop");
+    taskHandle = nullptr;
+    return false;
+  }
+  return true;
+}
+
+void NetworkActor::run(const std::function<void()>& work) {
+  Job job = {&work, ++nextJobId};
+  if (!taskHandle || !requests.push(job, nowUs())) {
+    work();
+    return;
+  }
+  xTaskNotifyGive(taskHandle);
+
+  // The job refers to `work` on this stack frame, so wait for its reply even if it takes long
+  Job reply;
+  while (!replies.pop(reply, nowUs()) || reply.id != job.id) {
+    if (wait)
+      wait->sleep(NET_REPLY_POLL_MS);
+    else
+      delay(NET_REPLY_POLL_MS);
+  }
+}
+
+void NetworkActor::snapshot(NetworkActorStats& out) const {
+  requests.snapshot(out.requests);
+  replies.snapshot(out.replies);
+  out.jobs = jobs;
+  out.avgRunUs = jobs > 0 ? (uint32_t)(totalRunUs / jobs) : 0;
+  out.maxRunUs = maxRunUs;
+}
+
+// ---------------------------
+// Network Task
+// ---------------------------
+
+void NetworkActor::taskEntry(void* param) {
+  static_cast<NetworkActor*>(param)->runTask();
+}
+
+void NetworkActor::runTask() {
+  Job job;
+  while (true) {
+    if (!requests.pop(job, nowUs())) {
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+      continue;
+    }
+    uint32_t start = nowUs();
+    (*job.work)();
+    uint32_t elapsed = nowUs() - start;
+    jobs++;
+    totalRunUs += elapsed;
+    maxRunUs = max(maxRunUs, elapsed);
+    // One job in flight at a time, so the reply queue can't be full
+    replies.push(job, nowUs());
+  }
+}
@@ -0,0 +1,71 @@
+#ifndef NETWORK_ACTOR_H
+#define NETWORK_ACTOR_H
+
+#include "cooperative_wait.h"
+#include "spsc_queue.h"
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <functional>
+
+// ---------------------------
+// Network Actor Configuration
+// ---------------------------
+static constexpr size_t NET_QUEUE_SIZE = 8;              // Power of two; one request is in flight at a time today
+static constexpr int NET_TASK_STACK = 8192;              // Same as the Arduino loop task that ran these calls before (TLS handshakes)
+static constexpr UBaseType_t NET_TASK_PRIORITY = 1;
+static constexpr BaseType_t NET_TASK_CORE = 0;           // With the WiFi stack; the game loop runs on core 1
+static constexpr uint32_t NET_REPLY_POLL_MS = 5;
+
+struct NetworkActorStats {
+  SpscQueueStats requests; // Game loop -> network task
+  SpscQueueStats replies;  // Network task -> game loop
+  uint32_t jobs;
+  uint32_t avgRunUs;
+  uint32_t maxRunUs;
+};
+
+// ---------------------------
+// Network Actor
+// ---------------------------
+/// Runs the blocking HTTPS calls (Stockfish, Lichess) on a task pinned to
+/// core 0, so a slow TLS handshake no longer stalls the game loop on core 1.
+/// The game loop hands work over through a lock-free request queue and polls
+/// the reply queue through the board's CooperativeWait, which keeps WiFi and
+/// the web resign relay serviced while the request is out.
+///
+/// run() is called from the game loop task only (the queues are
+/// single-producer, single-consumer). Work must not touch LEDs or sensors.
+class NetworkActor {
+ public:
+  NetworkActor();
+
+  /// Start the network task. Until it runs (or if it fails), run() executes inline.
+  bool begin();
+  /// Poll for replies with `wait` (the board's, see BoardDriver::cooperativeWait()). Plain delay() until set.
+  void setCooperativeWait(CooperativeWait* w) { wait = w; }
+  /// Execute `work` on the network task and wait for it to finish.
+  void run(const std::function<void()>& work);
+
+  void snapshot(NetworkActorStats& out) const;
+
+ private:
+  struct Job {
+    const std::function<void()>* work;
+    uint32_t id;
+  };
+
+  SpscQueue<Job, NET_QUEUE_SIZE> requests;
+  SpscQueue<Job, NET_QUEUE_SIZE> replies;
+  TaskHandle_t taskHandle;
+  CooperativeWait* wait;
+  uint32_t nextJobId;
+  uint32_t jobs;
+  uint64_t totalRunUs;
+  uint32_t maxRunUs;
+
+  static void taskEntry(void* param);
+  void runTask();
+};
+
+#endif // NETWORK_ACTOR_H
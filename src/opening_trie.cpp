@@ -0,0 +1,75 @@
+#include "opening_trie.h"
+#include "move_history.h"
+#include <string.h>
+
+OpeningTrie::OpeningTrie() : loaded(false) {
+  memset(&header, 0, sizeof(header));
+}
+
+OpeningTrie::~OpeningTrie() {
+  end();
+}
+
+static bool isValidHeader(const OpeningTrieHeader& h, size_t fileSize) {
+  if (memcmp(h.magic, "OCOT", 4) != 0 || h.version != OPENING_TRIE_VERSION || h.nodeSize != sizeof(OpeningNode))
+    return false;
+  if ((h.side != 'w' && h.side != 'b') || h.nodeCount == 0)
+    return false;
+  return fileSize == sizeof(OpeningTrieHeader) + (size_t)h.nodeCount * sizeof(OpeningNode);
+}
+
+bool OpeningTrie::validateFile(File& f, uint32_t& lineCount) {
+  OpeningTrieHeader h;
+  if (!f.seek(0) || f.read((uint8_t*)&h, sizeof(h)) != sizeof(h) || !isValidHeader(h, f.size()))
+    return false;
+  lineCount = h.lineCount;
+  return true;
+}
+
+bool OpeningTrie::begin(const char* path) {
+  end();
+  if (!MoveHistory::quietExists(path)) {
+    Serial.printf("Opening repertoire not found: %s\n", path);
+    return false;
+  }
+  file = LittleFS.open(path, "r");
+  if (!file) {
+    Serial.printf("Failed to open opening repertoire: %s\n", path);
+    return false;
+  }
+  if (file.read((uint8_t*)&header, sizeof(header)) != sizeof(header) || !isValidHeader(header, file.size())) {
+    Serial.println("Opening repertoire header is invalid");
+    file.close();
+    return false;
+  }
+
+  loaded = true;
+  Serial.printf("Opening repertoire loaded: %u lines for %s, %u nodes\n", header.lineCount, header.side == 'w' ? "White" : "Black", header.nodeCount);
+  return true;
+}
+
+void OpeningTrie::end() {
+  if (file)
+    file.close();
+  loaded = false;
+}
+
+bool OpeningTrie::readNode(uint32_t index, OpeningNode& out) {
+  if (!loaded || index >= header.nodeCount)
+    return false;
+  if (!file.seek(sizeof(OpeningTrieHeader) + index * sizeof(OpeningNode)))
+    return false;
+  return file.read((uint8_t*)&out, sizeof(OpeningNode)) == sizeof(OpeningNode);
+}
+
+int OpeningTrie::readChildren(const OpeningNode& parent, OpeningNode out[]) {
+  int count = min((int)parent.childCount, (int)OPENING_MAX_CHILDREN);
+  if (!loaded || count == 0 || parent.firstChild + count > header.nodeCount)
+    return 0;
+  if (!file.seek(sizeof(OpeningTrieHeader) + parent.firstChild * sizeof(OpeningNode)))
+    return 0;
+  size_t bytes = count * sizeof(OpeningNode);
+  if (file.read((uint8_t*)out, bytes) != bytes)
+    return 0;
+  return count;
+}
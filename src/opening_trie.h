@@ -0,0 +1,80 @@
+#ifndef OPENING_TRIE_H
+#define OPENING_TRIE_H
+
+#include <Arduino.h>
+#include <LittleFS.h>
+
+// ---------------------------
+// Opening Repertoire Format
+// ---------------------------
+// Compiled on a computer by tools/opening_trie.py from PGN repertoires.
+// All integers are little-endian. Layout:
+//   OpeningTrieHeader                  16 bytes
+//   OpeningNode[nodeCount]             12 bytes each, breadth-first
+// Node 0 is the starting position. Breadth-first order keeps the children of
+// every node contiguous, so a node's replies are one run of childCount nodes
+// starting at firstChild: advancing one ply is a single seek + read.
+
+static constexpr const char* OPENING_TRIE_PATH = "/openings.bin";
+static constexpr const char* OPENING_TRIE_TEMP_PATH = "/openings.tmp"; // Upload target until validated
+static constexpr uint8_t OPENING_TRIE_VERSION = 1;
+static constexpr uint8_t OPENING_MAX_CHILDREN = 32; // Replies per position kept by the compiler
+static constexpr uint8_t OPENING_MAX_DEPTH = 40;    // Plies per line kept by the compiler
+
+static constexpr uint8_t OPENING_NODE_LINE_END = 0x01; // A repertoire line ends here (it may still continue in others)
+
+struct __attribute__((packed)) OpeningTrieHeader {
+  char magic[4];      // "OCOT"
+  uint8_t version;    // OPENING_TRIE_VERSION
+  uint8_t nodeSize;   // sizeof(OpeningNode), checked on load
+  char side;          // 'w' or 'b': the color the repertoire is for
+  uint8_t maxDepth;   // Longest line in plies
+  uint32_t nodeCount; // Including the root
+  uint32_t lineCount; // Distinct repertoire lines
+};
+static_assert(sizeof(OpeningTrieHeader) == 16, "OpeningTrieHeader must be 16 bytes");
+
+struct __attribute__((packed)) OpeningNode {
+  uint16_t move;       // MoveHistory::encodeMove code of the move leading here (0 for the root)
+  uint16_t lineCount;  // Lines passing through this node (saturates at 65535)
+  uint8_t childCount;  // <= OPENING_MAX_CHILDREN
+  uint8_t flags;       // OPENING_NODE_* bits
+  uint16_t reserved;
+  uint32_t firstChild; // Index of the first child (meaningless when childCount == 0)
+};
+static_assert(sizeof(OpeningNode) == 12, "OpeningNode must be 12 bytes");
+
+// ---------------------------
+// Opening Trie Reader
+// ---------------------------
+/// LittleFS cannot be memory-mapped, so the reader keeps the file open and
+/// reads a node's child run on demand into the caller's buffer. Only the
+/// header lives in RAM; the trie size is bounded by flash, not heap.
+class OpeningTrie {
+ public:
+  OpeningTrie();
+  ~OpeningTrie();
+
+  /// Open the repertoire and check its header. Returns false if missing or malformed.
+  bool begin(const char* path = OPENING_TRIE_PATH);
+  void end();
+
+  bool isLoaded() const { return loaded; }
+  char getSide() const { return header.side; }
+  uint32_t getLineCount() const { return loaded ? header.lineCount : 0; }
+
+  /// Read node `index` (0 = root).
+  bool readNode(uint32_t index, OpeningNode& out);
+  /// Read the children of `parent` into out[] (OPENING_MAX_CHILDREN entries). Returns the number read.
+  int readChildren(const OpeningNode& parent, OpeningNode out[]);
+
+  /// Validate a repertoire file (used by the upload endpoint before replacing the trie).
+  static bool validateFile(File& file, uint32_t& lineCount);
+
+ private:
+  File file;
+  bool loaded;
+  OpeningTrieHeader header;
+};
+
+#endif // OPENING_TRIE_H
@@ -0,0 +1,311 @@
+#include "position_index.h"
+#include "game_arena.h"
+#include "logger.h"
+#include "move_history.h"
+#include <algorithm>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+static constexpr TickType_t LOOKUP_WAIT_TICKS = pdMS_TO_TICKS(2000); // A merge of a full index takes about a second
+
+static bool entryLess(const PositionEntry& a, const PositionEntry& b) {
+  if (a.hash != b.hash)
+    return a.hash < b.hash;
+  if (a.gameId != b.gameId)
+    return a.gameId < b.gameId;
+  return a.ply < b.ply;
+}
+
+static bool readRunHeader(File& f, PositionRunHeader& hdr) {
+  if (!f || f.read((uint8_t*)&hdr, sizeof(hdr)) != sizeof(hdr))
+    return false;
+  return memcmp(hdr.magic, "OCPI", 4) == 0 && hdr.version == POSITION_INDEX_VERSION && hdr.entrySize == sizeof(PositionEntry) && f.size() >= sizeof(hdr) + (size_t)hdr.count * sizeof(PositionEntry);
+}
+
+// Buffered sequential reader over the entries of one run
+class RunReader {
+ public:
+  RunReader(PositionEntry* buf) : buffer(buf), filled(0), pos(0), left(0) {}
+  bool open(const String& path) {
+    file = LittleFS.open(path, "r");
+    PositionRunHeader hdr;
+    if (!readRunHeader(file, hdr))
+      return false;
+    left = hdr.count;
+    return true;
+  }
+  const PositionEntry* peek() {
+    if (pos == filled) {
+      size_t want = std::min((size_t)left, POSITION_MERGE_CHUNK);
+      filled = want ? file.read((uint8_t*)buffer, want * sizeof(PositionEntry)) / sizeof(PositionEntry) : 0;
+      left -= filled;
+      pos = 0;
+      if (filled == 0)
+        return nullptr;
+    }
+    return &buffer[pos];
+  }
+  void next() { pos++; }
+  void close() {
+    if (file)
+      file.close();
+  }
+
+ private:
+  File file;
+  PositionEntry* buffer;
+  size_t filled;
+  size_t pos;
+  uint32_t left;
+};
+
+PositionIndex::PositionIndex() : mutex(xSemaphoreCreateMutex()), loaded(false), runTotal(0) {}
+
+String PositionIndex::runPath(uint16_t seq, bool temp) {
+  char buf[32];
+  snprintf(buf, sizeof(buf), "%s/run_%04u.%s", POSITION_INDEX_DIR, seq, temp ? "tmp" : "bin");
+  return String(buf);
+}
+
+void PositionIndex::begin() {
+  xSemaphoreTake(mutex, portMAX_DELAY);
+  if (!MoveHistory::quietExists(POSITION_INDEX_DIR))
+    LittleFS.mkdir(POSITION_INDEX_DIR);
+
+  // A merge writes run_N.tmp and then replaces run_N.bin with it. If power was
+  // lost in between, finish the rename, or drop the temp if run_N.bin survived.
+  std::vector<uint16_t> temps;
+  std::vector<uint16_t> seqs;
+  File dir = LittleFS.open(POSITION_INDEX_DIR);
+  if (dir && dir.isDirectory()) {
+    File f = dir.openNextFile();
+    while (f) {
+      String name = f.name();
+      if (name.startsWith("run_")) {
+        uint16_t seq = (uint16_t)name.substring(4, name.length() - 4).toInt();
+        if (name.endsWith(".tmp"))
+          temps.push_back(seq);
+        else if (name.endsWith(".bin"))
+          seqs.push_back(seq);
+      }
+      f = dir.openNextFile();
+    }
+  }
+  for (uint16_t seq : temps) {
+    if (std::find(seqs.begin(), seqs.end(), seq) == seqs.end()) {
+      LittleFS.rename(runPath(seq, true), runPath(seq));
+      seqs.push_back(seq);
+    } else {
+      LittleFS.remove(runPath(seq, true));
+    }
+  }
+  std::sort(seqs.begin(), seqs.end());
+
+  runTotal = 0;
+  for (uint16_t seq : seqs) {
+    File f = LittleFS.open(runPath(seq), "r");
+    PositionRunHeader hdr;
+    bool ok = readRunHeader(f, hdr);
+    if (f) f.close();
+    if (!ok || runTotal == POSITION_INDEX_MAX_RUNS + 1) {
+      LOG_ERROR("PositionIndex: dropping run %u (unreadable or over the run limit)", seq);
+      LittleFS.remove(runPath(seq));
+      continue;
+    }
+    runs[runTotal++] = {seq, hdr.maxGameId, hdr.count};
+  }
+  LOG_INFO("PositionIndex: %u runs, %u positions", runTotal, entryCount());
+  loaded.store(true);
+  xSemaphoreGive(mutex);
+}
+
+uint32_t PositionIndex::entryCount() const {
+  uint32_t total = 0;
+  for (uint8_t i = 0; i < runTotal; i++)
+    total += runs[i].count;
+  return total;
+}
+
+bool PositionIndex::writeRun(uint16_t seq, uint16_t maxGameId, const PositionEntry* entries, size_t count) {
+  File f = LittleFS.open(runPath(seq), "w");
+  if (!f)
+    return false;
+  PositionRunHeader hdr = {{'O', 'C', 'P', 'I'}, POSITION_INDEX_VERSION, sizeof(PositionEntry), maxGameId, (uint32_t)count, 0};
+  size_t bytes = count * sizeof(PositionEntry);
+  bool ok = f.write((const uint8_t*)&hdr, sizeof(hdr)) == sizeof(hdr) && f.write((const uint8_t*)entries, bytes) == bytes;
+  f.close();
+  if (!ok)
+    LittleFS.remove(runPath(seq));
+  return ok;
+}
+
+// Merge the two newest runs (or rewrite the only one) into the older's file,
+// dropping entries of games not in `liveIds` and of `dropGameId`.
+bool PositionIndex::mergeNewest(const std::vector<int>& liveIds, uint16_t dropGameId) {
+  if (runTotal == 0)
+    return false;
+  IndexRun& older = runs[runTotal >= 2 ? runTotal - 2 : 0];
+  IndexRun* newer = runTotal >= 2 ? &runs[runTotal - 1] : nullptr;
+
+  ArenaScratch scratch(nullptr); // On the catalog task: the game arena belongs to the loop
+  PositionEntry* buffers = static_cast<PositionEntry*>(scratch.allocate(3 * POSITION_MERGE_CHUNK * sizeof(PositionEntry)));
+  if (!buffers) {
+    LOG_ERROR("PositionIndex: no memory to merge");
+    return false;
+  }
+  RunReader a(buffers);
+  RunReader b(buffers + POSITION_MERGE_CHUNK);
+  PositionEntry* out = buffers + 2 * POSITION_MERGE_CHUNK;
+  bool ok = a.open(runPath(older.seq)) && (!newer || b.open(runPath(newer->seq)));
+
+  String tempPath = runPath(older.seq, true);
+  File f = ok ? LittleFS.open(tempPath, "w") : File();
+  PositionRunHeader hdr = {{'O', 'C', 'P', 'I'}, POSITION_INDEX_VERSION, sizeof(PositionEntry), older.maxGameId, 0, 0};
+  if (newer)
+    hdr.maxGameId = std::max(older.maxGameId, newer->maxGameId);
+  ok = f && f.write((const uint8_t*)&hdr, sizeof(hdr)) == sizeof(hdr);
+
+  size_t pending = 0;
+  while (ok) {
+    const PositionEntry* ea = a.peek();
+    const PositionEntry* eb = newer ? b.peek() : nullptr;
+    if (!ea && !eb)
+      break;
+    const PositionEntry* e;
+    if (ea && (!eb || !entryLess(*eb, *ea))) {
+      e = ea;
+      a.next();
+    } else {
+      e = eb;
+      b.next();
+    }
+    if (e->gameId == dropGameId || !std::binary_search(liveIds.begin(), liveIds.end(), (int)e->gameId))
+      continue;
+    out[pending++] = *e;
+    hdr.count++;
+    if (pending == POSITION_MERGE_CHUNK) {
+      ok = f.write((const uint8_t*)out, pending * sizeof(PositionEntry)) == pending * sizeof(PositionEntry);
+      pending = 0;
+    }
+  }
+  if (ok && pending > 0)
+    ok = f.write((const uint8_t*)out, pending * sizeof(PositionEntry)) == pending * sizeof(PositionEntry);
+  if (ok) {
+    f.seek(0);
+    ok = f.write((const uint8_t*)&hdr, sizeof(hdr)) == sizeof(hdr);
+  }
+  a.close();
+  b.close();
+  if (f) f.close();
+  if (!ok) {
+    LOG_ERROR("PositionIndex: merge into run %u failed", older.seq);
+    LittleFS.remove(tempPath);
+    return false;
+  }
+
+  // A crash from here on is recovered by begin()
+  LittleFS.remove(runPath(older.seq));
+  LittleFS.rename(tempPath, runPath(older.seq));
+  if (newer) {
+    LittleFS.remove(runPath(newer->seq));
+    runTotal--;
+  }
+  older.maxGameId = hdr.maxGameId;
+  older.count = hdr.count;
+  return true;
+}
+
+void PositionIndex::compact(const std::vector<int>& liveIds, uint16_t dropGameId, bool all) {
+  if (all && runTotal == 1) {
+    mergeNewest(liveIds, dropGameId);
+    return;
+  }
+  while (runTotal >= 2) {
+    const IndexRun& older = runs[runTotal - 2];
+    const IndexRun& newer = runs[runTotal - 1];
+    if (!all && runTotal <= POSITION_INDEX_MAX_RUNS && older.count > (uint32_t)POSITION_MERGE_RATIO * newer.count)
+      break;
+    if (!mergeNewest(liveIds, dropGameId))
+      break;
+  }
+}
+
+bool PositionIndex::addGame(uint16_t gameId, PositionEntry* entries, size_t count, const std::vector<int>& liveIds) {
+  // Sort, then keep each position's first visit
+  std::sort(entries, entries + count, entryLess);
+  size_t unique = 0;
+  for (size_t i = 0; i < count; i++)
+    if (unique == 0 || entries[i].hash != entries[unique - 1].hash)
+      entries[unique++] = entries[i];
+
+  xSemaphoreTake(mutex, portMAX_DELAY);
+  uint16_t maxGameId = 0;
+  for (uint8_t i = 0; i < runTotal; i++)
+    maxGameId = std::max(maxGameId, runs[i].maxGameId);
+  if (gameId <= maxGameId) {
+    // The id belonged to a deleted game whose entries may not have been merged away yet
+    LOG_INFO("PositionIndex: purging reused game id %u", gameId);
+    compact(liveIds, gameId, true);
+  }
+
+  uint16_t seq = runTotal > 0 ? runs[runTotal - 1].seq + 1 : 1;
+  bool ok = writeRun(seq, std::max(maxGameId, gameId), entries, unique);
+  if (ok) {
+    runs[runTotal++] = {seq, std::max(maxGameId, gameId), (uint32_t)unique};
+    compact(liveIds, 0, false);
+  } else {
+    LOG_ERROR("PositionIndex: failed to write run for game %u", gameId);
+  }
+  xSemaphoreGive(mutex);
+  return ok;
+}
+
+int PositionIndex::lookup(uint64_t hash, PositionEntry out[], int maxGames, uint32_t& total) {
+  total = 0;
+  if (!loaded.load() || xSemaphoreTake(mutex, LOOKUP_WAIT_TICKS) != pdTRUE)
+    return -1;
+
+  int found = 0;
+  for (uint8_t r = 0; r < runTotal; r++) {
+    File f = LittleFS.open(runPath(runs[r].seq), "r");
+    PositionRunHeader hdr;
+    if (!readRunHeader(f, hdr)) {
+      if (f) f.close();
+      continue;
+    }
+
+    // Lower bound of `hash`: only the 8-byte key is read at each probe
+    uint32_t lo = 0;
+    uint32_t hi = hdr.count;
+    while (lo < hi) {
+      uint32_t mid = lo + (hi - lo) / 2;
+      uint64_t key = 0;
+      f.seek(sizeof(PositionRunHeader) + (size_t)mid * sizeof(PositionEntry));
+      f.read((uint8_t*)&key, sizeof(key));
+      if (key < hash)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+    f.seek(sizeof(PositionRunHeader) + (size_t)lo * sizeof(PositionEntry));
+    PositionEntry e;
+    for (uint32_t i = lo; i < hdr.count; i++) {
+      if (f.read((uint8_t*)&e, sizeof(e)) != sizeof(e) || e.hash != hash)
+        break;
+      total++;
+      int slot = 0;
+      while (slot < found && out[slot].gameId != e.gameId)
+        slot++;
+      if (slot < found) {
+        if (e.ply < out[slot].ply)
+          out[slot] = e;
+      } else if (found < maxGames) {
+        out[found++] = e;
+      }
+    }
+    f.close();
+  }
+  xSemaphoreGive(mutex);
+  return found;
+}
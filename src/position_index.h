@@ -0,0 +1,101 @@
+#ifndef POSITION_INDEX_H
+#define POSITION_INDEX_H
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <vector>
+
+// ---------------------------
+// Position Index Format
+// ---------------------------
+// Maps the Zobrist hash of every position reached in a stored game to the
+// game and ply, so "games reaching this position" is a lookup instead of a
+// replay of every game. Written on the board by MoveHistory::finishGame().
+// All integers are little-endian. Each run file is:
+//   PositionRunHeader                  16 bytes
+//   PositionEntry[count]               16 bytes each, sorted by (hash, gameId, ply)
+//
+// The index is a small log-structured merge tree: every finished game is
+// written as its own sorted run, and the newest run is merged into the one
+// before it while that one is no more than POSITION_MERGE_RATIO times its
+// size. Run sizes then grow geometrically, so there are only a handful of
+// runs, each entry is rewritten O(log games) times, and a lookup is one
+// binary search per run. Entries of deleted games are dropped by the merges;
+// an id that is reused before then is purged when its new game is added.
+
+static constexpr const char* POSITION_INDEX_DIR = "/games/index";
+static constexpr uint8_t POSITION_INDEX_VERSION = 1;
+static constexpr uint8_t POSITION_INDEX_MAX_RUNS = 8;      // Merge regardless of size beyond this
+static constexpr uint8_t POSITION_MERGE_RATIO = 2;
+static constexpr size_t POSITION_MERGE_CHUNK = 32;         // Entries buffered per merge input (512 bytes each)
+
+struct __attribute__((packed)) PositionRunHeader {
+  char magic[4];      // "OCPI"
+  uint8_t version;    // POSITION_INDEX_VERSION
+  uint8_t entrySize;  // sizeof(PositionEntry), checked on load
+  uint16_t maxGameId; // Highest game id ever added to this run (or the runs merged into it)
+  uint32_t count;
+  uint32_t reserved;
+};
+static_assert(sizeof(PositionRunHeader) == 16, "PositionRunHeader must be 16 bytes");
+
+struct __attribute__((packed)) PositionEntry {
+  uint64_t hash;     // ChessEngine::computeZobristHash() of the position
+  uint16_t gameId;
+  uint16_t ply;      // Moves played before the position (FEN markers don't count)
+  uint16_t move;     // MoveHistory::encodeMove code played from it, 0 if the game ended or the board was edited
+  uint16_t reserved;
+};
+static_assert(sizeof(PositionEntry) == 16, "PositionEntry must be 16 bytes");
+
+// ---------------------------
+// Position Index
+// ---------------------------
+/// The index of one games directory, owned by its MoveHistory. Runs are added
+/// by MoveHistory's catalog task and looked up from the web server task, under
+/// a mutex. Merge buffers come from the heap: the game arena is the loop's.
+class PositionIndex {
+ public:
+  PositionIndex();
+
+  /// Create the directory and load the run list. Call after LittleFS is mounted.
+  /// Until then, lookups report busy.
+  void begin();
+  /// True if there are no runs (fresh flash, or games stored before the index existed).
+  bool isEmpty() const { return runTotal == 0; }
+
+  /// Add the positions of game `gameId` (any order, repeats allowed; sorted in place).
+  /// `liveIds` are the stored game ids (sorted): merges drop entries of the others.
+  bool addGame(uint16_t gameId, PositionEntry* entries, size_t count, const std::vector<int>& liveIds);
+
+  /// Find up to `maxGames` entries for `hash`, at most one per game (its first ply).
+  /// Returns the number found, or -1 if a merge held the index too long (or it isn't loaded yet). `total`
+  /// counts every matching entry, including those of deleted games not merged away yet.
+  int lookup(uint64_t hash, PositionEntry out[], int maxGames, uint32_t& total);
+
+  uint8_t runCount() const { return runTotal; }
+  uint32_t entryCount() const;
+
+ private:
+  struct IndexRun {
+    uint16_t seq;       // File name: run_<seq>.bin, older runs have lower numbers
+    uint16_t maxGameId;
+    uint32_t count;
+  };
+
+  SemaphoreHandle_t mutex;
+  std::atomic<bool> loaded;
+  // One slot more than the limit: a new run is added before compaction brings the count back down
+  IndexRun runs[POSITION_INDEX_MAX_RUNS + 1];
+  uint8_t runTotal;
+
+  bool writeRun(uint16_t seq, uint16_t maxGameId, const PositionEntry* entries, size_t count);
+  bool mergeNewest(const std::vector<int>& liveIds, uint16_t dropGameId);
+  void compact(const std::vector<int>& liveIds, uint16_t dropGameId, bool all);
+  static String runPath(uint16_t seq, bool temp = false);
+};
+
+#endif // POSITION_INDEX_H
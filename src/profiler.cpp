@@ -0,0 +1,125 @@
+#include "profiler.h"
+#include <atomic>
+#include <esp_freertos_hooks.h>
+#include <esp_heap_caps.h>
+#include <esp_ota_ops.h>
+#include <esp_timer.h>
+#include <freertos/xtensa_context.h>
+#include <string.h>
+
+// ---------------------------
+// Capture State
+// ---------------------------
+// The tick hooks run in ISR context on both cores and only ever append:
+// they claim a slot with an atomic counter and close the window when the
+// target count is reached. Everything else runs on the web server task.
+// The hooks can fire while flash cache is off, so they and the sample buffer
+// stay in internal RAM.
+
+// Defined (non-static) by ESP-IDF's FreeRTOS for its port code
+extern "C" void* volatile pxCurrentTCB[portNUM_PROCESSORS];
+
+static uint32_t* samples = nullptr;
+static std::atomic<uint32_t> nextSample(0);
+static uint32_t targetSamples = 0;
+static volatile bool capturing = false;
+static bool hooksRegistered = false;
+static uint32_t tickDivider = 1;
+static uint32_t tickCount[portNUM_PROCESSORS] = {};
+static int64_t startUs = 0;
+static volatile int64_t endUs = 0;
+static ProfileHeader header;
+
+// Runs in the tick ISR. The first member of a TCB is pxTopOfStack, which the
+// interrupt entry code pointed at the interrupted task's saved frame.
+static void IRAM_ATTR sampleTick(int core) {
+  if (!capturing || ++tickCount[core] % tickDivider != 0)
+    return;
+  void* tcb = pxCurrentTCB[core];
+  if (!tcb)
+    return;
+  const XtExcFrame* frame = *(const XtExcFrame* const*)tcb;
+  uint32_t index = nextSample.fetch_add(1);
+  if (index >= targetSamples) {
+    if (capturing) {
+      capturing = false;
+      endUs = esp_timer_get_time();
+    }
+    return;
+  }
+  samples[index] = (uint32_t)frame->pc | (core ? PROFILE_CORE_BIT : 0);
+}
+
+static void IRAM_ATTR sampleTickCore0() {
+  sampleTick(0);
+}
+
+static void IRAM_ATTR sampleTickCore1() {
+  sampleTick(1);
+}
+
+bool Profiler::start(uint8_t seconds) {
+  if (capturing)
+    return false;
+  if (!samples) {
+    samples = (uint32_t*)heap_caps_malloc(PROFILE_MAX_SAMPLES * sizeof(uint32_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!samples)
+      return false;
+  }
+  if (!hooksRegistered) {
+    esp_register_freertos_tick_hook_for_cpu(sampleTickCore0, 0);
+    esp_register_freertos_tick_hook_for_cpu(sampleTickCore1, 1);
+    hooksRegistered = true;
+  }
+
+  seconds = constrain(seconds, (uint8_t)1, PROFILE_MAX_SECONDS);
+  tickDivider = max((uint32_t)1, (uint32_t)configTICK_RATE_HZ / PROFILE_SAMPLE_HZ);
+  targetSamples = min(PROFILE_MAX_SAMPLES, (uint32_t)seconds * PROFILE_SAMPLE_HZ * portNUM_PROCESSORS);
+  nextSample.store(0);
+  startUs = esp_timer_get_time();
+  endUs = 0;
+  capturing = true;
+  return true;
+}
+
+bool Profiler::isRunning() {
+  return capturing;
+}
+
+void Profiler::release() {
+  capturing = false;
+  vTaskDelay(2); // Let a tick hook that already passed the capturing check finish its store
+  heap_caps_free(samples);
+  samples = nullptr;
+  startUs = 0;
+}
+
+size_t Profiler::captureSize() {
+  if (capturing || !samples || startUs == 0)
+    return 0;
+  return sizeof(ProfileHeader) + min(nextSample.load(), targetSamples) * sizeof(uint32_t);
+}
+
+size_t Profiler::readCapture(size_t offset, uint8_t* out, size_t len) {
+  size_t total = captureSize();
+  if (offset >= total)
+    return 0;
+  if (offset == 0) {
+    memcpy(header.magic, PROFILE_MAGIC, sizeof(header.magic));
+    header.version = PROFILE_VERSION;
+    header.sampleHz = PROFILE_SAMPLE_HZ;
+    header.sampleCount = (total - sizeof(ProfileHeader)) / sizeof(uint32_t);
+    header.durationMs = (uint32_t)((endUs - startUs) / 1000);
+    memcpy(header.elfSha256, esp_ota_get_app_description()->app_elf_sha256, sizeof(header.elfSha256));
+  }
+  size_t copied = 0;
+  len = min(len, total - offset);
+  if (offset < sizeof(ProfileHeader)) {
+    size_t n = min(len, sizeof(ProfileHeader) - offset);
+    memcpy(out, (const uint8_t*)&header + offset, n);
+    copied = n;
+  }
+  if (copied < len)
+    memcpy(out + copied, (const uint8_t*)samples + (offset + copied - sizeof(ProfileHeader)), len - copied);
+  return len;
+}
@@ -0,0 +1,62 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <Arduino.h>
+
+// ---------------------------
+// Sampling Profiler
+// ---------------------------
+// Samples the program counter of whatever each core is running from the
+// FreeRTOS tick interrupt while a capture window is open. The tick ISR sees
+// the interrupted task's saved frame, so a sample lands in the game loop,
+// the LED worker, the TCP stack or the idle task exactly as often as that
+// code holds the CPU. Captures are flat (no call stacks): enough to tell
+// move generation from LED output, shift-register scans or TLS.
+//
+// POST /debug/profile?seconds=N starts a capture; GET /debug/profile
+// downloads it in the format below, and tools/symbolize_profile.py turns it
+// into a function table and folded stacks for a flame graph.
+//
+// The native build samples with SIGPROF instead (src/host/profiler_posix.cpp)
+// and writes the same format; see PROFILE_OUTSIDE.
+
+static constexpr uint16_t PROFILE_SAMPLE_HZ = 100;      // Per core; every 10th tick at the default 1kHz tick
+static constexpr uint32_t PROFILE_MAX_SAMPLES = 8192;   // 32KB, allocated on the first capture
+static constexpr uint8_t PROFILE_MAX_SECONDS = 30;
+
+// Capture file: header then `sampleCount` little-endian uint32 samples,
+// each the sampled PC with the core number in bit 31 (ESP32 code addresses never set it).
+static constexpr char PROFILE_MAGIC[4] = {'O', 'C', 'P', 'F'};
+static constexpr uint16_t PROFILE_VERSION = 1;
+static constexpr uint32_t PROFILE_CORE_BIT = 0x80000000u;
+// Native captures: samples are link-time addresses in the program's ELF, and
+// this one stands for a PC outside it (libc, the kernel's vDSO)
+static constexpr uint32_t PROFILE_OUTSIDE = 0x7FFFFFFFu;
+
+struct ProfileHeader {
+  char magic[4];
+  uint16_t version;
+  uint16_t sampleHz;       // Per core
+  uint32_t sampleCount;
+  uint32_t durationMs;
+  uint8_t elfSha256[32];   // Build id: SHA-256 of the firmware ELF, checked by the symbolizer
+};
+static_assert(sizeof(ProfileHeader) == 48, "ProfileHeader layout is read by tools/symbolize_profile.py");
+
+/// Static like MoveTrace: one capture at a time, started and read from the web server task.
+class Profiler {
+ public:
+  /// Open a capture window of `seconds` (clamped to PROFILE_MAX_SECONDS). Returns false if already
+  /// capturing or the sample buffer can't be allocated.
+  static bool start(uint8_t seconds);
+  static bool isRunning();
+  /// Free the sample buffer (stops a capture in progress).
+  static void release();
+
+  /// Size of the finished capture file, or 0 if there is none (or one is still running).
+  static size_t captureSize();
+  /// Copy `len` bytes of the capture file starting at `offset`. Returns bytes copied.
+  static size_t readCapture(size_t offset, uint8_t* out, size_t len);
+};
+
+#endif // PROFILER_H
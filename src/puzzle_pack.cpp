@@ -0,0 +1,97 @@
+#include "puzzle_pack.h"
+#include "move_history.h"
+#include <string.h>
+
+PuzzlePack::PuzzlePack() : loaded(false) {
+  memset(&header, 0, sizeof(header));
+  memset(buckets, 0, sizeof(buckets));
+}
+
+PuzzlePack::~PuzzlePack() {
+  end();
+}
+
+static bool isValidHeader(const PuzzlePackHeader& h, size_t fileSize) {
+  if (memcmp(h.magic, "OCPZ", 4) != 0 || h.version != PUZZLE_PACK_VERSION || h.recordSize != sizeof(PuzzleRecord))
+    return false;
+  if (h.bucketCount == 0 || h.bucketCount > PUZZLE_MAX_BUCKETS || h.bucketWidth == 0)
+    return false;
+  size_t expected = sizeof(PuzzlePackHeader) + h.bucketCount * sizeof(PuzzleBucket) + (size_t)h.puzzleCount * sizeof(PuzzleRecord);
+  return fileSize == expected;
+}
+
+bool PuzzlePack::validateFile(File& f, uint32_t& puzzleCount) {
+  PuzzlePackHeader h;
+  if (!f.seek(0) || f.read((uint8_t*)&h, sizeof(h)) != sizeof(h) || !isValidHeader(h, f.size()))
+    return false;
+  puzzleCount = h.puzzleCount;
+  return true;
+}
+
+bool PuzzlePack::begin(const char* path) {
+  end();
+  if (!MoveHistory::quietExists(path)) {
+    Serial.printf("Puzzle pack not found: %s\n", path);
+    return false;
+  }
+  file = LittleFS.open(path, "r");
+  if (!file) {
+    Serial.printf("Failed to open puzzle pack: %s\n", path);
+    return false;
+  }
+
+  if (file.read((uint8_t*)&header, sizeof(header)) != sizeof(header) || !isValidHeader(header, file.size())) {
+    Serial.println("Puzzle pack header is invalid");
+    file.close();
+    return false;
+  }
+  size_t indexBytes = header.bucketCount * sizeof(PuzzleBucket);
+  if (file.read((uint8_t*)buckets, indexBytes) != indexBytes) {
+    Serial.println("Puzzle pack index is truncated");
+    file.close();
+    return false;
+  }
+
+  loaded = true;
+  Serial.printf("Puzzle pack loaded: %u puzzles, ratings %u-%u\n", header.puzzleCount, header.minRating, header.minRating + header.bucketCount * header.bucketWidth);
+  return true;
+}
+
+void PuzzlePack::end() {
+  if (file)
+    file.close();
+  loaded = false;
+}
+
+bool PuzzlePack::load(uint32_t index, PuzzleRecord& out) {
+  if (!loaded || index >= header.puzzleCount)
+    return false;
+  if (!file.seek(recordsOffset() + index * sizeof(PuzzleRecord)))
+    return false;
+  if (file.read((uint8_t*)&out, sizeof(PuzzleRecord)) != sizeof(PuzzleRecord))
+    return false;
+  out.fen[sizeof(out.fen) - 1] = '\0';
+  out.id[sizeof(out.id) - 1] = '\0';
+  return out.moveCount >= 2 && out.moveCount <= PUZZLE_MAX_MOVES;
+}
+
+bool PuzzlePack::loadRandom(int targetRating, PuzzleRecord& out) {
+  if (!loaded || header.puzzleCount == 0)
+    return false;
+
+  int target = (targetRating - (int)header.minRating) / (int)header.bucketWidth;
+  if (target < 0) target = 0;
+  if (target >= header.bucketCount) target = header.bucketCount - 1;
+
+  // Walk outwards from the target bucket until a non-empty one is found
+  for (int distance = 0; distance < header.bucketCount; distance++) {
+    for (int sign = -1; sign <= 1; sign += 2) {
+      int b = target + sign * distance;
+      if (b < 0 || b >= header.bucketCount || buckets[b].count == 0)
+        continue;
+      uint32_t index = buckets[b].firstRecord + (uint32_t)random(buckets[b].count);
+      return load(index, out);
+    }
+  }
+  return false;
+}
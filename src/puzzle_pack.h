@@ -0,0 +1,95 @@
+#ifndef PUZZLE_PACK_H
+#define PUZZLE_PACK_H
+
+#include <Arduino.h>
+#include <LittleFS.h>
+
+// ---------------------------
+// Puzzle Pack Format
+// ---------------------------
+// Generated on a computer by tools/puzzle_pack.py from the Lichess puzzle CSV.
+// All integers are little-endian. Layout:
+//   PuzzlePackHeader                   16 bytes
+//   PuzzleBucket[bucketCount]           8 bytes each
+//   PuzzleRecord[puzzleCount]         128 bytes each, sorted by rating
+// Bucket i covers ratings [minRating + i * bucketWidth, minRating + (i + 1) * bucketWidth)
+// and points at a contiguous run of records, so picking a random puzzle at a
+// target rating is one seek and one read.
+
+static constexpr const char* PUZZLE_PACK_PATH = "/puzzles.bin";
+static constexpr const char* PUZZLE_PACK_TEMP_PATH = "/puzzles.tmp"; // Upload target until validated
+static constexpr uint8_t PUZZLE_PACK_VERSION = 1;
+static constexpr uint8_t PUZZLE_MAX_BUCKETS = 64;
+static constexpr uint8_t PUZZLE_MAX_MOVES = 14;
+
+// ---------------------------
+// Puzzle Rating Configuration
+// ---------------------------
+static constexpr int PUZZLE_DEFAULT_RATING = 1500;
+static constexpr int PUZZLE_MIN_RATING = 400;
+static constexpr int PUZZLE_MAX_RATING = 3200;
+static constexpr int PUZZLE_RATING_STEP = 50; // Target rating change per solved/failed puzzle
+
+struct __attribute__((packed)) PuzzlePackHeader {
+  char magic[4];        // "OCPZ"
+  uint8_t version;      // PUZZLE_PACK_VERSION
+  uint8_t recordSize;   // sizeof(PuzzleRecord), checked on load
+  uint8_t bucketCount;  // <= PUZZLE_MAX_BUCKETS
+  uint8_t reserved;
+  uint16_t minRating;   // Lower bound of bucket 0
+  uint16_t bucketWidth; // Rating span of each bucket
+  uint32_t puzzleCount;
+};
+static_assert(sizeof(PuzzlePackHeader) == 16, "PuzzlePackHeader must be 16 bytes");
+
+struct __attribute__((packed)) PuzzleBucket {
+  uint32_t firstRecord;
+  uint32_t count;
+};
+static_assert(sizeof(PuzzleBucket) == 8, "PuzzleBucket must be 8 bytes");
+
+struct __attribute__((packed)) PuzzleRecord {
+  char fen[88];                      // Null-padded FEN, position before the opponent's setup move
+  char id[8];                        // Null-padded Lichess puzzle id
+  uint16_t rating;
+  uint8_t moveCount;                 // Including the setup move
+  uint8_t reserved;
+  uint16_t moves[PUZZLE_MAX_MOVES];  // MoveHistory::encodeMove codes, moves[0] is the opponent's setup move
+};
+static_assert(sizeof(PuzzleRecord) == 128, "PuzzleRecord must be 128 bytes");
+
+// ---------------------------
+// Puzzle Pack Reader
+// ---------------------------
+/// Keeps the header and bucket index in RAM (< 600 bytes) and the pack file
+/// open, so each puzzle costs a single seek + read of one record.
+class PuzzlePack {
+ public:
+  PuzzlePack();
+  ~PuzzlePack();
+
+  /// Open the pack and load its index. Returns false if missing or malformed.
+  bool begin(const char* path = PUZZLE_PACK_PATH);
+  void end();
+
+  bool isLoaded() const { return loaded; }
+  uint32_t getPuzzleCount() const { return loaded ? header.puzzleCount : 0; }
+
+  /// Load a random puzzle from the bucket containing targetRating, or the nearest non-empty one.
+  bool loadRandom(int targetRating, PuzzleRecord& out);
+  /// Load a puzzle by record index.
+  bool load(uint32_t index, PuzzleRecord& out);
+
+  /// Validate a pack file (used by the upload endpoint before replacing the pack).
+  static bool validateFile(File& file, uint32_t& puzzleCount);
+
+ private:
+  File file;
+  bool loaded;
+  PuzzlePackHeader header;
+  PuzzleBucket buckets[PUZZLE_MAX_BUCKETS];
+
+  size_t recordsOffset() const { return sizeof(PuzzlePackHeader) + header.bucketCount * sizeof(PuzzleBucket); }
+};
+
+#endif // PUZZLE_PACK_H
@@ -0,0 +1,97 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+// ---------------------------
+// Single-Producer Single-Consumer Queue
+// ---------------------------
+// Bounded lock-free ring for passing messages between exactly two tasks, one
+// pushing and one popping (they may run on different cores). Capacity is
+// N - 1; N must be a power of two. Nothing is allocated: the slots are part
+// of the object.
+//
+// Each message carries the time it was pushed so the consumer can report
+// queueing latency; depth and latency counters are updated by the side that
+// owns them and may be read from any task (a torn read only mixes samples).
+
+struct SpscQueueStats {
+  uint32_t pushed;
+  uint32_t dropped;    // push() calls that found the queue full
+  uint32_t maxDepth;
+  uint32_t avgWaitUs;  // Push to pop
+  uint32_t maxWaitUs;
+};
+
+template <typename T, size_t N>
+class SpscQueue {
+  static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscQueue size must be a power of two");
+
+ public:
+  /// Producer side. Returns false (and counts a drop) if the queue is full.
+  bool push(const T& item, uint32_t nowUs) {
+    size_t h = head.load(std::memory_order_relaxed);
+    size_t next = (h + 1) & (N - 1);
+    if (next == tail.load(std::memory_order_acquire)) {
+      dropped++;
+      return false;
+    }
+    slots[h].item = item;
+    slots[h].pushedUs = nowUs;
+    // Counted before the item is published, so a consumer that has popped it sees the counts too
+    pushed++;
+    uint32_t depth = (uint32_t)((next - tail.load(std::memory_order_relaxed)) & (N - 1));
+    if (depth > maxDepth)
+      maxDepth = depth;
+    head.store(next, std::memory_order_release);
+    return true;
+  }
+
+  /// Consumer side. Returns false if the queue is empty.
+  bool pop(T& item, uint32_t nowUs) {
+    size_t t = tail.load(std::memory_order_relaxed);
+    if (t == head.load(std::memory_order_acquire))
+      return false;
+    item = slots[t].item;
+    uint32_t wait = nowUs - slots[t].pushedUs;
+    tail.store((t + 1) & (N - 1), std::memory_order_release);
+    popped++;
+    totalWaitUs += wait;
+    if (wait > maxWaitUs)
+      maxWaitUs = wait;
+    return true;
+  }
+
+  bool isEmpty() const { return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire); }
+
+  void snapshot(SpscQueueStats& out) const {
+    out.pushed = pushed;
+    out.dropped = dropped;
+    out.maxDepth = maxDepth;
+    out.avgWaitUs = popped > 0 ? (uint32_t)(totalWaitUs / popped) : 0;
+    out.maxWaitUs = maxWaitUs;
+  }
+
+ private:
+  struct Slot {
+    T item;
+    uint32_t pushedUs;
+  };
+
+  Slot slots[N];
+  std::atomic<size_t> head{0}; // Written by the producer only
+  std::atomic<size_t> tail{0}; // Written by the consumer only
+
+  // Producer-owned counters
+  uint32_t pushed = 0;
+  uint32_t dropped = 0;
+  uint32_t maxDepth = 0;
+  // Consumer-owned counters
+  uint32_t popped = 0;
+  uint64_t totalWaitUs = 0;
+  uint32_t maxWaitUs = 0;
+};
+
+#endif // SPSC_QUEUE_H
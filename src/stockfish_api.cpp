@@ -37,7 +37,7 @@ bool StockfishAPI::parseResponse(const String& response, StockfishResponse& stoc
 
   if (error) {
     stockfishResp.success = false;
-    stockfishResp.errorMessage = "JSON parsing failed: " + String(error.f_str());
+    stockfishResp.errorMessage = "JSON parsing failed: " + String(error.c_str());
     return false;
   }
 
@@ -112,8 +112,7 @@ bool StockfishAPI::parseResponse(const String& response, StockfishResponse& stoc
 }
 
 String StockfishAPI::buildRequestURL(const String& fen, int depth) {
-  // Validate depth (min 5 max 15)
-  int validDepth = depth > 15 ? 15 : (depth < 5 ? 5 : depth);
+  int validDepth = effectiveDepth(depth);
 
   // Build just the path + query (no scheme/host) so callers can reuse host/port constants
   String path = String(STOCKFISH_API_PATH) + "?fen=";
@@ -139,3 +138,8 @@ String StockfishAPI::buildRequestURL(const String& fen, int depth) {
 
   return path;
 }
+
+int StockfishAPI::effectiveDepth(int depth) {
+  // Validate depth (min 5 max 15)
+  return depth > 15 ? 15 : (depth < 5 ? 5 : depth);
+}
@@ -28,6 +28,9 @@ class StockfishAPI {
 
   // Build the API request URL
   static String buildRequestURL(const String& fen, int depth);
+
+  // Depth the API actually searches for a requested depth (it accepts 5-15)
+  static int effectiveDepth(int depth);
 };
 
 #endif // STOCKFISH_API_H
@@ -0,0 +1,272 @@
+#include "stockfish_cache.h"
+#include "chess_utils.h"
+#include "logger.h"
+#include "loop_stats.h"
+#include "move_history.h"
+#include <LittleFS.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+static constexpr size_t CACHE_FILE_SIZE = sizeof(StockfishCacheHeader) + (size_t)STOCKFISH_CACHE_SETS * STOCKFISH_CACHE_WAYS * sizeof(StockfishCacheEntry);
+
+static uint16_t setIndex(uint64_t hash, uint8_t depth) {
+  return (uint16_t)(((uint32_t)(hash >> 32) ^ (depth * 0x9E3779B1u)) & (STOCKFISH_CACHE_SETS - 1));
+}
+
+static size_t entryOffset(uint16_t set, uint8_t way) {
+  return sizeof(StockfishCacheHeader) + ((size_t)set * STOCKFISH_CACHE_WAYS + way) * sizeof(StockfishCacheEntry);
+}
+
+static bool sameKey(const StockfishCacheEntry& e, uint64_t hash, uint8_t depth) {
+  return e.lastUsed != 0 && e.hash == hash && e.depth == depth;
+}
+
+static void toResponse(const StockfishCacheEntry& e, StockfishResponse& out) {
+  int fromRow, fromCol, toRow, toCol;
+  char promotion;
+  MoveHistory::decodeMove(e.bestMove, fromRow, fromCol, toRow, toCol, promotion);
+  out.success = true;
+  out.bestMove = ChessUtils::toUCIMove(fromRow, fromCol, toRow, toCol, promotion);
+  out.ponderMove = "";
+  if (e.ponderMove != 0) {
+    MoveHistory::decodeMove(e.ponderMove, fromRow, fromCol, toRow, toCol, promotion);
+    out.ponderMove = ChessUtils::toUCIMove(fromRow, fromCol, toRow, toCol, promotion);
+  }
+  out.evaluation = e.evalCp / 100.0f;
+  out.hasMate = e.mate != 0;
+  out.mateInMoves = e.mate;
+  out.continuation = "";
+  out.errorMessage = "";
+}
+
+static uint16_t encodeUCI(const String& move) {
+  int fromRow, fromCol, toRow, toCol;
+  char promotion;
+  if (!ChessUtils::parseUCIMove(move, fromRow, fromCol, toRow, toCol, promotion))
+    return 0;
+  return MoveHistory::encodeMove(fromRow, fromCol, toRow, toCol, promotion);
+}
+
+StockfishCache::StockfishCache() : mutex(nullptr), loopStats(nullptr), loaded(false), loadFailed(false), useClock(0) {
+  memset(ramFront, 0, sizeof(ramFront));
+  memset(ramDirty, 0, sizeof(ramDirty));
+  memset(&stats, 0, sizeof(stats));
+}
+
+void StockfishCache::begin() {
+  if (!mutex)
+    mutex = xSemaphoreCreateMutex();
+}
+
+void StockfishCache::noteFlashWrite(size_t bytes) {
+  if (loopStats)
+    loopStats->noteFlashWrite(bytes);
+}
+
+// Open the flash table, creating it if it is missing or from another layout, and
+// find the newest use stamp. Called under the mutex on first use.
+bool StockfishCache::load() {
+  if (loaded)
+    return true;
+  if (loadFailed)
+    return false;
+
+  bool valid = false;
+  if (MoveHistory::quietExists(STOCKFISH_CACHE_PATH)) {
+    File f = LittleFS.open(STOCKFISH_CACHE_PATH, "r");
+    StockfishCacheHeader hdr;
+    valid = f && f.read((uint8_t*)&hdr, sizeof(hdr)) == sizeof(hdr) && memcmp(hdr.magic, "OCSC", 4) == 0 && hdr.version == STOCKFISH_CACHE_VERSION && hdr.entrySize == sizeof(StockfishCacheEntry) && hdr.ways == STOCKFISH_CACHE_WAYS && hdr.sets == STOCKFISH_CACHE_SETS && f.size() == CACHE_FILE_SIZE;
+    if (valid) {
+      StockfishCacheEntry ways[STOCKFISH_CACHE_WAYS];
+      for (uint16_t set = 0; set < STOCKFISH_CACHE_SETS; set++) {
+        if (f.read((uint8_t*)ways, sizeof(ways)) != sizeof(ways)) {
+          valid = false;
+          break;
+        }
+        for (uint8_t w = 0; w < STOCKFISH_CACHE_WAYS; w++) {
+          if (ways[w].lastUsed == 0)
+            continue;
+          stats.entries++;
+          if (ways[w].lastUsed > useClock)
+            useClock = ways[w].lastUsed;
+        }
+      }
+    }
+    if (f) f.close();
+  }
+
+  if (!valid) {
+    stats.entries = 0;
+    useClock = 0;
+    File f = LittleFS.open(STOCKFISH_CACHE_PATH, "w");
+    StockfishCacheHeader hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, "OCSC", 4);
+    hdr.version = STOCKFISH_CACHE_VERSION;
+    hdr.entrySize = sizeof(StockfishCacheEntry);
+    hdr.ways = STOCKFISH_CACHE_WAYS;
+    hdr.sets = STOCKFISH_CACHE_SETS;
+    bool ok = f && f.write((const uint8_t*)&hdr, sizeof(hdr)) == sizeof(hdr);
+    StockfishCacheEntry empty[STOCKFISH_CACHE_WAYS];
+    memset(empty, 0, sizeof(empty));
+    for (uint16_t set = 0; ok && set < STOCKFISH_CACHE_SETS; set++)
+      ok = f.write((const uint8_t*)empty, sizeof(empty)) == sizeof(empty);
+    if (f) f.close();
+    noteFlashWrite(CACHE_FILE_SIZE);
+    if (!ok) {
+      LOG_ERROR("StockfishCache: failed to create %s, caching in RAM only", STOCKFISH_CACHE_PATH);
+      LittleFS.remove(STOCKFISH_CACHE_PATH);
+      stats.errors++;
+      loadFailed = true;
+      return false;
+    }
+  }
+
+  loaded = true;
+  stats.loaded = true;
+  LOG_INFO("StockfishCache: %u of %u entries used", stats.entries, STOCKFISH_CACHE_SETS * STOCKFISH_CACHE_WAYS);
+  return true;
+}
+
+bool StockfishCache::readSet(uint16_t set, StockfishCacheEntry ways[]) {
+  File f = LittleFS.open(STOCKFISH_CACHE_PATH, "r");
+  bool ok = f && f.seek(entryOffset(set, 0)) && f.read((uint8_t*)ways, STOCKFISH_CACHE_WAYS * sizeof(StockfishCacheEntry)) == STOCKFISH_CACHE_WAYS * sizeof(StockfishCacheEntry);
+  if (f) f.close();
+  if (!ok)
+    stats.errors++;
+  return ok;
+}
+
+bool StockfishCache::writeEntry(uint16_t set, uint8_t way, const StockfishCacheEntry& entry) {
+  File f = LittleFS.open(STOCKFISH_CACHE_PATH, "r+");
+  bool ok = f && f.seek(entryOffset(set, way)) && f.write((const uint8_t*)&entry, sizeof(entry)) == sizeof(entry);
+  if (f) f.close();
+  noteFlashWrite(sizeof(entry));
+  if (!ok)
+    stats.errors++;
+  return ok;
+}
+
+// Put an entry in the RAM front, replacing the same key or the least recently
+// used one. RAM hits only move the RAM stamp, so an evicted entry writes its
+// stamp back to flash, where it still counts for the set's LRU order.
+void StockfishCache::remember(const StockfishCacheEntry& entry) {
+  uint8_t victim = 0;
+  for (uint8_t i = 0; i < STOCKFISH_CACHE_RAM_ENTRIES; i++) {
+    if (sameKey(ramFront[i], entry.hash, entry.depth)) {
+      victim = i;
+      break;
+    }
+    if (ramFront[i].lastUsed < ramFront[victim].lastUsed)
+      victim = i;
+  }
+  const StockfishCacheEntry& old = ramFront[victim];
+  if (ramDirty[victim] && !sameKey(old, entry.hash, entry.depth) && loaded) {
+    uint16_t set = setIndex(old.hash, old.depth);
+    StockfishCacheEntry ways[STOCKFISH_CACHE_WAYS];
+    if (readSet(set, ways)) {
+      for (uint8_t w = 0; w < STOCKFISH_CACHE_WAYS; w++) {
+        if (sameKey(ways[w], old.hash, old.depth)) {
+          ways[w].lastUsed = old.lastUsed;
+          writeEntry(set, w, ways[w]);
+          break;
+        }
+      }
+    }
+  }
+  ramFront[victim] = entry;
+  ramDirty[victim] = false;
+}
+
+bool StockfishCache::lookup(uint64_t hash, uint8_t depth, StockfishResponse& out) {
+  xSemaphoreTake(mutex, portMAX_DELAY);
+  for (uint8_t i = 0; i < STOCKFISH_CACHE_RAM_ENTRIES; i++) {
+    if (sameKey(ramFront[i], hash, depth)) {
+      ramFront[i].lastUsed = ++useClock;
+      ramDirty[i] = true;
+      stats.ramHits++;
+      toResponse(ramFront[i], out);
+      xSemaphoreGive(mutex);
+      return true;
+    }
+  }
+
+  uint16_t set = setIndex(hash, depth);
+  StockfishCacheEntry ways[STOCKFISH_CACHE_WAYS];
+  if (load() && readSet(set, ways)) {
+    for (uint8_t w = 0; w < STOCKFISH_CACHE_WAYS; w++) {
+      if (!sameKey(ways[w], hash, depth))
+        continue;
+      ways[w].lastUsed = ++useClock;
+      writeEntry(set, w, ways[w]);
+      remember(ways[w]);
+      stats.flashHits++;
+      toResponse(ways[w], out);
+      xSemaphoreGive(mutex);
+      return true;
+    }
+  }
+  stats.misses++;
+  xSemaphoreGive(mutex);
+  return false;
+}
+
+void StockfishCache::store(uint64_t hash, uint8_t depth, const StockfishResponse& response) {
+  StockfishCacheEntry entry;
+  memset(&entry, 0, sizeof(entry));
+  entry.bestMove = encodeUCI(response.bestMove);
+  if (!response.success || entry.bestMove == 0)
+    return; // Nothing to replay (e.g. the position is already mate)
+  entry.hash = hash;
+  entry.depth = depth;
+  entry.ponderMove = response.ponderMove.isEmpty() ? 0 : encodeUCI(response.ponderMove);
+  float cp = response.evaluation * 100.0f;
+  entry.evalCp = (int16_t)constrain(lroundf(cp), -32767L, 32767L);
+  entry.mate = response.hasMate ? (int8_t)constrain(response.mateInMoves, -127, 127) : 0;
+
+  xSemaphoreTake(mutex, portMAX_DELAY);
+  entry.lastUsed = ++useClock;
+  remember(entry);
+  uint16_t set = setIndex(hash, depth);
+  StockfishCacheEntry ways[STOCKFISH_CACHE_WAYS];
+  if (load() && readSet(set, ways)) {
+    // Same key first, then an empty slot, then the least recently used entry
+    uint8_t victim = 0;
+    for (uint8_t w = 0; w < STOCKFISH_CACHE_WAYS; w++) {
+      if (sameKey(ways[w], hash, depth)) {
+        victim = w;
+        break;
+      }
+      if (ways[w].lastUsed < ways[victim].lastUsed)
+        victim = w;
+    }
+    bool replacing = ways[victim].lastUsed != 0 && !sameKey(ways[victim], hash, depth);
+    if (writeEntry(set, victim, entry)) {
+      stats.stores++;
+      if (replacing)
+        stats.evictions++;
+      else if (ways[victim].lastUsed == 0)
+        stats.entries++;
+    }
+  }
+  xSemaphoreGive(mutex);
+}
+
+void StockfishCache::clear() {
+  xSemaphoreTake(mutex, portMAX_DELAY);
+  memset(ramFront, 0, sizeof(ramFront));
+  memset(ramDirty, 0, sizeof(ramDirty));
+  memset(&stats, 0, sizeof(stats));
+  if (MoveHistory::quietExists(STOCKFISH_CACHE_PATH))
+    LittleFS.remove(STOCKFISH_CACHE_PATH);
+  loaded = false;
+  loadFailed = false;
+  useClock = 0;
+  xSemaphoreGive(mutex);
+}
+
+void StockfishCache::snapshot(StockfishCacheStats& out) {
+  xSemaphoreTake(mutex, portMAX_DELAY);
+  out = stats;
+  xSemaphoreGive(mutex);
+}
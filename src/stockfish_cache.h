@@ -0,0 +1,103 @@
+#ifndef STOCKFISH_CACHE_H
+#define STOCKFISH_CACHE_H
+
+#include "stockfish_api.h"
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+class LoopStats;
+
+// ---------------------------
+// Stockfish Cache Format
+// ---------------------------
+// Stockfish answers by position and depth, kept on flash so the bot's
+// replies to common positions (the opening, above all) skip the HTTPS round
+// trip, across games and reboots. The file is a 4-way set-associative table:
+//   StockfishCacheHeader               16 bytes
+//   StockfishCacheEntry[SETS * WAYS]   24 bytes each
+// A position's set is picked from its Zobrist hash and depth, so a lookup is
+// one seek and one 96-byte read. A new answer replaces the least recently
+// used entry of its set. A small RAM front holds the most recent answers.
+
+static constexpr const char* STOCKFISH_CACHE_PATH = "/stockfish_cache.bin";
+static constexpr uint8_t STOCKFISH_CACHE_VERSION = 1;
+static constexpr uint16_t STOCKFISH_CACHE_SETS = 256;     // Power of two
+static constexpr uint8_t STOCKFISH_CACHE_WAYS = 4;
+static constexpr uint8_t STOCKFISH_CACHE_RAM_ENTRIES = 16; // RAM front, fully associative (384 bytes)
+
+struct __attribute__((packed)) StockfishCacheHeader {
+  char magic[4];     // "OCSC"
+  uint8_t version;   // STOCKFISH_CACHE_VERSION
+  uint8_t entrySize; // sizeof(StockfishCacheEntry), checked on load
+  uint8_t ways;
+  uint8_t reserved;
+  uint32_t sets;
+  uint32_t reserved2;
+};
+static_assert(sizeof(StockfishCacheHeader) == 16, "StockfishCacheHeader must be 16 bytes");
+
+struct __attribute__((packed)) StockfishCacheEntry {
+  uint64_t hash;       // ChessEngine::computeZobristHash() of the position
+  uint32_t lastUsed;   // Use stamp for LRU replacement, 0 = empty slot
+  uint16_t bestMove;   // MoveHistory::encodeMove code
+  uint16_t ponderMove; // 0 if the API gave none
+  int16_t evalCp;      // Evaluation in centipawns, White's point of view
+  int8_t mate;         // Mate in N as reported by the API, 0 if none
+  uint8_t depth;       // Depth the API searched (see StockfishAPI::effectiveDepth())
+  uint32_t reserved;
+};
+static_assert(sizeof(StockfishCacheEntry) == 24, "StockfishCacheEntry must be 24 bytes");
+
+struct StockfishCacheStats {
+  bool loaded;
+  uint32_t ramHits;
+  uint32_t flashHits;
+  uint32_t misses;
+  uint32_t stores;
+  uint32_t evictions; // Stores that replaced a used entry
+  uint32_t errors;    // Flash reads or writes that failed
+  uint32_t entries;   // Used slots on flash
+};
+
+// ---------------------------
+// Stockfish Cache
+// ---------------------------
+/// One per board, owned by main.cpp. Looked up and filled by ChessBot on the
+/// loop task; the web task reads the counters and can clear it, under a mutex.
+/// The flash table is opened (created if needed) on first use, not at boot.
+class StockfishCache {
+ public:
+  StockfishCache();
+
+  void begin();
+  /// Count flash writes in `stats` (they happen on the game loop, inside a bot move).
+  void setLoopStats(LoopStats* stats) { loopStats = stats; }
+
+  /// Fill `out` (success, best move, ponder, evaluation, mate) if the position was answered before at `depth`.
+  bool lookup(uint64_t hash, uint8_t depth, StockfishResponse& out);
+  /// Remember a successful answer. Answers without a parsable best move are skipped.
+  void store(uint64_t hash, uint8_t depth, const StockfishResponse& response);
+
+  /// Drop every entry and reset the counters.
+  void clear();
+  void snapshot(StockfishCacheStats& out);
+
+ private:
+  SemaphoreHandle_t mutex;
+  LoopStats* loopStats;
+  bool loaded;
+  bool loadFailed;   // Don't retry creating the file on every move
+  uint32_t useClock; // Last use stamp handed out
+  StockfishCacheEntry ramFront[STOCKFISH_CACHE_RAM_ENTRIES];
+  bool ramDirty[STOCKFISH_CACHE_RAM_ENTRIES]; // Use stamp newer than the flash copy
+  StockfishCacheStats stats;
+
+  bool load();
+  bool readSet(uint16_t set, StockfishCacheEntry ways[]);
+  bool writeEntry(uint16_t set, uint8_t way, const StockfishCacheEntry& entry);
+  void remember(const StockfishCacheEntry& entry);
+  void noteFlashWrite(size_t bytes);
+};
+
+#endif // STOCKFISH_CACHE_H
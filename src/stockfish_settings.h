@@ -1,6 +1,8 @@
 #ifndef STOCKFISH_SETTINGS_H
 #define STOCKFISH_SETTINGS_H
 
+#include <Arduino.h>
+
 // Stockfish Engine Settings
 struct StockfishSettings {
   int depth;      // Search depth (5-15, higher = stronger but slower)
@@ -35,10 +37,22 @@ struct StockfishSettings {
   }
 };
 
+// LAN engine server (see uci_engine.h), set from the web UI
+struct LanEngineSettings {
+  String host;         // Empty = not configured
+  uint16_t port;
+  uint32_t movetimeMs; // Thinking time per move (`go movetime`)
+
+  LanEngineSettings(const String& host = "", uint16_t port = 4000, uint32_t movetimeMs = 1000) : host(host), port(port), movetimeMs(movetimeMs) {}
+  bool isConfigured() const { return host.length() > 0; }
+};
+
 // Bot configuration structure
 struct BotConfig {
   StockfishSettings stockfishSettings;
   bool playerIsWhite;
+  bool useLanEngine = false;   // Ask the LAN engine instead of stockfish.online
+  LanEngineSettings lanEngine{};
 };
 
 #endif // STOCKFISH_SETTINGS_H
\ No newline at end of file
@@ -0,0 +1,180 @@
+#include "uci_engine.h"
+#include "logger.h"
+
+// Next space-separated token of `line` from `pos`, or "" at the end
+static String nextToken(const String& line, int& pos) {
+  while (pos < (int)line.length() && line[pos] == ' ')
+    pos++;
+  int start = pos;
+  while (pos < (int)line.length() && line[pos] != ' ')
+    pos++;
+  return line.substring(start, pos);
+}
+
+UciEngine::UciEngine(const LanEngineSettings& settings) : settings(settings), ready(false), whiteToMove(true) {}
+
+bool UciEngine::connect() {
+  if (ready && client.connected())
+    return true;
+  disconnect();
+  LOG_INFO("LAN engine: connecting to %s:%u", settings.host.c_str(), settings.port);
+  if (!client.connect(settings.host.c_str(), settings.port, UCI_CONNECT_TIMEOUT_MS)) {
+    LOG_ERROR("LAN engine: connection to %s:%u failed", settings.host.c_str(), settings.port);
+    return false;
+  }
+  client.setNoDelay(true); // Commands are one short line each
+  send("uci");
+  if (!waitFor("uciok", UCI_HANDSHAKE_TIMEOUT_MS)) {
+    LOG_ERROR("LAN engine: no uciok, is this a UCI server?");
+    disconnect();
+    return false;
+  }
+  send("ucinewgame");
+  send("isready");
+  if (!waitFor("readyok", UCI_HANDSHAKE_TIMEOUT_MS)) {
+    LOG_ERROR("LAN engine: no readyok");
+    disconnect();
+    return false;
+  }
+  ready = true;
+  return true;
+}
+
+void UciEngine::disconnect() {
+  if (client.connected())
+    client.stop();
+  lineBuffer = "";
+  ready = false;
+}
+
+void UciEngine::send(const String& command) {
+  client.print(command + "\n");
+}
+
+bool UciEngine::readLine(String& line) {
+  while (client.available() > 0) {
+    // Byte at a time up to the newline, so the rest stays in the socket for the next line
+    int c = client.read();
+    if (c < 0)
+      break;
+    if (c == '\n') {
+      line = lineBuffer;
+      line.trim();
+      lineBuffer = "";
+      return true;
+    }
+    if (c != '\r' && lineBuffer.length() < UCI_LINE_MAX)
+      lineBuffer += (char)c;
+  }
+  return false;
+}
+
+bool UciEngine::waitFor(const char* token, uint32_t timeoutMs) {
+  unsigned long start = millis();
+  String line;
+  while (millis() - start < timeoutMs) {
+    if (readLine(line)) {
+      if (line.startsWith(token))
+        return true;
+      continue; // `id`, `option` and `info string` lines
+    }
+    if (!client.connected())
+      return false;
+    delay(5);
+  }
+  return false;
+}
+
+bool UciEngine::startSearch(const String& fen, int depth) {
+  if (!settings.isConfigured() || !connect())
+    return false;
+  whiteToMove = fen.indexOf(" w ") != -1;
+  send("position fen " + fen);
+  String go = "go depth " + String(depth) + " movetime " + String(settings.movetimeMs);
+  send(go);
+  LOG_INFO("LAN engine: %s", go.c_str());
+  return true;
+}
+
+UciSearchState UciEngine::poll(StockfishResponse& out, bool& evalChanged) {
+  evalChanged = false;
+  String line;
+  while (readLine(line)) {
+    if (line.startsWith("info ")) {
+      if (parseInfo(line, whiteToMove, out))
+        evalChanged = true;
+    } else if (line.startsWith("bestmove")) {
+      if (!parseBestMove(line, out)) {
+        out.success = false;
+        out.errorMessage = "Engine has no move";
+        return UciSearchState::FAILED;
+      }
+      return UciSearchState::DONE;
+    }
+  }
+  if (!client.connected()) {
+    LOG_ERROR("LAN engine: connection lost");
+    disconnect();
+    out.success = false;
+    out.errorMessage = "Connection lost";
+    return UciSearchState::FAILED;
+  }
+  return UciSearchState::SEARCHING;
+}
+
+void UciEngine::stop() {
+  if (client.connected())
+    send("stop");
+}
+
+bool UciEngine::parseInfo(const String& line, bool whiteToMove, StockfishResponse& out) {
+  int pos = 0;
+  nextToken(line, pos); // "info"
+  bool scored = false;
+  for (String token = nextToken(line, pos); token.length() > 0; token = nextToken(line, pos)) {
+    if (token == "multipv") {
+      if (nextToken(line, pos) != "1")
+        return false; // Secondary lines don't change the evaluation
+    } else if (token == "string") {
+      return false; // Free text to the end of the line
+    } else if (token == "score") {
+      String kind = nextToken(line, pos);
+      int value = nextToken(line, pos).toInt();
+      if (!whiteToMove)
+        value = -value; // UCI scores are from the side to move
+      if (kind == "cp") {
+        out.evaluation = value / 100.0f;
+        out.hasMate = false;
+        out.mateInMoves = 0;
+        scored = true;
+      } else if (kind == "mate") {
+        out.hasMate = true;
+        out.mateInMoves = value;
+        scored = true;
+      }
+    } else if (token == "pv") {
+      // The principal variation runs to the end of the line
+      out.continuation = line.substring(pos);
+      out.continuation.trim();
+      int p = 0;
+      nextToken(out.continuation, p);
+      out.ponderMove = nextToken(out.continuation, p);
+      break;
+    }
+  }
+  return scored;
+}
+
+bool UciEngine::parseBestMove(const String& line, StockfishResponse& out) {
+  int pos = 0;
+  nextToken(line, pos); // "bestmove"
+  String move = nextToken(line, pos);
+  if (move.length() < 4 || move == "(none)" || move == "0000")
+    return false;
+  out.success = true;
+  out.bestMove = move;
+  if (nextToken(line, pos) == "ponder")
+    out.ponderMove = nextToken(line, pos);
+  out.errorMessage = "";
+  return true;
+}
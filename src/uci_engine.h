@@ -0,0 +1,72 @@
+#ifndef UCI_ENGINE_H
+#define UCI_ENGINE_H
+
+#include "stockfish_api.h"
+#include "stockfish_settings.h"
+#include <Arduino.h>
+#include <WiFi.h>
+
+// ---------------------------
+// UCI Engine Configuration
+// ---------------------------
+static constexpr uint32_t UCI_CONNECT_TIMEOUT_MS = 3000;
+static constexpr uint32_t UCI_HANDSHAKE_TIMEOUT_MS = 5000; // uci -> uciok, isready -> readyok
+static constexpr uint32_t UCI_SEARCH_GRACE_MS = 3000;      // Past movetime before the bot sends `stop` itself
+static constexpr uint32_t UCI_STOP_GRACE_MS = 2000;        // Wait for `bestmove` after `stop`
+static constexpr uint32_t UCI_POLL_MS = 20;                // Game loop polling interval while the engine thinks
+static constexpr uint32_t UCI_EVAL_PUBLISH_MS = 250;       // Live evaluation pushed to the web at most this often
+static constexpr size_t UCI_LINE_MAX = 512;                // Longer lines (deep pv) are cut
+static constexpr uint32_t UCI_MIN_MOVETIME_MS = 100;
+static constexpr uint32_t UCI_MAX_MOVETIME_MS = 60000;
+
+enum class UciSearchState : uint8_t {
+  SEARCHING,
+  DONE,  // `bestmove` received
+  FAILED // Connection lost or refused
+};
+
+// ---------------------------
+// UCI Engine
+// ---------------------------
+/// Client for a UCI engine served over a plain TCP socket on the LAN (e.g.
+/// tools/uci_stub_server.py, or the same script bridging a real engine). It
+/// fills the same StockfishResponse as StockfishAPI, so ChessBot can use
+/// either. The connection stays open for the whole game.
+///
+/// Socket calls: startSearch() can block (connect, handshake) and belongs on
+/// the network actor. poll() and stop() never block.
+class UciEngine {
+ public:
+  explicit UciEngine(const LanEngineSettings& settings);
+
+  /// Connect and handshake if needed, then send the position and
+  /// `go depth <depth> movetime <ms>`.
+  bool startSearch(const String& fen, int depth);
+  /// Read the lines that have arrived. `out` follows the latest `info` line
+  /// (`evalChanged` is set when it had a score) until `bestmove` fills it in.
+  UciSearchState poll(StockfishResponse& out, bool& evalChanged);
+  /// Ask the engine to answer now. It still replies with `bestmove`.
+  void stop();
+  void disconnect();
+
+  /// Parse an `info` line. Scores are turned to White's point of view, as the API gives them.
+  static bool parseInfo(const String& line, bool whiteToMove, StockfishResponse& out);
+  /// Parse `bestmove <move> [ponder <move>]`. Returns false for `bestmove (none)`.
+  static bool parseBestMove(const String& line, StockfishResponse& out);
+
+ private:
+  LanEngineSettings settings;
+  WiFiClient client;
+  String lineBuffer;
+  bool ready;       // Handshake done on the current connection
+  bool whiteToMove; // Side to move of the current search
+
+  bool connect();
+  void send(const String& command);
+  /// Assemble the next complete line from what has arrived. Never blocks.
+  bool readLine(String& line);
+  /// Block until a line starting with `token` arrives.
+  bool waitFor(const char* token, uint32_t timeoutMs);
+};
+
+#endif // UCI_ENGINE_H
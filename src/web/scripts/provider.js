@@ -1,6 +1,13 @@
 // Domain-specific API provider — centralizes all endpoint URLs and request building
 // Uses low-level helpers from api.js (getApi, postApi, deleteApi)
 
+// Multipart upload of a data file built by the host tools (puzzle pack, opening repertoire, ECO table)
+const uploadDataFile = (url, file, password) => {
+    const form = new FormData();
+    form.append('file', file, file.name);
+    return fetch(url, { method: 'POST', body: form, headers: password ? { 'X-OTA-Password': password } : {} }).then((r) => r.json());
+};
+
 window.Api = {
     // --- WiFi ---
     getNetworks: () => getApi('/wifi/networks').then((r) => r.json()),
@@ -20,13 +27,32 @@ window.Api = {
     getLichessInfo: () => getApi('/lichess').then((r) => r.json()),
     saveLichessToken: (token) => postApi('/lichess', `token=${encodeURIComponent(token)}`),
 
+    // --- LAN engine ---
+    getEngineSettings: () => getApi('/engine').then((r) => r.json()),
+    // Empty host removes the engine
+    saveEngineSettings: (host, port, movetime) => postApi('/engine', `host=${encodeURIComponent(host)}&port=${port}&movetime=${movetime}`),
+
     // --- Game ---
-    selectGame: (mode, playerColor, difficulty) =>
-        postApi('/gameselect', `gamemode=${mode}${mode === 2 ? `&playerColor=${playerColor}&difficulty=${difficulty}` : ''}`).then((r) => r.json()),
+    selectGame: (mode, playerColor, difficulty, rating, clock, engine) =>
+        postApi('/gameselect', `gamemode=${mode}${mode === 2 ? `&playerColor=${playerColor}&difficulty=${difficulty}${engine ? `&engine=${engine}` : ''}` : ''}${mode === 6 && rating ? `&rating=${rating}` : ''}${mode === 7 && playerColor ? `&playerColor=${playerColor}` : ''}${clock ? `&clockMinutes=${clock.minutes}&clockIncrement=${clock.increment}&clockMode=${clock.mode}` : ''}`).then((r) => r.json()),
     resign: () => postApi('/resign').then((r) => r.json()),
-    getGames: () => getApi('/games').then((r) => r.json()),
+    getClock: () => getApi('/clock').then((r) => r.json()),
+    // filter: { mode, result, winner, color, depth, eco, minPlies, maxPlies, offset, limit }, all optional
+    getGames: (filter = {}) => {
+        const query = new URLSearchParams(Object.entries(filter).filter(([, v]) => v !== undefined && v !== '')).toString();
+        return getApi(query ? `/games?${query}` : '/games').then((r) => r.json());
+    },
+    getGameStats: () => getApi('/games/stats').then((r) => r.json()),
     getGame: (id) => getApi(`/games?id=${id}`),
     deleteGame: (id) => deleteApi(`/games?id=${id}`),
+    getAnalysis: () => getApi('/analysis').then((r) => r.json()),
+    showAnalysisHint: () => postApi('/analysis/hint').then((r) => r.json()),
+    getPuzzle: () => getApi('/puzzle').then((r) => r.json()),
+    uploadPuzzlePack: (file, password) => uploadDataFile('/puzzles', file, password),
+    getOpening: () => getApi('/opening').then((r) => r.json()),
+    showOpeningHint: () => postApi('/opening/hint').then((r) => r.json()),
+    uploadOpeningRepertoire: (file, password) => uploadDataFile('/openings', file, password),
+    uploadEcoTable: (file, password) => uploadDataFile('/eco', file, password),
 
     // --- OTA ---
     getOtaStatus: () => getApi('/ota/status').then((r) => r.json()),
@@ -0,0 +1,237 @@
+#include "wifi_connector.h"
+
+void WiFiConnector::begin(WiFiLink* l, SavedNetwork* nets, uint8_t* count) {
+  link = l;
+  networks = nets;
+  networkCount = count;
+}
+
+void WiFiConnector::notifyLinkUp() {
+  linkUpPending = true;
+}
+
+void WiFiConnector::notifyLinkDown(unsigned long now) {
+  linkDownAt = now;
+  linkDownPending = true;
+}
+
+void WiFiConnector::requestConnect(int8_t networkIndex) {
+  pendingRequest = networkIndex;
+}
+
+void WiFiConnector::requestRemoval(uint8_t networkIndex) {
+  if (networkIndex < 8)
+    pendingRemoval.fetch_or((uint8_t)(1 << networkIndex));
+}
+
+WiFiConnectorEvent WiFiConnector::tick(unsigned long now) {
+  bool up = linkUpPending.exchange(false);
+  bool down = linkDownPending.exchange(false);
+  // Reports from the attempt this one replaced arrive right after it starts
+  bool downCounts = down && (long)(linkDownAt.load() - phaseStart) >= (long)LINK_DOWN_SETTLE_MS;
+
+  removed = false;
+  uint8_t removals = pendingRemoval.exchange(0);
+  WiFiConnectorEvent event;
+  if (removals && applyRemovals(removals, now, event))
+    return event; // The link or attempt was on a removed network: its reports are stale
+
+  int8_t request = pendingRequest.exchange(NO_REQUEST);
+  if (request != NO_REQUEST) {
+    bool wasUp = phase == Phase::UP;
+    if (wasUp)
+      link->disconnect();
+    startRound(request, false, now);
+    return wasUp ? WiFiConnectorEvent::LOST : WiFiConnectorEvent::NONE;
+  }
+
+  switch (phase) {
+    case Phase::UP:
+      if (downCounts) {
+        connected = -1;
+        lostAt = now;
+        backoff = RECONNECT_INITIAL_MS;
+        startRound(index, true, now);
+        return WiFiConnectorEvent::LOST;
+      }
+      break;
+    case Phase::FAST:
+    case Phase::FULL: {
+      if (up)
+        return linkCameUp(now);
+      unsigned long timeout = phase == Phase::FAST ? FAST_CONNECT_TIMEOUT_MS : FULL_CONNECT_TIMEOUT_MS;
+      bool timedOut = now - phaseStart >= timeout;
+      if (downCounts || timedOut)
+        return attemptFailed(timedOut, now);
+      break;
+    }
+    case Phase::BACKOFF:
+      if (now - phaseStart >= backoff) {
+        backoff = min(backoff * 2, RECONNECT_MAX_MS);
+        attempt(index, now);
+      }
+      break;
+    case Phase::IDLE:
+      if (*networkCount == 0)
+        break;
+      if (retryForever) // Lost with no networks saved, and one was added since
+        startRound(0, true, now);
+      else if (now - phaseStart >= GAVE_UP_RETRY_MS) // Networks may have come back since the last round gave up
+        startRound(-1, false, now);
+      break;
+  }
+  return WiFiConnectorEvent::NONE;
+}
+
+bool WiFiConnector::applyRemovals(uint8_t mask, unsigned long now, WiFiConnectorEvent& event) {
+  bool active = phase == Phase::UP || phase == Phase::FAST || phase == Phase::FULL;
+  bool onRemoved = false;
+  uint8_t count = *networkCount;
+  // Highest first, so the indices still to remove are not shifted yet
+  for (int i = count - 1; i >= 0; i--) {
+    if (!(mask & (1 << i)))
+      continue;
+    if (active && index == i)
+      onRemoved = true;
+    for (int j = i; j < count - 1; j++)
+      networks[j] = networks[j + 1];
+    networks[count - 1] = SavedNetwork();
+    count--;
+    if (index > i)
+      index--;
+  }
+  removed = count != *networkCount;
+  *networkCount = count;
+
+  if (!onRemoved) {
+    if (phase == Phase::UP)
+      connected = (int8_t)index;
+    return false;
+  }
+
+  link->disconnect();
+  event = WiFiConnectorEvent::NONE;
+  if (phase == Phase::UP) {
+    // As if the link was lost: go on to the remaining networks, starting with the one after it
+    connected = -1;
+    lostAt = now;
+    backoff = RECONNECT_INITIAL_MS;
+    startRound(count > 0 ? index % count : 0, true, now);
+    event = WiFiConnectorEvent::LOST;
+  } else if (singleNetwork || count == 0) {
+    goIdle(now);
+    if (!retryForever)
+      event = WiFiConnectorEvent::GAVE_UP;
+  } else {
+    attempt(index, now); // The next candidate now has the removed one's index
+  }
+  return true;
+}
+
+void WiFiConnector::startRound(int8_t request, bool forever, unsigned long now) {
+  retryForever = forever;
+  roundTried = 0;
+  if (*networkCount == 0 || request >= *networkCount) {
+    goIdle(now);
+    return;
+  }
+  // A reconnect (forever) starts with the network that was lost and goes on to the others
+  singleNetwork = !forever && request >= 0;
+  wifiState = forever ? WiFiState::RECONNECTING : WiFiState::CONNECTING;
+  attempt(request >= 0 ? (uint8_t)request : 0, now);
+}
+
+void WiFiConnector::attempt(uint8_t networkIndex, unsigned long now) {
+  if (networkIndex >= *networkCount)
+    networkIndex = 0; // The registry shrank
+  index = networkIndex;
+  phaseStart = now;
+  const SavedNetwork& net = networks[index];
+  if (net.fast.channel != 0) {
+    phase = Phase::FAST;
+    usedLease = net.lease.ip != 0 && now - net.lease.obtainedAt < LEASE_REUSE_MS;
+    link->connect(net.ssid.c_str(), net.password.c_str(), &net.fast, usedLease ? &net.lease : nullptr);
+  } else {
+    phase = Phase::FULL;
+    usedLease = false;
+    link->connect(net.ssid.c_str(), net.password.c_str(), nullptr, nullptr);
+  }
+}
+
+WiFiConnectorEvent WiFiConnector::attemptFailed(bool timedOut, unsigned long now) {
+  if (timedOut)
+    link->disconnect();
+  if (*networkCount == 0) {
+    goIdle(now);
+    return retryForever ? WiFiConnectorEvent::NONE : WiFiConnectorEvent::GAVE_UP;
+  }
+
+  if (phase == Phase::FAST && index < *networkCount) {
+    // The cached BSSID may have moved channel or been replaced: scan for the SSID, and run DHCP
+    phaseStart = now;
+    phase = Phase::FULL;
+    usedLease = false;
+    link->connect(networks[index].ssid.c_str(), networks[index].password.c_str(), nullptr, nullptr);
+    return WiFiConnectorEvent::NONE;
+  }
+
+  roundTried++;
+  uint8_t next = (uint8_t)((index + 1) % *networkCount);
+  if (singleNetwork || roundTried >= *networkCount) {
+    if (!retryForever) {
+      goIdle(now);
+      return WiFiConnectorEvent::GAVE_UP;
+    }
+    // Every network failed this round: wait before the next one
+    roundTried = 0;
+    index = next;
+    phase = Phase::BACKOFF;
+    phaseStart = now;
+    return WiFiConnectorEvent::NONE;
+  }
+  attempt(next, now);
+  return WiFiConnectorEvent::NONE;
+}
+
+WiFiConnectorEvent WiFiConnector::linkCameUp(unsigned long now) {
+  if (phase == Phase::FAST)
+    fastConnectCount++;
+  reconnected = retryForever;
+  if (retryForever) {
+    reconnectCount++;
+    lastReconnect = (uint32_t)(now - lostAt);
+  }
+
+  refreshed = false;
+  WiFiFastConnect current;
+  if (link->readFastConnect(current) && index < *networkCount) {
+    WiFiFastConnect& cached = networks[index].fast;
+    if (cached.channel != current.channel || memcmp(cached.bssid, current.bssid, sizeof(cached.bssid)) != 0) {
+      cached = current;
+      refreshed = true;
+    }
+  }
+  // A reused lease goes back to DHCP now, but the cached copy keeps its
+  // original age, so it is given up on schedule
+  if (usedLease) {
+    link->renewLease();
+  } else if (index < *networkCount) {
+    WiFiLease lease;
+    bool haveLease = link->readLease(lease);
+    lease.obtainedAt = now;
+    networks[index].lease = haveLease ? lease : WiFiLease();
+  }
+
+  phase = Phase::UP;
+  backoff = RECONNECT_INITIAL_MS;
+  connected = (int8_t)index;
+  wifiState = WiFiState::CONNECTED;
+  return WiFiConnectorEvent::CONNECTED;
+}
+
+void WiFiConnector::goIdle(unsigned long now) {
+  phase = Phase::IDLE;
+  phaseStart = now;
+  connected = -1;
+  wifiState = retryForever ? WiFiState::RECONNECTING : WiFiState::AP_ONLY;
+}
@@ -0,0 +1,140 @@
+#ifndef WIFI_CONNECTOR_H
+#define WIFI_CONNECTOR_H
+
+#include "hal.h"
+#include <Arduino.h>
+#include <atomic>
+
+// ---------------------------
+// WiFi Station Connector
+// ---------------------------
+// Event-driven connect and reconnect policy for the saved networks. Nothing
+// here blocks or touches the radio directly: attempts are started through a
+// WiFiLink, their outcome arrives as link-up/link-down notifications from the
+// WiFi event task, and tick() advances timeouts and backoff from whichever
+// task owns the connector (the network startup task, then the main loop).
+// Time is passed in, so the policy runs the same against any WiFiLink.
+//
+// Each network remembers the BSSID and channel it was last joined on. An
+// attempt with that hint skips the all-channel scan, which is most of the
+// time a reconnect takes after an access point blip; only if the hint fails
+// does the attempt fall back to a full scan. The DHCP lease from the last join
+// rides along with the hint while it is fresh, so a reconnect has its address
+// without waiting for DHCP; once the link is up, DHCP takes the address back
+// over, so the server never hands it to another client while the board uses it.
+//
+// The registry belongs to the owning task: other tasks post removals, which
+// tick() applies (dropping the link first if it is on a removed network).
+
+static constexpr unsigned long FAST_CONNECT_TIMEOUT_MS = 1500; // Cached BSSID + channel, no scan
+static constexpr unsigned long FULL_CONNECT_TIMEOUT_MS = 8000; // Scan, then associate
+// Link-down reports this soon after an attempt starts belong to the attempt it replaced
+static constexpr unsigned long LINK_DOWN_SETTLE_MS = 100;
+
+// Backoff between reconnect rounds (every saved network tried once per round)
+static constexpr unsigned long RECONNECT_INITIAL_MS = 5000;
+static constexpr unsigned long RECONNECT_MAX_MS = 60000;
+// After a requested connect gave up, try the saved networks again this often
+static constexpr unsigned long GAVE_UP_RETRY_MS = 300000; // 5 minutes
+// A cached lease is reused this long after DHCP handed it out (well inside a typical lease time)
+static constexpr unsigned long LEASE_REUSE_MS = 1800000; // 30 minutes
+
+enum class WiFiState {
+  AP_ONLY,       // No STA connection, AP is active
+  CONNECTING,    // Attempting STA connection, AP is active
+  CONNECTED,     // STA connected, AP disabled after stabilization
+  RECONNECTING   // STA lost, AP re-enabled, attempting reconnection
+};
+
+struct SavedNetwork {
+  String ssid;
+  String password;
+  WiFiFastConnect fast = {}; // Where it was last joined, channel 0 if never
+  WiFiLease lease = {};      // Addresses from the last DHCP on it, this boot only (ip 0 if none)
+};
+
+/// What a tick() changed, for the owner to react to (AP, mDNS, persisting the cache).
+enum class WiFiConnectorEvent : uint8_t {
+  NONE,
+  CONNECTED,   // Link is up on connectedIndex()
+  LOST,        // Link went down (or was dropped for a requested connect); retrying
+  GAVE_UP      // A requested connect tried every candidate and failed; back to AP_ONLY (retried every GAVE_UP_RETRY_MS)
+};
+
+class WiFiConnector {
+ public:
+  /// `networks` and `networkCount` are the owner's registry, read at every attempt
+  /// and shortened by tick() when a removal is applied.
+  void begin(WiFiLink* link, SavedNetwork* networks, uint8_t* networkCount);
+
+  // --- Any task ---
+  void notifyLinkUp();
+  void notifyLinkDown(unsigned long now);
+  /// Try saved network `index`, or every saved network in order if -1. Unlike a
+  /// reconnect this does not retry: if nothing connects the state returns to AP_ONLY.
+  void requestConnect(int8_t index);
+  /// Delete registry entry `index` (as numbered now: removals posted before the next
+  /// tick() all refer to the same registry). Later entries shift down when it is applied.
+  void requestRemoval(uint8_t index);
+  /// Entries awaiting removal, bit i = entry i. Lists should already leave them out.
+  uint8_t pendingRemovals() const { return pendingRemoval.load(); }
+
+  // --- Owning task only ---
+  WiFiConnectorEvent tick(unsigned long now);
+  /// True if the last CONNECTED stored a new BSSID or channel for connectedIndex().
+  bool cacheRefreshed() const { return refreshed; }
+  /// True if the last CONNECTED ended a reconnect (see lastReconnectMs()).
+  bool wasReconnect() const { return reconnected; }
+  /// True if the last tick() removed registry entries, which the owner then saves.
+  bool registryChanged() const { return removed; }
+
+  WiFiState state() const { return wifiState.load(); }
+  int8_t connectedIndex() const { return connected.load(); }
+  uint32_t reconnects() const { return reconnectCount.load(); }
+  uint32_t fastConnects() const { return fastConnectCount.load(); }
+  /// Link-down to link-up time of the last reconnect, 0 if none yet.
+  uint32_t lastReconnectMs() const { return lastReconnect.load(); }
+
+ private:
+  enum class Phase : uint8_t { IDLE, FAST, FULL, BACKOFF, UP };
+  static constexpr int8_t NO_REQUEST = -2;
+
+  WiFiLink* link = nullptr;
+  SavedNetwork* networks = nullptr;
+  uint8_t* networkCount = nullptr;
+
+  std::atomic<WiFiState> wifiState{WiFiState::AP_ONLY};
+  std::atomic<int8_t> connected{-1};
+  std::atomic<bool> linkUpPending{false};
+  std::atomic<bool> linkDownPending{false};
+  std::atomic<unsigned long> linkDownAt{0};
+  std::atomic<int8_t> pendingRequest{NO_REQUEST};
+  std::atomic<uint8_t> pendingRemoval{0};
+  std::atomic<uint32_t> reconnectCount{0};
+  std::atomic<uint32_t> fastConnectCount{0};
+  std::atomic<uint32_t> lastReconnect{0};
+
+  Phase phase = Phase::IDLE;
+  uint8_t index = 0;        // Network being tried, or the connected one
+  uint8_t roundTried = 0;   // Networks tried in the current round
+  bool singleNetwork = false;
+  bool retryForever = false; // Reconnecting after a loss, as opposed to a requested connect
+  bool refreshed = false;
+  bool reconnected = false;
+  bool removed = false;
+  bool usedLease = false;  // The current attempt reuses the cached lease
+  unsigned long phaseStart = 0;
+  unsigned long lostAt = 0;
+  unsigned long backoff = RECONNECT_INITIAL_MS;
+
+  void startRound(int8_t request, bool forever, unsigned long now);
+  void attempt(uint8_t networkIndex, unsigned long now);
+  WiFiConnectorEvent attemptFailed(bool timedOut, unsigned long now);
+  WiFiConnectorEvent linkCameUp(unsigned long now);
+  /// Shift the removed entries out. True if the link or attempt was on one of them
+  /// (then dropped, with `event` saying what that changed).
+  bool applyRemovals(uint8_t mask, unsigned long now, WiFiConnectorEvent& event);
+  void goIdle(unsigned long now);
+};
+
+#endif // WIFI_CONNECTOR_H
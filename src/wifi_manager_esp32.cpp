@@ -1,16 +1,38 @@
 #include "wifi_manager_esp32.h"
+#include "boot_timeline.h"
+#include "chess_engine.h"
 #include "chess_lichess.h"
 #include "chess_utils.h"
+#include "eco_trie.h"
+#include "game_arena.h"
+#include "game_catalog.h"
+#include "heap_report.h"
+#include "logger.h"
+#include "loop_stats.h"
+#include "microbench.h"
 #include "move_history.h"
+#include "move_trace.h"
+#include "network_actor.h"
+#include "profiler.h"
+#include "stockfish_cache.h"
+#include "uci_engine.h"
 #include <Arduino.h>
 #include <ArduinoJson.h>
 #include <Preferences.h>
 #include <Update.h>
 #include <ESPmDNS.h>
+#include <esp_ota_ops.h>
 #include <esp_random.h>
+#include <esp_sntp.h>
+#include <esp_system.h>
 #include <mbedtls/sha256.h>
+#include <new>
+#include <vector>
 
-static const char* INITIAL_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+// Data files uploaded from the web UI (built by the host tools in tools/)
+static const WiFiManagerESP32::DataFileSpec PUZZLE_PACK_FILE = {PUZZLE_PACK_PATH, PUZZLE_PACK_TEMP_PATH, "Puzzle pack", "puzzles", PuzzlePack::validateFile};
+static const WiFiManagerESP32::DataFileSpec OPENING_TRIE_FILE = {OPENING_TRIE_PATH, OPENING_TRIE_TEMP_PATH, "Opening repertoire", "lines", OpeningTrie::validateFile};
+static const WiFiManagerESP32::DataFileSpec ECO_TRIE_FILE = {ECO_TRIE_PATH, ECO_TRIE_TEMP_PATH, "ECO table", "lines", EcoTrie::validateFile};
 
 // --- Response helpers ---
 
@@ -37,63 +59,68 @@ static AsyncWebServerResponse* beginJsonOk(AsyncWebServerRequest* request) {
   return request->beginResponse(200, "application/json", "{\"ok\":true}");
 }
 
-// Singleton instance for WiFi event callback
-WiFiManagerESP32* WiFiManagerESP32::instance = nullptr;
-
 // ===========================
 // WiFiManagerESP32
 // ===========================
 
-WiFiManagerESP32::WiFiManagerESP32(BoardDriver* bd, MoveHistory* mh) : boardDriver(bd), moveHistory(mh), server(AP_PORT), gameMode("0"), lichessToken(""), botConfig(), currentFen(INITIAL_FEN), hasPendingEdit(false), boardEvaluation(0.0f) {}
-
 void WiFiManagerESP32::begin() {
   Serial.println("=== Starting LibreChess WiFi Manager (ESP32) ===");
-  instance = this;
-
-  if (!ChessUtils::ensureNvsInitialized()) {
-    Serial.println("NVS init failed - credentials not loaded");
-  } else {
-    loadNetworks();
+  if (loadSettings())
     loadOtaPassword();
 
-    // Load Lichess token
-    prefs.begin("lichess", false);
-    if (prefs.isKey("token")) {
-      lichessToken = prefs.getString("token", "");
-    }
-    prefs.end();
-    if (lichessToken.length() > 0) {
-      Serial.println("Lichess API token loaded from NVS");
-    }
+  networkStarting = true;
+  if (xTaskCreatePinnedToCore(networkStartTask, "NetStart", NETWORK_START_TASK_STACK, this, 1, nullptr, NETWORK_START_TASK_CORE) != pdPASS) {
+    Serial.println("WARNING: Failed to start network task, starting the network inline");
+    startNetwork();
+    networkStarting = false;
   }
+}
 
+void WiFiManagerESP32::networkStartTask(void* param) {
+  WiFiManagerESP32* self = static_cast<WiFiManagerESP32*>(param);
+  self->startNetwork();
+  self->networkStarting = false;
+  BootTimeline::print();
+  vTaskDelete(nullptr);
+}
+
+void WiFiManagerESP32::waitForNetworkStart() {
+  if (!networkStarting.load())
+    return;
+  Serial.println("Waiting for the network to come up...");
+  while (networkStarting.load())
+    boardDriver->cooperativeWait().sleep(NETWORK_START_POLL_MS);
+}
+
+void WiFiManagerESP32::startNetwork() {
   // Start AP — always active initially
   if (!WiFi.softAP(AP_SSID, AP_PASSWORD)) {
     Serial.println("ERROR: Failed to create Access Point!");
     return;
   }
   apActive = true;
-  wifiState = WiFiState::AP_ONLY;
+  BootTimeline::mark(BootStage::AP_READY);
 
   // Register WiFi event handler for state machine (observer pattern)
-  WiFi.onEvent(onWiFiEvent);
+  wifiLink->begin();
+  WiFi.onEvent([this](WiFiEvent_t event, WiFiEventInfo_t info) { this->onWiFiEvent(event); });
 
   // Create stabilization timer (one-shot, not started yet)
   apStabilizationTimer = xTimerCreate("apStab", pdMS_TO_TICKS(AP_STABILIZATION_MS), pdFALSE, this, apStabilizationCallback);
 
-  // Attempt connection to saved networks
-  bool connected = false;
-  for (uint8_t i = 0; i < networkCount && !connected; i++) {
-    wifiState = WiFiState::CONNECTING;
-    connected = connectToNetwork(i);
-  }
-  if (!connected) {
-    wifiState = WiFiState::AP_ONLY;
-  }
+  // Try the saved networks in order; this task owns the connector until startup finishes
+  connector.requestConnect(-1);
+  do {
+    serviceWiFi();
+    delay(NETWORK_START_POLL_MS);
+  } while (connector.state() == WiFiState::CONNECTING);
+  int8_t connectedIndex = connector.connectedIndex();
+  bool connected = connectedIndex >= 0;
 
   // Start mDNS responder — enables http://librechess.local access
   if (MDNS.begin(MDNS_HOSTNAME)) {
     MDNS.addService("http", "tcp", AP_PORT);
+    BootTimeline::mark(BootStage::MDNS_READY);
     Serial.println("mDNS started: http://" MDNS_HOSTNAME ".local");
   } else {
     Serial.println("mDNS failed to start");
@@ -107,7 +134,7 @@ void WiFiManagerESP32::begin() {
   Serial.println("  URL: http://" MDNS_HOSTNAME ".local");
   if (connected) {
     Serial.println("Connected to WiFi:");
-    Serial.println("  SSID: " + savedNetworks[connectedNetworkIndex].ssid);
+    Serial.println("  SSID: " + savedNetworks[connectedIndex].ssid);
     Serial.println("  URL: http://" + WiFi.localIP().toString());
     Serial.println("  URL: http://" MDNS_HOSTNAME ".local");
   } else {
@@ -153,6 +180,8 @@ void WiFiManagerESP32::begin() {
   server.on("/gameselect", HTTP_POST, [this](AsyncWebServerRequest* request) { this->handleGameSelection(request); });
   server.on("/lichess", HTTP_GET, [this](AsyncWebServerRequest* request) { request->send(200, "application/json", this->getLichessInfoJSON()); });
   server.on("/lichess", HTTP_POST, [this](AsyncWebServerRequest* request) { this->handleSaveLichessToken(request); });
+  server.on("/engine", HTTP_GET, [this](AsyncWebServerRequest* request) { request->send(200, "application/json", this->getEngineSettingsJSON()); });
+  server.on("/engine", HTTP_POST, [this](AsyncWebServerRequest* request) { this->handleSaveEngineSettings(request); });
   server.on("/board-settings", HTTP_GET, [this](AsyncWebServerRequest* request) { request->send(200, "application/json", this->getBoardSettingsJSON()); });
   server.on("/board-settings", HTTP_POST, [this](AsyncWebServerRequest* request) { this->handleBoardSettings(request); });
   server.on("/board-calibrate", HTTP_POST, [this](AsyncWebServerRequest* request) { this->handleBoardCalibration(request); });
@@ -161,12 +190,108 @@ void WiFiManagerESP32::begin() {
     [this](AsyncWebServerRequest* request, const String& filename, size_t index, uint8_t* data, size_t len, bool final) {
       this->handleOtaUpload(request, filename, index, data, len, final);
     });
+  // Before "/games", whose handler would otherwise also match "/games/search" and "/games/stats"
+  server.on("/games/search", HTTP_GET, [this](AsyncWebServerRequest* request) { this->handleGameSearch(request); });
+  server.on("/games/stats", HTTP_GET, [this](AsyncWebServerRequest* request) {
+    String json = this->moveHistory->getGameStatsJSON();
+    if (json.isEmpty()) {
+      sendJsonError(request, 503, "Game catalog is busy, try again");
+      return;
+    }
+    request->send(200, "application/json", json);
+  });
   server.on("/games", HTTP_GET, [this](AsyncWebServerRequest* request) { this->handleGamesRequest(request); });
   server.on("/games", HTTP_DELETE, [this](AsyncWebServerRequest* request) { this->handleDeleteGame(request); });
   server.on("/resign", HTTP_POST, [this](AsyncWebServerRequest* request) {
     this->hasPendingResign = true;
     sendJsonOk(request);
   });
+  server.on("/analysis", HTTP_GET, [this](AsyncWebServerRequest* request) {
+    request->send(200, "application/json", this->analysisJson.isEmpty() ? String("{\"active\":false}") : this->analysisJson);
+  });
+  server.on("/analysis/hint", HTTP_POST, [this](AsyncWebServerRequest* request) {
+    if (this->analysisJson.isEmpty()) {
+      sendJsonError(request, 409, "Analysis mode is not active");
+      return;
+    }
+    this->hasPendingAnalysisHint = true;
+    sendJsonOk(request);
+  });
+  server.on("/puzzle", HTTP_GET, [this](AsyncWebServerRequest* request) {
+    request->send(200, "application/json", this->puzzleJson.isEmpty() ? String("{\"active\":false}") : this->puzzleJson);
+  });
+  server.on("/puzzles", HTTP_POST,
+    [this](AsyncWebServerRequest* request) { this->handleDataFileResult(request, PUZZLE_PACK_FILE); },
+    [this](AsyncWebServerRequest* request, const String& filename, size_t index, uint8_t* data, size_t len, bool final) {
+      this->handleDataFileUpload(request, PUZZLE_PACK_FILE, !this->puzzleJson.isEmpty(), filename, index, data, len, final);
+    });
+  server.on("/opening", HTTP_GET, [this](AsyncWebServerRequest* request) {
+    request->send(200, "application/json", this->openingJson.isEmpty() ? String("{\"active\":false}") : this->openingJson);
+  });
+  server.on("/opening/hint", HTTP_POST, [this](AsyncWebServerRequest* request) {
+    if (this->openingJson.isEmpty()) {
+      sendJsonError(request, 409, "Opening trainer is not active");
+      return;
+    }
+    this->hasPendingOpeningHint = true;
+    sendJsonOk(request);
+  });
+  server.on("/clock", HTTP_GET, [this](AsyncWebServerRequest* request) { request->send(200, "application/json", this->getClockJSON()); });
+  server.on("/debug/trace", HTTP_GET, [this](AsyncWebServerRequest* request) { this->handleTraceExport(request); });
+  server.on("/debug/trace", HTTP_DELETE, [](AsyncWebServerRequest* request) {
+    MoveTrace::clear();
+    sendJsonOk(request);
+  });
+  server.on("/debug/loop", HTTP_GET, [this](AsyncWebServerRequest* request) { request->send(200, "application/json", this->getLoopStatsJSON()); });
+  server.on("/debug/loop", HTTP_DELETE, [this](AsyncWebServerRequest* request) {
+    if (loopStats)
+      loopStats->reset();
+    boardDriver->cooperativeWait().reset();
+    sendJsonOk(request);
+  });
+  server.on("/debug/log", HTTP_GET, [this](AsyncWebServerRequest* request) {
+    uint32_t since = request->hasArg("since") ? (uint32_t)request->arg("since").toInt() : 0;
+    request->send(200, "application/json", this->getLogJSON(since));
+  });
+  server.on("/debug/log", HTTP_DELETE, [](AsyncWebServerRequest* request) {
+    Log::resetStats();
+    sendJsonOk(request);
+  });
+  server.on("/debug/profile", HTTP_POST, [this](AsyncWebServerRequest* request) { this->handleProfileStart(request); });
+  server.on("/debug/profile", HTTP_GET, [this](AsyncWebServerRequest* request) { this->handleProfileExport(request); });
+  server.on("/debug/profile", HTTP_DELETE, [](AsyncWebServerRequest* request) {
+    Profiler::release();
+    sendJsonOk(request);
+  });
+  server.on("/debug/bench", HTTP_POST, [](AsyncWebServerRequest* request) {
+    if (!Microbench::start()) {
+      sendJsonError(request, 409, "Benchmark is already running");
+      return;
+    }
+    sendJsonOk(request);
+  });
+  server.on("/debug/bench", HTTP_GET, [this](AsyncWebServerRequest* request) { request->send(200, "application/json", this->getBenchJSON()); });
+  server.on("/debug/boot", HTTP_GET, [this](AsyncWebServerRequest* request) { request->send(200, "application/json", this->getBootJSON()); });
+  server.on("/debug/heap", HTTP_GET, [this](AsyncWebServerRequest* request) { request->send(200, "application/json", this->getHeapReportJSON()); });
+  server.on("/debug/bus", HTTP_GET, [this](AsyncWebServerRequest* request) { request->send(200, "application/json", this->getBusStatsJSON()); });
+  server.on("/debug/stockfish-cache", HTTP_GET, [this](AsyncWebServerRequest* request) { request->send(200, "application/json", this->getStockfishCacheJSON()); });
+  server.on("/debug/stockfish-cache", HTTP_DELETE, [this](AsyncWebServerRequest* request) {
+    if (stockfishCache)
+      stockfishCache->clear();
+    sendJsonOk(request);
+  });
+  server.on("/debug/latency", HTTP_GET, [this](AsyncWebServerRequest* request) { request->send(200, "application/json", this->getLatencyJSON()); });
+  server.on("/openings", HTTP_POST,
+    [this](AsyncWebServerRequest* request) { this->handleDataFileResult(request, OPENING_TRIE_FILE); },
+    [this](AsyncWebServerRequest* request, const String& filename, size_t index, uint8_t* data, size_t len, bool final) {
+      this->handleDataFileUpload(request, OPENING_TRIE_FILE, !this->openingJson.isEmpty(), filename, index, data, len, final);
+    });
+  // Only opened while a finished game is catalogued, so it can be replaced at any time
+  server.on("/eco", HTTP_POST,
+    [this](AsyncWebServerRequest* request) { this->handleDataFileResult(request, ECO_TRIE_FILE); },
+    [this](AsyncWebServerRequest* request, const String& filename, size_t index, uint8_t* data, size_t len, bool final) {
+      this->handleDataFileUpload(request, ECO_TRIE_FILE, false, filename, index, data, len, final);
+    });
 
   // Static file serving
   server.serveStatic("/sounds/", LittleFS, "/sounds/").setTryGzipFirst(false);
@@ -179,63 +304,82 @@ void WiFiManagerESP32::begin() {
   DefaultHeaders::Instance().addHeader("X-Frame-Options", "DENY");
 
   server.begin();
+  BootTimeline::mark(BootStage::WEB_SERVER_READY);
   Serial.println("Web server started on port 80");
+
+  // NTP time sync resolves in the background once a station connection is up
+  sntp_set_time_sync_notification_cb([](struct timeval*) { BootTimeline::mark(BootStage::NTP_SYNCED); });
+  configTime(0, 0, "pool.ntp.org", "time.nist.gov");
 }
 
 // ===========================
 // WiFi State Machine
 // ===========================
 
-void WiFiManagerESP32::onWiFiEvent(WiFiEvent_t event, WiFiEventInfo_t info) {
-  if (!instance) return;
+void WiFiManagerESP32::onWiFiEvent(WiFiEvent_t event) {
   switch (event) {
     case ARDUINO_EVENT_WIFI_STA_GOT_IP:
-      instance->handleWiFiConnected();
+      connector.notifyLinkUp();
       break;
     case ARDUINO_EVENT_WIFI_STA_DISCONNECTED:
     case ARDUINO_EVENT_WIFI_STA_LOST_IP:
-      instance->handleWiFiDisconnected();
+      connector.notifyLinkDown(millis());
       break;
     default:
       break;
   }
 }
 
-void WiFiManagerESP32::handleWiFiConnected() {
-  Serial.println("WiFi STA connected — IP: " + WiFi.localIP().toString());
-
-  // Restart mDNS so it binds to the new STA interface
-  MDNS.end();
-  if (MDNS.begin(MDNS_HOSTNAME)) {
-    MDNS.addService("http", "tcp", AP_PORT);
+void WiFiManagerESP32::serviceWiFi() {
+  WiFiConnectorEvent event = connector.tick(millis());
+  if (applyStagedNetwork() || connector.registryChanged())
+    saveNetworks();
+  switch (event) {
+    case WiFiConnectorEvent::CONNECTED:
+      handleWiFiConnected();
+      break;
+    case WiFiConnectorEvent::LOST:
+      handleWiFiDisconnected();
+      break;
+    case WiFiConnectorEvent::GAVE_UP:
+      Serial.println("WiFi: no saved network could be joined");
+      break;
+    case WiFiConnectorEvent::NONE:
+      break;
   }
+}
 
-  if (wifiState == WiFiState::CONNECTING || wifiState == WiFiState::RECONNECTING) {
-    // Start stabilization timer before disabling AP
-    wifiState = WiFiState::CONNECTED;
-    reconnectInterval = RECONNECT_INITIAL_MS; // Reset backoff
-    if (apStabilizationTimer) {
-      xTimerStart(apStabilizationTimer, 0);
+void WiFiManagerESP32::handleWiFiConnected() {
+  BootTimeline::mark(BootStage::STA_CONNECTED);
+  int8_t index = connector.connectedIndex();
+  Serial.printf("WiFi STA connected to '%s' — IP: %s\n", savedNetworks[index].ssid.c_str(), WiFi.localIP().toString().c_str());
+  if (connector.wasReconnect())
+    Serial.printf("  Reconnected in %lu ms\n", (unsigned long)connector.lastReconnectMs());
+  if (connector.cacheRefreshed())
+    saveFastConnect(index);
+
+  // Restart mDNS so it binds to the new STA interface (startup starts it once connecting is done)
+  if (!networkStarting.load()) {
+    MDNS.end();
+    if (MDNS.begin(MDNS_HOSTNAME)) {
+      MDNS.addService("http", "tcp", AP_PORT);
     }
   }
+
+  // Start stabilization timer before disabling AP
+  if (apStabilizationTimer) {
+    xTimerStart(apStabilizationTimer, 0);
+  }
 }
 
 void WiFiManagerESP32::handleWiFiDisconnected() {
-  // Ignore disconnect events when we're not in a connected/connecting state
-  if (wifiState == WiFiState::AP_ONLY) return;
-
-  Serial.println("WiFi STA disconnected");
+  Serial.println("WiFi STA disconnected — reconnecting");
 
   // Cancel stabilization timer if it was running (prevents disabling AP during unstable connection)
   if (apStabilizationTimer) {
     xTimerStop(apStabilizationTimer, 0);
   }
 
-  wifiState = WiFiState::RECONNECTING;
-  connectedNetworkIndex = -1;
-  lastReconnectAttempt = 0; // Force immediate first attempt in update()
-  reconnectNetworkIndex = 0;
-
   enableAP();
 }
 
@@ -263,83 +407,9 @@ void WiFiManagerESP32::enableAP() {
 }
 
 void WiFiManagerESP32::update() {
-  // Only handle reconnection logic when in RECONNECTING state
-  if (wifiState != WiFiState::RECONNECTING || networkCount == 0) return;
-
-  unsigned long now = millis();
-  if (now - lastReconnectAttempt < reconnectInterval) return;
-  lastReconnectAttempt = now;
-
-  Serial.printf("Reconnection attempt — trying network %d/%d (backoff %lums)\n", reconnectNetworkIndex + 1, networkCount, reconnectInterval);
-
-  WiFi.mode(WIFI_AP_STA);
-  WiFi.begin(savedNetworks[reconnectNetworkIndex].ssid.c_str(), savedNetworks[reconnectNetworkIndex].password.c_str());
-
-  // Move to next network for the next attempt
-  reconnectNetworkIndex = (reconnectNetworkIndex + 1) % networkCount;
-
-  // Exponential backoff: 5s → 10s → 20s → 40s → 60s cap
-  reconnectInterval = min(reconnectInterval * 2, RECONNECT_MAX_MS);
-}
-
-// ===========================
-// Known-Networks Registry
-// ===========================
-
-void WiFiManagerESP32::loadNetworks() {
-  prefs.begin("wifiNets", true);
-  networkCount = prefs.getUChar("count", 0);
-  if (networkCount > MAX_SAVED_NETWORKS) networkCount = MAX_SAVED_NETWORKS;
-
-  for (uint8_t i = 0; i < networkCount; i++) {
-    savedNetworks[i].ssid = prefs.getString(("ssid" + String(i)).c_str(), "");
-    savedNetworks[i].password = prefs.getString(("pass" + String(i)).c_str(), "");
-  }
-  prefs.end();
-
-  Serial.printf("Loaded %d saved network(s)\n", networkCount);
-}
-
-void WiFiManagerESP32::saveNetworks() {
-  if (!ChessUtils::ensureNvsInitialized()) {
-    Serial.println("NVS init failed - networks not saved");
-    return;
-  }
-  prefs.begin("wifiNets", false);
-  prefs.clear(); // Clear all keys first to handle deletions
-  prefs.putUChar("count", networkCount);
-  for (uint8_t i = 0; i < networkCount; i++) {
-    prefs.putString(("ssid" + String(i)).c_str(), savedNetworks[i].ssid);
-    prefs.putString(("pass" + String(i)).c_str(), savedNetworks[i].password);
-  }
-  prefs.end();
-}
-
-bool WiFiManagerESP32::connectToNetwork(uint8_t index) {
-  if (index >= networkCount) return false;
-
-  const SavedNetwork& net = savedNetworks[index];
-  if (net.ssid.isEmpty()) return false;
-
-  Serial.printf("Connecting to '%s'...\n", net.ssid.c_str());
-  WiFi.mode(WIFI_AP_STA);
-  WiFi.begin(net.ssid.c_str(), net.password.c_str());
-
-  int attempts = 0;
-  while (WiFi.status() != WL_CONNECTED && attempts < 10) {
-    boardDriver->showConnectingAnimation();
-    attempts++;
-    Serial.printf("  Attempt %d/10 — status: %d\n", attempts, WiFi.status());
-  }
-
-  if (WiFi.status() == WL_CONNECTED) {
-    connectedNetworkIndex = index;
-    Serial.printf("Connected to '%s'\n", net.ssid.c_str());
-    return true;
-  }
-
-  Serial.printf("Failed to connect to '%s'\n", net.ssid.c_str());
-  return false;
+  // The startup task owns the connector until it has tried the saved networks
+  if (networkStarting.load()) return;
+  serviceWiFi();
 }
 
 // ===========================
@@ -449,12 +519,17 @@ void WiFiManagerESP32::handleOtaPassword(AsyncWebServerRequest* request) {
 String WiFiManagerESP32::getNetworksJSON() {
   JsonDocument doc;
   JsonArray arr = doc["networks"].to<JsonArray>();
+  uint8_t removals = connector.pendingRemovals(); // Deleted, not yet shifted out by the connector
   for (uint8_t i = 0; i < networkCount; i++) {
+    if (removals & (1 << i))
+      continue;
     JsonObject net = arr.add<JsonObject>();
     net["index"] = i;
     net["ssid"] = savedNetworks[i].ssid;
-    net["connected"] = (i == connectedNetworkIndex && WiFi.status() == WL_CONNECTED);
-    if (i == connectedNetworkIndex && WiFi.status() == WL_CONNECTED) {
+    bool isConnected = i == connector.connectedIndex() && WiFi.status() == WL_CONNECTED;
+    net["connected"] = isConnected;
+    net["fastConnect"] = savedNetworks[i].fast.channel != 0;
+    if (isConnected) {
       net["ip"] = WiFi.localIP().toString();
       net["rssi"] = WiFi.RSSI();
     }
@@ -464,7 +539,10 @@ String WiFiManagerESP32::getNetworksJSON() {
   doc["apIp"] = WiFi.softAPIP().toString();
   doc["hostname"] = MDNS_HOSTNAME ".local";
   doc["maxNetworks"] = MAX_SAVED_NETWORKS;
-  doc["wifiState"] = static_cast<int>(wifiState);
+  doc["wifiState"] = static_cast<int>(connector.state());
+  doc["reconnects"] = connector.reconnects();
+  doc["fastConnects"] = connector.fastConnects();
+  doc["lastReconnectMs"] = connector.lastReconnectMs();
   String output;
   serializeJson(doc, output);
   return output;
@@ -495,6 +573,17 @@ String WiFiManagerESP32::getScanResultsJSON() {
   return output;
 }
 
+int WiFiManagerESP32::registryIndex(int listed) {
+  uint8_t removals = connector.pendingRemovals();
+  for (uint8_t i = 0; i < networkCount && listed >= 0; i++) {
+    if (removals & (1 << i))
+      continue;
+    if (listed-- == 0)
+      return i;
+  }
+  return -1;
+}
+
 void WiFiManagerESP32::handleAddNetwork(AsyncWebServerRequest* request) {
   if (!request->hasArg("ssid") || !request->hasArg("password")) {
     sendJsonError(request, 400, "Missing ssid or password");
@@ -513,29 +602,32 @@ void WiFiManagerESP32::handleAddNetwork(AsyncWebServerRequest* request) {
     return;
   }
 
-  // Check if SSID already exists — update password instead of adding duplicate
-  for (uint8_t i = 0; i < networkCount; i++) {
-    if (savedNetworks[i].ssid == ssid) {
-      savedNetworks[i].password = password;
-      saveNetworks();
-      sendJsonOk(request, "action", "updated");
-      Serial.printf("WiFi: updated password for '%s'\n", ssid.c_str());
-      return;
-    }
+  if (hasStagedNetwork.load()) {
+    sendJsonError(request, 503, "Still saving the previous network, try again");
+    return;
   }
 
-  if (networkCount >= MAX_SAVED_NETWORKS) {
+  // An SSID already saved gets the new password instead of a duplicate entry
+  uint8_t removals = connector.pendingRemovals();
+  uint8_t kept = 0;
+  bool exists = false;
+  for (uint8_t i = 0; i < networkCount; i++) {
+    if (removals & (1 << i))
+      continue;
+    kept++;
+    exists = exists || savedNetworks[i].ssid == ssid;
+  }
+  if (!exists && kept >= MAX_SAVED_NETWORKS) {
     sendJsonError(request, 409, "Maximum networks reached. Delete one first.");
     return;
   }
 
-  savedNetworks[networkCount].ssid = ssid;
-  savedNetworks[networkCount].password = password;
-  networkCount++;
-  saveNetworks();
+  // serviceWiFi() adds it: the registry is only written where the connector reads it
+  stagedNetwork.ssid = ssid;
+  stagedNetwork.password = password;
+  hasStagedNetwork = true;
 
-  sendJsonOk(request, "action", "added");
-  Serial.printf("WiFi: added network '%s' (%d/%d)\n", ssid.c_str(), networkCount, MAX_SAVED_NETWORKS);
+  sendJsonOk(request, "action", exists ? "updated" : "added");
 }
 
 void WiFiManagerESP32::handleDeleteNetwork(AsyncWebServerRequest* request) {
@@ -544,29 +636,17 @@ void WiFiManagerESP32::handleDeleteNetwork(AsyncWebServerRequest* request) {
     return;
   }
 
-  int index = request->arg("index").toInt();
-  if (index < 0 || index >= networkCount) {
+  int index = registryIndex(request->arg("index").toInt());
+  if (index < 0) {
     sendJsonError(request, 400, "Invalid index");
     return;
   }
 
   String removedSsid = savedNetworks[index].ssid;
 
-  // If deleting the connected network, disconnect
-  if (index == connectedNetworkIndex) {
-    WiFi.disconnect();
-    connectedNetworkIndex = -1;
-  } else if (connectedNetworkIndex > index) {
-    connectedNetworkIndex--; // Adjust index after shift
-  }
-
-  // Shift remaining networks down
-  for (int i = index; i < networkCount - 1; i++) {
-    savedNetworks[i] = savedNetworks[i + 1];
-  }
-  savedNetworks[networkCount - 1] = SavedNetwork(); // Clear last slot
-  networkCount--;
-  saveNetworks();
+  // The connector's next tick shifts the registry, dropping the link first if it is on this
+  // network (it then reconnects to the others), and serviceWiFi() saves the result
+  connector.requestRemoval((uint8_t)index);
 
   sendJsonOk(request);
   Serial.printf("WiFi: deleted network '%s'\n", removedSsid.c_str());
@@ -578,29 +658,16 @@ void WiFiManagerESP32::handleConnectNetwork(AsyncWebServerRequest* request) {
     return;
   }
 
-  int index = request->arg("index").toInt();
-  if (index < 0 || index >= networkCount) {
+  int index = registryIndex(request->arg("index").toInt());
+  if (index < 0) {
     sendJsonError(request, 400, "Invalid index");
     return;
   }
 
-  // Respond immediately — connection proceeds on a separate task to avoid
-  // blocking the async_tcp task that serves other HTTP requests
+  // Respond immediately — the connector starts the attempt on its next tick
   sendJsonOk(request, "message", "Connecting...");
 
-  wifiState = WiFiState::CONNECTING;
-  xTaskCreate([](void* param) {
-    uint8_t idx = (uint8_t)(uintptr_t)param;
-    if (instance->connectToNetwork(idx)) {
-      instance->wifiState = WiFiState::CONNECTED;
-      if (instance->apStabilizationTimer) {
-        xTimerStart(instance->apStabilizationTimer, 0);
-      }
-    } else {
-      instance->wifiState = WiFiState::AP_ONLY;
-    }
-    vTaskDelete(nullptr);
-  }, "WiFiConn", 4096, (void*)(uintptr_t)index, 1, nullptr);
+  connector.requestConnect((int8_t)index);
 }
 
 void WiFiManagerESP32::handleWiFiScan(AsyncWebServerRequest* request) {
@@ -612,9 +679,14 @@ void WiFiManagerESP32::handleWiFiScan(AsyncWebServerRequest* request) {
 // ===========================
 
 String WiFiManagerESP32::getBoardUpdateJSON() {
+  BoardState state;
+  boardSnapshot.read(state);
   JsonDocument doc;
-  doc["fen"] = currentFen;
-  doc["evaluation"] = serialized(String(boardEvaluation, 2));
+  doc["fen"] = state.fen;
+  doc["evaluation"] = serialized(String(state.evaluation, 2));
+  doc["moveNumber"] = state.moveNumber;
+  doc["lastMove"] = state.lastMove;
+  doc["version"] = state.version;
   String output;
   serializeJson(doc, output);
   return output;
@@ -648,6 +720,25 @@ void WiFiManagerESP32::handleGameSelection(AsyncWebServerRequest* request) {
       sendJsonError(request, 400, "Missing bot parameters");
       return;
     }
+    botConfig.useLanEngine = request->arg("engine") == "lan";
+    if (botConfig.useLanEngine) {
+      if (!lanEngineSettings.isConfigured()) {
+        sendJsonError(request, 400, "No LAN engine configured");
+        return;
+      }
+      botConfig.lanEngine = lanEngineSettings;
+      Serial.printf("Bot engine: %s:%u\n", lanEngineSettings.host.c_str(), lanEngineSettings.port);
+    }
+  }
+  // Over-the-board games take an optional time control (minutes + seconds per move)
+  if (mode == 1 || mode == 2) {
+    timeControl = {ClockMode::NONE, 0, 0};
+    if (request->hasArg("clockMinutes") && request->arg("clockMinutes").toFloat() > 0) {
+      timeControl.mode = request->arg("clockMode") == "bronstein" ? ClockMode::BRONSTEIN : ClockMode::FISCHER;
+      timeControl.baseMs = constrain((uint32_t)(request->arg("clockMinutes").toFloat() * 60000), 1000UL, CLOCK_MAX_BASE_MS);
+      timeControl.incrementMs = constrain(request->arg("clockIncrement").toInt(), 0L, (long)(CLOCK_MAX_INCREMENT_MS / 1000)) * 1000;
+      Serial.printf("Time control received: %u ms + %u ms (%s)\n", timeControl.baseMs, timeControl.incrementMs, timeControl.mode == ClockMode::BRONSTEIN ? "Bronstein" : "Fischer");
+    }
   }
   // If Lichess mode, verify token exists
   if (mode == 3) {
@@ -657,10 +748,318 @@ void WiFiManagerESP32::handleGameSelection(AsyncWebServerRequest* request) {
     }
     Serial.println("Lichess mode selected via web");
   }
+  // Opening trainer: the repertoire's side is used unless a color is given
+  if (mode == 7)
+    openingColor = request->hasArg("playerColor") ? (request->arg("playerColor") == "black" ? 'b' : 'w') : ' ';
+  // Puzzle mode takes an optional starting rating
+  if (mode == 6 && request->hasArg("rating")) {
+    puzzleRating = constrain(request->arg("rating").toInt(), PUZZLE_MIN_RATING, PUZZLE_MAX_RATING);
+    Serial.printf("Puzzle target rating: %d\n", puzzleRating);
+  }
   Serial.println("Game mode selected via web: " + gameMode);
   sendJsonOk(request);
 }
 
+String WiFiManagerESP32::getClockJSON() {
+  JsonDocument doc;
+  doc["active"] = clock != nullptr && clock->isEnabled();
+  if (clock && clock->isEnabled()) {
+    const TimeControl& tc = clock->getTimeControl();
+    doc["mode"] = tc.mode == ClockMode::BRONSTEIN ? "bronstein" : "fischer";
+    doc["base"] = tc.baseMs / 1000;
+    doc["increment"] = tc.incrementMs / 1000;
+    doc["white"] = clock->getRemainingMs('w');
+    doc["black"] = clock->getRemainingMs('b');
+    char running = clock->getRunningSide();
+    char flagged = clock->getFlaggedSide();
+    doc["running"] = running == ' ' ? String() : String(running);
+    doc["flagged"] = flagged == ' ' ? String() : String(flagged);
+    doc["lowTime"] = CLOCK_LOW_TIME_MS;
+    JsonObject latency = doc["latency"].to<JsonObject>();
+    latency["lastUs"] = clock->getLastLatencyUs();
+    latency["avgUs"] = clock->getAverageLatencyUs();
+    latency["maxUs"] = clock->getMaxLatencyUs();
+  }
+  String output;
+  serializeJson(doc, output);
+  return output;
+}
+
+void WiFiManagerESP32::handleTraceExport(AsyncWebServerRequest* request) {
+  // Copy out under the trace lock, then stream so the JSON never sits in RAM whole
+  std::vector<TraceEvent> events(MOVE_TRACE_CAPACITY);
+  events.resize(MoveTrace::snapshot(events.data(), events.size()));
+
+  AsyncResponseStream* response = request->beginResponseStream("application/json");
+  response->print("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+  response->print("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"OpenChess\"}}");
+  for (size_t i = 0; i < events.size(); i++) {
+    const TraceEvent& e = events[i];
+    const char* name = MoveTrace::stageName(e.stage);
+    // Each stage is drawn as a span from the previous event of the same move
+    if (e.stage == TraceStage::SENSOR_EDGE || i == 0 || events[i - 1].move != e.move) {
+      response->printf(",{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%u,\"pid\":1,\"tid\":%u", name, e.timeUs, e.core);
+    } else {
+      uint32_t start = events[i - 1].timeUs;
+      response->printf(",{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%u,\"dur\":%u,\"pid\":1,\"tid\":%u", name, start, e.timeUs - start, e.core);
+    }
+    response->printf(",\"args\":{\"move\":%u,\"cycles\":%u,\"sinceEdgeUs\":%u}}", e.move, e.cycles, e.sinceEdgeUs);
+  }
+  response->print("]}");
+  request->send(response);
+}
+
+void WiFiManagerESP32::handleProfileStart(AsyncWebServerRequest* request) {
+  uint8_t seconds = request->hasArg("seconds") ? constrain(request->arg("seconds").toInt(), 1, PROFILE_MAX_SECONDS) : 5;
+  if (Profiler::isRunning()) {
+    sendJsonError(request, 409, "Capture in progress");
+    return;
+  }
+  if (!Profiler::start(seconds)) {
+    sendJsonError(request, 503, "Not enough memory for the sample buffer");
+    return;
+  }
+  JsonDocument doc;
+  doc["status"] = "ok";
+  doc["seconds"] = seconds;
+  doc["sampleHz"] = PROFILE_SAMPLE_HZ;
+  String output;
+  serializeJson(doc, output);
+  request->send(200, "application/json", output);
+}
+
+void WiFiManagerESP32::handleProfileExport(AsyncWebServerRequest* request) {
+  if (Profiler::isRunning()) {
+    sendJsonError(request, 409, "Capture in progress");
+    return;
+  }
+  size_t size = Profiler::captureSize();
+  if (size == 0) {
+    sendJsonError(request, 404, "No capture");
+    return;
+  }
+  // Filled straight from the sample buffer: the capture can be larger than free heap allows copying
+  AsyncWebServerResponse* response = request->beginResponse("application/octet-stream", size, [](uint8_t* buffer, size_t maxLen, size_t index) -> size_t {
+    return Profiler::readCapture(index, buffer, maxLen);
+  });
+  response->addHeader("Content-Disposition", "attachment; filename=profile.bin");
+  request->send(response);
+}
+
+String WiFiManagerESP32::getBenchJSON() {
+  BenchResult results[BENCH_CASE_COUNT];
+  uint32_t elapsedMs = 0;
+  uint8_t count = Microbench::results(results, elapsedMs);
+  JsonDocument doc;
+  doc["running"] = Microbench::isRunning();
+  // Build id and version let tools/microbench.py label runs from different firmware
+  const esp_app_desc_t* app = esp_ota_get_app_description();
+  char build[17];
+  for (int i = 0; i < 8; i++)
+    snprintf(build + 2 * i, 3, "%02x", app->app_elf_sha256[i]);
+  doc["build"] = build;
+  doc["version"] = app->version;
+  doc["batches"] = BENCH_BATCHES;
+  doc["elapsedMs"] = elapsedMs;
+  JsonArray cases = doc["cases"].to<JsonArray>();
+  for (uint8_t i = 0; i < count; i++) {
+    JsonObject c = cases.add<JsonObject>();
+    c["name"] = results[i].name;
+    c["calls"] = results[i].callsPerBatch;
+    c["minNs"] = results[i].minNs;
+    c["medianNs"] = results[i].medianNs;
+    c["heapBlocks"] = results[i].heapBlocks;
+  }
+  String output;
+  serializeJson(doc, output);
+  return output;
+}
+
+String WiFiManagerESP32::getHeapReportJSON() {
+  HeapReportSnapshot h;
+  HeapReport::snapshot(h);
+  JsonDocument doc;
+  JsonObject heap = doc["heap"].to<JsonObject>();
+  heap["free"] = h.freeBytes;
+  heap["largestBlock"] = h.largestBlock;
+  heap["minFree"] = h.minFreeBytes;
+  heap["bootLargestBlock"] = h.bootLargestBlock;
+  JsonArray games = doc["games"].to<JsonArray>();
+  for (uint8_t i = 0; i < h.gameCount; i++) {
+    JsonObject game = games.add<JsonObject>();
+    game["game"] = h.games[i].game;
+    game["free"] = h.games[i].freeBytes;
+    game["largestBlock"] = h.games[i].largestBlock;
+  }
+  JsonObject tls = doc["tls"].to<JsonObject>();
+  tls["connects"] = h.tlsConnects;
+  tls["failures"] = h.tlsFailures;
+  tls["failureLargestBlock"] = h.tlsFailureLargestBlock;
+  if (gameArena) {
+    GameArenaStats a;
+    gameArena->snapshot(a);
+    JsonObject arena = doc["arena"].to<JsonObject>();
+    arena["capacity"] = a.capacity;
+    arena["used"] = a.used;
+    arena["highWater"] = a.highWater;
+    arena["resets"] = a.resets;
+    arena["fallbacks"] = a.fallbacks;
+  }
+  String output;
+  serializeJson(doc, output);
+  return output;
+}
+
+String WiFiManagerESP32::getBootJSON() {
+  JsonDocument doc;
+  doc["resetReason"] = (int)esp_reset_reason();
+  uint32_t interactiveUs = BootTimeline::timeUs(BootStage::INTERACTIVE);
+  doc["interactiveMs"] = interactiveUs / 1000;
+  JsonArray stages = doc["stages"].to<JsonArray>();
+  for (uint8_t i = 0; i < (uint8_t)BootStage::COUNT; i++) {
+    uint32_t us = BootTimeline::timeUs((BootStage)i);
+    if (us == 0)
+      continue; // Not reached (yet)
+    JsonObject stage = stages.add<JsonObject>();
+    stage["name"] = BootTimeline::stageName((BootStage)i);
+    stage["ms"] = us / 1000;
+  }
+  String output;
+  serializeJson(doc, output);
+  return output;
+}
+
+String WiFiManagerESP32::getLatencyJSON() {
+  JsonDocument doc;
+  JsonArray stages = doc["stages"].to<JsonArray>();
+  for (uint8_t s = (uint8_t)TraceStage::DEBOUNCE_ACCEPTED; s < (uint8_t)TraceStage::COUNT; s++) {
+    TraceHistogram h;
+    MoveTrace::histogram((TraceStage)s, h);
+    JsonObject stage = stages.add<JsonObject>();
+    stage["name"] = MoveTrace::stageName((TraceStage)s);
+    stage["count"] = h.count;
+    stage["avgUs"] = h.count > 0 ? (uint32_t)(h.totalUs / h.count) : 0;
+    stage["maxUs"] = h.maxUs;
+    // Sparse buckets keyed by their lower bound in µs
+    JsonObject buckets = stage["buckets"].to<JsonObject>();
+    for (uint8_t b = 0; b < MOVE_TRACE_BUCKETS; b++)
+      if (h.buckets[b] > 0)
+        buckets[String(MoveTrace::bucketFloorUs(b))] = h.buckets[b];
+  }
+  String output;
+  serializeJson(doc, output);
+  return output;
+}
+
+String WiFiManagerESP32::getLoopStatsJSON() {
+  LoopStatsSnapshot s = {};
+  if (loopStats)
+    loopStats->snapshot(s);
+  JsonDocument doc;
+  JsonObject loop = doc["loop"].to<JsonObject>();
+  loop["iterations"] = s.iterations;
+  loop["avgUs"] = s.avgIterationUs;
+  loop["maxUs"] = s.maxIterationUs;
+  loop["slow"] = s.slowIterations;
+  loop["slowThresholdUs"] = LOOP_SLOW_ITERATION_US;
+  JsonObject moves = doc["moves"].to<JsonObject>();
+  moves["count"] = s.moves;
+  moves["avgUs"] = s.avgMoveUs;
+  moves["maxUs"] = s.maxMoveUs;
+  moves["avgHeapBlocks"] = s.avgMoveHeapBlocks;
+  moves["maxHeapBlocks"] = s.maxMoveHeapBlocks;
+  moves["maxFlashWrites"] = s.maxMoveFlashWrites;
+  JsonObject flash = doc["flash"].to<JsonObject>();
+  flash["writes"] = s.flashWrites;
+  flash["bytes"] = s.flashBytes;
+  doc["minFreeHeap"] = s.minFreeHeap;
+  CooperativeWaitStats w;
+  boardDriver->cooperativeWait().snapshot(w);
+  JsonObject service = doc["service"].to<JsonObject>();
+  service["ticks"] = w.ticks;
+  service["avgGapUs"] = w.avgGapUs;
+  service["maxGapUs"] = w.maxGapUs;
+  service["avgRunUs"] = w.avgServiceUs;
+  service["maxRunUs"] = w.maxServiceUs;
+  String output;
+  serializeJson(doc, output);
+  return output;
+}
+
+static void queueStatsJSON(JsonObject obj, const SpscQueueStats& q) {
+  obj["pushed"] = q.pushed;
+  obj["dropped"] = q.dropped;
+  obj["maxDepth"] = q.maxDepth;
+  obj["avgWaitUs"] = q.avgWaitUs;
+  obj["maxWaitUs"] = q.maxWaitUs;
+}
+
+String WiFiManagerESP32::getBusStatsJSON() {
+  JsonDocument doc;
+  if (networkActor) {
+    NetworkActorStats s;
+    networkActor->snapshot(s);
+    queueStatsJSON(doc["requests"].to<JsonObject>(), s.requests);
+    queueStatsJSON(doc["replies"].to<JsonObject>(), s.replies);
+    JsonObject jobs = doc["jobs"].to<JsonObject>();
+    jobs["count"] = s.jobs;
+    jobs["avgRunUs"] = s.avgRunUs;
+    jobs["maxRunUs"] = s.maxRunUs;
+  }
+  String output;
+  serializeJson(doc, output);
+  return output;
+}
+
+String WiFiManagerESP32::getStockfishCacheJSON() {
+  StockfishCacheStats s = {};
+  if (stockfishCache)
+    stockfishCache->snapshot(s);
+  uint32_t hits = s.ramHits + s.flashHits;
+  JsonDocument doc;
+  doc["loaded"] = s.loaded;
+  doc["entries"] = s.entries;
+  doc["capacity"] = STOCKFISH_CACHE_SETS * STOCKFISH_CACHE_WAYS;
+  doc["ramEntries"] = STOCKFISH_CACHE_RAM_ENTRIES;
+  doc["ramHits"] = s.ramHits;
+  doc["flashHits"] = s.flashHits;
+  doc["misses"] = s.misses;
+  doc["hitRate"] = hits + s.misses ? (float)hits / (hits + s.misses) : 0.0f;
+  doc["stores"] = s.stores;
+  doc["evictions"] = s.evictions;
+  doc["errors"] = s.errors;
+  String output;
+  serializeJson(doc, output);
+  return output;
+}
+
+String WiFiManagerESP32::getLogJSON(uint32_t fromSeq) {
+  // Heap, not stack: the ring holds ~4.4KB and the AsyncTCP task stack is small
+  LogLine* lines = new (std::nothrow) LogLine[LOG_RING_ENTRIES];
+  size_t count = lines ? Log::readRecent(fromSeq, lines, LOG_RING_ENTRIES) : 0;
+  LogStats s;
+  Log::snapshot(s);
+  JsonDocument doc;
+  JsonArray linesJson = doc["lines"].to<JsonArray>();
+  for (size_t i = 0; i < count; i++) {
+    JsonObject line = linesJson.add<JsonObject>();
+    line["seq"] = lines[i].seq;
+    line["ms"] = lines[i].ms;
+    line["level"] = Log::levelName(lines[i].level);
+    line["text"] = lines[i].text;
+  }
+  delete[] lines;
+  JsonObject stats = doc["stats"].to<JsonObject>();
+  stats["lines"] = s.lines;
+  stats["dropped"] = s.dropped;
+  stats["avgCallerUs"] = s.avgCallerUs;
+  stats["maxCallerUs"] = s.maxCallerUs;
+  stats["serialUs"] = s.serialUs;
+  String output;
+  serializeJson(doc, output);
+  return output;
+}
+
 String WiFiManagerESP32::getLichessInfoJSON() {
   // Don't expose the actual token, just whether it exists and a masked version
   String maskedToken = lichessToken.length() > 4
@@ -704,6 +1103,54 @@ void WiFiManagerESP32::handleSaveLichessToken(AsyncWebServerRequest* request) {
   sendJsonOk(request);
 }
 
+String WiFiManagerESP32::getEngineSettingsJSON() {
+  JsonDocument doc;
+  doc["configured"] = lanEngineSettings.isConfigured();
+  doc["host"] = lanEngineSettings.host;
+  doc["port"] = lanEngineSettings.port;
+  doc["movetimeMs"] = lanEngineSettings.movetimeMs;
+  String output;
+  serializeJson(doc, output);
+  return output;
+}
+
+void WiFiManagerESP32::handleSaveEngineSettings(AsyncWebServerRequest* request) {
+  if (!ChessUtils::ensureNvsInitialized()) {
+    sendJsonError(request, 500, "NVS init failed");
+    return;
+  }
+
+  // Empty host = remove
+  String host = request->hasArg("host") ? request->arg("host") : "";
+  host.trim();
+  if (host.isEmpty()) {
+    prefs.begin("engine", false);
+    prefs.clear();
+    prefs.end();
+    lanEngineSettings = LanEngineSettings();
+    Serial.println("LAN engine removed");
+    sendJsonOk(request);
+    return;
+  }
+
+  long port = request->hasArg("port") ? request->arg("port").toInt() : lanEngineSettings.port;
+  if (port < 1 || port > 65535) {
+    sendJsonError(request, 400, "Invalid port");
+    return;
+  }
+  uint32_t movetime = request->hasArg("movetime") ? (uint32_t)constrain(request->arg("movetime").toInt(), (long)UCI_MIN_MOVETIME_MS, (long)UCI_MAX_MOVETIME_MS) : lanEngineSettings.movetimeMs;
+
+  prefs.begin("engine", false);
+  prefs.putString("host", host);
+  prefs.putUShort("port", (uint16_t)port);
+  prefs.putUInt("movetime", movetime);
+  prefs.end();
+  lanEngineSettings = LanEngineSettings(host, (uint16_t)port, movetime);
+  Serial.printf("LAN engine saved to NVS: %s:%ld, %ums per move\n", host.c_str(), port, movetime);
+
+  sendJsonOk(request);
+}
+
 String WiFiManagerESP32::getBoardSettingsJSON() {
   JsonDocument doc;
   doc["brightness"] = boardDriver->getBrightness();
@@ -837,28 +1284,70 @@ void WiFiManagerESP32::handleOtaUpload(AsyncWebServerRequest* request, const Str
   }
 }
 
-LichessConfig WiFiManagerESP32::getLichessConfig() {
-  LichessConfig config;
-  config.apiToken = lichessToken;
-  return config;
-}
+void WiFiManagerESP32::handleDataFileResult(AsyncWebServerRequest* request, const DataFileSpec& spec) {
+  if (dataUploadFile)
+    dataUploadFile.close();
+  if (!dataUploadError.isEmpty()) {
+    sendJsonError(request, 400, dataUploadError.c_str());
+    dataUploadError = "";
+    return;
+  }
 
-void WiFiManagerESP32::updateBoardState(const String& fen, float evaluation) {
-  currentFen = fen;
-  boardEvaluation = evaluation;
-}
+  // Validate the whole upload before replacing the current file
+  File uploaded = LittleFS.open(spec.tempPath, "r");
+  uint32_t count = 0;
+  bool valid = uploaded && spec.validate(uploaded, count);
+  if (uploaded)
+    uploaded.close();
+  if (!valid) {
+    LittleFS.remove(spec.tempPath);
+    sendJsonError(request, 400, (String("Invalid ") + spec.label).c_str());
+    return;
+  }
 
-bool WiFiManagerESP32::getPendingBoardEdit(String& fenOut) {
-  if (hasPendingEdit) {
-    fenOut = pendingFenEdit;
-    return true;
+  if (MoveHistory::quietExists(spec.path))
+    LittleFS.remove(spec.path);
+  if (!LittleFS.rename(spec.tempPath, spec.path)) {
+    sendJsonError(request, 500, (String("Failed to store ") + spec.label).c_str());
+    return;
   }
-  return false;
+  Serial.printf("%s stored: %u %s\n", spec.label, count, spec.countKey);
+  sendJsonOk(request, spec.countKey, String(count).c_str());
 }
 
-void WiFiManagerESP32::clearPendingEdit() {
-  currentFen = pendingFenEdit;
-  hasPendingEdit = false;
+void WiFiManagerESP32::handleDataFileUpload(AsyncWebServerRequest* request, const DataFileSpec& spec, bool inUse, const String& filename, size_t index, uint8_t* data, size_t len, bool final) {
+  if (index == 0) {
+    dataUploadError = "";
+    // Same protection as firmware updates: the upload replaces a file on flash
+    if (!otaPasswordHash.isEmpty() && (!request->hasHeader("X-OTA-Password") || !verifyOtaPassword(request->header("X-OTA-Password")))) {
+      dataUploadError = "Incorrect OTA password";
+      return;
+    }
+    // The file is held open while its game mode runs
+    if (inUse) {
+      dataUploadError = String("Leave the game mode before uploading a new ") + spec.label;
+      return;
+    }
+    Serial.printf("%s upload starting: %s\n", spec.label, filename.c_str());
+    dataUploadFile = LittleFS.open(spec.tempPath, "w");
+    if (!dataUploadFile) {
+      dataUploadError = String("Failed to create ") + spec.label + " file";
+      return;
+    }
+  }
+
+  if (!dataUploadError.isEmpty() || !dataUploadFile)
+    return;
+
+  if (dataUploadFile.write(data, len) != len) {
+    dataUploadFile.close();
+    LittleFS.remove(spec.tempPath);
+    dataUploadError = String("Not enough flash space for the ") + spec.label;
+    return;
+  }
+
+  if (final)
+    Serial.printf("%s upload complete: %u bytes\n", spec.label, index + len);
 }
 
 void WiFiManagerESP32::handleGamesRequest(AsyncWebServerRequest* request) {
@@ -902,9 +1391,58 @@ void WiFiManagerESP32::handleGamesRequest(AsyncWebServerRequest* request) {
     AsyncWebServerResponse* response = request->beginResponse(LittleFS, path, "application/octet-stream", true);
     request->send(response);
   } else {
-    // GET /games — return JSON list of all saved games
-    request->send(200, "application/json", moveHistory->getGameListJSON());
+    // GET /games — return JSON list of the saved games, optionally filtered and paged
+    CatalogFilter filter;
+    if (request->hasArg("mode")) filter.mode = (uint8_t)request->arg("mode").toInt();
+    if (request->hasArg("result")) filter.result = (uint8_t)request->arg("result").toInt();
+    if (request->hasArg("winner")) filter.winnerColor = (uint8_t)request->arg("winner").charAt(0);
+    if (request->hasArg("color")) filter.playerColor = (uint8_t)request->arg("color").charAt(0);
+    if (request->hasArg("depth")) filter.botDepth = (uint8_t)request->arg("depth").toInt();
+    if (request->hasArg("minPlies")) filter.minPlies = (uint16_t)request->arg("minPlies").toInt();
+    if (request->hasArg("maxPlies")) filter.maxPlies = (uint16_t)request->arg("maxPlies").toInt();
+    if (request->hasArg("eco")) {
+      String eco = request->arg("eco");
+      eco.toUpperCase();
+      strlcpy(filter.ecoPrefix, eco.c_str(), sizeof(filter.ecoPrefix));
+    }
+    uint16_t offset = request->hasArg("offset") ? (uint16_t)request->arg("offset").toInt() : 0;
+    uint16_t limit = request->hasArg("limit") ? (uint16_t)request->arg("limit").toInt() : UINT16_MAX;
+
+    String json = moveHistory->getGameListJSON(filter, offset, limit);
+    if (json.isEmpty()) {
+      sendJsonError(request, 503, "Game catalog is busy, try again");
+      return;
+    }
+    request->send(200, "application/json", json);
+  }
+}
+
+void WiFiManagerESP32::handleGameSearch(AsyncWebServerRequest* request) {
+  if (!request->hasArg("fen")) {
+    sendJsonError(request, 400, "Missing fen parameter");
+    return;
+  }
+
+  uint64_t hash;
+  {
+    char board[8][8];
+    char turn = 'w';
+    ChessEngine engine;
+    ChessUtils::fenToBoard(request->arg("fen"), board, turn, &engine);
+    int row, col;
+    if (!engine.findKingPosition(board, 'w', row, col) || !engine.findKingPosition(board, 'b', row, col)) {
+      sendJsonError(request, 400, "Invalid FEN");
+      return;
+    }
+    hash = engine.computeZobristHash(board, turn);
+  }
+
+  String json = moveHistory->getPositionSearchJSON(hash);
+  if (json.isEmpty()) {
+    sendJsonError(request, 503, "Position index is busy, try again");
+    return;
   }
+  request->send(200, "application/json", json);
 }
 
 void WiFiManagerESP32::handleDeleteGame(AsyncWebServerRequest* request) {
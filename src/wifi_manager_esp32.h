@@ -2,7 +2,12 @@
 #define WIFI_MANAGER_ESP32_H
 
 #include "board_driver.h"
+#include "board_snapshot.h"
+#include "chess_clock.h"
+#include "opening_trie.h"
+#include "puzzle_pack.h"
 #include "stockfish_settings.h"
+#include "wifi_connector.h"
 #include <Arduino.h>
 #include <AsyncTCP.h>
 #include <ESPAsyncWebServer.h>
@@ -10,10 +15,15 @@
 #include <Preferences.h>
 #include <WiFi.h>
 #include <array>
+#include <atomic>
 
 // Forward declarations
 struct LichessConfig;
+class GameArena;
+class LoopStats;
 class MoveHistory;
+class NetworkActor;
+class StockfishCache;
 
 // ---------------------------
 // WiFi Configuration
@@ -31,27 +41,10 @@ static constexpr uint8_t MAX_SAVED_NETWORKS = 3;
 // WiFi state machine stabilization delay before disabling AP
 static constexpr unsigned long AP_STABILIZATION_MS = 10000; // 10 seconds
 
-// Reconnection backoff intervals (ms)
-static constexpr unsigned long RECONNECT_INITIAL_MS = 5000;
-static constexpr unsigned long RECONNECT_MAX_MS = 60000;
-
-// ---------------------------
-// WiFi State Machine
-// ---------------------------
-enum class WiFiState {
-  AP_ONLY,       // No STA connection, AP is active
-  CONNECTING,    // Attempting STA connection, AP is active
-  CONNECTED,     // STA connected, AP disabled after stabilization
-  RECONNECTING   // STA lost, AP re-enabled, attempting reconnection
-};
-
-// ---------------------------
-// Saved Network Entry
-// ---------------------------
-struct SavedNetwork {
-  String ssid;
-  String password;
-};
+// Network startup runs on its own task after setup() (see startNetwork())
+static constexpr int NETWORK_START_TASK_STACK = 8192;
+static constexpr int NETWORK_START_TASK_CORE = 0;
+static constexpr unsigned long NETWORK_START_POLL_MS = 50;
 
 // ---------------------------
 // WiFi Manager Class for ESP32
@@ -64,11 +57,13 @@ class WiFiManagerESP32 {
   String lichessToken;
 
   BotConfig botConfig = {StockfishSettings::medium(), true};
+  LanEngineSettings lanEngineSettings; // Saved in NVS, copied into botConfig when a game picks the LAN engine
 
   MoveHistory* moveHistory;
   BoardDriver* boardDriver;
-  String currentFen;
-  float boardEvaluation;
+  WiFiLink* wifiLink;
+  BoardSnapshot boardSnapshot;                    // Written by the game loop, read by HTTP handlers
+  char lastMove[BOARD_SNAPSHOT_MOVE_SIZE] = "";  // Game loop only, published with the next board state
 
   // Board edit storage (pending edits from web interface)
   String pendingFenEdit;
@@ -77,26 +72,65 @@ class WiFiManagerESP32 {
   // Resign flag (set from web interface)
   bool hasPendingResign = false;
 
+  // Analysis mode state (JSON published by ChessAnalysis, empty when inactive)
+  String analysisJson;
+  bool hasPendingAnalysisHint = false;
+
+  // Puzzle mode state (JSON published by ChessPuzzle, empty when inactive)
+  String puzzleJson;
+  int puzzleRating = PUZZLE_DEFAULT_RATING;
+
+  // Opening trainer state (JSON published by ChessOpening, empty when inactive)
+  String openingJson;
+  bool hasPendingOpeningHint = false;
+  char openingColor = ' '; // ' ' = the repertoire's own side
+
+  // Game clock (time control chosen on the web page, applied to Chess Moves and Bot games)
+  TimeControl timeControl = {ClockMode::NONE, 0, 0};
+  const ChessClock* clock = nullptr;
+
+  // Network actor queue metrics (GET /debug/bus)
+  const NetworkActor* networkActor = nullptr;
+
+  // The board's diagnostics (GET/DELETE /debug/loop, /debug/heap, /debug/stockfish-cache)
+  LoopStats* loopStats = nullptr;
+  const GameArena* gameArena = nullptr;
+  StockfishCache* stockfishCache = nullptr;
+
+  // Data file upload (written to a temp file, validated, then renamed over the target)
+  File dataUploadFile;
+  String dataUploadError;
+
   // tracks errors across multi-file OTA uploads
   bool otaHasError = false;
   String otaErrorMessage;
 
-  // --- WiFi State Machine ---
-  WiFiState wifiState = WiFiState::AP_ONLY;
+  // --- WiFi State Machine (see WiFiConnector) ---
+  WiFiConnector connector;
   TimerHandle_t apStabilizationTimer = nullptr;
-  unsigned long reconnectInterval = RECONNECT_INITIAL_MS;
-  unsigned long lastReconnectAttempt = 0;
-  uint8_t reconnectNetworkIndex = 0;
   bool apActive = true;
+  std::atomic<bool> networkStarting{false};
 
   // --- Known-Networks Registry ---
+  // Written only by the task running serviceWiFi(): web handlers stage additions
+  // here and post removals to the connector
   std::array<SavedNetwork, MAX_SAVED_NETWORKS> savedNetworks;
   uint8_t networkCount = 0;
-  int8_t connectedNetworkIndex = -1; // Index of currently connected network, -1 if none
+  SavedNetwork stagedNetwork; // Added (or its password replaced) by the next serviceWiFi()
+  std::atomic<bool> hasStagedNetwork{false};
 
+  /// Load the saved networks, Lichess token and LAN engine from NVS (false if NVS is unusable).
+  bool loadSettings();
   void loadNetworks();
   void saveNetworks();
-  bool connectToNetwork(uint8_t index);
+  /// Add the staged network, or give the saved one of that SSID its password. True if anything changed.
+  bool applyStagedNetwork();
+  /// Registry index of the `listed`-th network in GET /wifi/networks (pending removals are not listed), or -1.
+  int registryIndex(int listed);
+  /// Store one network's fast-connect entry without rewriting the registry.
+  void saveFastConnect(uint8_t index);
+  static void networkStartTask(void* param);
+  void startNetwork();
 
   // --- OTA Password ---
   String otaPasswordHash; // SHA-256 hex, empty = no password set
@@ -108,8 +142,9 @@ class WiFiManagerESP32 {
   String generateRandomHex(size_t bytes) const;
 
   // --- WiFi Event Handler ---
-  static void onWiFiEvent(WiFiEvent_t event, WiFiEventInfo_t info);
-  static WiFiManagerESP32* instance; // Singleton for event callback
+  void onWiFiEvent(WiFiEvent_t event); // Registered as a lambda capturing this
+  /// Advance the connector and react to what changed. Network task during startup, loop task after.
+  void serviceWiFi();
   void handleWiFiConnected();
   void handleWiFiDisconnected();
   static void apStabilizationCallback(TimerHandle_t timer);
@@ -121,7 +156,20 @@ class WiFiManagerESP32 {
   String getScanResultsJSON();
   String getBoardUpdateJSON();
   String getLichessInfoJSON();
+  String getEngineSettingsJSON();
   String getBoardSettingsJSON();
+  String getClockJSON();
+  String getLatencyJSON();
+  String getLoopStatsJSON();
+  String getBusStatsJSON();
+  String getStockfishCacheJSON();
+  String getLogJSON(uint32_t fromSeq);
+  String getBenchJSON();
+  String getHeapReportJSON();
+  String getBootJSON();
+  void handleTraceExport(AsyncWebServerRequest* request);
+  void handleProfileStart(AsyncWebServerRequest* request);
+  void handleProfileExport(AsyncWebServerRequest* request);
   void handleBoardEditSuccess(AsyncWebServerRequest* request);
   void handleAddNetwork(AsyncWebServerRequest* request);
   void handleDeleteNetwork(AsyncWebServerRequest* request);
@@ -129,18 +177,39 @@ class WiFiManagerESP32 {
   void handleWiFiScan(AsyncWebServerRequest* request);
   void handleGameSelection(AsyncWebServerRequest* request);
   void handleSaveLichessToken(AsyncWebServerRequest* request);
+  void handleSaveEngineSettings(AsyncWebServerRequest* request);
   void handleBoardSettings(AsyncWebServerRequest* request);
   void handleBoardCalibration(AsyncWebServerRequest* request);
   void handleOtaResult(AsyncWebServerRequest* request);
   void handleOtaUpload(AsyncWebServerRequest* request, const String& filename, size_t index, uint8_t* data, size_t len, bool final);
   void handleOtaPassword(AsyncWebServerRequest* request);
   void handleGamesRequest(AsyncWebServerRequest* request);
+  void handleGameSearch(AsyncWebServerRequest* request);
   void handleDeleteGame(AsyncWebServerRequest* request);
 
  public:
-  WiFiManagerESP32(BoardDriver* boardDriver, MoveHistory* moveHistory);
+  /// A LittleFS data file that can be replaced through a multipart upload.
+  struct DataFileSpec {
+    const char* path;
+    const char* tempPath;
+    const char* label;    // For log and error messages
+    const char* countKey; // JSON key for the record count in the response
+    bool (*validate)(File& file, uint32_t& count);
+  };
+
+ private:
+  void handleDataFileResult(AsyncWebServerRequest* request, const DataFileSpec& spec);
+  void handleDataFileUpload(AsyncWebServerRequest* request, const DataFileSpec& spec, bool inUse, const String& filename, size_t index, uint8_t* data, size_t len, bool final);
+
+ public:
+  WiFiManagerESP32(BoardDriver* boardDriver, MoveHistory* moveHistory, WiFiLink* wifiLink);
+  /// Load saved settings, then start the network stack (AP, saved networks, mDNS, web server,
+  /// NTP) on a background task so the board is usable without waiting for WiFi.
   void begin();
   void update(); // Called from loop() — handles reconnection
+  bool isNetworkStarting() const { return networkStarting.load(); }
+  /// Wait (servicing the board, see CooperativeWait) until startup has tried the saved networks.
+  void waitForNetworkStart();
 
   // Configuration getters
   // Game selection via web
@@ -153,17 +222,47 @@ class WiFiManagerESP32 {
   String getLichessToken() { return lichessToken; }
   // Board state management (FEN-based)
   void updateBoardState(const String& fen, float evaluation = 0.0f);
-  String getCurrentFen() const { return currentFen; }
-  float getEvaluation() const { return boardEvaluation; }
+  /// The last applied move (UCI), published with the next updateBoardState(). Pass fromRow < 0 to clear.
+  void noteLastMove(int fromRow, int fromCol, int toRow, int toCol, char promotion);
+  String getCurrentFen() const;
+  float getEvaluation() const;
   // Board edit management (FEN-based)
   bool getPendingBoardEdit(String& fenOut);
   void clearPendingEdit();
   // Web resign
   bool getPendingResign() const { return hasPendingResign; }
   void clearPendingResign() { hasPendingResign = false; }
+  // Analysis mode
+  void updateAnalysis(const String& json) { analysisJson = json; }
+  void clearAnalysis() {
+    analysisJson = "";
+    hasPendingAnalysisHint = false;
+  }
+  bool getPendingAnalysisHint() const { return hasPendingAnalysisHint; }
+  void clearPendingAnalysisHint() { hasPendingAnalysisHint = false; }
+  // Puzzle mode
+  int getPuzzleRating() const { return puzzleRating; }
+  void updatePuzzle(const String& json) { puzzleJson = json; }
+  void clearPuzzle() { puzzleJson = ""; }
+  // Opening trainer
+  char getOpeningColor() const { return openingColor; }
+  void updateOpening(const String& json) { openingJson = json; }
+  void clearOpening() {
+    openingJson = "";
+    hasPendingOpeningHint = false;
+  }
+  bool getPendingOpeningHint() const { return hasPendingOpeningHint; }
+  void clearPendingOpeningHint() { hasPendingOpeningHint = false; }
+  // Game clock
+  void setClock(const ChessClock* c) { clock = c; }
+  void setNetworkActor(const NetworkActor* actor) { networkActor = actor; }
+  void setLoopStats(LoopStats* stats) { loopStats = stats; }
+  void setGameArena(const GameArena* arena) { gameArena = arena; }
+  void setStockfishCache(StockfishCache* cache) { stockfishCache = cache; }
+  TimeControl getTimeControl() const { return timeControl; }
   // WiFi state
-  WiFiState getWiFiState() const { return wifiState; }
-  bool isWiFiConnected() const { return wifiState == WiFiState::CONNECTED; }
+  WiFiState getWiFiState() const { return connector.state(); }
+  bool isWiFiConnected() const { return connector.state() == WiFiState::CONNECTED; }
 };
 
 #endif // WIFI_MANAGER_ESP32_H
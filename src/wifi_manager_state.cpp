@@ -0,0 +1,172 @@
+#include "wifi_manager_esp32.h"
+#include "chess_lichess.h"
+#include "chess_utils.h"
+#include "move_trace.h"
+#include <Arduino.h>
+#include <Preferences.h>
+
+// ---------------------------
+// WiFiManagerESP32: Settings and Board State
+// ---------------------------
+// The parts of the manager with no ESP-IDF or web-server dependency, shared by
+// the firmware (wifi_manager_esp32.cpp) and the native build (host/wifi_manager_host.cpp).
+
+static const char* INITIAL_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+WiFiManagerESP32::WiFiManagerESP32(BoardDriver* bd, MoveHistory* mh, WiFiLink* link) : boardDriver(bd), moveHistory(mh), wifiLink(link), server(AP_PORT), gameMode("0"), lichessToken(""), botConfig(), hasPendingEdit(false) {
+  boardSnapshot.publish(INITIAL_FEN, 0.0f, "");
+  connector.begin(link, savedNetworks.data(), &networkCount);
+}
+
+bool WiFiManagerESP32::loadSettings() {
+  if (!ChessUtils::ensureNvsInitialized()) {
+    Serial.println("NVS init failed - credentials not loaded");
+    return false;
+  }
+  loadNetworks();
+
+  // Load Lichess token
+  prefs.begin("lichess", false);
+  if (prefs.isKey("token")) {
+    lichessToken = prefs.getString("token", "");
+  }
+  prefs.end();
+  if (lichessToken.length() > 0) {
+    Serial.println("Lichess API token loaded from NVS");
+  }
+
+  // Load the LAN engine server
+  prefs.begin("engine", false);
+  if (prefs.isKey("host")) {
+    lanEngineSettings.host = prefs.getString("host", "");
+    lanEngineSettings.port = prefs.getUShort("port", lanEngineSettings.port);
+    lanEngineSettings.movetimeMs = prefs.getUInt("movetime", lanEngineSettings.movetimeMs);
+  }
+  prefs.end();
+  if (lanEngineSettings.isConfigured()) {
+    Serial.printf("LAN engine loaded from NVS: %s:%u\n", lanEngineSettings.host.c_str(), lanEngineSettings.port);
+  }
+  return true;
+}
+
+// ===========================
+// Known-Networks Registry
+// ===========================
+
+void WiFiManagerESP32::loadNetworks() {
+  prefs.begin("wifiNets", true);
+  networkCount = prefs.getUChar("count", 0);
+  if (networkCount > MAX_SAVED_NETWORKS) networkCount = MAX_SAVED_NETWORKS;
+
+  for (uint8_t i = 0; i < networkCount; i++) {
+    savedNetworks[i].ssid = prefs.getString(("ssid" + String(i)).c_str(), "");
+    savedNetworks[i].password = prefs.getString(("pass" + String(i)).c_str(), "");
+    String fastKey = "fast" + String(i);
+    if (prefs.getBytesLength(fastKey.c_str()) != sizeof(WiFiFastConnect) || prefs.getBytes(fastKey.c_str(), &savedNetworks[i].fast, sizeof(WiFiFastConnect)) != sizeof(WiFiFastConnect))
+      savedNetworks[i].fast = WiFiFastConnect();
+  }
+  prefs.end();
+
+  Serial.printf("Loaded %d saved network(s)\n", networkCount);
+}
+
+void WiFiManagerESP32::saveNetworks() {
+  if (!ChessUtils::ensureNvsInitialized()) {
+    Serial.println("NVS init failed - networks not saved");
+    return;
+  }
+  Preferences netPrefs; // Not `prefs`: this runs on the loop task while web handlers may hold that one
+  netPrefs.begin("wifiNets", false);
+  netPrefs.clear(); // Clear all keys first to handle deletions
+  netPrefs.putUChar("count", networkCount);
+  for (uint8_t i = 0; i < networkCount; i++) {
+    netPrefs.putString(("ssid" + String(i)).c_str(), savedNetworks[i].ssid);
+    netPrefs.putString(("pass" + String(i)).c_str(), savedNetworks[i].password);
+    if (savedNetworks[i].fast.channel != 0)
+      netPrefs.putBytes(("fast" + String(i)).c_str(), &savedNetworks[i].fast, sizeof(WiFiFastConnect));
+  }
+  netPrefs.end();
+}
+
+bool WiFiManagerESP32::applyStagedNetwork() {
+  if (!hasStagedNetwork.load())
+    return false;
+  uint8_t i = 0;
+  while (i < networkCount && savedNetworks[i].ssid != stagedNetwork.ssid)
+    i++;
+  bool added = i == networkCount;
+  if (added && networkCount >= MAX_SAVED_NETWORKS) {
+    hasStagedNetwork = false; // Filled up by another addition since the handler checked
+    return false;
+  }
+  savedNetworks[i].ssid = stagedNetwork.ssid;
+  savedNetworks[i].password = stagedNetwork.password;
+  if (added)
+    networkCount++;
+  else
+    savedNetworks[i].lease = WiFiLease(); // New password, maybe a new network behind the SSID
+  hasStagedNetwork = false;
+  Serial.printf("WiFi: %s network '%s' (%d/%d)\n", added ? "added" : "updated", stagedNetwork.ssid.c_str(), networkCount, MAX_SAVED_NETWORKS);
+  return true;
+}
+
+void WiFiManagerESP32::saveFastConnect(uint8_t index) {
+  if (!ChessUtils::ensureNvsInitialized()) return;
+  Preferences fastPrefs; // Not `prefs`: this runs on the loop task while web handlers may hold that one
+  fastPrefs.begin("wifiNets", false);
+  fastPrefs.putBytes(("fast" + String(index)).c_str(), &savedNetworks[index].fast, sizeof(WiFiFastConnect));
+  fastPrefs.end();
+}
+
+// ===========================
+// Board State
+// ===========================
+
+LichessConfig WiFiManagerESP32::getLichessConfig() {
+  LichessConfig config;
+  config.apiToken = lichessToken;
+  return config;
+}
+
+void WiFiManagerESP32::updateBoardState(const String& fen, float evaluation) {
+  boardSnapshot.publish(fen.c_str(), evaluation, lastMove);
+  MoveTrace::webPublished();
+}
+
+void WiFiManagerESP32::noteLastMove(int fromRow, int fromCol, int toRow, int toCol, char promotion) {
+  if (fromRow < 0) {
+    lastMove[0] = '\0';
+    return;
+  }
+  snprintf(lastMove, sizeof(lastMove), "%c%d%c%d", 'a' + fromCol, 8 - fromRow, 'a' + toCol, 8 - toRow);
+  if (promotion != ' ' && promotion != '\0') {
+    lastMove[4] = (char)tolower(promotion);
+    lastMove[5] = '\0';
+  }
+}
+
+String WiFiManagerESP32::getCurrentFen() const {
+  BoardState state;
+  boardSnapshot.read(state);
+  return String(state.fen);
+}
+
+float WiFiManagerESP32::getEvaluation() const {
+  BoardState state;
+  boardSnapshot.read(state);
+  return state.evaluation;
+}
+
+bool WiFiManagerESP32::getPendingBoardEdit(String& fenOut) {
+  if (hasPendingEdit) {
+    fenOut = pendingFenEdit;
+    return true;
+  }
+  return false;
+}
+
+void WiFiManagerESP32::clearPendingEdit() {
+  lastMove[0] = '\0';
+  boardSnapshot.publish(pendingFenEdit.c_str(), getEvaluation(), lastMove);
+  hasPendingEdit = false;
+}
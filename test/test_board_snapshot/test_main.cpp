@@ -0,0 +1,120 @@
+#include "board_snapshot.h"
+#include <atomic>
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+#include <unity.h>
+#include <vector>
+
+// ---------------------------
+// BoardSnapshot seqlock
+// ---------------------------
+// One writer publishing as fast as it can while several readers copy the
+// state. Every field of a publish is derived from its version number, so a
+// reader can rebuild what a complete snapshot of that version must hold and
+// any mix of two publishes shows up as a mismatch.
+
+static constexpr uint32_t PUBLISHES = 200000;
+static constexpr int READERS = 4;
+
+// Different lengths, so a torn copy also leaves the tail of a longer FEN behind
+static const char* const BASE_FENS[] = {
+  "8/8/8/8/8/8/8/K6k w - - 0",
+  "rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0",
+  "r1bq1rk1/pp2bppp/2n1pn2/2pp4/3P4/2PBPN2/PP1N1PPP/R1BQ1RK1 w - c6 0",
+};
+static const char* const MOVES[] = {"", "e2e4", "g1f3", "e7e8q", "a7a8n"};
+
+struct Expected {
+  char fen[BOARD_SNAPSHOT_FEN_SIZE];
+  const char* lastMove;
+  float evaluation;
+  uint16_t moveNumber;
+};
+
+static Expected expectedFor(uint32_t version) {
+  Expected e;
+  e.moveNumber = (uint16_t)(version % 500 + 1);
+  snprintf(e.fen, sizeof(e.fen), "%s %u", BASE_FENS[version % 3], e.moveNumber);
+  e.lastMove = MOVES[version % 5];
+  e.evaluation = (float)(version % 2000) / 100.0f - 10.0f;
+  return e;
+}
+
+static void publishVersion(BoardSnapshot& snapshot, uint32_t version) {
+  Expected e = expectedFor(version);
+  snapshot.publish(e.fen, e.evaluation, e.lastMove);
+}
+
+static bool isComplete(const BoardState& state) {
+  if (state.version == 0)
+    return state.fen[0] == '\0' && state.lastMove[0] == '\0' && state.moveNumber == 0;
+  Expected e = expectedFor(state.version);
+  return strcmp(state.fen, e.fen) == 0 && strcmp(state.lastMove, e.lastMove) == 0 &&
+         state.evaluation == e.evaluation && state.moveNumber == e.moveNumber;
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_readers_never_see_a_torn_snapshot() {
+  BoardSnapshot snapshot;
+  std::atomic<bool> writing{true};
+  std::atomic<uint32_t> torn{0}, backwards{0};
+  std::vector<uint32_t> reads(READERS, 0);
+
+  std::vector<std::thread> readers;
+  for (int r = 0; r < READERS; r++) {
+    readers.emplace_back([&, r] {
+      uint32_t lastVersion = 0;
+      BoardState state;
+      while (writing.load(std::memory_order_relaxed)) {
+        snapshot.read(state);
+        if (!isComplete(state))
+          torn++;
+        if (state.version < lastVersion)
+          backwards++;
+        lastVersion = state.version;
+        reads[r]++;
+      }
+    });
+  }
+
+  for (uint32_t version = 1; version <= PUBLISHES; version++)
+    publishVersion(snapshot, version);
+  writing = false;
+  for (std::thread& reader : readers)
+    reader.join();
+
+  for (int r = 0; r < READERS; r++)
+    TEST_ASSERT_GREATER_THAN_UINT32(0, reads[r]);
+  TEST_ASSERT_EQUAL_UINT32(0, torn.load());
+  TEST_ASSERT_EQUAL_UINT32(0, backwards.load());
+
+  BoardState last;
+  snapshot.read(last);
+  TEST_ASSERT_EQUAL_UINT32(PUBLISHES, last.version);
+  TEST_ASSERT_TRUE(isComplete(last));
+}
+
+void test_long_fen_is_truncated_and_terminated() {
+  BoardSnapshot snapshot;
+  char longFen[BOARD_SNAPSHOT_FEN_SIZE * 2];
+  memset(longFen, 'p', sizeof(longFen) - 1);
+  longFen[sizeof(longFen) - 1] = '\0';
+  snapshot.publish(longFen, 0.5f, "e2e4");
+
+  BoardState state;
+  snapshot.read(state);
+  TEST_ASSERT_EQUAL_UINT32(1, state.version);
+  TEST_ASSERT_EQUAL_size_t(BOARD_SNAPSHOT_FEN_SIZE - 1, strlen(state.fen));
+  TEST_ASSERT_EQUAL_STRING("e2e4", state.lastMove);
+  TEST_ASSERT_EQUAL_UINT16(1, state.moveNumber); // No move-number field: defaults to 1
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_readers_never_see_a_torn_snapshot);
+  RUN_TEST(test_long_fen_is_truncated_and_terminated);
+  return UNITY_END();
+}
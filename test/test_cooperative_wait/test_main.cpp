@@ -0,0 +1,155 @@
+#include "cooperative_wait.h"
+#include <host_platform.h>
+#include <unity.h>
+
+// ---------------------------
+// CooperativeWait
+// ---------------------------
+// sleep() with a fake service standing in for main.cpp's background work.
+// The clock is virtual, so the delays cost nothing and the recorded gaps are
+// the requested sleeps plus a little CPU time.
+
+static constexpr uint32_t SLACK_US = 1000; // CPU time the virtual clock counts on top of the delays
+
+static CooperativeWait* waits = nullptr; // A fresh one per test, as a board's BoardDriver holds it
+
+struct FakeService {
+  uint32_t calls = 0;
+  unsigned long lastCallMs = 0;
+  uint32_t workMs = 0;     // Time each run spends, like a WiFi tick
+  bool waitInside = false; // Blocks in a wait of its own, as a nested mode would
+};
+
+static void runFake(void* context) {
+  FakeService* fake = static_cast<FakeService*>(context);
+  fake->calls++;
+  fake->lastCallMs = millis();
+  if (fake->workMs)
+    delay(fake->workMs);
+  if (fake->waitInside)
+    waits->sleep(1);
+}
+
+void setUp() {
+  HostClock::setVirtual(true);
+  waits = new CooperativeWait();
+}
+
+void tearDown() {
+  delete waits;
+  waits = nullptr;
+}
+
+void test_sleep_without_service_only_delays() {
+  unsigned long start = millis();
+  waits->sleep(50);
+  TEST_ASSERT_GREATER_OR_EQUAL(50, millis() - start);
+
+  CooperativeWaitStats stats;
+  waits->snapshot(stats);
+  TEST_ASSERT_EQUAL_UINT32(0, stats.ticks);
+}
+
+void test_sleep_runs_service_before_delaying() {
+  FakeService fake;
+  waits->setService(runFake, &fake);
+  unsigned long before = millis();
+  waits->sleep(100);
+  TEST_ASSERT_EQUAL_UINT32(1, fake.calls);
+  TEST_ASSERT_LESS_THAN(before + 100, fake.lastCallMs); // Ran first, not after the delay
+}
+
+void test_wait_loop_services_every_pass() {
+  FakeService fake;
+  waits->setService(runFake, &fake);
+  for (int pass = 0; pass < 10; pass++)
+    waits->sleep(20);
+
+  CooperativeWaitStats stats;
+  waits->snapshot(stats);
+  TEST_ASSERT_EQUAL_UINT32(10, fake.calls);
+  TEST_ASSERT_EQUAL_UINT32(10, stats.ticks);
+  TEST_ASSERT_UINT32_WITHIN(SLACK_US, 20000, stats.avgGapUs);
+  TEST_ASSERT_UINT32_WITHIN(SLACK_US, 20000, stats.maxGapUs);
+}
+
+void test_service_time_is_measured_apart_from_gaps() {
+  FakeService fake;
+  fake.workMs = 3;
+  waits->setService(runFake, &fake);
+  for (int pass = 0; pass < 4; pass++)
+    waits->sleep(10);
+
+  CooperativeWaitStats stats;
+  waits->snapshot(stats);
+  TEST_ASSERT_UINT32_WITHIN(SLACK_US, 3000, stats.avgServiceUs);
+  TEST_ASSERT_UINT32_WITHIN(SLACK_US, 3000, stats.maxServiceUs);
+  TEST_ASSERT_UINT32_WITHIN(SLACK_US, 10000, stats.avgGapUs); // End of one run to start of the next
+}
+
+void test_wait_inside_service_does_not_recurse() {
+  FakeService fake;
+  fake.waitInside = true;
+  waits->setService(runFake, &fake);
+  waits->sleep(5);
+  waits->sleep(5);
+  TEST_ASSERT_EQUAL_UINT32(2, fake.calls);
+
+  CooperativeWaitStats stats;
+  waits->snapshot(stats);
+  TEST_ASSERT_EQUAL_UINT32(2, stats.ticks);
+}
+
+void test_reset_and_unregister() {
+  FakeService fake;
+  waits->setService(runFake, &fake);
+  waits->sleep(5);
+  waits->sleep(5);
+  waits->reset();
+
+  CooperativeWaitStats stats;
+  waits->snapshot(stats);
+  TEST_ASSERT_EQUAL_UINT32(0, stats.ticks);
+  TEST_ASSERT_EQUAL_UINT32(0, stats.maxGapUs);
+
+  // The first run after a reset has no previous run to measure a gap from
+  waits->sleep(5);
+  waits->snapshot(stats);
+  TEST_ASSERT_EQUAL_UINT32(1, stats.ticks);
+  TEST_ASSERT_EQUAL_UINT32(0, stats.maxGapUs);
+
+  waits->setService(nullptr, nullptr);
+  waits->sleep(5);
+  TEST_ASSERT_EQUAL_UINT32(3, fake.calls);
+}
+
+void test_boards_keep_their_own_service_and_stats() {
+  FakeService fakeA, fakeB;
+  CooperativeWait other;
+  waits->setService(runFake, &fakeA);
+  other.setService(runFake, &fakeB);
+  waits->sleep(5);
+  waits->sleep(5);
+  other.sleep(5);
+  TEST_ASSERT_EQUAL_UINT32(2, fakeA.calls);
+  TEST_ASSERT_EQUAL_UINT32(1, fakeB.calls);
+
+  CooperativeWaitStats stats;
+  other.snapshot(stats);
+  TEST_ASSERT_EQUAL_UINT32(1, stats.ticks);
+  waits->reset();
+  other.snapshot(stats);
+  TEST_ASSERT_EQUAL_UINT32(1, stats.ticks);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_sleep_without_service_only_delays);
+  RUN_TEST(test_sleep_runs_service_before_delaying);
+  RUN_TEST(test_wait_loop_services_every_pass);
+  RUN_TEST(test_service_time_is_measured_apart_from_gaps);
+  RUN_TEST(test_wait_inside_service_does_not_recurse);
+  RUN_TEST(test_reset_and_unregister);
+  RUN_TEST(test_boards_keep_their_own_service_and_stats);
+  return UNITY_END();
+}
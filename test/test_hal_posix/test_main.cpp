@@ -0,0 +1,116 @@
+#include "board_driver.h"
+#include "host/hal_posix.h"
+#include <host_platform.h>
+#include <unity.h>
+
+// ---------------------------
+// POSIX HAL
+// ---------------------------
+// The native implementations behave like the ESP32 ones where BoardDriver
+// relies on it: exact-length settings reads and a calibration that survives a
+// restart and maps the virtual matrix square for square.
+
+static const char* TEST_DIR = ".pio/test_hal_posix";
+
+void setUp() {
+  HostPlatform::removeTree(TEST_DIR);
+  HostPlatform::setDataDir(TEST_DIR);
+  HostClock::setVirtual(true);
+}
+
+void tearDown() {
+  HostPlatform::removeTree(TEST_DIR);
+}
+
+void test_settings_round_trip() {
+  FileSettingsStore store;
+  TEST_ASSERT_TRUE(store.isAvailable());
+  TEST_ASSERT_EQUAL_UINT8(7, store.getUChar("ns", "missing", 7));
+  store.putUChar("ns", "u8", 42);
+  TEST_ASSERT_EQUAL_UINT8(42, store.getUChar("ns", "u8", 0));
+
+  uint32_t value = 0xDEADBEEF, readBack = 0;
+  store.putBytes("ns", "blob", &value, sizeof(value));
+  TEST_ASSERT_TRUE(store.getBytes("ns", "blob", &readBack, sizeof(readBack)));
+  TEST_ASSERT_EQUAL_UINT32(value, readBack);
+}
+
+void test_settings_length_must_match() {
+  FileSettingsStore store;
+  uint32_t value = 1;
+  store.putBytes("ns", "blob", &value, sizeof(value));
+  uint16_t shorter;
+  uint64_t longer;
+  TEST_ASSERT_FALSE(store.getBytes("ns", "blob", &shorter, sizeof(shorter)));
+  TEST_ASSERT_FALSE(store.getBytes("ns", "blob", &longer, sizeof(longer)));
+}
+
+void test_settings_clear_only_touches_namespace() {
+  FileSettingsStore store;
+  store.putUChar("a", "k", 1);
+  store.putUChar("b", "k", 2);
+  store.clear("a");
+  TEST_ASSERT_EQUAL_UINT8(0, store.getUChar("a", "k", 0));
+  TEST_ASSERT_EQUAL_UINT8(2, store.getUChar("b", "k", 0));
+}
+
+static void scanSettled(BoardDriver& board) {
+  board.readSensors();
+  delay(DEBOUNCE_MS + 1);
+  board.readSensors();
+}
+
+// Drivers that began stay alive: their animation task keeps running (as on the board, nothing stops it)
+
+void test_identity_calibration_maps_squares() {
+  static PosixLedOutput leds(LED_COUNT);
+  static VirtualSensorMatrix sensors;
+  static FileSettingsStore settings;
+  static BoardDriver board(&leds, &sensors, &settings);
+  board.saveIdentityCalibration();
+  board.begin();
+  board.waitForAnimationQueueDrain();
+
+  sensors.setOccupied(1, 6, true);
+  sensors.setOccupied(7, 0, true);
+  scanSettled(board);
+  for (int row = 0; row < NUM_ROWS; row++)
+    for (int col = 0; col < NUM_COLS; col++)
+      TEST_ASSERT_EQUAL((row == 1 && col == 6) || (row == 7 && col == 0), board.getSensorState(row, col));
+
+  board.clearAllLEDs(false);
+  board.setSquareLED(2, 5, LedColors::White);
+  board.showLEDs();
+  LedRGB lit = leds.pixel(2 * NUM_COLS + 5);
+  TEST_ASSERT_TRUE(lit.r > 0 || lit.g > 0 || lit.b > 0);
+  LedRGB dark = leds.pixel(5 * NUM_COLS + 2);
+  TEST_ASSERT_TRUE(dark.r == 0 && dark.g == 0 && dark.b == 0);
+}
+
+void test_calibration_survives_restart() {
+  static PosixLedOutput leds(LED_COUNT);
+  static VirtualSensorMatrix sensors;
+  static FileSettingsStore settings;
+  {
+    BoardDriver first(&leds, &sensors, &settings);
+    first.saveIdentityCalibration();
+  }
+  // A second driver over the same flash loads the mapping instead of prompting for calibration
+  static BoardDriver board(&leds, &sensors, &settings);
+  board.begin();
+  board.waitForAnimationQueueDrain();
+  sensors.setOccupied(4, 3, true);
+  scanSettled(board);
+  TEST_ASSERT_TRUE(board.getSensorState(4, 3));
+  TEST_ASSERT_FALSE(board.getSensorState(3, 4));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_settings_round_trip);
+  RUN_TEST(test_settings_length_must_match);
+  RUN_TEST(test_settings_clear_only_touches_namespace);
+  RUN_TEST(test_identity_calibration_maps_squares);
+  RUN_TEST(test_calibration_survives_restart);
+  return UNITY_END();
+}
@@ -0,0 +1,164 @@
+#include "network_actor.h"
+#include "spsc_queue.h"
+#include <host_platform.h>
+#include <thread>
+#include <unity.h>
+
+// ---------------------------
+// SpscQueue and NetworkActor
+// ---------------------------
+// The queue's counters with explicit timestamps, then both of them across real
+// threads: a producer and a consumer thread for the queue, and the game loop
+// (this thread) and the "NetActor" task for the actor. The clock is real here:
+// latencies are measured between threads, and virtual time is per thread.
+
+static constexpr uint32_t STREAM_ITEMS = 100000;
+static constexpr uint32_t JOB_US = 2000;          // What a job spends, standing in for a TLS call
+static constexpr uint32_t LATENCY_BOUND_US = 500000; // A wake-up or a reply poll, with room for a loaded host
+
+void setUp() {
+  HostClock::setVirtual(false);
+}
+
+void tearDown() {}
+
+static uint32_t nowUs() {
+  return (uint32_t)HostClock::now();
+}
+
+// The task runs for good, as on the board, so an actor is never destroyed
+static NetworkActor* startActor() {
+  NetworkActor* actor = new NetworkActor();
+  TEST_ASSERT_TRUE(actor->begin());
+  return actor;
+}
+
+void test_queue_counts_depth_drops_and_wait() {
+  SpscQueue<int, 4> queue;
+  TEST_ASSERT_TRUE(queue.push(1, 100));
+  TEST_ASSERT_TRUE(queue.push(2, 200));
+  TEST_ASSERT_TRUE(queue.push(3, 300));
+  TEST_ASSERT_FALSE(queue.push(4, 400)); // Capacity is N - 1
+
+  int item = 0;
+  TEST_ASSERT_TRUE(queue.pop(item, 600));
+  TEST_ASSERT_EQUAL_INT(1, item);
+  TEST_ASSERT_TRUE(queue.pop(item, 600));
+  TEST_ASSERT_TRUE(queue.pop(item, 600));
+  TEST_ASSERT_EQUAL_INT(3, item);
+  TEST_ASSERT_FALSE(queue.pop(item, 700));
+  TEST_ASSERT_TRUE(queue.isEmpty());
+
+  SpscQueueStats stats;
+  queue.snapshot(stats);
+  TEST_ASSERT_EQUAL_UINT32(3, stats.pushed);
+  TEST_ASSERT_EQUAL_UINT32(1, stats.dropped);
+  TEST_ASSERT_EQUAL_UINT32(3, stats.maxDepth);
+  TEST_ASSERT_EQUAL_UINT32(400, stats.avgWaitUs); // 500, 400 and 300
+  TEST_ASSERT_EQUAL_UINT32(500, stats.maxWaitUs);
+}
+
+void test_queue_passes_a_stream_between_threads_in_order() {
+  static SpscQueue<uint32_t, 16> queue;
+  uint32_t received = 0;
+  bool inOrder = true;
+  std::thread consumer([&] {
+    uint32_t item;
+    while (received < STREAM_ITEMS) {
+      if (!queue.pop(item, nowUs())) {
+        std::this_thread::yield();
+        continue;
+      }
+      if (item != received)
+        inOrder = false;
+      received++;
+    }
+  });
+  std::thread producer([] {
+    for (uint32_t i = 0; i < STREAM_ITEMS; i++)
+      while (!queue.push(i, nowUs()))
+        std::this_thread::yield();
+  });
+  producer.join();
+  consumer.join();
+
+  TEST_ASSERT_TRUE(inOrder);
+  TEST_ASSERT_EQUAL_UINT32(STREAM_ITEMS, received);
+  TEST_ASSERT_TRUE(queue.isEmpty());
+  SpscQueueStats stats;
+  queue.snapshot(stats);
+  TEST_ASSERT_EQUAL_UINT32(STREAM_ITEMS, stats.pushed); // Full-queue retries count as drops, not pushes
+  TEST_ASSERT_GREATER_OR_EQUAL(1, stats.maxDepth);
+  TEST_ASSERT_LESS_OR_EQUAL(15, stats.maxDepth);
+  TEST_ASSERT_LESS_OR_EQUAL(stats.maxWaitUs, stats.avgWaitUs);
+}
+
+void test_actor_runs_work_on_its_task_and_waits_for_it() {
+  NetworkActor* actor = startActor();
+  const char* ranOn = nullptr;
+  bool done = false;
+  actor->run([&] {
+    ranOn = pcTaskGetName(xTaskGetCurrentTaskHandle());
+    delayMicroseconds(JOB_US);
+    done = true;
+  });
+  TEST_ASSERT_TRUE(done); // run() returned only after the job finished
+  TEST_ASSERT_EQUAL_STRING("NetActor", ranOn);
+}
+
+void test_actor_reports_queue_depth_and_latency() {
+  NetworkActor* actor = startActor();
+  static constexpr uint32_t JOBS = 20;
+  for (uint32_t i = 0; i < JOBS; i++)
+    actor->run([] { delayMicroseconds(JOB_US); });
+
+  NetworkActorStats stats;
+  actor->snapshot(stats);
+  TEST_ASSERT_EQUAL_UINT32(JOBS, stats.jobs);
+  TEST_ASSERT_EQUAL_UINT32(JOBS, stats.requests.pushed);
+  TEST_ASSERT_EQUAL_UINT32(JOBS, stats.replies.pushed);
+  TEST_ASSERT_EQUAL_UINT32(0, stats.requests.dropped);
+  TEST_ASSERT_EQUAL_UINT32(1, stats.requests.maxDepth); // One job in flight at a time
+  TEST_ASSERT_EQUAL_UINT32(1, stats.replies.maxDepth);
+  TEST_ASSERT_GREATER_OR_EQUAL(JOB_US, stats.avgRunUs);
+  TEST_ASSERT_LESS_OR_EQUAL(stats.maxRunUs, stats.avgRunUs);
+  TEST_ASSERT_LESS_THAN(LATENCY_BOUND_US, stats.requests.maxWaitUs); // Notified, not polled
+  TEST_ASSERT_LESS_THAN(LATENCY_BOUND_US, stats.replies.maxWaitUs);  // Polled every NET_REPLY_POLL_MS
+}
+
+void test_actor_waits_through_the_cooperative_wait() {
+  NetworkActor* actor = startActor();
+  CooperativeWait waits;
+  uint32_t serviced = 0;
+  waits.setService([](void* context) { (*static_cast<uint32_t*>(context))++; }, &serviced);
+  actor->setCooperativeWait(&waits);
+  actor->run([] { delay(10 * NET_REPLY_POLL_MS); });
+  TEST_ASSERT_GREATER_OR_EQUAL(2, serviced); // The game loop's background work ran while the job was out
+
+  CooperativeWaitStats stats;
+  waits.snapshot(stats);
+  TEST_ASSERT_EQUAL_UINT32(serviced, stats.ticks);
+}
+
+void test_actor_runs_inline_until_started() {
+  NetworkActor actor;
+  const char* ranOn = nullptr;
+  actor.run([&] { ranOn = pcTaskGetName(xTaskGetCurrentTaskHandle()); });
+  TEST_ASSERT_EQUAL_STRING("loopTask", ranOn);
+
+  NetworkActorStats stats;
+  actor.snapshot(stats);
+  TEST_ASSERT_EQUAL_UINT32(0, stats.jobs);
+  TEST_ASSERT_EQUAL_UINT32(0, stats.requests.pushed);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_queue_counts_depth_drops_and_wait);
+  RUN_TEST(test_queue_passes_a_stream_between_threads_in_order);
+  RUN_TEST(test_actor_runs_work_on_its_task_and_waits_for_it);
+  RUN_TEST(test_actor_reports_queue_depth_and_latency);
+  RUN_TEST(test_actor_waits_through_the_cooperative_wait);
+  RUN_TEST(test_actor_runs_inline_until_started);
+  return UNITY_END();
+}
@@ -0,0 +1,160 @@
+#include "profiler.h"
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <host_platform.h>
+#include <link.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <unity.h>
+#include <vector>
+
+// ---------------------------
+// SIGPROF Profiler
+// ---------------------------
+// End to end on Linux: burn CPU in a known function, read the capture file
+// back the way GET /debug/profile serves it, and check the samples land in
+// that function with the right core bit, under the build id sha256sum gives
+// for this very program.
+
+static volatile uint32_t sink;
+
+// Arithmetic only, no calls: every sample taken while it runs has its PC in here
+__attribute__((noinline)) static void burnCpu(uint64_t realUs) {
+  uint64_t until = HostClock::realMicros() + realUs;
+  uint32_t x = 1;
+  while (HostClock::realMicros() < until)
+    for (int i = 0; i < 1000000; i++)
+      x = x * 1664525u + 1013904223u;
+  sink = x;
+}
+
+// The code of burnCpu lies well inside this many bytes from its entry
+static constexpr uintptr_t BURN_CPU_SPAN = 512;
+
+static uintptr_t programBias() {
+  uintptr_t bias = 0;
+  dl_iterate_phdr([](struct dl_phdr_info* info, size_t, void* out) {
+    *(uintptr_t*)out = (uintptr_t)info->dlpi_addr;
+    return 1;
+  }, &bias);
+  return bias;
+}
+
+static std::vector<uint8_t> readCapture() {
+  std::vector<uint8_t> file(Profiler::captureSize());
+  size_t offset = 0, n;
+  while ((n = Profiler::readCapture(offset, file.data() + offset, 1000)) > 0) // Odd chunks, as the web server reads it
+    offset += n;
+  file.resize(offset);
+  return file;
+}
+
+static void waitForWindow() {
+  while (Profiler::isRunning())
+    HostClock::realSleepMicros(10000);
+}
+
+void setUp() {}
+void tearDown() {
+  Profiler::release();
+}
+
+void test_samples_land_in_the_busy_function() {
+  TEST_ASSERT_TRUE(Profiler::start(1));
+  TEST_ASSERT_FALSE(Profiler::start(1)); // One capture at a time
+  burnCpu(1200000);
+  waitForWindow();
+
+  std::vector<uint8_t> file = readCapture();
+  TEST_ASSERT_GREATER_OR_EQUAL(sizeof(ProfileHeader), file.size());
+  ProfileHeader header;
+  memcpy(&header, file.data(), sizeof(header));
+  TEST_ASSERT_EQUAL_MEMORY(PROFILE_MAGIC, header.magic, 4);
+  TEST_ASSERT_EQUAL_UINT16(PROFILE_VERSION, header.version);
+  TEST_ASSERT_EQUAL_size_t(sizeof(ProfileHeader) + header.sampleCount * 4, file.size());
+  TEST_ASSERT_UINT32_WITHIN(300, 1000, header.durationMs);
+  TEST_ASSERT_GREATER_OR_EQUAL(50, header.sampleCount); // 200/s of CPU time, one busy thread
+
+  uintptr_t entry = (uintptr_t)&burnCpu - programBias();
+  uint32_t inBurn = 0;
+  for (uint32_t i = 0; i < header.sampleCount; i++) {
+    uint32_t sample;
+    memcpy(&sample, file.data() + sizeof(ProfileHeader) + 4 * i, 4);
+    TEST_ASSERT_TRUE(sample & PROFILE_CORE_BIT); // The test thread is the loop task's core
+    uint32_t pc = sample & ~PROFILE_CORE_BIT;
+    if (pc != PROFILE_OUTSIDE && pc >= entry && pc < entry + BURN_CPU_SPAN)
+      inBurn++;
+  }
+  TEST_ASSERT_GREATER_OR_EQUAL(header.sampleCount * 8 / 10, inBurn);
+}
+
+static std::atomic<bool> burnerDone{false};
+
+void test_core_bit_follows_the_task() {
+  TEST_ASSERT_TRUE(Profiler::start(1));
+  xTaskCreatePinnedToCore([](void*) {
+    burnCpu(1200000);
+    burnerDone = true;
+    vTaskDelete(nullptr);
+  }, "Burn0", 4096, nullptr, 1, nullptr, 0);
+  while (!burnerDone.load())
+    HostClock::realSleepMicros(10000); // Mostly asleep: the samples belong to the core 0 task
+  waitForWindow();
+
+  std::vector<uint8_t> file = readCapture();
+  ProfileHeader header;
+  memcpy(&header, file.data(), sizeof(header));
+  uint32_t core0 = 0;
+  for (uint32_t i = 0; i < header.sampleCount; i++) {
+    uint32_t sample;
+    memcpy(&sample, file.data() + sizeof(ProfileHeader) + 4 * i, 4);
+    core0 += (sample & PROFILE_CORE_BIT) == 0;
+  }
+  TEST_ASSERT_GREATER_OR_EQUAL(50, header.sampleCount);
+  TEST_ASSERT_GREATER_OR_EQUAL(header.sampleCount * 9 / 10, core0);
+}
+
+void test_idle_window_closes_on_time() {
+  TEST_ASSERT_TRUE(Profiler::start(1));
+  HostClock::realSleepMicros(1100000); // No CPU used, so no signal arrives to close it
+  TEST_ASSERT_FALSE(Profiler::isRunning());
+  TEST_ASSERT_GREATER_OR_EQUAL(sizeof(ProfileHeader), Profiler::captureSize());
+}
+
+void test_build_id_is_the_program_sha256() {
+  TEST_ASSERT_TRUE(Profiler::start(1));
+  burnCpu(100000);
+  HostClock::realSleepMicros(1000000);
+  waitForWindow();
+  std::vector<uint8_t> file = readCapture();
+  ProfileHeader header;
+  memcpy(&header, file.data(), sizeof(header));
+
+  char exe[512];
+  ssize_t len = readlink("/proc/self/exe", exe, sizeof(exe) - 1);
+  TEST_ASSERT_GREATER_THAN(0, len);
+  exe[len] = '\0';
+  char command[600];
+  snprintf(command, sizeof(command), "sha256sum '%s'", exe);
+  FILE* pipe = popen(command, "r");
+  TEST_ASSERT_NOT_NULL(pipe);
+  char expected[65] = {};
+  TEST_ASSERT_EQUAL(1, fscanf(pipe, "%64s", expected));
+  pclose(pipe);
+
+  char actual[65];
+  for (int i = 0; i < 32; i++)
+    snprintf(actual + 2 * i, 3, "%02x", header.elfSha256[i]);
+  TEST_ASSERT_EQUAL_STRING(expected, actual);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_samples_land_in_the_busy_function);
+  RUN_TEST(test_core_bit_follows_the_task);
+  RUN_TEST(test_idle_window_closes_on_time);
+  RUN_TEST(test_build_id_is_the_program_sha256);
+  return UNITY_END();
+}
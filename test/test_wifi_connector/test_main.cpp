@@ -0,0 +1,235 @@
+#include "host/hal_posix.h"
+#include "wifi_connector.h"
+#include <thread>
+#include <unity.h>
+
+// ---------------------------
+// WiFiConnector against SimWiFiLink
+// ---------------------------
+// The connector on a simulated radio with a clock the test steps, so blips,
+// channel moves, removals and the give-up retry play out in milliseconds.
+
+static constexpr unsigned long STEP_MS = 10;
+
+struct Rig {
+  SimWiFiLink link;
+  SavedNetwork networks[3];
+  uint8_t count = 0;
+  WiFiConnector connector;
+  unsigned long now = 1000;
+
+  int add(const char* ssid, uint8_t channel) {
+    networks[count].ssid = ssid;
+    networks[count].password = "password";
+    count++;
+    return link.addAccessPoint(ssid, "password", channel);
+  }
+
+  void begin() {
+    connector.begin(&link, networks, &count);
+    link.attach(&connector);
+  }
+
+  WiFiConnectorEvent step() {
+    now += STEP_MS;
+    link.advance(now);
+    return connector.tick(now);
+  }
+
+  /// Step until `wanted` is returned or `limitMs` passes.
+  bool runUntil(WiFiConnectorEvent wanted, unsigned long limitMs) {
+    for (unsigned long waited = 0; waited < limitMs; waited += STEP_MS)
+      if (step() == wanted)
+        return true;
+    return false;
+  }
+
+  void connectFirst() {
+    connector.requestConnect(-1);
+    TEST_ASSERT_TRUE(runUntil(WiFiConnectorEvent::CONNECTED, 20000));
+  }
+};
+
+void setUp() {}
+void tearDown() {}
+
+void test_first_join_scans_and_caches() {
+  Rig rig;
+  int ap = rig.add("home", 6);
+  rig.begin();
+  unsigned long start = rig.now;
+  rig.connectFirst();
+
+  TEST_ASSERT_GREATER_OR_EQUAL(SimWiFiLink::DEFAULT_SCAN_JOIN_MS + SimWiFiLink::DEFAULT_DHCP_MS, rig.now - start);
+  TEST_ASSERT_TRUE(rig.connector.cacheRefreshed());
+  TEST_ASSERT_EQUAL_UINT8(6, rig.networks[0].fast.channel);
+  TEST_ASSERT_EQUAL_MEMORY(rig.link.accessPoint(ap).bssid, rig.networks[0].fast.bssid, 6);
+  TEST_ASSERT_EQUAL_UINT32(rig.link.accessPoint(ap).lease.ip, rig.networks[0].lease.ip);
+  TEST_ASSERT_EQUAL(WiFiState::CONNECTED, rig.connector.state());
+}
+
+void test_blip_reconnects_on_cached_bssid_and_lease() {
+  Rig rig;
+  int ap = rig.add("home", 6);
+  rig.begin();
+  rig.connectFirst();
+
+  // Back before the connector's next tick, so the reconnect finds it where it was
+  rig.link.setAccessPointUp(ap, false);
+  rig.link.setAccessPointUp(ap, true);
+  TEST_ASSERT_EQUAL(WiFiConnectorEvent::LOST, rig.step());
+  TEST_ASSERT_TRUE(rig.runUntil(WiFiConnectorEvent::CONNECTED, 20000));
+
+  TEST_ASSERT_TRUE(rig.connector.wasReconnect());
+  TEST_ASSERT_EQUAL_UINT32(1, rig.connector.fastConnects());
+  TEST_ASSERT_EQUAL_UINT32(1, rig.link.stats().leaseReuses);
+  // Back on DHCP at once: the server must not hand the address out again
+  TEST_ASSERT_EQUAL_UINT32(1, rig.link.stats().leaseRenewals);
+  TEST_ASSERT_FALSE(rig.link.onStaticAddress());
+  TEST_ASSERT_LESS_OR_EQUAL(SimWiFiLink::DEFAULT_FAST_JOIN_MS + 2 * STEP_MS, rig.connector.lastReconnectMs());
+}
+
+void test_old_lease_is_not_reused() {
+  Rig rig;
+  int ap = rig.add("home", 6);
+  rig.begin();
+  rig.connectFirst();
+  unsigned long firstLease = rig.networks[0].lease.obtainedAt;
+
+  rig.now += LEASE_REUSE_MS;
+  rig.link.setAccessPointUp(ap, false);
+  rig.link.setAccessPointUp(ap, true);
+  TEST_ASSERT_EQUAL(WiFiConnectorEvent::LOST, rig.step());
+  TEST_ASSERT_TRUE(rig.runUntil(WiFiConnectorEvent::CONNECTED, 20000));
+
+  TEST_ASSERT_EQUAL_UINT32(0, rig.link.stats().leaseReuses);
+  TEST_ASSERT_GREATER_OR_EQUAL(SimWiFiLink::DEFAULT_FAST_JOIN_MS + SimWiFiLink::DEFAULT_DHCP_MS, rig.connector.lastReconnectMs());
+  TEST_ASSERT_GREATER_THAN(firstLease, rig.networks[0].lease.obtainedAt);
+}
+
+void test_channel_move_falls_back_to_scan() {
+  Rig rig;
+  int ap = rig.add("home", 6);
+  rig.begin();
+  rig.connectFirst();
+
+  rig.link.setAccessPointChannel(ap, 11);
+  TEST_ASSERT_EQUAL(WiFiConnectorEvent::LOST, rig.step());
+  TEST_ASSERT_TRUE(rig.runUntil(WiFiConnectorEvent::CONNECTED, 20000));
+
+  TEST_ASSERT_TRUE(rig.connector.cacheRefreshed());
+  TEST_ASSERT_EQUAL_UINT8(11, rig.networks[0].fast.channel);
+  TEST_ASSERT_GREATER_OR_EQUAL(FAST_CONNECT_TIMEOUT_MS + SimWiFiLink::DEFAULT_SCAN_JOIN_MS, rig.connector.lastReconnectMs());
+}
+
+void test_removing_connected_network_moves_to_next() {
+  Rig rig;
+  rig.add("first", 1);
+  rig.add("second", 6);
+  rig.begin();
+  rig.connectFirst();
+  TEST_ASSERT_EQUAL_INT8(0, rig.connector.connectedIndex());
+
+  rig.connector.requestRemoval(0);
+  TEST_ASSERT_EQUAL_UINT8(1, rig.connector.pendingRemovals());
+  TEST_ASSERT_EQUAL(WiFiConnectorEvent::LOST, rig.step());
+  TEST_ASSERT_TRUE(rig.connector.registryChanged());
+  TEST_ASSERT_EQUAL_UINT8(0, rig.connector.pendingRemovals());
+  TEST_ASSERT_EQUAL_UINT8(1, rig.count);
+  TEST_ASSERT_EQUAL_STRING("second", rig.networks[0].ssid.c_str());
+  TEST_ASSERT_EQUAL(-1, rig.link.associatedWith());
+
+  TEST_ASSERT_TRUE(rig.runUntil(WiFiConnectorEvent::CONNECTED, 20000));
+  TEST_ASSERT_EQUAL_INT8(0, rig.connector.connectedIndex());
+  TEST_ASSERT_EQUAL(1, rig.link.associatedWith());
+}
+
+void test_removals_posted_together_use_one_numbering() {
+  Rig rig;
+  rig.add("a", 1);
+  rig.add("b", 6);
+  rig.add("c", 11);
+  rig.begin();
+  rig.connector.requestConnect(2);
+  TEST_ASSERT_TRUE(rig.runUntil(WiFiConnectorEvent::CONNECTED, 20000));
+  uint32_t disconnects = rig.link.stats().disconnects;
+
+  rig.connector.requestRemoval(0);
+  rig.connector.requestRemoval(1);
+  TEST_ASSERT_EQUAL(WiFiConnectorEvent::NONE, rig.step());
+  TEST_ASSERT_EQUAL_UINT8(1, rig.count);
+  TEST_ASSERT_EQUAL_STRING("c", rig.networks[0].ssid.c_str());
+  TEST_ASSERT_EQUAL_INT8(0, rig.connector.connectedIndex());
+  TEST_ASSERT_EQUAL_UINT32(disconnects, rig.link.stats().disconnects); // The link was not on them
+}
+
+void test_removal_from_another_task_is_applied_by_tick() {
+  Rig rig;
+  rig.add("a", 1);
+  rig.add("b", 6);
+  rig.add("c", 11);
+  rig.begin();
+  rig.connector.requestConnect(2);
+  TEST_ASSERT_TRUE(rig.runUntil(WiFiConnectorEvent::CONNECTED, 20000));
+
+  // The web task posts while the owner keeps ticking; only tick() touches the registry
+  std::atomic<bool> posted{false};
+  std::thread web([&] {
+    rig.connector.requestRemoval(0);
+    posted = true;
+  });
+  while (!posted.load())
+    TEST_ASSERT_EQUAL(WiFiConnectorEvent::NONE, rig.step());
+  web.join();
+  rig.step();
+
+  TEST_ASSERT_EQUAL_UINT8(2, rig.count);
+  TEST_ASSERT_EQUAL_STRING("b", rig.networks[0].ssid.c_str());
+  TEST_ASSERT_EQUAL_INT8(1, rig.connector.connectedIndex());
+  TEST_ASSERT_EQUAL(WiFiState::CONNECTED, rig.connector.state());
+}
+
+void test_removing_attempted_network_tries_the_next() {
+  Rig rig;
+  rig.add("a", 1);
+  int b = rig.add("b", 6);
+  rig.begin();
+  rig.connector.requestConnect(-1);
+  rig.step(); // Scanning for "a"
+
+  rig.connector.requestRemoval(0);
+  TEST_ASSERT_EQUAL(WiFiConnectorEvent::NONE, rig.step());
+  TEST_ASSERT_EQUAL(WiFiState::CONNECTING, rig.connector.state());
+  TEST_ASSERT_TRUE(rig.runUntil(WiFiConnectorEvent::CONNECTED, 20000));
+  TEST_ASSERT_EQUAL(b, rig.link.associatedWith());
+}
+
+void test_gave_up_retries_slowly() {
+  Rig rig;
+  int ap = rig.add("home", 6);
+  rig.begin();
+  rig.link.setAccessPointUp(ap, false);
+  rig.connector.requestConnect(-1);
+  TEST_ASSERT_TRUE(rig.runUntil(WiFiConnectorEvent::GAVE_UP, 20000));
+  TEST_ASSERT_EQUAL(WiFiState::AP_ONLY, rig.connector.state());
+
+  rig.link.setAccessPointUp(ap, true);
+  uint32_t connects = rig.link.stats().connects;
+  TEST_ASSERT_FALSE(rig.runUntil(WiFiConnectorEvent::CONNECTED, GAVE_UP_RETRY_MS - 1000));
+  TEST_ASSERT_EQUAL_UINT32(connects, rig.link.stats().connects);
+  TEST_ASSERT_TRUE(rig.runUntil(WiFiConnectorEvent::CONNECTED, 20000));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_first_join_scans_and_caches);
+  RUN_TEST(test_blip_reconnects_on_cached_bssid_and_lease);
+  RUN_TEST(test_old_lease_is_not_reused);
+  RUN_TEST(test_channel_move_falls_back_to_scan);
+  RUN_TEST(test_removing_connected_network_moves_to_next);
+  RUN_TEST(test_removals_posted_together_use_one_numbering);
+  RUN_TEST(test_removal_from_another_task_is_applied_by_tick);
+  RUN_TEST(test_removing_attempted_network_tries_the_next);
+  RUN_TEST(test_gave_up_retries_slowly);
+  return UNITY_END();
+}
@@ -0,0 +1,199 @@
+"""
+Compile the Lichess opening tables into an ECO trie (eco.bin) that the board
+uses to classify games as they are saved.
+
+Input is the TSV files of https://github.com/lichess-org/chess-openings
+(a.tsv ... e.tsv, columns: eco, name, pgn). Every line is merged into a
+prefix trie from the starting position; the node where a line ends carries
+its ECO code. Nodes are written breadth-first as fixed 12-byte records, so
+the children of each position are one contiguous run, as in the opening
+trainer's trie. The layout is documented in src/eco_trie.h.
+
+Requires python-chess (`pip install chess`) to resolve SAN moves.
+
+Usage:
+    python tools/eco_trie.py chess-openings/*.tsv -o eco.bin
+    python tools/eco_trie.py a.tsv b.tsv --max-depth 24
+    python tools/eco_trie.py chess-openings/*.tsv --upload http://librechess.local
+"""
+
+import argparse
+import csv
+import struct
+import sys
+import urllib.request
+import uuid
+from collections import deque
+from pathlib import Path
+
+try:
+    import chess
+except ImportError:
+    sys.exit("python-chess is required: pip install chess")
+
+# Must match src/eco_trie.h
+MAGIC = b"OCEC"
+VERSION = 1
+NODE_SIZE = 12
+MAX_DEPTH = 40
+MAX_CHILDREN = 255  # EcoNode::childCount is one byte
+
+PROMOTION_CODES = {chess.QUEEN: 1, chess.ROOK: 2, chess.BISHOP: 3, chess.KNIGHT: 4}
+NODE = struct.Struct("<HHBBHI")
+
+
+def encode_move(move):
+    """Encode a move as MoveHistory::encodeMove does: [from:6][to:6][promotion:4], row 0 = rank 8."""
+    def index(square):
+        return (7 - chess.square_rank(square)) * 8 + chess.square_file(square)
+    promo = PROMOTION_CODES.get(move.promotion, 0)
+    return (index(move.from_square) << 10) | (index(move.to_square) << 4) | promo
+
+
+def encode_eco(eco):
+    """EcoTrie::encode(): 1 + volume * 100 + number, e.g. B90 -> 191."""
+    if len(eco) != 3 or eco[0] not in "ABCDE" or not eco[1:].isdigit():
+        return 0
+    return 1 + (ord(eco[0]) - ord("A")) * 100 + int(eco[1:])
+
+
+class TrieNode:
+    __slots__ = ("move", "children", "eco", "lines")
+
+    def __init__(self, move=0):
+        self.move = move
+        self.children = {}
+        self.eco = 0
+        self.lines = 0
+
+
+def read_lines(paths, max_depth):
+    """Returns (eco code, [encoded moves]) per opening line."""
+    lines = []
+    skipped = 0
+    for path in paths:
+        with open(path, encoding="utf-8", newline="") as f:
+            for row in csv.DictReader(f, delimiter="\t"):
+                code = encode_eco(row.get("eco", ""))
+                board = chess.Board()
+                moves = []
+                try:
+                    for token in row.get("pgn", "").split():
+                        if token[0].isdigit():
+                            continue  # Move number, e.g. "1." or "12..."
+                        moves.append(encode_move(board.push_san(token)))
+                except ValueError:
+                    moves = []
+                if code == 0 or not moves:
+                    skipped += 1
+                    continue
+                if len(moves) > max_depth:
+                    skipped += 1  # A deeper line would be classified by its prefix's code anyway
+                    continue
+                lines.append((code, moves))
+    if skipped:
+        print(f"Skipped {skipped} rows with errors or longer than {max_depth} plies")
+    return lines
+
+
+def build_trie(lines):
+    root = TrieNode()
+    for code, moves in lines:
+        node = root
+        for move in moves:
+            node = node.children.setdefault(move, TrieNode(move))
+            node.lines += 1
+        if node.eco == 0:
+            node.eco = code  # Several names can share a line: the first one listed wins
+    return root
+
+
+def flatten(root):
+    """Breadth-first order: the children of every node are contiguous. Most common moves come first."""
+    order = [root]
+    queue = deque([root])
+    while queue:
+        node = queue.popleft()
+        kids = sorted(node.children.values(), key=lambda c: -c.lines)
+        if len(kids) > MAX_CHILDREN:
+            print(f"Warning: position with {len(kids)} replies, keeping the {MAX_CHILDREN} most common")
+            kids = kids[:MAX_CHILDREN]
+        node.children = {c.move: c for c in kids}
+        order.extend(kids)
+        queue.extend(kids)
+    return order
+
+
+def serialize(order, max_depth, line_count):
+    index = {id(node): i for i, node in enumerate(order)}
+    out = bytearray()
+    out += struct.pack("<4sBBBBII", MAGIC, VERSION, NODE_SIZE, max_depth, 0, len(order), line_count)
+    for node in order:
+        kids = list(node.children.values())
+        first = index[id(kids[0])] if kids else 0
+        out += NODE.pack(node.move, node.eco, len(kids), 0, 0, first)
+    return bytes(out)
+
+
+def classify(pack, moves):
+    """Walk a game down the flat array as MoveHistory::catalogGame() does; returns the deepest code reached."""
+    base = 16
+    _, _, child_count, _, _, first = NODE.unpack_from(pack, base)
+    code = 0
+    for move in moves:
+        for i in range(child_count):
+            child = NODE.unpack_from(pack, base + (first + i) * NODE_SIZE)
+            if child[0] == move:
+                _, eco, child_count, _, _, first = child
+                code = eco or code
+                break
+        else:
+            break
+    return code
+
+
+def upload(pack, base_url, password):
+    boundary = uuid.uuid4().hex
+    body = (
+        f"--{boundary}\r\n"
+        'Content-Disposition: form-data; name="file"; filename="eco.bin"\r\n'
+        "Content-Type: application/octet-stream\r\n\r\n"
+    ).encode() + pack + f"\r\n--{boundary}--\r\n".encode()
+    request = urllib.request.Request(base_url.rstrip("/") + "/eco", data=body, method="POST")
+    request.add_header("Content-Type", f"multipart/form-data; boundary={boundary}")
+    if password:
+        request.add_header("X-OTA-Password", password)
+    with urllib.request.urlopen(request, timeout=120) as response:
+        print(response.read().decode())
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compile the Lichess opening tables into a LibreChess ECO trie")
+    parser.add_argument("tsv", nargs="+", help="chess-openings TSV files (eco, name, pgn)")
+    parser.add_argument("-o", "--output", default="eco.bin", help="output file (default: eco.bin)")
+    parser.add_argument("--max-depth", type=int, default=MAX_DEPTH, help=f"longest line kept, in plies (max {MAX_DEPTH})")
+    parser.add_argument("--upload", metavar="URL", help="upload to the board, e.g. http://librechess.local")
+    parser.add_argument("--password", help="OTA password, if one is set on the board")
+    args = parser.parse_args()
+
+    max_depth = min(args.max_depth, MAX_DEPTH)
+    lines = read_lines(args.tsv, max_depth)
+    if not lines:
+        sys.exit("No lines found")
+    root = build_trie(lines)
+    order = flatten(root)
+    pack = serialize(order, max(len(moves) for _, moves in lines), len(lines))
+    Path(args.output).write_bytes(pack)
+
+    # Every line must classify as itself or as an earlier line with the same moves
+    mismatched = sum(1 for code, moves in lines if classify(pack, moves) == 0)
+    print(f"Wrote {args.output}: {len(lines)} lines, {len(order)} nodes, {len(pack) / 1024:.1f} KB")
+    if mismatched:
+        print(f"Warning: {mismatched} lines don't classify (dropped by the child limit)")
+
+    if args.upload:
+        upload(pack, args.upload, args.password)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,103 @@
+"""
+Run the board's microbenchmarks (POST/GET /debug/bench) and compare runs.
+
+The board times the FEN/UCI codecs, the material evaluation, the move
+history codec, the Zobrist hash and the search's evaluation with fixed
+inputs and iteration counts
+(see src/microbench.h). This script starts a run, waits for it, saves the
+JSON and prints a table; given a baseline file it adds the change in the
+median per case, so two firmware builds can be compared by flashing one,
+saving, flashing the other and diffing.
+
+Usage:
+    python tools/microbench.py --board http://librechess.local --save before.json
+    python tools/microbench.py --board http://librechess.local --save after.json --baseline before.json
+    python tools/microbench.py after.json --baseline before.json
+
+The native build runs the same cases on the host and also counts heap
+allocations per call: `pio run -e native_bench` writes the JSON with
+`.pio/build/native_bench/program before.json`. Compare native runs with
+each other, not with the board.
+"""
+
+import argparse
+import json
+import sys
+import time
+import urllib.error
+import urllib.request
+from pathlib import Path
+
+# Changes in the median smaller than this are reported as noise
+NOISE_PERCENT = 3.0
+
+
+def run_on_board(base_url):
+    url = base_url.rstrip("/") + "/debug/bench"
+    request = urllib.request.Request(url, data=b"", method="POST")
+    try:
+        with urllib.request.urlopen(request, timeout=10) as response:
+            json.load(response)
+    except urllib.error.HTTPError as e:
+        if e.code != 409:  # 409: a run is already going, wait for it
+            raise
+    print("Benchmarking...")
+    for _ in range(60):
+        time.sleep(1)
+        with urllib.request.urlopen(url, timeout=10) as response:
+            result = json.load(response)
+        if not result["running"] and result["cases"]:
+            return result
+    sys.exit("Benchmark did not finish")
+
+
+def load(path):
+    result = json.loads(Path(path).read_text())
+    if not result.get("cases"):
+        sys.exit(f"{path}: no benchmark results")
+    return result
+
+
+def print_table(result, baseline):
+    print(f"Build {result['build']} ({result['version']}), {result['batches']} batches, {result['elapsedMs']} ms")
+    if baseline:
+        print(f"Baseline {baseline['build']} ({baseline['version']})")
+    before = {c["name"]: c for c in baseline["cases"]} if baseline else {}
+    allocs = all("allocsPerCall" in c for c in result["cases"])  # Native runs only
+    print(f"\n{'case':<20} {'calls':>6} {'min ns':>8} {'median ns':>10} {'heap':>5}" + (f" {'allocs':>7}" if allocs else "") + ("  change" if baseline else ""))
+    for c in result["cases"]:
+        line = f"{c['name']:<20} {c['calls']:>6} {c['minNs']:>8} {c['medianNs']:>10} {c['heapBlocks']:>5}"
+        if allocs:
+            line += f" {c['allocsPerCall']:>7.2f}"
+        old = before.get(c["name"])
+        if old and old["medianNs"] > 0:
+            change = 100.0 * (c["medianNs"] - old["medianNs"]) / old["medianNs"]
+            line += f"  {change:+6.1f}%" + ("" if abs(change) >= NOISE_PERCENT else " (noise)")
+        elif baseline:
+            line += "  new"
+        print(line)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Run and compare /debug/bench microbenchmarks")
+    parser.add_argument("result", nargs="?", help="saved result to print (instead of --board)")
+    parser.add_argument("--board", metavar="URL", help="run on the board, e.g. http://librechess.local")
+    parser.add_argument("--save", help="with --board, write the result JSON here")
+    parser.add_argument("--baseline", help="earlier result JSON to compare against")
+    args = parser.parse_args()
+
+    if args.board:
+        result = run_on_board(args.board)
+        if args.save:
+            # Sorted keys and one case per line keep saved runs diffable
+            Path(args.save).write_text(json.dumps(result, indent=1, sort_keys=True) + "\n")
+    elif args.result:
+        result = load(args.result)
+    else:
+        parser.error("pass a result file or --board")
+
+    print_table(result, load(args.baseline) if args.baseline else None)
+
+
+if __name__ == "__main__":
+    main()
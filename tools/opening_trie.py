@@ -0,0 +1,209 @@
+"""
+Compile PGN opening repertoires into a move trie (openings.bin) for the
+board's Opening Trainer mode.
+
+Every game and every variation (RAV) in the PGN files becomes a line from
+the starting position. Lines are merged into a prefix trie and written
+breadth-first as fixed 12-byte nodes, so the children of each position are
+one contiguous run. The layout is documented in src/opening_trie.h.
+
+Requires python-chess (`pip install chess`) to resolve SAN moves.
+
+Usage:
+    python tools/opening_trie.py white_repertoire.pgn --side w -o openings.bin
+    python tools/opening_trie.py a.pgn b.pgn --side b --max-depth 24
+    python tools/opening_trie.py rep.pgn --side w --upload http://librechess.local
+"""
+
+import argparse
+import random
+import struct
+import sys
+import time
+import urllib.request
+import uuid
+from collections import deque
+from pathlib import Path
+
+try:
+    import chess
+    import chess.pgn
+except ImportError:
+    sys.exit("python-chess is required: pip install chess")
+
+# Must match src/opening_trie.h
+MAGIC = b"OCOT"
+VERSION = 1
+NODE_SIZE = 12
+MAX_CHILDREN = 32
+MAX_DEPTH = 40
+NODE_LINE_END = 0x01
+
+PROMOTION_CODES = {chess.QUEEN: 1, chess.ROOK: 2, chess.BISHOP: 3, chess.KNIGHT: 4}
+NODE = struct.Struct("<HHBBHI")
+
+
+def encode_move(move):
+    """Encode a move as MoveHistory::encodeMove does: [from:6][to:6][promotion:4], row 0 = rank 8."""
+    def index(square):
+        return (7 - chess.square_rank(square)) * 8 + chess.square_file(square)
+    promo = PROMOTION_CODES.get(move.promotion, 0)
+    return (index(move.from_square) << 10) | (index(move.to_square) << 4) | promo
+
+
+class TrieNode:
+    __slots__ = ("move", "children", "line_end", "lines")
+
+    def __init__(self, move=0):
+        self.move = move
+        self.children = {}
+        self.line_end = False
+        self.lines = 0
+
+
+def collect_lines(node, board, line, max_depth, out):
+    """Depth-first walk of a PGN game tree, yielding every main line and variation."""
+    if not node.variations or len(line) >= max_depth:
+        out.append(list(line))
+        return
+    for variation in node.variations:
+        move = variation.move
+        line.append(encode_move(move))
+        board.push(move)
+        collect_lines(variation, board, line, max_depth, out)
+        board.pop()
+        line.pop()
+
+
+def read_lines(paths, max_depth):
+    lines = []
+    skipped = 0
+    for path in paths:
+        with open(path, encoding="utf-8", errors="replace") as f:
+            while True:
+                game = chess.pgn.read_game(f)
+                if game is None:
+                    break
+                if game.errors or game.board().fen() != chess.STARTING_FEN:
+                    skipped += 1
+                    continue
+                collect_lines(game, game.board(), [], max_depth, lines)
+    if skipped:
+        print(f"Skipped {skipped} games with errors or a custom starting position")
+    return [line for line in lines if line]
+
+
+def build_trie(lines):
+    root = TrieNode()
+    for line in lines:
+        node = root
+        for move in line:
+            node = node.children.setdefault(move, TrieNode(move))
+        node.line_end = True
+
+    def count(node):
+        # A line that ends inside a longer one still counts as its own line
+        node.lines = (1 if node.line_end else 0) + sum(count(c) for c in node.children.values())
+        return node.lines
+
+    count(root)
+    return root
+
+
+def flatten(root):
+    """Breadth-first order: the children of every node are contiguous."""
+    order = [root]
+    queue = deque([root])
+    while queue:
+        node = queue.popleft()
+        kids = sorted(node.children.values(), key=lambda c: -c.lines)
+        if len(kids) > MAX_CHILDREN:
+            print(f"Warning: position with {len(kids)} replies, keeping the {MAX_CHILDREN} most common")
+            kids = kids[:MAX_CHILDREN]
+        node.children = {c.move: c for c in kids}
+        order.extend(kids)
+        queue.extend(kids)
+    return order
+
+
+def serialize(order, side, max_depth):
+    index = {id(node): i for i, node in enumerate(order)}
+    out = bytearray()
+    root = order[0]
+    out += struct.pack("<4sBBcBII", MAGIC, VERSION, NODE_SIZE, side.encode(), max_depth, len(order), root.lines)
+    for node in order:
+        kids = list(node.children.values())
+        first = index[id(kids[0])] if kids else 0
+        flags = NODE_LINE_END if node.line_end else 0
+        out += NODE.pack(node.move, min(node.lines, 0xFFFF), len(kids), flags, 0, first)
+    return bytes(out)
+
+
+def benchmark(pack, lines, samples=20000):
+    """Walk random repertoire lines over the flat array the way the board does: one child-run read per ply."""
+    base = 16
+    rng = random.Random(0)
+    plies = 0
+    start = time.perf_counter()
+    for _ in range(samples):
+        line = rng.choice(lines)
+        move_, lines_, child_count, flags, _, first = NODE.unpack_from(pack, base)
+        for move in line:
+            found = False
+            for i in range(child_count):
+                child = NODE.unpack_from(pack, base + (first + i) * NODE_SIZE)
+                if child[0] == move:
+                    _, _, child_count, _, _, first = child
+                    found = True
+                    break
+            if not found:
+                break
+            plies += 1
+    elapsed = time.perf_counter() - start
+    return elapsed / max(plies, 1) * 1e9, plies
+
+
+def upload(pack, base_url, password):
+    boundary = uuid.uuid4().hex
+    body = (
+        f"--{boundary}\r\n"
+        'Content-Disposition: form-data; name="file"; filename="openings.bin"\r\n'
+        "Content-Type: application/octet-stream\r\n\r\n"
+    ).encode() + pack + f"\r\n--{boundary}--\r\n".encode()
+    request = urllib.request.Request(base_url.rstrip("/") + "/openings", data=body, method="POST")
+    request.add_header("Content-Type", f"multipart/form-data; boundary={boundary}")
+    if password:
+        request.add_header("X-OTA-Password", password)
+    with urllib.request.urlopen(request, timeout=120) as response:
+        print(response.read().decode())
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compile PGN repertoires into a LibreChess opening trie")
+    parser.add_argument("pgn", nargs="+", help="PGN files (variations are included)")
+    parser.add_argument("--side", choices=["w", "b"], required=True, help="color the repertoire is for")
+    parser.add_argument("-o", "--output", default="openings.bin", help="output file (default: openings.bin)")
+    parser.add_argument("--max-depth", type=int, default=MAX_DEPTH, help=f"plies kept per line (max {MAX_DEPTH})")
+    parser.add_argument("--upload", metavar="URL", help="upload to the board, e.g. http://librechess.local")
+    parser.add_argument("--password", help="OTA password, if one is set on the board")
+    args = parser.parse_args()
+
+    max_depth = min(args.max_depth, MAX_DEPTH)
+    lines = read_lines(args.pgn, max_depth)
+    if not lines:
+        sys.exit("No lines found")
+    root = build_trie(lines)
+    order = flatten(root)
+    pack = serialize(order, args.side, max(len(line) for line in lines))
+    Path(args.output).write_bytes(pack)
+
+    ns_per_ply, plies = benchmark(pack, lines)
+    print(f"Wrote {args.output}: {root.lines} lines, {len(order)} nodes, {len(pack) / 1024:.1f} KB")
+    print(f"Lookup: {ns_per_ply:.0f} ns per ply on this machine ({plies} plies walked)")
+
+    if args.upload:
+        upload(pack, args.upload, args.password)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,167 @@
+"""
+Build a puzzle pack (puzzles.bin) for the board's Puzzle mode from the
+Lichess puzzle database CSV (https://database.lichess.org/#puzzles).
+
+The pack layout is documented in src/puzzle_pack.h. Puzzles are sorted by
+rating into fixed-width buckets so the board can pick one near a target
+rating with a single seek and read.
+
+Usage:
+    python tools/puzzle_pack.py lichess_db_puzzle.csv -o puzzles.bin
+    python tools/puzzle_pack.py lichess_db_puzzle.csv --per-bucket 200 --themes mateIn2,fork
+    python tools/puzzle_pack.py lichess_db_puzzle.csv --upload http://librechess.local
+
+Decompress the .csv.zst download first (e.g. `zstd -d lichess_db_puzzle.csv.zst`).
+"""
+
+import argparse
+import csv
+import random
+import struct
+import sys
+import urllib.request
+import uuid
+from pathlib import Path
+
+# Must match src/puzzle_pack.h
+MAGIC = b"OCPZ"
+VERSION = 1
+RECORD_SIZE = 128
+MAX_BUCKETS = 64
+MAX_MOVES = 14
+FEN_SIZE = 88
+ID_SIZE = 8
+
+PROMOTION_CODES = {"q": 1, "r": 2, "b": 3, "n": 4}
+
+
+def square_index(square):
+    """Board index as used by MoveHistory::encodeMove (row 0 = rank 8)."""
+    col = ord(square[0]) - ord("a")
+    row = 8 - int(square[1])
+    if not (0 <= col < 8 and 0 <= row < 8):
+        raise ValueError(f"bad square '{square}'")
+    return row * 8 + col
+
+
+def encode_move(uci):
+    """Encode a UCI move as [from:6][to:6][promotion:4]."""
+    from_sq = square_index(uci[0:2])
+    to_sq = square_index(uci[2:4])
+    promo = PROMOTION_CODES[uci[4]] if len(uci) > 4 else 0
+    return (from_sq << 10) | (to_sq << 4) | promo
+
+
+def encode_record(puzzle):
+    fen = puzzle["fen"].encode("ascii")
+    moves = [encode_move(m) for m in puzzle["moves"]]
+    moves += [0] * (MAX_MOVES - len(moves))
+    return struct.pack(
+        f"<{FEN_SIZE}s{ID_SIZE}sHBB{MAX_MOVES}H",
+        fen,
+        puzzle["id"].encode("ascii"),
+        puzzle["rating"],
+        len(puzzle["moves"]),
+        0,
+        *moves,
+    )
+
+
+def read_puzzles(path, args):
+    themes = set(args.themes.split(",")) if args.themes else None
+    skipped = 0
+    puzzles = []
+    with open(path, newline="", encoding="utf-8") as f:
+        for row in csv.DictReader(f):
+            moves = row["Moves"].split()
+            fen = row["FEN"]
+            rating = int(row["Rating"])
+            if len(fen) >= FEN_SIZE or len(row["PuzzleId"]) > ID_SIZE or not 2 <= len(moves) <= MAX_MOVES:
+                skipped += 1
+                continue
+            if int(row["Popularity"]) < args.min_popularity:
+                continue
+            if themes and not themes.intersection(row["Themes"].split()):
+                continue
+            if not args.min_rating <= rating < args.max_rating:
+                continue
+            puzzles.append({"id": row["PuzzleId"], "fen": fen, "moves": moves, "rating": rating})
+    if skipped:
+        print(f"Skipped {skipped} puzzles that do not fit a {RECORD_SIZE}-byte record")
+    return puzzles
+
+
+def build_pack(puzzles, args):
+    width = args.bucket_width
+    bucket_count = min(MAX_BUCKETS, (args.max_rating - args.min_rating + width - 1) // width)
+    buckets = [[] for _ in range(bucket_count)]
+    for p in puzzles:
+        b = min((p["rating"] - args.min_rating) // width, bucket_count - 1)
+        buckets[b].append(p)
+
+    rng = random.Random(args.seed)
+    records = []
+    index = []
+    for bucket in buckets:
+        if args.per_bucket and len(bucket) > args.per_bucket:
+            bucket = rng.sample(bucket, args.per_bucket)
+        bucket.sort(key=lambda p: p["rating"])
+        index.append((len(records), len(bucket)))
+        records.extend(bucket)
+
+    out = bytearray()
+    out += struct.pack("<4sBBBBHHI", MAGIC, VERSION, RECORD_SIZE, bucket_count, 0, args.min_rating, width, len(records))
+    for first, count in index:
+        out += struct.pack("<II", first, count)
+    for p in records:
+        out += encode_record(p)
+    return bytes(out), len(records)
+
+
+def upload(pack, base_url, password):
+    boundary = uuid.uuid4().hex
+    body = (
+        f"--{boundary}\r\n"
+        'Content-Disposition: form-data; name="file"; filename="puzzles.bin"\r\n'
+        "Content-Type: application/octet-stream\r\n\r\n"
+    ).encode() + pack + f"\r\n--{boundary}--\r\n".encode()
+    request = urllib.request.Request(base_url.rstrip("/") + "/puzzles", data=body, method="POST")
+    request.add_header("Content-Type", f"multipart/form-data; boundary={boundary}")
+    if password:
+        request.add_header("X-OTA-Password", password)
+    with urllib.request.urlopen(request, timeout=300) as response:
+        print(response.read().decode())
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Build a LibreChess puzzle pack from the Lichess puzzle CSV")
+    parser.add_argument("csv", help="lichess_db_puzzle.csv (decompressed)")
+    parser.add_argument("-o", "--output", default="puzzles.bin", help="output pack file (default: puzzles.bin)")
+    parser.add_argument("--min-rating", type=int, default=400)
+    parser.add_argument("--max-rating", type=int, default=3200)
+    parser.add_argument("--bucket-width", type=int, default=50, help="rating span per bucket (default: 50)")
+    parser.add_argument("--per-bucket", type=int, default=150, help="max puzzles kept per bucket, 0 = all (default: 150)")
+    parser.add_argument("--min-popularity", type=int, default=80, help="drop puzzles with lower Lichess popularity (default: 80)")
+    parser.add_argument("--themes", help="comma-separated Lichess themes to keep (default: all)")
+    parser.add_argument("--seed", type=int, default=1, help="sampling seed for reproducible packs")
+    parser.add_argument("--upload", metavar="URL", help="upload the pack to the board, e.g. http://librechess.local")
+    parser.add_argument("--password", help="OTA password, if one is set on the board")
+    args = parser.parse_args()
+
+    if (args.max_rating - args.min_rating) / args.bucket_width > MAX_BUCKETS:
+        print(f"Rating range / bucket width exceeds {MAX_BUCKETS} buckets; ratings above "
+              f"{args.min_rating + MAX_BUCKETS * args.bucket_width} share the last bucket")
+
+    puzzles = read_puzzles(args.csv, args)
+    if not puzzles:
+        sys.exit("No puzzles matched the filters")
+    pack, count = build_pack(puzzles, args)
+    Path(args.output).write_bytes(pack)
+    print(f"Wrote {args.output}: {count} puzzles, {len(pack) / 1024:.0f} KB")
+
+    if args.upload:
+        upload(pack, args.upload, args.password)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,183 @@
+"""
+Symbolize a capture from the board's sampling profiler (GET /debug/profile)
+into a per-function table and folded stacks for a flame graph.
+
+The capture layout is documented in src/profiler.h: a 48-byte header with
+the SHA-256 of the firmware ELF, then one 32-bit sample per tick (program
+counter, core number in bit 31). Addresses are resolved with the toolchain's
+addr2line against the ELF of the exact build that produced the capture;
+the build id is checked so a stale ELF can't silently mislabel samples.
+
+Captures from the native build (firmware_main --profile=SECONDS:FILE) use
+the same layout with the program's link-time addresses; they are resolved
+with the host's addr2line against the native program, and PCs outside it
+(libc, vDSO) are grouped as one entry.
+
+Samples are flat (no call stacks), so the folded output has two frames per
+line, core and function. Load it in https://www.speedscope.app or pipe it to
+flamegraph.pl.
+
+Usage:
+    python tools/symbolize_profile.py profile.bin
+    python tools/symbolize_profile.py --board http://librechess.local --seconds 10
+    python tools/symbolize_profile.py profile.bin --elf .pio/build/esp32dev/firmware.elf --folded profile.folded
+    python tools/symbolize_profile.py profile.bin --elf .pio/build/native_firmware/program
+"""
+
+import argparse
+import hashlib
+import json
+import shutil
+import struct
+import subprocess
+import sys
+import time
+import urllib.error
+import urllib.request
+from collections import Counter
+from pathlib import Path
+
+# Must match src/profiler.h
+MAGIC = b"OCPF"
+VERSION = 1
+HEADER = struct.Struct("<4sHHII32s")
+CORE_BIT = 0x80000000
+OUTSIDE = 0x7FFFFFFF  # Native captures: a PC outside the program
+OUTSIDE_NAME = "[outside program]"
+EM_XTENSA = 94
+
+DEFAULT_ELF = Path(__file__).resolve().parent.parent / ".pio" / "build" / "esp32dev" / "firmware.elf"
+ADDR2LINE = "xtensa-esp32-elf-addr2line"
+
+
+def capture_from_board(base_url, seconds):
+    base = base_url.rstrip("/") + "/debug/profile"
+    request = urllib.request.Request(f"{base}?seconds={seconds}", data=b"", method="POST")
+    with urllib.request.urlopen(request, timeout=10) as response:
+        json.load(response)
+    print(f"Sampling for {seconds}s...")
+    time.sleep(seconds + 0.5)
+    for _ in range(20):
+        try:
+            with urllib.request.urlopen(base, timeout=30) as response:
+                return response.read()
+        except urllib.error.HTTPError as e:
+            if e.code != 409:  # 409: capture still running
+                raise
+        time.sleep(0.5)
+    sys.exit("Capture did not finish")
+
+
+def parse_capture(data):
+    if len(data) < HEADER.size:
+        sys.exit("Capture too short")
+    magic, version, sample_hz, count, duration_ms, elf_sha = HEADER.unpack_from(data)
+    if magic != MAGIC or version != VERSION:
+        sys.exit(f"Not a version {VERSION} profile capture")
+    if len(data) != HEADER.size + 4 * count:
+        sys.exit(f"Capture size mismatch: header says {count} samples, file holds {(len(data) - HEADER.size) // 4}")
+    samples = struct.unpack_from(f"<{count}I", data, HEADER.size)
+    return {"sample_hz": sample_hz, "duration_ms": duration_ms, "elf_sha": elf_sha.hex(), "samples": samples}
+
+
+def is_xtensa(elf):
+    header = elf.read_bytes()[:20]
+    endian = "<" if header[5] == 1 else ">"
+    return struct.unpack_from(endian + "H", header, 18)[0] == EM_XTENSA
+
+
+def find_addr2line(explicit, elf):
+    if explicit:
+        return explicit
+    if not is_xtensa(elf):
+        found = shutil.which("addr2line")  # A native build: the host's binutils
+        if found:
+            return found
+        sys.exit("addr2line not found: install binutils or pass --addr2line")
+    found = shutil.which(ADDR2LINE)
+    if found:
+        return found
+    # PlatformIO keeps its toolchains outside PATH
+    for candidate in sorted((Path.home() / ".platformio" / "packages").glob(f"toolchain-xtensa*/bin/{ADDR2LINE}")):
+        return str(candidate)
+    sys.exit(f"{ADDR2LINE} not found: install the ESP32 toolchain or pass --addr2line")
+
+
+def symbolize(addresses, elf, addr2line):
+    """Map each address to a function name with one addr2line call."""
+    if not addresses:
+        return {}
+    ordered = sorted(addresses - {OUTSIDE})
+    result = subprocess.run(
+        [addr2line, "-f", "-C", "-e", str(elf)] + [f"0x{a:08x}" for a in ordered],
+        check=True, capture_output=True, text=True)
+    lines = result.stdout.splitlines()
+    names = {OUTSIDE: OUTSIDE_NAME}
+    for i, address in enumerate(ordered):
+        name = lines[2 * i].strip() if 2 * i < len(lines) else "??"
+        names[address] = name if name != "??" else f"0x{address:08x}"
+    return names
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Symbolize a /debug/profile capture")
+    parser.add_argument("capture", nargs="?", help="capture file (profile.bin)")
+    parser.add_argument("--board", metavar="URL", help="take a fresh capture from the board, e.g. http://librechess.local")
+    parser.add_argument("--seconds", type=int, default=5, help="capture length with --board (default 5)")
+    parser.add_argument("--save", help="with --board, also write the raw capture here")
+    parser.add_argument("--elf", default=str(DEFAULT_ELF), help="firmware ELF of the running build")
+    parser.add_argument("--addr2line", help="path to xtensa-esp32-elf-addr2line")
+    parser.add_argument("--folded", help="write folded stacks (core;function count) for a flame graph")
+    parser.add_argument("--top", type=int, default=25, help="functions to list (default 25)")
+    parser.add_argument("--force", action="store_true", help="symbolize even if the ELF does not match the build id")
+    args = parser.parse_args()
+
+    if args.board:
+        data = capture_from_board(args.board, args.seconds)
+        if args.save:
+            Path(args.save).write_bytes(data)
+    elif args.capture:
+        data = Path(args.capture).read_bytes()
+    else:
+        parser.error("pass a capture file or --board")
+
+    capture = parse_capture(data)
+    elf = Path(args.elf)
+    if not elf.exists():
+        sys.exit(f"{elf}: not found (build the firmware or pass --elf)")
+    elf_sha = hashlib.sha256(elf.read_bytes()).hexdigest()
+    if elf_sha != capture["elf_sha"]:
+        message = f"Build id mismatch: capture {capture['elf_sha'][:16]}, ELF {elf_sha[:16]}"
+        if not args.force:
+            sys.exit(message + " (flash this ELF or pass --force)")
+        print("Warning: " + message)
+
+    samples = capture["samples"]
+    names = symbolize({s & ~CORE_BIT for s in samples}, elf, find_addr2line(args.addr2line, elf))
+    per_core = Counter()
+    per_function = Counter()
+    folded = Counter()
+    for s in samples:
+        core = 1 if s & CORE_BIT else 0
+        name = names[s & ~CORE_BIT]
+        per_core[core] += 1
+        per_function[name] += 1
+        folded[f"core{core};{name}"] += 1
+
+    total = len(samples)
+    print(f"{total} samples over {capture['duration_ms'] / 1000:.1f}s at {capture['sample_hz']} Hz per core"
+          f" (core 0: {per_core[0]}, core 1: {per_core[1]})")
+    if total:
+        print(f"\n{'samples':>8} {'%':>6}  function")
+        for name, count in per_function.most_common(args.top):
+            print(f"{count:>8} {100.0 * count / total:>5.1f}%  {name}")
+
+    if args.folded:
+        with open(args.folded, "w") as f:
+            for stack, count in sorted(folded.items()):
+                f.write(f"{stack} {count}\n")
+        print(f"\nWrote {args.folded}")
+
+
+if __name__ == "__main__":
+    main()
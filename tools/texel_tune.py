@@ -0,0 +1,311 @@
+"""
+Tune the analysis engine's evaluation weights (src/eval_weights.h) with
+Texel's method.
+
+Positions come from engine-vs-engine games of the firmware's own search
+(ChessSearch, with ChessEngine's move rules), played by the native_texel build
+one game per process on every core, or from an existing EPD file whose positions carry a c9 result opcode ("1-0", "0-1",
+"1/2-1/2"). Each quiet position becomes a feature row (material difference
+plus piece-square occupancy); the evaluation is then a dot product with the
+weight vector, so the whole loss and its gradient are a few numpy matrix
+operations per step. The fitted weights are written back as the constexpr
+header the firmware compiles, so a stronger evaluator costs no extra cycles.
+
+The evaluation model must match ChessSearch::evaluate(): material plus
+piece-square tables, from White's side, Black reading the tables mirrored.
+Before tuning, every position's feature score is checked against the native
+build's `eval` output, so a drifted model stops the run instead of fitting
+terms the firmware does not evaluate.
+
+Requires numpy and the native build (`pio run -e native_texel`).
+
+Usage:
+    python tools/texel_tune.py --games 2000 --depth 2 --save-epd selfplay.epd
+    python tools/texel_tune.py --epd selfplay.epd --iterations 2000
+    python tools/texel_tune.py --epd quiet-labeled.epd --dry-run
+"""
+
+import argparse
+import os
+import re
+import subprocess
+import sys
+import time
+from concurrent.futures import ThreadPoolExecutor, as_completed
+from pathlib import Path
+
+try:
+    import numpy as np
+except ImportError:
+    sys.exit("numpy is required: pip install numpy")
+
+# Must match src/eval_weights.h
+HEADER_PATH = Path(__file__).resolve().parent.parent / "src" / "eval_weights.h"
+PROGRAM_PATH = Path(__file__).resolve().parent.parent / ".pio" / "build" / "native_texel" / "program"
+PIECES = "PNBRQK"
+PIECE_NAMES = ["Pawn", "Knight", "Bishop", "Rook", "Queen", "King (middlegame: stay castled)"]
+NUM_MATERIAL = 6
+NUM_FEATURES = NUM_MATERIAL + 6 * 64
+KING = 5
+WEIGHT_LIMIT = 2000  # Keeps every weight well inside int16_t
+
+RESULTS = {"1-0": 1.0, "0-1": 0.0, "1/2-1/2": 0.5}
+
+
+# ---------------------------
+# Header I/O
+# ---------------------------
+
+def read_weights(path):
+    """Parse EVAL_PIECE_VALUES and EVAL_PST from the header into a flat weight vector."""
+    text = Path(path).read_text()
+
+    def numbers(name):
+        match = re.search(r"\b%s\b[^=]*=\s*\{(.*?)\};" % name, text, re.S)
+        if not match:
+            sys.exit(f"{path}: {name} not found")
+        body = re.sub(r"//[^\n]*", "", match.group(1))
+        return [int(v) for v in re.findall(r"-?\d+", body)]
+
+    values = numbers("EVAL_PIECE_VALUES")
+    pst = numbers("EVAL_PST")
+    if len(values) != NUM_MATERIAL or len(pst) != 6 * 64:
+        sys.exit(f"{path}: expected {NUM_MATERIAL} piece values and {6 * 64} table entries")
+    return np.array(values + pst, dtype=np.float64)
+
+
+def write_weights(path, weights, source):
+    w = [int(round(v)) for v in weights]
+    lines = [
+        "#ifndef EVAL_WEIGHTS_H",
+        "#define EVAL_WEIGHTS_H",
+        "",
+        "#include <stdint.h>",
+        "",
+        "// ---------------------------",
+        "// Evaluation Weights",
+        "// ---------------------------",
+        "// Material and piece-square tables used by ChessSearch::evaluate(), in",
+        "// centipawns. This file is regenerated by tools/texel_tune.py, which fits the",
+        "// weights to game results; keep the layout below so the tool can read the",
+        "// current values back as its starting point.",
+        "//",
+        f"// Source: {source}",
+        "",
+        "// Material values, indexed by \"PNBRQK\" order (the king is never traded, so it stays 0)",
+        "static constexpr int16_t EVAL_PIECE_VALUES[6] = {%s};" % ", ".join(str(v) for v in w[:NUM_MATERIAL]),
+        "",
+        "// Piece-square tables from White's point of view, [row][col] with row 0 = rank 8",
+        "// (same orientation as the board array). Black pieces read the table mirrored (7 - row).",
+        "static constexpr int16_t EVAL_PST[6][8][8] = {",
+    ]
+    for t in range(6):
+        lines.append(f"    // {PIECE_NAMES[t]}")
+        for row in range(8):
+            start = NUM_MATERIAL + t * 64 + row * 8
+            cells = "{%s}" % ", ".join(str(v) for v in w[start:start + 8])
+            prefix = "    {" if row == 0 else "     "
+            suffix = "}" + ("};" if t == 5 else ",") if row == 7 else ","
+            lines.append(prefix + cells + suffix)
+    lines += ["", "#endif // EVAL_WEIGHTS_H", ""]
+    Path(path).write_text("\n".join(lines))
+
+
+# ---------------------------
+# Features
+# ---------------------------
+
+def fen_features(fen):
+    """Sparse (index, sign) pairs for a FEN's placement, White positive."""
+    features = []
+    for row, rank in enumerate(fen.split()[0].split("/")):
+        col = 0
+        for ch in rank:
+            if ch.isdigit():
+                col += int(ch)
+                continue
+            t = PIECES.index(ch.upper())
+            if ch.isupper():
+                features.append((t, 1))
+                features.append((NUM_MATERIAL + t * 64 + row * 8 + col, 1))
+            else:
+                features.append((t, -1))
+                features.append((NUM_MATERIAL + t * 64 + (7 - row) * 8 + col, -1))
+            col += 1
+    return features
+
+
+def build_matrix(positions):
+    """Dense int8 feature matrix (one row per position) and result vector."""
+    x = np.zeros((len(positions), NUM_FEATURES), dtype=np.int8)
+    y = np.empty(len(positions), dtype=np.float64)
+    for i, (fen, result) in enumerate(positions):
+        for index, sign in fen_features(fen):
+            x[i, index] += sign
+        y[i] = result
+    return x, y
+
+
+# ---------------------------
+# Self-Play (native build)
+# ---------------------------
+
+def run_program(program, args, stdin=None):
+    try:
+        done = subprocess.run([program] + args, input=stdin, capture_output=True, text=True, check=True)
+    except FileNotFoundError:
+        sys.exit(f"{program} not found: build it with `pio run -e native_texel`")
+    except subprocess.CalledProcessError as e:
+        sys.exit(f"{program} {' '.join(args)} failed: {e.stderr.strip()}")
+    return done.stdout.splitlines()
+
+
+def play_game(program, seed, depth):
+    """One game of the firmware's search against itself; returns (result, [quiet FENs])."""
+    lines = run_program(program, ["play", str(seed), str(depth)])
+    if not lines or not lines[-1].startswith("result "):
+        sys.exit(f"{program} play {seed}: no result line")
+    return lines[-1].split()[1], lines[:-1]
+
+
+def self_play(program, games, depth, workers):
+    positions = []
+    tally = {"1-0": 0, "0-1": 0, "1/2-1/2": 0}
+    started = time.time()
+    # Each game is its own process, so threads are enough to keep every core busy
+    with ThreadPoolExecutor(workers) as pool:
+        jobs = [pool.submit(play_game, program, seed, depth) for seed in range(games)]
+        for done, job in enumerate(as_completed(jobs), 1):
+            result, fens = job.result()
+            tally[result] += 1
+            positions += [(fen, RESULTS[result]) for fen in fens]
+            if done % 50 == 0 or done == games:
+                print(f"  {done}/{games} games, {len(positions)} positions, {time.time() - started:.0f}s")
+    print(f"Self-play: +{tally['1-0']} -{tally['0-1']} ={tally['1/2-1/2']}")
+    return positions
+
+
+def check_model(program, positions, x, weights):
+    """Exit unless the feature model scores every position as ChessSearch::evaluate() does."""
+    fens = "".join(fen + "\n" for fen, _ in positions)
+    firmware = np.array([int(v) for v in run_program(program, ["eval"], fens)], dtype=np.float64)
+    mismatch = np.flatnonzero(firmware != x @ weights)
+    if len(firmware) != len(positions) or len(mismatch):
+        i = mismatch[0] if len(mismatch) else 0
+        sys.exit(f"Feature model disagrees with ChessSearch::evaluate() on {positions[i][0]}: "
+                 f"{x[i] @ weights:.0f} vs {firmware[i]:.0f}. Update fen_features() to match, "
+                 f"and rebuild {program} if {HEADER_PATH.name} changed.")
+
+
+def read_epd(path):
+    positions = []
+    for line in Path(path).read_text().splitlines():
+        match = re.search(r'c9\s+"([^"]+)"', line)
+        if not match or match.group(1) not in RESULTS:
+            continue
+        fields = line.split()
+        positions.append((" ".join(fields[:4]) + " 0 1", RESULTS[match.group(1)]))
+    return positions
+
+
+def write_epd(path, positions):
+    names = {v: k for k, v in RESULTS.items()}
+    with open(path, "w") as f:
+        for fen, result in positions:
+            f.write(" ".join(fen.split()[:4]) + f' c9 "{names[result]}";\n')
+
+
+# ---------------------------
+# Tuning
+# ---------------------------
+
+def loss(x, y, weights, k):
+    predicted = 1.0 / (1.0 + np.power(10.0, -k * (x @ weights) / 400.0))
+    return float(np.mean((y - predicted) ** 2))
+
+
+def fit_k(x, y, weights):
+    """Scale of the evaluation-to-probability sigmoid that best fits the start weights."""
+    lo, hi = 0.1, 3.0
+    for _ in range(40):  # Golden-section search, loss is unimodal in k
+        a = hi - (hi - lo) / 1.618
+        b = lo + (hi - lo) / 1.618
+        if loss(x, y, weights, a) < loss(x, y, weights, b):
+            hi = b
+        else:
+            lo = a
+    return (lo + hi) / 2
+
+
+def tune(x, y, start, k, iterations, rate, l2):
+    """Adam on the mean squared error, with L2 pull toward the start weights."""
+    xf = x.astype(np.float32)
+    weights = start.copy()
+    frozen = np.zeros_like(weights, dtype=bool)
+    frozen[KING] = True  # King material cancels out in every position
+    m = np.zeros_like(weights)
+    v = np.zeros_like(weights)
+    c = k * np.log(10.0) / 400.0
+    for step in range(1, iterations + 1):
+        predicted = 1.0 / (1.0 + np.exp(-c * (xf @ weights)))
+        error = predicted - y
+        grad = (2.0 / len(y)) * c * (xf.T @ (error * predicted * (1.0 - predicted)))
+        grad += l2 * (weights - start)
+        grad[frozen] = 0.0
+        m = 0.9 * m + 0.1 * grad
+        v = 0.999 * v + 0.001 * grad * grad
+        weights -= rate * (m / (1 - 0.9 ** step)) / (np.sqrt(v / (1 - 0.999 ** step)) + 1e-12)
+        np.clip(weights, -WEIGHT_LIMIT, WEIGHT_LIMIT, out=weights)
+        if step % 200 == 0 or step == iterations:
+            print(f"  step {step}: loss {loss(x, y, weights, k):.6f}")
+    return weights
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Texel-tune src/eval_weights.h")
+    parser.add_argument("--epd", help="labeled positions to tune on instead of self-play")
+    parser.add_argument("--games", type=int, default=1000, help="self-play games (default 1000)")
+    parser.add_argument("--depth", type=int, default=2, help="self-play search depth (default 2)")
+    parser.add_argument("--workers", type=int, default=os.cpu_count(), help="self-play processes (default: all cores)")
+    parser.add_argument("--program", default=str(PROGRAM_PATH), help="native_texel build to play and evaluate with")
+    parser.add_argument("--save-epd", help="write the self-play positions here for later runs")
+    parser.add_argument("--iterations", type=int, default=1000, help="optimizer steps (default 1000)")
+    parser.add_argument("--rate", type=float, default=1.0, help="Adam step size in centipawns (default 1.0)")
+    parser.add_argument("--l2", type=float, default=1e-7, help="pull toward the start weights (default 1e-7)")
+    parser.add_argument("--header", default=str(HEADER_PATH), help="weights header to read and rewrite")
+    parser.add_argument("--dry-run", action="store_true", help="report the loss change without writing the header")
+    args = parser.parse_args()
+
+    start = read_weights(args.header)
+    if args.epd:
+        positions = read_epd(args.epd)
+        source = f"Texel-tuned on {Path(args.epd).name}"
+    else:
+        positions = self_play(args.program, args.games, args.depth, args.workers)
+        if args.save_epd:
+            write_epd(args.save_epd, positions)
+        source = f"Texel-tuned on {args.games} self-play games at depth {args.depth}"
+    if not positions:
+        sys.exit("No labeled positions")
+
+    x, y = build_matrix(positions)
+    if Path(args.header).resolve() == HEADER_PATH:
+        check_model(args.program, positions, x, start)
+    else:
+        print(f"{args.header} is not the header the native build compiles: skipping the model check")
+    k = fit_k(x, y, start)
+    before = loss(x, y, start, k)
+    print(f"{len(y)} positions, K = {k:.3f}, start loss {before:.6f}")
+    weights = tune(x, y, start, k, args.iterations, args.rate, args.l2)
+    after = loss(x, y, np.round(weights), k)
+    print(f"Loss {before:.6f} -> {after:.6f}")
+    print("Piece values: " + " ".join(f"{p}={int(round(v))}" for p, v in zip(PIECES, weights[:NUM_MATERIAL])))
+
+    if args.dry_run:
+        return
+    write_weights(args.header, weights, f"{source}, {len(y)} positions, loss {after:.6f}")
+    print(f"Wrote {args.header}")
+
+
+if __name__ == "__main__":
+    main()
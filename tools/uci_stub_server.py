@@ -0,0 +1,241 @@
+"""
+Serve a UCI engine over TCP for the board's LAN engine backend.
+
+The board connects to <host>:<port>, sends UCI commands one per line and
+reads the engine's replies (see src/uci_engine.h). Two modes:
+
+  Stub (default): a fake engine for testing. It plays a random legal move,
+  streams an `info` line per depth every --depth-ms, honours `go depth`,
+  `go movetime`, `go infinite` and `stop`, and answers `bestmove`. Needs
+  python-chess (`pip install chess`) to pick legal moves.
+
+  Bridge (--engine): starts the given engine binary for each connection and
+  relays lines both ways, so a real engine (e.g. Stockfish) on a LAN machine
+  can play the board at full strength.
+
+Usage:
+    python tools/uci_stub_server.py
+    python tools/uci_stub_server.py --port 4000 --depth-ms 200 --verbose
+    python tools/uci_stub_server.py --engine /usr/games/stockfish
+"""
+
+import argparse
+import random
+import socketserver
+import subprocess
+import sys
+import threading
+import time
+
+DEFAULT_PORT = 4000  # Must match LanEngineSettings in src/stockfish_settings.h
+STUB_MAX_DEPTH = 30
+
+
+class Connection:
+    """Line-based I/O on one client socket."""
+
+    def __init__(self, sock, verbose):
+        self.sock = sock
+        self.reader = sock.makefile("r", encoding="ascii", errors="replace", newline="\n")
+        self.verbose = verbose
+        self.lock = threading.Lock()
+
+    def lines(self):
+        for line in self.reader:
+            line = line.strip()
+            if self.verbose:
+                print(f"<< {line}")
+            yield line
+
+    def send(self, line):
+        if self.verbose:
+            print(f">> {line}")
+        with self.lock:
+            try:
+                self.sock.sendall((line + "\n").encode("ascii"))
+            except OSError:
+                pass  # Client gone; the read loop ends on its own
+
+
+class StubEngine:
+    """Fake engine: random legal moves, made-up scores, real UCI timing."""
+
+    def __init__(self, conn, depth_ms, seed):
+        import chess  # Only the stub needs python-chess
+
+        self.chess = chess
+        self.conn = conn
+        self.depth_ms = depth_ms
+        self.random = random.Random(seed)
+        self.board = chess.Board()
+        self.search = None
+        self.stop_event = threading.Event()
+
+    def handle(self, line):
+        tokens = line.split()
+        if not tokens:
+            return True
+        command = tokens[0]
+        if command == "uci":
+            self.conn.send("id name LibreChess UCI stub")
+            self.conn.send("id author LibreChess")
+            self.conn.send("uciok")
+        elif command == "isready":
+            self.conn.send("readyok")
+        elif command == "ucinewgame":
+            self.board = self.chess.Board()
+        elif command == "position":
+            self.position(tokens[1:])
+        elif command == "go":
+            self.go(tokens[1:])
+        elif command == "stop":
+            self.stop_search()
+        elif command == "quit":
+            return False
+        return True
+
+    def position(self, args):
+        try:
+            if args and args[0] == "startpos":
+                self.board = self.chess.Board()
+                rest = args[1:]
+            elif args and args[0] == "fen":
+                end = args.index("moves") if "moves" in args else len(args)
+                self.board = self.chess.Board(" ".join(args[1:end]))
+                rest = args[end:]
+            else:
+                return
+            if rest and rest[0] == "moves":
+                for move in rest[1:]:
+                    self.board.push_uci(move)
+        except ValueError as e:
+            self.conn.send(f"info string bad position: {e}")
+
+    def go(self, args):
+        self.stop_search()
+        options = {}
+        for i, token in enumerate(args):
+            if token in ("depth", "movetime") and i + 1 < len(args):
+                options[token] = int(args[i + 1])
+            elif token == "infinite":
+                options["infinite"] = True
+        self.stop_event.clear()
+        self.search = threading.Thread(target=self.think, args=(self.board.copy(), options), daemon=True)
+        self.search.start()
+
+    def stop_search(self):
+        self.stop_event.set()
+        if self.search:
+            self.search.join()
+            self.search = None
+
+    def think(self, board, options):
+        moves = list(board.legal_moves)
+        start = time.monotonic()
+        max_depth = options.get("depth", STUB_MAX_DEPTH)
+        movetime = options.get("movetime")
+        best = self.random.choice(moves) if moves else None
+        score = self.random.randint(-60, 60)
+        depth = 0
+        while moves and depth < max_depth:
+            if self.stop_event.wait(self.depth_ms / 1000):
+                break
+            elapsed_ms = int((time.monotonic() - start) * 1000)
+            if movetime is not None and elapsed_ms >= movetime and not options.get("infinite"):
+                break
+            depth += 1
+            if self.random.random() < 0.3:
+                best = self.random.choice(moves)  # Change its mind now and then, like a real search
+            score += self.random.randint(-15, 15)
+            pv = [best.uci()]
+            board.push(best)
+            replies = list(board.legal_moves)
+            if replies:
+                pv.append(self.random.choice(replies).uci())
+            board.pop()
+            nodes = depth * 12000
+            self.conn.send(f"info depth {depth} seldepth {depth + 2} multipv 1 score cp {score} nodes {nodes} "
+                           f"nps {nodes * 1000 // max(elapsed_ms, 1)} time {elapsed_ms} pv {' '.join(pv)}")
+        if options.get("infinite"):
+            self.stop_event.wait()  # `go infinite` only answers after `stop`
+        if best is None:
+            self.conn.send("bestmove (none)")
+        else:
+            self.conn.send(f"bestmove {best.uci()}" + (f" ponder {pv[1]}" if depth and len(pv) > 1 else ""))
+
+
+def serve_stub(conn, args):
+    engine = StubEngine(conn, args.depth_ms, args.seed)
+    for line in conn.lines():
+        if not engine.handle(line):
+            break
+    engine.stop_search()
+
+
+def serve_bridge(conn, args):
+    try:
+        engine = subprocess.Popen([args.engine], stdin=subprocess.PIPE, stdout=subprocess.PIPE, text=True, bufsize=1)
+    except OSError as e:
+        conn.send(f"info string cannot start {args.engine}: {e}")
+        return
+
+    def relay_output():
+        for line in engine.stdout:
+            conn.send(line.rstrip("\r\n"))
+
+    threading.Thread(target=relay_output, daemon=True).start()
+    try:
+        for line in conn.lines():
+            engine.stdin.write(line + "\n")
+            engine.stdin.flush()
+            if line == "quit":
+                break
+    except BrokenPipeError:
+        pass
+    finally:
+        if engine.poll() is None:
+            try:
+                engine.stdin.write("quit\n")
+                engine.stdin.flush()
+                engine.wait(timeout=2)
+            except (BrokenPipeError, subprocess.TimeoutExpired):
+                engine.kill()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Serve a UCI engine over TCP for the LibreChess LAN engine backend")
+    parser.add_argument("--host", default="0.0.0.0", help="address to listen on (default: all interfaces)")
+    parser.add_argument("--port", type=int, default=DEFAULT_PORT, help=f"TCP port (default: {DEFAULT_PORT})")
+    parser.add_argument("--engine", metavar="PATH", help="bridge to this UCI engine binary instead of the stub")
+    parser.add_argument("--depth-ms", type=int, default=100, help="stub: time per depth iteration (default: 100)")
+    parser.add_argument("--seed", type=int, help="stub: random seed, for repeatable games")
+    parser.add_argument("--verbose", action="store_true", help="print every line sent and received")
+    args = parser.parse_args()
+
+    if not args.engine:
+        try:
+            import chess  # noqa: F401
+        except ImportError:
+            sys.exit("python-chess is required for the stub: pip install chess (or use --engine)")
+
+    serve = serve_bridge if args.engine else serve_stub
+
+    class Handler(socketserver.BaseRequestHandler):
+        def handle(self):
+            print(f"Board connected from {self.client_address[0]}")
+            serve(Connection(self.request, args.verbose), args)
+            print(f"Board {self.client_address[0]} disconnected")
+
+    socketserver.ThreadingTCPServer.allow_reuse_address = True
+    socketserver.ThreadingTCPServer.daemon_threads = True
+    with socketserver.ThreadingTCPServer((args.host, args.port), Handler) as server:
+        mode = f"bridging {args.engine}" if args.engine else "stub engine"
+        print(f"UCI server ({mode}) listening on {args.host}:{args.port}")
+        try:
+            server.serve_forever()
+        except KeyboardInterrupt:
+            pass
+
+
+if __name__ == "__main__":
+    main()